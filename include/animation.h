@@ -2,6 +2,10 @@
 
 #include "msk.h"
 #include "pixel.h"
+#include "assetstore.h"
+#include "shader.h"
+
+class Compositor;
 
 // Animation types
 enum AnimationType
@@ -11,9 +15,21 @@ enum AnimationType
         ANIM_RAINBOW_CYCLE,
         ANIM_BREATHING,
         ANIM_SPARKLE,
-        ANIM_BITMAP
+        ANIM_BITMAP,
+        ANIM_SHADER
 };
 
+// Animation timing. Every effect is a function of the time since start(),
+// so the refresh rate changes smoothness, never speed.
+namespace AnimConfig
+{
+        constexpr u16 REFRESH_MS = 40;         // Default refresh for continuous content (25 Hz)
+        constexpr u16 STEP_MS = 50;            // Chase/rainbow: one step per 50 ms (20 Hz movement)
+        constexpr u16 SPARKLE_STEP_MS = 120;   // Sparkle: the dot jumps every 120 ms
+        constexpr u16 BREATH_PERIOD_MS = 8000; // Breathing: one full in/out cycle
+        constexpr u8 BREATH_PEAK = 100;        // Breathing: brightest level (0-255)
+}
+
 // Bitmap animation data structure
 // Self-contained descriptor for memory-mapped RGB animation data
 struct BitmapAnimation
@@ -33,6 +49,34 @@ constexpr BitmapAnimation createBitmapAnimation(const u32 (&data)[Frames][Leds],
         return {&data[0][0], (u16)Frames, (u16)Leds, frameRate};
 }
 
+// Packed bitmap animation (generated by tools/anim_encode.py)
+// Colors come from a palette of up to 256 entries; each frame is a token
+// stream of palette indices. Frame 0 is self-contained, later frames may
+// skip pixels that did not change since the previous frame.
+struct PackedAnimation
+{
+        const u32 *palette; // Palette colors (0x00RRGGBB)
+        const u8 *data;     // Token stream for all frames, back to back
+        u32 dataSize;       // Bytes in data
+        u16 frameCount;     // Total number of frames
+        u16 ledCount;       // Number of LEDs per frame
+        u16 paletteSize;    // Entries in palette (1-256)
+        u8 frameRate;       // Playback speed in Frames Per Second
+};
+
+// Token layout of PackedAnimation::data (count stored as n - 1)
+namespace PackedAnimToken
+{
+        constexpr u8 RUN = 0x00;     // 0nnnnnnn idx        : 1-128 LEDs of one color
+        constexpr u8 LITERAL = 0x80; // 10nnnnnn idx...     : 1-64 LEDs, one index each
+        constexpr u8 SKIP = 0xC0;    // 11nnnnnn            : 1-64 LEDs unchanged
+        constexpr u8 RUN_MASK = 0x7F;
+        constexpr u8 COUNT_MASK = 0x3F;
+}
+
+// Called when an animation starts, so the owner can schedule update()
+typedef void (*AnimationWakeCallback)(void);
+
 class Animation
 {
 public:
@@ -42,11 +86,20 @@ public:
         // Initialize the animation system
         void init();
 
-        // Refresh animation (checks flag, clears it, and updates if needed)
-        void refresh(volatile bool &flag);
+        // Render the animation at the current time and push changed pixels
+        // (called by the Core animation task)
+        // Returns ms until the next update is needed, 0 if none (paused, stopped or
+        // holding the last frame of a one-shot bitmap)
+        u32 update();
+
+        // Update period for continuous content (breathing, cross-fades) and the
+        // shortest period for stepped effects; does not change animation speed
+        void setRefreshMs(u16 ms) { m_refreshMs = ms ? ms : 1; }
+        u16 getRefreshMs() const { return m_refreshMs; }
 
-        // Update animation state (call from main loop when flagged)
-        void update();
+        // Cross-fade bitmap animations between keyframes (applies from the next startBitmap)
+        // Packed animations then keep two decoded keyframes (8 bytes per LED)
+        void setCrossfade(bool enable) { m_crossfade = enable; }
 
         // Start/stop animation
         void start(AnimationType type);
@@ -56,6 +109,23 @@ public:
         // loop: true for infinite loop, false for one-shot
         void startBitmap(const BitmapAnimation *animData, bool loop = true);
 
+        // Start a packed bitmap animation (decoded one frame per step)
+        void startBitmap(const PackedAnimation *animData, bool loop = true);
+
+        // Start a packed animation stored in the AssetStore (ASSET_PACKED_ANIMATION)
+        // The palette is loaded to RAM; the token stream is read in chunks.
+        // Returns false if the asset is missing or malformed
+        bool startBitmap(u16 assetId, bool loop = true);
+
+        // Run a procedural shader program on every pixel each refresh
+        // (program memory must stay valid while it runs)
+        // Returns false if the program fails validation
+        bool startShader(const ShaderProgram &program);
+
+        // Run a shader stored in the AssetStore (ASSET_SHADER, loaded to RAM)
+        // Returns false if the asset is missing or malformed
+        bool startShader(u16 assetId);
+
         // Stop animation
         // clearPixels: true to turn off LEDs, false to leave them as-is (pause)
         void stop(bool clearPixels = true);
@@ -65,6 +135,13 @@ public:
 
         bool isActive() const { return m_active; }
 
+        // Draw into a compositor layer instead of the strip (nullptr = strip)
+        // Set by Compositor::setSource(); the compositor then sends the frames
+        void setLayer(Compositor *compositor, u8 layer);
+
+        // Set the hook called by start()/startBitmap()
+        void setWakeCallback(AnimationWakeCallback callback) { m_wake = callback; }
+
         // Get current animation type
         AnimationType getType() const { return m_type; }
 
@@ -72,19 +149,56 @@ private:
         PixelStrip *m_pixels;
         bool m_active;
         AnimationType m_type;
-        u16 m_position; // Changed from u8 to u16 to support larger frame counts
-        u16 m_frameCounter;
-        u16 m_stepDelay;
+        u32 m_startTime; // millis() at start: the animation timebase
+        u16 m_refreshMs;
+        u16 m_position;  // Bitmap: frame shown (packed: keyframe A), 0xFFFF = none yet
+        u16 m_shownFrac; // Bitmap: cross-fade fraction shown with m_position
 
-        // Bitmap animation state
+        // Bitmap animation state (raw or packed, one of the two is set)
         const BitmapAnimation *m_currentBitmap;
+        const PackedAnimation *m_currentPacked;
+        u32 m_streamPos;    // Packed: offset of the next frame's tokens
+        u16 m_decodedFrame; // Packed: frame the stream position follows
         bool m_bitmapLoop;
-        u32 m_lastFrameTime;
-
-        // Animation implementations
-        void updateRedDotChase();
-        void updateRainbowCycle();
-        void updateBreathing();
-        void updateSparkle();
-        void updateBitmap();
+        bool m_bitmapHeld; // One-shot finished: last frame stays, no more updates
+        bool m_crossfade;
+        u32 *m_keyA; // Packed cross-fade: keyframe m_position
+        u32 *m_keyB; // Packed cross-fade: keyframe m_position + 1
+
+        // Packed animation streamed from the AssetStore (m_asset.data == nullptr)
+        PackedAnimation m_asset;
+        AssetReader m_reader;
+        u32 *m_assetPalette;
+        u32 m_assetStreamStart; // Payload offset of the token stream
+
+        // Shader state (code/palette owned only when loaded from an asset)
+        Shader m_shader;
+        u8 *m_shaderCode;
+        u32 *m_shaderPalette;
+
+        AnimationWakeCallback m_wake;
+
+        // Output target
+        Compositor *m_compositor; // nullptr = draw straight into m_pixels
+        u8 m_layer;
+
+        void put(u16 index, u32 color);
+
+        // Animation implementations: render at `elapsed` ms, return ms until the next change
+        u32 updateRedDotChase(u32 elapsed);
+        u32 updateRainbowCycle(u32 elapsed);
+        u32 updateBreathing(u32 elapsed);
+        u32 updateSparkle(u32 elapsed);
+        u32 updateBitmap(u32 elapsed);
+        u32 updateShader(u32 elapsed);
+        void showRawFrame(u16 frame, u16 frac);
+        void showPackedFrame(u16 frame, u16 frac);
+        void startPacked(const PackedAnimation *animData, bool loop);
+        void releaseBitmap();
+        bool runShader(const ShaderProgram &program);
+        void decodeNextPacked(u32 *dst);
+        void decodePackedFrame(u32 *dst);
+        bool packedWindow(u32 pos, const u8 *&p, const u8 *&end);
+        u16 bitmapFrameCount() const;
+        u8 bitmapFrameRate() const;
 };
@@ -5,13 +5,17 @@
 #include "inputmanager.h"
 #include "roomserial.h" // Include full definition for sendFrame
 #include "deviceconfig.h"
+#include "dispatch.h"
 
 // Forward declarations to avoid circular includes
 class PixelStrip;
 class Synth;
 class Animation;
 class IOExpander;
+class ExpanderBus;
 class MatrixPanel;
+class MotorController;
+class Compositor;
 
 /**
  * @brief Context structure passed to applications
@@ -24,10 +28,14 @@ struct AppContext
         Animation *animation;
         InputManager *inputManager;
         RoomSerial *roomBus;
-        IOExpander *ioExpander;
+        IOExpander *ioExpander;       // Primary expander (0x20)
+        ExpanderBus *expanders;       // All expanders, unified pin space
         MatrixPanel *matrixPanel;
+        MotorController *motors;      // Speed/ramp/timed motor control
+        Compositor *compositor;       // Layered pixel output (opt-in)
         const u8 *deviceAddress;      // Pointer to Core::m_address
         const DeviceType *deviceType; // Pointer to Core::m_type
+        CommandTable *commands;       // Register device command handlers here in setup()
 };
 
 /**
@@ -64,10 +72,17 @@ public:
         virtual void loop() {}
 
         /**
-         * @brief Handle an incoming RoomBus command targeted at this device
-         * @param frame The received command frame
+         * @brief Register the handler of a device command (call from setup())
+         * Commands without a handler are answered with EV_DEVICE_ERROR, and
+         * handlers are dropped when the App is replaced.
+         * @param cmd Device command (SERVER_MIN..SERVER_MAX, see roombus.h)
+         * @param fn Handler; ctx is passed through (usually the App)
          */
-        virtual void handleCommand(const RoomFrame &frame) {}
+        void onCommand(u8 cmd, CommandFn fn, void *ctx)
+        {
+                if (m_context.commands)
+                        m_context.commands->set(cmd, fn, ctx);
+        }
 
         /**
          * @brief Handle a local input event (button press, keypad, etc.)
@@ -121,6 +136,34 @@ public:
                 return -1;
         }
 
+        /**
+         * @brief Helper to get the keypad index (0-15) from a release event.
+         * @param event The input event.
+         * @return The index (0-15) or -1 if not a keypad release event.
+         */
+        int getKeypadReleaseIndex(InputEvent event) const
+        {
+                if (event >= INPUT_KEYPAD_RELEASE_0 && event <= INPUT_KEYPAD_RELEASE_15)
+                {
+                        return event - INPUT_KEYPAD_RELEASE_0;
+                }
+                return -1;
+        }
+
+        /**
+         * @brief Helper to get the keypad index (0-15) from a hold event.
+         * @param event The input event.
+         * @return The index (0-15) or -1 if not a keypad hold event.
+         */
+        int getKeypadHoldIndex(InputEvent event) const
+        {
+                if (event >= INPUT_KEYPAD_HOLD_0 && event <= INPUT_KEYPAD_HOLD_15)
+                {
+                        return event - INPUT_KEYPAD_HOLD_0;
+                }
+                return -1;
+        }
+
 protected:
         AppContext m_context;
 };
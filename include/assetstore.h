@@ -0,0 +1,209 @@
+/************************* assetstore.h *************************
+ * Asset store on the LittleFS data partition
+ * Animations, songs and shaders kept as files and found by a 16-bit asset ID
+ * Created by MSK, November 2025
+ * Assets are read through a small chunk window, never loaded whole
+ ***************************************************************/
+
+#ifndef ASSETSTORE_H
+#define ASSETSTORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "msk.h"
+
+namespace AssetConfig
+{
+        constexpr u8 MAX_ASSETS = 32;               // Index slots (12 bytes of RAM each)
+        constexpr u16 CHUNK_SIZE = 256;             // AssetReader window (bytes)
+        constexpr u32 MAX_SIZE = 512 * 1024;        // Largest accepted payload
+        constexpr u32 MAGIC = 0x31415352;           // "RSA1" (little-endian)
+        constexpr u8 VERSION = 1;                   // AssetHeader::version
+        constexpr const char *DIR = "/assets";      // One file per asset: /assets/<id hex>.bin
+        constexpr const char *UPLOAD_PATH = "/assets/upload.tmp";
+}
+
+// What an asset's payload holds
+enum AssetType : u8
+{
+        ASSET_NONE = 0,
+        ASSET_PACKED_ANIMATION = 1, // PackedAssetHeader + palette + token stream
+        ASSET_SONG = 2,             // SongAssetHeader + notes
+        ASSET_SHADER = 3,           // ShaderAssetHeader + palette + bytecode
+        ASSET_PUZZLE = 4            // PuzzleAssetHeader + bytecode
+};
+
+// File header in front of every payload (16 bytes, little-endian)
+struct AssetHeader
+{
+        u32 magic;   // AssetConfig::MAGIC
+        u16 id;      // Asset ID
+        u8 type;     // AssetType
+        u8 version;  // AssetConfig::VERSION
+        u32 size;    // Payload bytes after this header
+        u32 crc;     // CRC-32 of the payload (same as zlib.crc32)
+};
+
+// ASSET_PACKED_ANIMATION payload: this header, paletteSize u32 colors
+// (0x00RRGGBB), then the PackedAnimation token stream up to the end
+struct PackedAssetHeader
+{
+        u16 frameCount;
+        u16 ledCount;
+        u16 paletteSize; // 1-256
+        u8 frameRate;
+        u8 reserved;
+};
+
+// ASSET_SONG payload: this header, then length SongAssetNote records
+struct SongAssetHeader
+{
+        u16 length; // Notes
+        u8 bpm;
+        u8 reserved;
+};
+
+struct SongAssetNote
+{
+        u16 note;     // Frequency (Hz), 0 = rest
+        u16 duration; // 16th notes
+        u16 advance;  // 16th notes until the next note (0 = chord)
+        u8 preset;    // SoundPreset
+        u8 reserved;
+};
+
+// ASSET_SHADER payload: this header, paletteSize u32 colors (0x00RRGGBB),
+// then codeSize bytes of Shader bytecode (see ShaderOp in shader.h)
+struct ShaderAssetHeader
+{
+        u16 codeSize;
+        u16 width; // Pixels per row for X/Y (0 = one row)
+        u8 paletteSize;
+        u8 reserved[3];
+};
+
+// ASSET_PUZZLE payload: this header, then codeSize bytes of PuzzleVM
+// bytecode (see PuzzleOp in puzzlevm.h)
+struct PuzzleAssetHeader
+{
+        u16 codeSize;
+        u16 entries[7]; // Code offset per PuzzleEvent (0xFFFF = no handler)
+};
+
+static_assert(sizeof(AssetHeader) == 16, "AssetHeader layout is part of the file format");
+static_assert(sizeof(PackedAssetHeader) == 8, "PackedAssetHeader layout is part of the file format");
+static_assert(sizeof(SongAssetHeader) == 4, "SongAssetHeader layout is part of the file format");
+static_assert(sizeof(SongAssetNote) == 8, "SongAssetNote layout is part of the file format");
+static_assert(sizeof(ShaderAssetHeader) == 8, "ShaderAssetHeader layout is part of the file format");
+static_assert(sizeof(PuzzleAssetHeader) == 16, "PuzzleAssetHeader layout is part of the file format");
+
+// One index entry (built from the file headers at mount)
+struct AssetInfo
+{
+        u16 id;
+        AssetType type;
+        u32 size; // Payload bytes
+        u32 crc;
+};
+
+/**
+ * AssetReader
+ * Reads one asset's payload through a CHUNK_SIZE window, so sequential
+ * readers (the packed animation decoder) touch flash once per chunk and
+ * RAM use does not depend on the asset size.
+ */
+class AssetReader
+{
+public:
+        AssetReader();
+        ~AssetReader() { close(); }
+
+        /**
+         * Open an asset for reading
+         * @param id Asset ID
+         * @param type Expected type (fails on mismatch)
+         * @return true on success
+         */
+        bool open(u16 id, AssetType type);
+
+        void close();
+        bool isOpen() const { return m_open; }
+        u32 size() const { return m_size; }
+
+        /**
+         * Copy payload bytes straight into dst (headers, palettes, notes)
+         * @return true if all len bytes were read
+         */
+        bool read(u32 offset, void *dst, u32 len);
+
+        /**
+         * Point p/end at the window holding payload offset (refills if needed)
+         * @return false past the end of the payload or on a read error
+         */
+        bool window(u32 offset, const u8 *&p, const u8 *&end);
+
+private:
+        File m_file;
+        bool m_open;
+        u32 m_size;        // Payload bytes
+        u32 m_windowStart; // Payload offset of m_window[0]
+        u16 m_windowLen;   // Valid bytes in m_window
+        u8 m_window[AssetConfig::CHUNK_SIZE];
+};
+
+/**
+ * AssetStore
+ * Mounts LittleFS and keeps a RAM index of the assets in AssetConfig::DIR.
+ * The index is rebuilt from the file headers at mount, so files written by
+ * `pio run -t uploadfs` and by a bus upload are found the same way; a file
+ * whose payload does not match its header CRC is left out.
+ * A bus upload goes to a temp file and is renamed into place only after its
+ * size and CRC check out; the rename replaces an older copy in one step, so
+ * neither a reset nor a failed commit leaves a broken or missing asset.
+ */
+class AssetStore
+{
+public:
+        /**
+         * Mount the partition (formatted on first use) and build the index
+         * @return true if the store is usable
+         */
+        static bool begin();
+
+        static bool isMounted();
+
+        /**
+         * Look up an asset
+         * @return Index entry, nullptr if not stored
+         */
+        static const AssetInfo *find(u16 id);
+
+        static u8 count();
+        static const AssetInfo *at(u8 index);
+        static u32 freeBytes();
+
+        /**
+         * Delete an asset (file and index entry)
+         */
+        static bool remove(u16 id);
+
+        // Upload (one at a time; data must arrive in order)
+        static bool uploadBegin(u16 id, AssetType type, u32 size, u32 crc);
+        static bool uploadWrite(u32 offset, const u8 *data, u8 len);
+        static bool uploadCommit();
+        static void uploadAbort();
+        static bool isUploading();
+        static u32 uploadOffset(); // Next payload offset expected
+
+        /**
+         * Build the file path of an asset into buf
+         */
+        static void path(u16 id, char *buf, size_t len);
+
+        /**
+         * Print the index to Serial
+         */
+        static void list();
+};
+
+#endif // ASSETSTORE_H
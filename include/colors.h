@@ -18,4 +18,20 @@
 #define CLR_OR 0xFF4000
 #define CLR_PR 0x5000FF
 #define OFF 0x000000
+
+#include <stdint.h>
+
+/************************* colorLerp ******************************
+ * a + (b - a) * alpha / 256 on all channels of 0x00RRGGBB colors.
+ * R and B share one multiply (16-bit lanes), G takes another.
+ * @param alpha 0 (all a) to 256 (all b).
+ ***************************************************************/
+static inline uint32_t colorLerp(uint32_t a, uint32_t b, uint32_t alpha)
+{
+        uint32_t inv = 256 - alpha;
+        uint32_t rb = (((a & 0x00FF00FF) * inv + (b & 0x00FF00FF) * alpha) >> 8) & 0x00FF00FF;
+        uint32_t g = (((a & 0x0000FF00) * inv + (b & 0x0000FF00) * alpha) >> 8) & 0x0000FF00;
+        return rb | g;
+}
+
 #endif // COLORS_H
@@ -0,0 +1,138 @@
+/************************* compositor.h *************************
+ * Layered pixel compositor
+ * N layers with opacity, blend mode and mask over one PixelStrip
+ * Created by MSK, November 2025
+ * Integer-only blending on packed 0x00RRGGBB words
+ ***************************************************************/
+
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "msk.h"
+#include "pixel.h"
+
+class Animation;
+
+// Called when a layer changes, so the owner can schedule update()
+typedef void (*CompositorWakeCallback)(void);
+
+namespace CompositorConfig
+{
+        constexpr u8 MAX_LAYERS = 4; // Layer slots (bottom = 0)
+}
+
+// How a layer combines with the layers below it
+enum BlendMode
+{
+        BLEND_OVER,     // Replace (opacity < 255 cross-fades)
+        BLEND_ADD,      // Per-channel saturating add
+        BLEND_MULTIPLY, // Per-channel multiply (darken / tint)
+        BLEND_MAX       // Per-channel maximum (lighten)
+};
+
+// One layer: its own logical-pixel buffer plus how it is blended
+struct CompositorLayer
+{
+        u32 *pixels;       // logicalCount packed colors (0x00RRGGBB)
+        u8 *mask;          // 1 bit per pixel, nullptr = whole layer visible
+        Animation *source; // Animation rendering into this layer (optional)
+        u8 opacity;        // 0 = hidden, 255 = opaque
+        BlendMode mode;
+};
+
+/**
+ * Compositor
+ * Opt-in: an app calls begin() to split the strip into layers, draws its
+ * own content into one layer and attaches animations to others. Layers are
+ * blended bottom-up into the PixelStrip frame once per frame, and only when
+ * a layer changed: every change calls the wake hook, and the owner's frame
+ * task (Core's animation task) runs update(). Apps never render themselves.
+ * Without begin(), animations and apps draw straight into the PixelStrip
+ * as before.
+ */
+class Compositor
+{
+public:
+        explicit Compositor(PixelStrip *pixels);
+        ~Compositor();
+
+        /**
+         * Allocate layers (all transparent black, opacity 255, BLEND_OVER)
+         * @param layerCount Number of layers (1 to MAX_LAYERS)
+         * @return true on success
+         */
+        bool begin(u8 layerCount);
+
+        /**
+         * Free all layers and detach sources (animations draw to the strip again)
+         */
+        void end();
+
+        bool isEnabled() const { return m_layerCount > 0; }
+        u8 getLayerCount() const { return m_layerCount; }
+
+        // Layer drawing (logical pixel index as in PixelStrip)
+        void setColor(u8 layer, u16 index, u32 color);
+        u32 getColor(u8 layer, u16 index) const;
+        void fill(u8 layer, u32 color);
+        void clear(u8 layer) { fill(layer, 0); }
+
+        // Layer properties
+        void setOpacity(u8 layer, u8 opacity);
+        void setBlendMode(u8 layer, BlendMode mode);
+
+        /**
+         * Attach an animation as the layer's source (nullptr detaches)
+         * The animation then draws into the layer instead of the strip.
+         */
+        void setSource(u8 layer, Animation *source);
+
+        /**
+         * Pause every running layer source (as Animation::pause())
+         */
+        void pauseSources();
+
+        /**
+         * Limit a pixel of the layer (first call creates an all-visible mask)
+         */
+        void setMask(u8 layer, u16 index, bool visible);
+
+        /**
+         * Drop the mask: whole layer visible again
+         */
+        void clearMask(u8 layer);
+
+        /**
+         * Set the hook called when a layer changes (also given to sources)
+         */
+        void setWakeCallback(CompositorWakeCallback callback) { m_wake = callback; }
+
+        /**
+         * Run every layer source, then blend all layers into the PixelStrip
+         * and send if anything changed (frame task only)
+         * @return ms until the next source update is needed, 0 if none
+         */
+        u32 update();
+
+        /**
+         * Time each blend mode per pixel and print the results (probe builds)
+         * Uses temporary buffers; does not touch the layers or the strip.
+         */
+        static void benchmark(u16 count = 1000);
+
+private:
+        PixelStrip *m_pixels;
+        CompositorLayer m_layers[CompositorConfig::MAX_LAYERS];
+        u8 m_layerCount;
+        u16 m_count;    // Logical pixels per layer
+        bool m_changed;  // A layer changed since the last render
+        bool m_updating; // Sources running in update(): no wake
+        CompositorWakeCallback m_wake;
+
+        CompositorLayer *layer(u8 index);
+        void markChanged();
+        void render();
+        static void blendRow(u32 *dst, const u32 *src, const u8 *mask, u16 count, BlendMode mode, u8 opacity);
+};
+
+#endif // COMPOSITOR_H
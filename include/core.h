@@ -12,6 +12,11 @@
 #include "matrixpanel.h"
 #include "app_base.h"
 #include "deviceconfig.h"
+#include "scheduler.h"
+#include "motors.h"
+#include "expanderbus.h"
+#include "compositor.h"
+#include "dispatch.h"
 #include <Preferences.h>
 
 #define PIXEL_BRIGHTNESS 5
@@ -32,6 +37,28 @@ struct LedPattern
         u32 timeOff; // LED OFF duration in milliseconds
 };
 
+// Main loop timing window (CPU cycles between successive update() calls)
+struct LoopStats
+{
+        u32 lastCycles;     // Cycle count at previous update() (0 = not started)
+        u32 minCycles;      // Shortest period in window
+        u32 maxCycles;      // Longest period in window
+        uint64_t sumCycles; // Sum of periods in window (for average)
+        u32 count;          // Periods recorded in window
+};
+
+// Core scheduler task slots (slot number = notification bit, lower runs first)
+enum CoreTask : u8
+{
+        TASK_INPUT = 0,  // Buttons + keypad scan
+        TASK_BUS_RX,     // Room Bus receive/dispatch
+        TASK_STATUS,     // Status LED + type detection
+        TASK_APP,        // Active App loop()
+        TASK_MOTOR,      // Motor PWM slices (only while a motor is active)
+        TASK_ANIMATION,  // Animation frame + pixel output
+        CORE_TASK_COUNT
+};
+
 // Status LED modes
 enum StatusLedMode
 {
@@ -54,11 +81,12 @@ public:
         // Initialize core firmware logic (called by begin, or for soft reset)
         void init();
 
-        // Main core update loop
+        // Main core update: run due tasks, then sleep until the next deadline or trigger
         void update();
 
-        // Refresh animations (call from main loop with ISR flag)
-        void refreshAnimations(volatile bool &flag);
+        // Wake a core task early (e.g. from an input ISR)
+        void notify(CoreTask task) { m_scheduler.trigger(task); }
+        void notifyFromISR(CoreTask task) { m_scheduler.triggerFromISR(task); }
 
         // Set core mode
         void setMode(CoreMode mode);
@@ -99,6 +127,14 @@ private:
         IOExpander *m_ioExpander;
         MatrixPanel *m_matrixPanel; // Keypad+LED matrix abstraction
         AppBase *m_app;             // Current application instance
+        Scheduler m_scheduler;      // Cooperative task scheduler (replaces delay() loop)
+        ExpanderBus m_expanderBus;  // All expanders on the I2C bus (primary = m_ioExpander)
+        MotorController m_motors;   // Soft-PWM motor control on the expander
+        Compositor m_compositor;    // Layered pixel output (off until an App calls begin())
+        CommandTable m_commands;    // Room Bus cmd_srv -> handler (core + App)
+        u32 m_inputPeriodMs;        // Current input task period (slower while keypad is parked)
+        u32 m_motorPeriodMs;        // Current motor task period (0 while all motors are idle)
+        u32 m_animPeriodMs;         // Current animation task period (0 while nothing animates)
 
         // Core state
         CoreMode m_mode;
@@ -122,6 +158,12 @@ private:
         // LED patterns for different modes
         static const LedPattern kLedPatterns[];
 
+        // Runtime telemetry (reported via CORE_STATS)
+        LoopStats m_loopStats;
+#ifdef ENABLE_PROBES
+        u32 m_lastProbeDump; // Last periodic probe dump (ms)
+#endif
+
         // Type detection mode state
         CoreMode m_previousMode;    // Mode to return to after type detection
         u32 m_lastTypeRead;         // Last time device type was read and logged
@@ -136,6 +178,19 @@ private:
         // MIDI note mapping for keypad - defined in core.cpp
         static const int kNoteMap[16];
 
+        // Scheduler tasks (ctx = Core instance)
+        void registerTasks();
+        static void taskInput(void *ctx);
+        static void taskBusRx(void *ctx);
+        static void taskStatus(void *ctx);
+        static void taskApp(void *ctx);
+        static void taskAnimation(void *ctx);
+        static void taskMotor(void *ctx);
+        static void onBusReceive();
+        static void onKeypadInterrupt();
+        static void onMotorWake();
+        static void onAnimationWake();
+
         // Event handlers
         static void onInputEvent(InputEvent event);
         void handleInputEvent(InputEvent event);
@@ -144,7 +199,23 @@ private:
         void handleKeypadPress(u8 keyIndex);
         void handleRoomBusFrame(const RoomFrame &frame);
 
+        // Room Bus command handlers (ctx = Core instance)
+        void registerCommands();
+        static void cmdIgnore(void *ctx, const RoomFrame &frame);
+        static void cmdPing(void *ctx, const RoomFrame &frame);
+        static void cmdReset(void *ctx, const RoomFrame &frame);
+        static void cmdSetAddress(void *ctx, const RoomFrame &frame);
+        static void cmdStats(void *ctx, const RoomFrame &frame);
+#ifdef ENABLE_PROBES
+        static void cmdProbe(void *ctx, const RoomFrame &frame);
+#endif
+        static void cmdAsset(void *ctx, const RoomFrame &frame);
+        static void cmdFade(void *ctx, const RoomFrame &frame);
+        void sendDeviceError(u8 error, u8 detail);
+
         // Configuration
+        void assignExpanders();                 // Keypad/motor expander per device type
+        void startApp();                        // Create + set up the App for m_type
         u8 readDeviceType(bool verbose = true); // Read from Pot
         void saveDeviceType(u8 type);
         u8 loadDeviceType();
@@ -161,6 +232,21 @@ private:
         // Helper to send HELLO
         void sendHello();
 
+        // Runtime telemetry
+        void recordLoopTiming();
+        void resetLoopStats();
+        void sendStats(u8 page, bool resetWindow, u8 command = 0);
+#ifdef ENABLE_PROBES
+        void sendProbe(u8 id, u8 page, bool resetAll);
+#endif
+
+        // Asset upload/management over the Room Bus
+        void handleAssetFrame(const RoomFrame &frame);
+        void sendAssetReply(u8 op, u8 status, u16 id);
+
+        // Bus-commanded LED fade
+        void handleFadeFrame(const RoomFrame &frame);
+
         // Keypad test mode
         void enterKeypadTestMode();
         void exitKeypadTestMode();
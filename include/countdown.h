@@ -0,0 +1,82 @@
+/************************* countdown.h **************************
+ * Countdown engine
+ * Drift-free room countdown on the esp_timer microsecond timebase
+ * Created by MSK, November 2025
+ * Server resyncs are slewed in, so the shown time never jumps
+ ***************************************************************/
+
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include <stdint.h>
+#include "msk.h"
+
+namespace CountdownConfig
+{
+        constexpr u32 SLEW_PERMILLE = 100; // Resync correction rate: at most 0.1 s per running second
+        constexpr u32 SNAP_MS = 2000;      // Larger resync errors are applied at once
+}
+
+/**
+ * Countdown
+ * Remaining time is kept as a value at an esp_timer timestamp; reading it
+ * subtracts the elapsed microseconds, so there is no tick that can be
+ * missed or accumulate rounding. Nothing runs in the background: the owner
+ * polls update() and redraws when remainingMs() changes what it shows.
+ *
+ * sync() reconciles with a reference from the server. While running, an
+ * error up to SNAP_MS becomes a pending correction that is applied at
+ * SLEW_PERMILLE of elapsed time (the clock runs up to 10% fast or slow
+ * until it is absorbed); bigger errors, or any error while paused, are
+ * applied directly.
+ */
+class Countdown
+{
+public:
+        Countdown();
+
+        /**
+         * Set the remaining time (jumps, drops any pending correction)
+         */
+        void set(u32 ms);
+
+        /**
+         * Add (or with a negative delta, remove) time; clamps at 0
+         */
+        void add(int32_t ms);
+
+        /**
+         * Start/resume or pause counting down (no effect at 0)
+         */
+        void start();
+        void pause();
+        bool isRunning() const { return m_running; }
+
+        /**
+         * Reconcile with the server's remaining time
+         * @param ms Reference remaining time when the server sent it
+         */
+        void sync(u32 ms);
+
+        /**
+         * Remaining time now, in ms (rounded up, so 0 only once it has expired)
+         */
+        u32 remainingMs() const;
+
+        /**
+         * Advance the state; call from the app loop
+         * @return true once, when the countdown reaches 0 (it then stops)
+         */
+        bool update();
+
+private:
+        int64_t m_baseUs;    // Remaining time at m_baseTime
+        int64_t m_baseTime;  // esp_timer timestamp of m_baseUs
+        int64_t m_pendingUs; // Resync correction still to slew in (signed)
+        bool m_running;
+
+        int64_t remainingAt(int64_t now, int64_t *applied) const;
+        void rebase(int64_t now);
+};
+
+#endif // COUNTDOWN_H
@@ -17,6 +17,12 @@
 #include "ioexpander.h"
 #include "roombus.h" // Room Bus server command IDs
 #include <initializer_list>
+#include <stddef.h>
+
+// makeCommandSet() and the catalog checks loop in constexpr functions (C++14)
+#if __cplusplus < 201402L
+#error deviceconfig.h needs C++14 or later (platformio.ini builds with -std=gnu++17)
+#endif
 
 // Maximum device types supported (0-63)
 constexpr u8 MAX_DEVICE_TYPES = 64;
@@ -24,11 +30,13 @@ constexpr u8 MAX_DEVICE_TYPES = 64;
 // Maximum hardware components
 constexpr u8 MAX_MOTORS = 4;
 constexpr u8 MAX_KEYS = 16;
-constexpr u8 MAX_COMMANDS = 8;
+constexpr u8 MAX_COMMANDS = 12; // Per merged set: core commands + device commands
 
 // --- Device Types ---
 // Manually defined for code readability.
-// These IDs must match the 'id' field in ALL_DEVICES in deviceconfig.cpp
+// DEVICE_CATALOG in deviceconfig.cpp has one entry per type, in this order
+// (checked at compile time). roomBus.ts gets its DeviceType enum from both:
+// run tools/device_types.py after adding a type.
 enum DeviceType : u8
 {
         TERMINAL = 0,
@@ -46,7 +54,8 @@ enum DeviceType : u8
         SCORES = 12,
         BALL_BASE = 13,
         PURGER = 14,
-        // ... types 15-63 are generic/reserved
+        PUZZLE = 15,
+        DEVICE_TYPE_COUNT, // Defined types; 16-63 are generic/reserved
 };
 
 // --- Data Structures ---
@@ -58,15 +67,22 @@ struct CommandSet
         u8 count;
 };
 
+// Not constexpr: reaching it while building the catalog is a compile error
+inline void commandSetOverflow() {}
+
 // Helper to create sets easily: makeCommandSet({CMD_A, CMD_B})
-inline CommandSet makeCommandSet(std::initializer_list<RoomServerCommand> list)
+// Usable at compile time; extra commands are dropped (or fail the build there).
+constexpr CommandSet makeCommandSet(std::initializer_list<RoomServerCommand> list)
 {
         CommandSet cs{};
         size_t n = list.size();
         if (n > MAX_COMMANDS)
+        {
+                commandSetOverflow();
                 n = MAX_COMMANDS;
+        }
         for (size_t i = 0; i < n; i++)
-                cs.cmds[i] = *(list.begin() + i);
+                cs.cmds[i] = list.begin()[i];
         cs.count = (u8)n;
         return cs;
 }
@@ -78,6 +94,8 @@ struct DeviceConfig
         const char *keyNames[MAX_KEYS];     // Optional key names (nullptr = default)
         const char *motorNames[MAX_MOTORS]; // Optional motor names (nullptr = unused)
         CommandSet commands;                // Supported commands
+        u8 keypadExpander;                  // Expander slot for the keypad (0-7 = 0x20-0x27, usually 0)
+        u8 motorExpander;                   // Expander slot for motors P00-P07 (usually 0)
 };
 
 // 3. The Master Device Definition
@@ -93,7 +111,7 @@ struct DeviceDefinition
 class DeviceConfigurations
 {
 public:
-        // Get definition for a specific Type
+        // Get definition for a specific Type (direct index, nullptr if undefined)
         static const DeviceDefinition *getDefinition(DeviceType type);
 
         // Helpers (wrappers around getDefinition())
@@ -102,9 +120,12 @@ public:
         static void printConfig(DeviceType type);
 
         // Legacy/Helper accessors
+        static u16 getCellCount(DeviceType type);
         static u8 getMotorCount(DeviceType type);
         static const char *getKeyName(DeviceType type, u8 keyIndex);
         static const char *getMotorName(DeviceType type, u8 motorIndex);
+        static u8 getKeypadExpander(DeviceType type);
+        static u8 getMotorExpander(DeviceType type);
 };
 
 #endif // DEVICECONFIG_H
@@ -0,0 +1,84 @@
+/************************* dispatch.h ***************************
+ * Room Bus command dispatch table
+ * Handlers registered per cmd_srv by Core and the active App
+ * Created by MSK, November 2025
+ * O(1) lookup, per-command hit and latency counters
+ ***************************************************************/
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdint.h>
+#include "msk.h"
+#include "roombus.h"
+
+namespace DispatchConfig
+{
+        constexpr u16 TABLE_SIZE = SERVER_MAX + 1; // One slot per server→device command
+}
+
+// Command handler: ctx is the pointer given to CommandTable::set()
+typedef void (*CommandFn)(void *ctx, const RoomFrame &frame);
+
+// Per-command counters (CPU cycles)
+struct CommandStats
+{
+        u32 hits;
+        u32 maxCycles;
+        uint64_t totalCycles;
+};
+
+/**
+ * CommandTable
+ * Maps cmd_srv (CORE_MIN..SERVER_MAX) straight to a handler. Core fills the
+ * core range at boot; the App registers its device commands in setup() and
+ * they are cleared when the App is replaced. A command without a handler is
+ * unsupported on this device: dispatch() returns false and the caller
+ * answers with EV_DEVICE_ERROR.
+ */
+class CommandTable
+{
+public:
+        CommandTable();
+
+        /**
+         * Register (or with fn = nullptr, remove) the handler of a command
+         * @return false if cmd is outside CORE_MIN..SERVER_MAX
+         */
+        bool set(u8 cmd, CommandFn fn, void *ctx);
+
+        /**
+         * Remove all handlers in [first, last] (counters are kept)
+         */
+        void clear(u8 first, u8 last);
+
+        bool has(u8 cmd) const;
+
+        /**
+         * Run the handler of frame.cmd_srv and count it
+         * @return false if the command has no handler (counted as unsupported)
+         */
+        bool dispatch(const RoomFrame &frame);
+
+        /**
+         * Counters of one command (nullptr outside the table)
+         */
+        const CommandStats *getStats(u8 cmd) const;
+
+        u32 getUnsupportedCount() const { return m_unsupported; }
+
+        void resetStats();
+
+private:
+        struct Entry
+        {
+                CommandFn fn;
+                void *ctx;
+                CommandStats stats;
+        };
+
+        Entry m_entries[DispatchConfig::TABLE_SIZE];
+        u32 m_unsupported; // Commands received without a handler
+};
+
+#endif // DISPATCH_H
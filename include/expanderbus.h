@@ -0,0 +1,107 @@
+/************************* expanderbus.h ************************
+ * I/O Expander Bus Manager
+ * Discovers PCF8575 expanders at 0x20-0x27 and exposes one pin space
+ * Created by MSK, November 2025
+ * Batches per-cycle reads and writes across all present expanders
+ ***************************************************************/
+
+#ifndef EXPANDERBUS_H
+#define EXPANDERBUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "msk.h"
+#include "ioexpander.h"
+
+namespace ExpanderBusConfig
+{
+        constexpr u8 MAX_EXPANDERS = 8;     // A0-A2 select 0x20-0x27
+        constexpr u8 PINS_PER_EXPANDER = 16; // P00-P17
+        constexpr u8 NO_PIN = 0xFF;
+}
+
+// Unified pin number: slot (address - 0x20) * 16 + pin (0-127).
+// Slots follow the address jumpers, so a missing board does not renumber others.
+constexpr u8 expanderPin(u8 slot, u8 pin)
+{
+        return slot * ExpanderBusConfig::PINS_PER_EXPANDER + pin;
+}
+
+/**
+ * Expander Bus
+ * Owns every expander found on the I2C bus. The board's primary expander
+ * (0x20, keypad + motors) is passed in and reused; others are created on
+ * discovery. Apps address pins through the unified pin space or get a
+ * slot's IOExpander directly for keypad/motor assignment.
+ */
+class ExpanderBus
+{
+public:
+        /**
+         * Constructor
+         * @param wire I2C interface shared by all expanders
+         * @param primary Existing expander instance (used for its own address)
+         */
+        ExpanderBus(TwoWire *wire, IOExpander *primary);
+
+        /**
+         * Probe 0x20-0x27 and initialize every PCF8575 that answers
+         * @return Number of expanders found
+         */
+        u8 discover();
+
+        /**
+         * Number of expanders found by discover()
+         */
+        u8 getCount() const { return m_count; }
+
+        /**
+         * Get the expander in a slot
+         * @param slot 0-7 (address 0x20-0x27)
+         * @return Expander, or nullptr if not present
+         */
+        IOExpander *get(u8 slot) const;
+
+        /**
+         * Check if a slot has a responding expander
+         */
+        bool isPresent(u8 slot) const { return get(slot) != nullptr; }
+
+        /**
+         * Set a pin in the unified pin space (written on next flush)
+         * @param pin expanderPin(slot, pin)
+         * @param value HIGH or LOW
+         */
+        void digitalWrite(u8 pin, u8 value);
+
+        /**
+         * Read a pin in the unified pin space (cycle snapshot)
+         * @param pin expanderPin(slot, pin)
+         * @return HIGH or LOW (LOW if the slot is absent)
+         */
+        u8 digitalRead(u8 pin);
+
+        /**
+         * Start a new I/O cycle on every expander (snapshots go stale;
+         * each expander is read on its first digitalRead() of the cycle)
+         */
+        void beginCycle();
+
+        /**
+         * Write pending outputs on every expander (only those that changed)
+         */
+        void flush();
+
+        /**
+         * Sum of failed I2C transactions across all expanders
+         */
+        u16 getI2cErrorCount() const;
+
+private:
+        TwoWire *m_wire;
+        IOExpander *m_primary;
+        IOExpander *m_slots[ExpanderBusConfig::MAX_EXPANDERS];
+        u8 m_count;
+};
+
+#endif // EXPANDERBUS_H
@@ -0,0 +1,243 @@
+/************************* glyph.h ******************************
+ * Segment glyph renderer for LED digit displays
+ * Characters and numbers drawn onto 11-segment digits in the strip
+ * Created by MSK, November 2025
+ * Glyph-to-LED masks are built at compile time
+ ***************************************************************/
+
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#include <stdint.h>
+#include "msk.h"
+#include "pixel.h"
+
+class Compositor;
+
+/**
+ * Segments of one digit (one LED each), bit n = segment n.
+ *
+ *      --A--
+ *     |  |  |
+ *     F  H  B
+ *     |  |  |
+ *      G1 G2
+ *     |  |  |
+ *     E  I  C
+ *     |  |  |
+ *      --D--  DP
+ */
+enum GlyphSegment : u8
+{
+        SEG_A = 0, // Top
+        SEG_B,     // Upper right
+        SEG_C,     // Lower right
+        SEG_D,     // Bottom
+        SEG_E,     // Lower left
+        SEG_F,     // Upper left
+        SEG_G1,    // Middle, left half
+        SEG_G2,    // Middle, right half
+        SEG_H,     // Upper centre
+        SEG_I,     // Lower centre
+        SEG_DP,    // Decimal point (also the Timer's mm.ss separator)
+        SEG_COUNT
+};
+
+namespace GlyphConfig
+{
+        constexpr u8 LEDS_PER_DIGIT = SEG_COUNT; // Digits follow each other on the strip
+        constexpr u8 MAX_DIGITS = 24;             // NumBox: 4 rows of 6
+
+        // Wiring: LED offset inside a digit for each segment (edit to match the PCB)
+        constexpr u8 SEGMENT_LED[SEG_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+}
+
+static_assert(GlyphConfig::MAX_DIGITS <= 32, "SegmentDisplay keeps dirty digits in a u32");
+
+/**
+ * Segments lit for a character (0 = blank, also for unknown characters).
+ * Digits, letters (b c d h n o r u keep a lower-case shape, the rest are
+ * drawn upper case) and - _ = + * ' " [ ] / \ ? .
+ */
+constexpr u16 glyphSegments(char c)
+{
+        constexpr u16 A = 1u << SEG_A, B = 1u << SEG_B, C = 1u << SEG_C, D = 1u << SEG_D;
+        constexpr u16 E = 1u << SEG_E, F = 1u << SEG_F, G = (1u << SEG_G1) | (1u << SEG_G2);
+        constexpr u16 G1 = 1u << SEG_G1, G2 = 1u << SEG_G2, H = 1u << SEG_H, I = 1u << SEG_I;
+
+        if (c >= 'a' && c <= 'z' && c != 'b' && c != 'c' && c != 'd' && c != 'h' &&
+            c != 'n' && c != 'o' && c != 'r' && c != 'u')
+                c = (char)(c - 'a' + 'A');
+
+        switch (c)
+        {
+        case '0': return A | B | C | D | E | F;
+        case '1': return B | C;
+        case '2': return A | B | G | E | D;
+        case '3': return A | B | G | C | D;
+        case '4': return F | G | B | C;
+        case '5': return A | F | G | C | D;
+        case '6': return A | F | G | E | C | D;
+        case '7': return A | B | C;
+        case '8': return A | B | C | D | E | F | G;
+        case '9': return A | B | C | D | F | G;
+        case 'A': return A | B | C | E | F | G;
+        case 'B': return A | B | C | D | G2 | H | I;
+        case 'C': return A | D | E | F;
+        case 'D': return A | B | C | D | H | I;
+        case 'E': return A | D | E | F | G1;
+        case 'F': return A | E | F | G1;
+        case 'G': return A | C | D | E | F | G2;
+        case 'H': return B | C | E | F | G;
+        case 'I': return A | D | H | I;
+        case 'J': return B | C | D | E;
+        case 'K': return E | F | G1 | B | C | G2;
+        case 'L': return D | E | F;
+        case 'M': return A | B | C | E | F | H;
+        case 'N': return A | B | C | E | F;
+        case 'P': return A | B | E | F | G;
+        case 'Q': return A | B | C | D | E | F | I;
+        case 'R': return A | B | E | F | G | I;
+        case 'S': return A | F | G | C | D;
+        case 'T': return A | H | I;
+        case 'U': return B | C | D | E | F;
+        case 'V': return B | F | G1 | G2 | I;
+        case 'W': return B | C | D | E | F | I;
+        case 'X': return B | C | E | F | G;
+        case 'Y': return B | F | G | I;
+        case 'Z': return A | B | G | E | D;
+        case 'b': return C | D | E | F | G;
+        case 'c': return D | E | G;
+        case 'd': return B | C | D | E | G;
+        case 'h': return C | E | F | G;
+        case 'n': return C | E | G;
+        case 'o': return C | D | E | G;
+        case 'r': return E | G;
+        case 'u': return C | D | E;
+        case '-': return G;
+        case '_': return D;
+        case '=': return G | D;
+        case '+': return G | H | I;
+        case '*': return A | B | F | G;
+        case '\'': return F;
+        case '"': return F | B;
+        case '[': return A | D | E | F;
+        case ']': return A | B | C | D;
+        case '/': return B | G | E;
+        case '\\': return F | G | C;
+        case '?': return A | B | G2 | I;
+        case '.': return 1u << SEG_DP;
+        default: return 0;
+        }
+}
+
+/**
+ * Map a segment mask to LEDs inside the digit through GlyphConfig::SEGMENT_LED.
+ * Bit n of the result = LED n of the digit.
+ */
+constexpr u16 glyphLeds(u16 segments)
+{
+        u16 leds = 0;
+        for (u8 s = 0; s < SEG_COUNT; s++)
+        {
+                if (segments & (1u << s))
+                        leds |= (u16)(1u << GlyphConfig::SEGMENT_LED[s]);
+        }
+        return leds;
+}
+
+/**
+ * SegmentDisplay
+ * A run of digits on a PixelStrip, GlyphConfig::LEDS_PER_DIGIT LEDs each.
+ * Drawing only records an LED mask and color per digit; render() blits the
+ * changed digits straight into the strip's frame buffer, or into a
+ * compositor layer after setLayer().
+ */
+class SegmentDisplay
+{
+public:
+        /**
+         * Constructor
+         * @param pixels Strip holding the digits
+         * @param firstLed Strip index of digit 0's first LED
+         * @param digits Number of digits (up to GlyphConfig::MAX_DIGITS)
+         */
+        SegmentDisplay(PixelStrip *pixels, u16 firstLed, u8 digits);
+
+        u8 getDigitCount() const { return m_digits; }
+
+        /**
+         * Set the lit color of every digit / one digit
+         */
+        void setColor(u32 color);
+        void setDigitColor(u8 digit, u32 color);
+
+        /**
+         * Set the color of unlit segments (default off)
+         */
+        void setBackground(u32 color);
+
+        /**
+         * Show one character on a digit
+         * @param dot Also light the decimal point
+         */
+        void setGlyph(u8 digit, char c, bool dot = false);
+
+        /**
+         * Show a raw segment mask (bit n = GlyphSegment n)
+         */
+        void setSegments(u8 digit, u16 segments);
+
+        /**
+         * Print text left-aligned into [first, first + width)
+         * A '.' after a character lights that digit's decimal point.
+         * Unused digits are blanked.
+         */
+        void print(u8 first, u8 width, const char *text);
+
+        /**
+         * Print a number right-aligned into [first, first + width)
+         * Shows dashes if the number does not fit.
+         * @param leadingZeros Pad with 0 instead of blanks
+         */
+        void printNumber(u8 first, u8 width, int32_t value, bool leadingZeros = false);
+
+        /**
+         * Blank all digits
+         */
+        void clear();
+
+        /**
+         * Draw into a compositor layer instead of the strip (nullptr = strip)
+         * The layer uses the strip's logical indices; every digit is redrawn.
+         */
+        void setLayer(Compositor *compositor, u8 layer);
+
+        /**
+         * Write changed digits into the strip's frame (no transmission;
+         * call PixelStrip::show() afterwards) or into the layer (the
+         * compositor sends it)
+         */
+        void render();
+
+        /**
+         * Time a full-display print + render on a temporary strip (probe builds)
+         */
+        static void benchmark();
+
+private:
+        PixelStrip *m_pixels;
+        u16 m_firstLed;
+        u8 m_digits;
+        u16 m_leds[GlyphConfig::MAX_DIGITS];  // LED mask shown per digit
+        u32 m_color[GlyphConfig::MAX_DIGITS]; // Lit color per digit
+        u32 m_background;
+        u32 m_dirty; // Bit per digit to blit
+        Compositor *m_compositor; // nullptr = draw straight into m_pixels
+        u8 m_layer;
+
+        void setLeds(u8 digit, u16 leds);
+        void renderLayer();
+};
+
+#endif // GLYPH_H
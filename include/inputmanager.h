@@ -10,7 +10,7 @@ enum InputEvent
         INPUT_NONE,
         INPUT_BTN1_PRESS,
         INPUT_BTN1_LONG_PRESS,
-        INPUT_KEYPAD_0,
+        INPUT_KEYPAD_0, // Keypad press (debounced, fires immediately)
         INPUT_KEYPAD_1,
         INPUT_KEYPAD_2,
         INPUT_KEYPAD_3,
@@ -25,7 +25,39 @@ enum InputEvent
         INPUT_KEYPAD_12,
         INPUT_KEYPAD_13,
         INPUT_KEYPAD_14,
-        INPUT_KEYPAD_15
+        INPUT_KEYPAD_15,
+        INPUT_KEYPAD_RELEASE_0, // Keypad release
+        INPUT_KEYPAD_RELEASE_1,
+        INPUT_KEYPAD_RELEASE_2,
+        INPUT_KEYPAD_RELEASE_3,
+        INPUT_KEYPAD_RELEASE_4,
+        INPUT_KEYPAD_RELEASE_5,
+        INPUT_KEYPAD_RELEASE_6,
+        INPUT_KEYPAD_RELEASE_7,
+        INPUT_KEYPAD_RELEASE_8,
+        INPUT_KEYPAD_RELEASE_9,
+        INPUT_KEYPAD_RELEASE_10,
+        INPUT_KEYPAD_RELEASE_11,
+        INPUT_KEYPAD_RELEASE_12,
+        INPUT_KEYPAD_RELEASE_13,
+        INPUT_KEYPAD_RELEASE_14,
+        INPUT_KEYPAD_RELEASE_15,
+        INPUT_KEYPAD_HOLD_0, // Keypad held for KeypadConfig::HOLD_MS (once per press)
+        INPUT_KEYPAD_HOLD_1,
+        INPUT_KEYPAD_HOLD_2,
+        INPUT_KEYPAD_HOLD_3,
+        INPUT_KEYPAD_HOLD_4,
+        INPUT_KEYPAD_HOLD_5,
+        INPUT_KEYPAD_HOLD_6,
+        INPUT_KEYPAD_HOLD_7,
+        INPUT_KEYPAD_HOLD_8,
+        INPUT_KEYPAD_HOLD_9,
+        INPUT_KEYPAD_HOLD_10,
+        INPUT_KEYPAD_HOLD_11,
+        INPUT_KEYPAD_HOLD_12,
+        INPUT_KEYPAD_HOLD_13,
+        INPUT_KEYPAD_HOLD_14,
+        INPUT_KEYPAD_HOLD_15
 };
 
 // Callback function type for input events
@@ -47,6 +79,13 @@ public:
         // Get keypad note index (0-15) for musical applications
         u8 getKeypadNote(InputEvent event) const;
 
+        // Keypad expander (assignable per device type)
+        void setExpander(IOExpander *ioExpander) { m_ioExpander = ioExpander; }
+        IOExpander *getExpander() const { return m_ioExpander; }
+
+        // Debounced keypad bitmap (bit n = key n down), for chords
+        u16 getKeypadState() const { return m_ioExpander->getKeyState(); }
+
 private:
         IOExpander *m_ioExpander;
         InputCallback m_callback;
@@ -54,4 +93,5 @@ private:
 
         void checkButtons();
         void checkKeypad();
+        void dispatchKeys(u16 keys, InputEvent base);
 };
\ No newline at end of file
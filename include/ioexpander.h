@@ -24,15 +24,38 @@ constexpr u8 KEYPAD_COLS = 4;
 constexpr u8 KEYPAD_SIZE = KEYPAD_ROWS * KEYPAD_COLS; // Total keys (16)
 constexpr u8 KEYPAD_ROW_START = 12;                   // P14-P17 (pins 12-15)
 constexpr u8 KEYPAD_COL_START = 8;                    // P10-P13 (pins 8-11)
+constexpr u16 KEYPAD_ROW_MASK = 0x000F << KEYPAD_ROW_START;
+constexpr u16 KEYPAD_COL_MASK = 0x000F << KEYPAD_COL_START;
 
 // Keypad scanning configuration
 namespace KeypadConfig
 {
-        constexpr unsigned long SCAN_RATE_MS = 10;           // Scan every 10ms
-        constexpr u8 DEBOUNCE_COUNT = 3;                     // 3 stable reads required
-        constexpr unsigned long MIN_PRESS_INTERVAL_MS = 200; // Minimum 200ms between events
+        constexpr unsigned long SCAN_RATE_MS = 10;  // Scan every 10ms
+        constexpr u8 DEBOUNCE_COUNT = 4;            // Stable reads to toggle a key (fixed by the 2-bit vertical counter)
+        constexpr unsigned long HOLD_MS = 500;      // Key down this long fires a hold event (once per press)
+        constexpr bool USE_INTERRUPT = true;        // Park matrix and wait for INT when idle
+        constexpr unsigned long IDLE_POLL_MS = 250; // Idle safety poll (1 read) in case an INT edge is missed
 }
 
+// Keypad events from one scan (bit n = key index n)
+struct KeypadEvents
+{
+        u16 pressed;  // Debounced press edges
+        u16 released; // Debounced release edges
+        u16 held;     // Keys that just crossed HOLD_MS
+};
+
+// I2C bus speed (PCF8575 is rated for 400 kHz fast mode)
+namespace I2CConfig
+{
+        constexpr u32 FAST_HZ = 400000;    // Default bus clock
+        constexpr u32 STANDARD_HZ = 100000; // Fallback clock (long wires, weak pull-ups)
+        constexpr u8 FALLBACK_ERRORS = 8;  // Consecutive failures before dropping to STANDARD_HZ
+}
+
+// Wake callback for the expander INT line (runs in ISR context)
+typedef void (*ExpanderWakeCallback)(void);
+
 // Motor control pins (H-bridge control for 4 motors)
 constexpr u8 MOT1A = 0; // P00 - Motor A forward
 constexpr u8 MOT1B = 1; // P01 - Motor A reverse
@@ -42,6 +65,8 @@ constexpr u8 MOT3A = 4; // P04 - Motor C forward
 constexpr u8 MOT3B = 5; // P05 - Motor C reverse
 constexpr u8 MOT4A = 6; // P06 - Motor D forward
 constexpr u8 MOT4B = 7; // P07 - Motor D reverse
+constexpr u8 MOTOR_COUNT = 4;
+constexpr u16 MOTOR_MASK = 0x00FF; // P00-P07
 
 // Keypad key definitions (4x4 matrix)
 constexpr char KEYPAD_KEYS[KEYPAD_ROWS][KEYPAD_COLS] = {
@@ -72,25 +97,48 @@ private:
         u16 _inputState;  // Current input state (last read)
         TwoWire *_wire;   // I2C interface
         bool _isPresent;  // Device presence flag
-
-        // Keypad scanning state
-        u8 _lastKeyIndex;    // Last key that triggered an event (0-15, 255 if none)
-        u8 _lastKeyRow;      // Last detected key row
-        u8 _lastKeyCol;      // Last detected key column
-        char _lastKey;       // Last detected key character (for convenience)
-        bool _keyPressed;    // Key press state
-        u8 _pressedKeyIndex; // Index of currently pressed key (255 if none)
-
-        // Debouncing state
-        u8 _stableKeyIndex;              // Last stable key (after debounce)
-        u8 _rawKeyIndex;                 // Current raw scan result
-        u8 _debounceCount;               // Consecutive matching reads
-        unsigned long _lastScanTime;     // Time of last scan (for rate limiting)
-        unsigned long _lastKeyPressTime; // Time of last key press event (for minimum response time)
+        u16 _i2cErrors;   // Failed I2C transactions (free-running, wraps)
+        u8 _errorStreak;  // Consecutive failed transactions (for clock fallback)
+        u32 _busHz;       // Current I2C clock
+        bool _dirty;      // _outputState has bits not yet written to the port
+        bool _inputValid; // _inputState was read during the current cycle
+
+        // Keypad state (bit n = key index n, 1 = pressed)
+        u16 _keyState;               // Debounced key bitmap
+        u16 _rawKeys;                // Last raw scan (after ghost masking)
+        u16 _ct0, _ct1;              // Vertical debounce counter (2 bits per key, all 16 keys in parallel)
+        u16 _heldKeys;               // Keys whose hold event has fired
+        u16 _ghostKeys;              // Keys masked as ambiguous on the last scan
+        u16 _ghostCount;             // Scans with ghosting detected (free-running, wraps)
+        unsigned long _lastScanTime; // Time of last scan (for rate limiting)
+        unsigned long _pressTime[KEYPAD_SIZE]; // Debounced press time per key (for hold)
+
+        // Interrupt-driven idle state
+        bool _intEnabled;                 // INT line in use (matrix parked while idle)
+        bool _keypadIdle;                 // No key activity: skip scans until INT/idle poll
+        volatile bool _intPending;        // Set by INT ISR, cleared when scanning starts
+        ExpanderWakeCallback _wakeCallback; // Optional hook to wake the input task
+        static IOExpander *s_intInstance; // Instance served by the INT ISR
+        static void intISR();
+
+        // Drive all keypad rows low (columns stay inputs) and clear INT
+        void parkKeypad();
+
+        // Raw matrix read (fewest transactions), returns 16-bit key bitmap
+        u16 readMatrix();
+
+        // Row-by-row matrix read (used for chords across rows and columns)
+        bool readRows(u8 rowMask, u16 &raw);
+
+        // Keys that cannot be trusted in a diode-less matrix (rectangle rule)
+        static u16 ghostMask(u16 raw);
 
         // I2C communication helpers
         bool writePort(u16 value);
         bool readPort(u16 &value);
+        bool transferPort(u16 value, u16 &readValue); // Write then read with repeated start (one transaction)
+        void trackResult(bool ok);                    // Error accounting and clock fallback
+        void markWritten(u16 value);                  // Clear _dirty if value carried all pending bits
 
 public:
         /**
@@ -113,66 +161,165 @@ public:
          */
         bool isPresent() const { return _isPresent; }
 
+        /**
+         * Get the I2C address
+         */
+        u8 getAddress() const { return _address; }
+
+        /**
+         * Get number of failed I2C transactions since boot
+         * @return Free-running 16-bit error counter
+         */
+        u16 getI2cErrorCount() const { return _i2cErrors; }
+
+        /**
+         * Set the I2C clock used for this expander
+         * @param hz Bus frequency (I2CConfig::FAST_HZ or STANDARD_HZ)
+         */
+        void setBusSpeed(u32 hz);
+
+        /**
+         * Get the current I2C clock
+         * @return Bus frequency in Hz
+         */
+        u32 getBusSpeed() const { return _busHz; }
+
+        /**
+         * Time the keypad matrix read at both bus speeds and print a table:
+         * legacy row-by-row scan (separate write/read + settle delay) vs the
+         * transaction-minimised scan. Restores the bus speed afterwards.
+         * @param iterations Reads per measurement
+         */
+        void benchmarkScan(u16 iterations = 200);
+
         // ========== Pin Control Methods ==========
 
+        // Writes are write-behind: they update the shadow register and go out
+        // on the next flush() (Core flushes once per scheduler pass).
+        // Reads return a snapshot taken at most once per cycle.
+
         /**
-         * Set a single pin state
+         * Set a single pin state (written on next flush)
          * @param pin Pin number (0-15)
          * @param value HIGH or LOW
          */
         void digitalWrite(u8 pin, u8 value);
 
         /**
-         * Read a single pin state
+         * Read a single pin state from the cycle snapshot
          * @param pin Pin number (0-15)
          * @return HIGH or LOW
          */
         u8 digitalRead(u8 pin);
 
         /**
-         * Set all 16 pins at once
+         * Set all 16 pins at once (written on next flush)
          * @param value 16-bit value (bit 0 = pin 0, bit 15 = pin 15)
          */
         void write(u16 value);
 
         /**
-         * Read all 16 pins at once
+         * Read all 16 pins from the cycle snapshot (one I2C read per cycle)
+         * Keypad matrix pins reflect the last scan strobe; use the keypad API.
          * @return 16-bit value (bit 0 = pin 0, bit 15 = pin 15)
          */
         u16 read();
 
+        /**
+         * Start a new I/O cycle: the next read() refreshes the snapshot
+         */
+        void beginCycle() { _inputValid = false; }
+
         // ========== Keypad Matrix Methods ==========
 
         /**
-         * Scan keypad matrix for key presses (row-column scanning)
-         * Call this regularly (e.g., in loop()) to detect key presses
-         * @return Key index (0-15 for keys 0-15), or 255 if no key pressed
+         * Scan keypad matrix (n-key rollover, row-column scanning)
+         * Call this regularly (e.g., in loop()). All 16 keys are debounced in
+         * parallel; events are bitmaps so chords are reported in one scan.
+         * @param events Out: press/release/hold edges from this scan
+         * @return true if a scan ran and any event bit is set
+         */
+        bool scanKeypad(KeypadEvents &events);
+
+        /**
+         * Enable interrupt-driven keypad scanning
+         * Parks the matrix (all rows LOW) and waits for the INT falling edge;
+         * full scans only run while keys are active.
+         * @param intPin GPIO connected to the expander INT output (active LOW)
+         * @param wakeCallback Optional function called from the ISR on INT
+         * @return true if enabled (device present)
+         */
+        bool enableInterrupt(u8 intPin, ExpanderWakeCallback wakeCallback = nullptr);
+
+        /**
+         * Check whether the keypad is parked waiting for INT
+         * @return true when idle (no scans running)
+         */
+        bool isKeypadIdle() const { return _intEnabled && _keypadIdle; }
+
+        /**
+         * Get the debounced keypad bitmap
+         * @return Bit n set while key n is held down
+         */
+        u16 getKeyState() const { return _keyState; }
+
+        /**
+         * Check if a key is currently down (debounced)
+         * @param keyIndex Key index (0-15)
          */
-        u8 scanKeypad();
+        bool isKeyDown(u8 keyIndex) const { return keyIndex < KEYPAD_SIZE && (_keyState & (1 << keyIndex)); }
 
-        /* getKeypadBitmap removed: unused API (cleaned from code/docs) */
+        /**
+         * Get the keys masked as possible ghosts on the last scan
+         * @return Bitmap of ambiguous keys (state frozen while set)
+         */
+        u16 getGhostKeys() const { return _ghostKeys; }
 
         /**
-         * Get the last detected key index
-         * @return Last key index (0-15), or 255 if no key detected
+         * Get the number of scans that detected ghosting
+         * @return Free-running counter (wraps at 65535)
          */
-        u8 getLastKeyIndex() const { return _lastKeyIndex; }
+        u16 getGhostCount() const { return _ghostCount; }
+
+        // ========== Coalesced Output ==========
 
         /**
-         * Get the last detected key character (for convenience)
-         * Uses the KEYPAD_KEYS mapping to convert index to character
-         * @return Last key character, or 0 if no key detected
+         * Update output bits in the cached port state without an I2C write.
+         * The change goes out with the next write (flush(), keypad scan
+         * strobe, digitalWrite), so several updates share one transaction.
+         * @param mask Bits to change
+         * @param value New values for the masked bits
          */
-        char getLastKey() const { return _lastKey; }
+        void setOutputBits(u16 mask, u16 value);
 
         /**
-         * Check if a key is currently pressed
-         * @return true if key is pressed, false otherwise
+         * Write pending output bits (skipped when nothing changed)
+         * @return true if the port matches the cached state
          */
-        bool isKeyPressed() const { return _keyPressed; }
+        bool flush();
+
+        /**
+         * Check for output bits not yet written
+         */
+        bool isDirty() const { return _dirty; }
 
         // ========== Motor Control Methods ==========
 
+        /**
+         * H-bridge pin pattern for one motor
+         * @param motor Motor index (0-3 = A-D)
+         * @param direction Requested state
+         * @return Port bits (within MOTOR_MASK)
+         */
+        static u16 motorBits(u8 motor, MotorDirection direction);
+
+        /**
+         * Set motor direction (written on next flush)
+         * @param motor Motor index (0-3 = A-D)
+         * @param direction MOTOR_STOP, MOTOR_FORWARD, MOTOR_REVERSE, or MOTOR_BRAKE
+         */
+        void setMotor(u8 motor, MotorDirection direction);
+
         /**
          * Set motor A direction
          * @param direction MOTOR_STOP, MOTOR_FORWARD, MOTOR_REVERSE, or MOTOR_BRAKE
@@ -198,7 +345,7 @@ public:
         void setMotorD(MotorDirection direction);
 
         /**
-         * Stop all motors (A, B, C, D)
+         * Stop all motors (A, B, C, D) (written on next flush)
          */
         void stopAllMotors();
 };
@@ -26,8 +26,9 @@ public:
         /**
          * @brief Construct a new Matrix Panel object
          * @param pixels Pointer to PixelStrip for LED control
+         * @param firstLed Strip index of the panel's first LED (panels on long strips)
          */
-        explicit MatrixPanel(PixelStrip *pixels);
+        explicit MatrixPanel(PixelStrip *pixels, u16 firstLed = 0);
 
         /**
          * @brief Convert column (x) and row (y) to logical cell index
@@ -90,6 +91,23 @@ public:
          */
         void fill(u8 r, u8 g, u8 b);
 
+        /**
+         * @brief Fade one LED by logical index to a color (see PixelStrip::fadeTo)
+         * @param logicalIndex Logical cell index (0-15)
+         * @param color Target color (0x00RRGGBB)
+         * @param durationMs Fade time (0 = set immediately)
+         * @param easing Transition curve
+         */
+        void fadeCell(u8 logicalIndex, u32 color, u16 durationMs, FadeEasing easing = FADE_EASE_IN_OUT);
+
+        /**
+         * @brief Fade all LEDs of the matrix to one color
+         * @param color Target color (0x00RRGGBB)
+         * @param durationMs Fade time (0 = set immediately)
+         * @param easing Transition curve
+         */
+        void fadeAll(u32 color, u16 durationMs, FadeEasing easing = FADE_EASE_IN_OUT);
+
         /**
          * @brief Get the number of rows in the matrix
          * @return Number of rows (4)
@@ -110,6 +128,7 @@ public:
 
 private:
         PixelStrip *m_pixels; ///< Pointer to LED strip controller
+        u16 m_firstLed;       ///< Strip index added to every mapped LED
 
         /**
          * Key to LED mapping (16 keys -> 16 LEDs)
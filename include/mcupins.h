@@ -73,7 +73,7 @@ constexpr u8 CONFIG_ADC_PIN = 2; // D0/A0 - Device type configuration (GPIO 2, A
 
 // I/O Expander Configuration (PCF8575-based)
 constexpr u8 IO_EXPANDER_I2C_ADDR = 0x20; // I/O Expander base address (A0=A1=A2=0)
-constexpr u8 IO_EXPANDER_INT_PIN = 10;    // D10 - I/O Expander interrupt pin (optional, active LOW)
+constexpr u8 IO_EXPANDER_INT_PIN = 10;    // D10 - I/O Expander interrupt pin (active LOW, see KeypadConfig::USE_INTERRUPT)
 
 #elif defined(S2_MINI)
 
@@ -136,7 +136,7 @@ constexpr u8 CONFIG_ADC_PIN = 1; // GPIO 1 - Device type configuration (ADC1_CH0
 
 // I/O Expander Configuration (PCF8575-based)
 constexpr u8 IO_EXPANDER_I2C_ADDR = 0x20; // I/O Expander base address (A0=A1=A2=0)
-constexpr u8 IO_EXPANDER_INT_PIN = 12;    // GPIO 12 - I/O Expander interrupt pin (optional, active LOW)
+constexpr u8 IO_EXPANDER_INT_PIN = 12;    // GPIO 12 - I/O Expander interrupt pin (active LOW, see KeypadConfig::USE_INTERRUPT)
 
 #else
 #error No board defined! Define SEEED_XIAO_ESP32C3 or S2_MINI.
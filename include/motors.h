@@ -0,0 +1,135 @@
+/************************* motors.h *****************************
+ * Motor Controller (software PWM on the I/O expander)
+ * Speed control, acceleration ramps and timed moves for 4 DC motors
+ * Created by MSK, November 2025
+ * Non-blocking: driven by a Core scheduler task, coalesced port writes
+ ***************************************************************/
+
+#ifndef MOTORS_H
+#define MOTORS_H
+
+#include <Arduino.h>
+#include "msk.h"
+#include "ioexpander.h"
+
+namespace MotorConfig
+{
+        constexpr u32 TICK_MS = 2;                         // PWM time slice (one port write at most)
+        constexpr u8 PWM_STEPS = 10;                       // Slices per period: 10% duty resolution
+        constexpr u32 PWM_PERIOD_MS = TICK_MS * PWM_STEPS; // 20 ms = 50 Hz
+        constexpr u16 DEFAULT_RAMP = 200;                  // %/s (0 -> 100% in 0.5 s), 0 = no ramp
+        constexpr int16_t SPEED_SCALE = 100;               // Internal speed units per percent
+}
+
+// Wake callback: a command changed motor state (runs in task context)
+typedef void (*MotorWakeCallback)(void);
+
+// Per-motor state
+struct MotorState
+{
+        int8_t target;   // Requested speed (-100..100, sign = direction)
+        int16_t speed;   // Ramped speed in 1/SPEED_SCALE percent
+        u16 rampRate;    // Ramp in %/s (0 = jump to target)
+        u32 stopAt;      // millis() end of a timed move (0 = none)
+        bool brake;      // Brake instead of coast when speed reaches 0
+};
+
+/**
+ * Motor Controller
+ * Drives the H-bridge inputs on expander pins P00-P07 with a low-frequency
+ * time-sliced PWM. Motors are phase-staggered so their on-edges fall in
+ * different slices (spreads inrush current). All outputs for one slice are
+ * written in a single I2C transaction, and only when a bit changes.
+ *
+ * update(now) is pure state math (no I/O) and returns the port bits for a
+ * given time; tick() applies them to the expander.
+ */
+class MotorController
+{
+public:
+        explicit MotorController(IOExpander *io);
+
+        /**
+         * Set target speed; the motor ramps there at its ramp rate
+         * @param motor Motor index (0-3 = A-D)
+         * @param speed -100 (full reverse) .. 100 (full forward), 0 = stop
+         */
+        void setSpeed(u8 motor, int8_t speed);
+
+        /**
+         * Run for a fixed time, then ramp to 0
+         * @param motor Motor index (0-3)
+         * @param speed -100..100
+         * @param durationMs Time at the commanded speed (ramp-up included)
+         */
+        void run(u8 motor, int8_t speed, u32 durationMs);
+
+        /**
+         * Stop immediately (no ramp)
+         * @param motor Motor index (0-3)
+         * @param brake true = short the windings (both inputs HIGH), false = coast
+         */
+        void stop(u8 motor, bool brake = false);
+
+        /**
+         * Stop all motors immediately (coast)
+         */
+        void stopAll();
+
+        /**
+         * Set acceleration/deceleration rate
+         * @param motor Motor index (0-3)
+         * @param percentPerSec Speed change per second (0 = instant)
+         */
+        void setRamp(u8 motor, u16 percentPerSec);
+
+        /**
+         * Current (ramped) speed
+         * @return -100..100
+         */
+        int8_t getSpeed(u8 motor) const;
+
+        /**
+         * Check for any running, ramping or timed motor
+         */
+        bool isActive() const;
+
+        /**
+         * Advance ramps and timed moves to now and compute the port bits
+         * (pure: no I/O, usable from a simulation)
+         * @param now Time in ms
+         * @return Motor pin bits (within MOTOR_MASK)
+         */
+        u16 update(u32 now);
+
+        /**
+         * update(millis()) and stage the bits in the expander shadow register
+         */
+        void tick();
+
+        /**
+         * Move motor control to another expander (stops all motors first)
+         * @param io Expander whose P00-P07 drive the H-bridges
+         */
+        void setExpander(IOExpander *io);
+
+        /**
+         * Get the expander driving the motors
+         */
+        IOExpander *getExpander() const { return m_io; }
+
+        /**
+         * Register a hook called when a command needs the tick task running
+         */
+        void setWakeCallback(MotorWakeCallback callback) { m_wake = callback; }
+
+private:
+        IOExpander *m_io;
+        MotorState m_motors[MOTOR_COUNT];
+        u32 m_lastUpdate;        // Time of previous update() (for ramp steps)
+        MotorWakeCallback m_wake;
+
+        void wake();
+};
+
+#endif // MOTORS_H
@@ -11,6 +11,11 @@
 #define DUR_2 8
 #define DUR_1 16
 
+namespace MusicConfig
+{
+        constexpr u16 MAX_ASSET_NOTES = 512; // Longest song loaded from the AssetStore (8 bytes per note)
+}
+
 struct MusicNote
 {
         u16 note;           // Frequency (Hz) or NOTE_xxx
@@ -39,8 +44,15 @@ private:
         // Gap between notes for articulation (staccato/legato)
         // For now, simple full duration
 
+        // Notes loaded from the AssetStore (the sample ISR cannot read flash files)
+        MusicNote *assetNotes;
+        u16 assetCapacity; // Notes assetNotes holds: grows to the longest song played
+
+        void stopAsset();
+
 public:
         MusicPlayer(Synth *s);
+        ~MusicPlayer();
 
         // Start playing a melody
         void play(const MusicNote *melody, u16 length, u8 bpm = 120);
@@ -48,6 +60,12 @@ public:
         // Play a predefined song
         void playSong(const struct Song &song);
 
+        // Play a song stored in the AssetStore (ASSET_SONG)
+        // Notes are copied to RAM (at most MusicConfig::MAX_ASSET_NOTES), into a
+        // buffer reused by the next asset song
+        // Returns false if the asset is missing, malformed or too long
+        bool playAsset(u16 assetId);
+
         // Stop playing
         void stop();
 
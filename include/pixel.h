@@ -9,18 +9,66 @@
 
 #include "msk.h"
 #include <Adafruit_NeoPixel.h>
+#include "pixeloutput.h"
+
+namespace PixelConfig
+{
+        // Compact frame buffer: one entry per logical pixel, no padding byte
+        constexpr u8 BYTES_PER_PIXEL = 3;
+
+        // Pin of a strip that is never begun (benchmarks): no GPIO is touched
+        constexpr u8 NO_PIN = 0xFF;
+
+        // Channel order inside each frame entry: WS2812B wire order (GRB),
+        // so an unscaled frame can be copied to the output as-is
+        constexpr u8 OFFSET_G = 0;
+        constexpr u8 OFFSET_R = 1;
+        constexpr u8 OFFSET_B = 2;
+
+        // Colour pipeline
+        constexpr float GAMMA = 2.6f;           // Exponent used by setGamma(true)
+        constexpr u32 DITHER_REFRESH_MS = 10;  // Re-send rate while dithering (100 Hz)
+        constexpr u8 DITHER_BITS = 2;          // Fraction bits kept: a level repeats every 4 refreshes
+        constexpr bool DITHER_DEFAULT = false; // Opt-in: dithering keeps the strip re-sending
+
+        // Transitions (fadeTo)
+        constexpr u8 FADE_SLOTS = 8;          // Fades with distinct start/duration/easing at once
+        constexpr u8 FADE_NONE = 0xFF;        // fadeSlot entry of a pixel that is not fading
+        constexpr u32 FADE_REFRESH_MS = 20;   // Frame rate while fading (50 Hz)
+}
+
+// Transition curves (progress 0..1 -> 0..1)
+enum FadeEasing : u8
+{
+        FADE_LINEAR = 0,
+        FADE_EASE_IN,     // Slow start (quadratic)
+        FADE_EASE_OUT,    // Slow end (quadratic)
+        FADE_EASE_IN_OUT, // Slow start and end (smoothstep)
+        FADE_EASING_COUNT
+};
+
+// Called when a fade starts, so the owner can schedule updateFades()
+typedef void (*PixelWakeCallback)(void);
 
 class PixelStrip
 {
 public:
         /**
          * Constructor
-         * @param pin GPIO pin connected to pixel strip
+         * @param pin GPIO pin connected to pixel strip (PixelConfig::NO_PIN = none)
          * @param count Number of logical groups (pixels you control)
          * @param groupSize Number of physical LEDs per logical group (default 1)
          * @param brightness Initial brightness (0-255)
          */
-        PixelStrip(u8 pin, u8 count, u8 groupSize = 1, u8 brightness = 25);
+        PixelStrip(u8 pin, u16 count, u16 groupSize = 1, u8 brightness = 25);
+        ~PixelStrip();
+
+        /**
+         * Change the logical pixel count (same group size); call before begin()
+         * Clears the frame and drops any fades.
+         * @param count New logical pixel count
+         */
+        void setCount(u16 count);
 
         /**
          * Initialize the pixel strip
@@ -34,14 +82,21 @@ public:
          * @param g Green value (0-255)
          * @param b Blue value (0-255)
          */
-        void setColor(u8 index, u8 r, u8 g, u8 b);
+        void setColor(u16 index, u8 r, u8 g, u8 b);
 
         /**
          * Set a single logical pixel (group) color using u32 color value
          * @param index Logical group index (0 to logicalCount-1)
          * @param color 24-bit RGB color (0xRRGGBB)
          */
-        void setColor(u8 index, u32 color);
+        void setColor(u16 index, u32 color);
+
+        /**
+         * Get a logical pixel color from the frame buffer
+         * @param index Logical group index (0 to logicalCount-1)
+         * @return 24-bit RGB color (0xRRGGBB), 0 if out of range
+         */
+        u32 getColor(u16 index) const;
 
         /**
          * Set all logical pixels (groups) to the same color (RGB)
@@ -54,49 +109,146 @@ public:
         void setAll(u32 color);
 
         /**
-         * Clear all pixels (turn off)
+         * Clear all pixels (turn off), cancelling any fades
          */
         void clear();
 
         /**
-         * Update the strip with current pixel values
+         * Fade a logical pixel from its current color to a target color
+         * The fade runs in updateFades(); setColor() on the pixel cancels it,
+         * so frame sources (Animation, Compositor) skip pixels that are fading.
+         * Allocates 7 bytes per logical pixel on first use.
+         * @param index Logical group index
+         * @param color Target color (0xRRGGBB)
+         * @param durationMs Fade time (0 = set immediately)
+         * @param easing Transition curve
+         */
+        void fadeTo(u16 index, u32 color, u16 durationMs, FadeEasing easing = FADE_EASE_IN_OUT);
+
+        /**
+         * Fade a range of logical pixels to one color (one shared fade)
+         * @param first First logical index
+         * @param count Number of pixels (clipped to the strip)
+         */
+        void fadeRange(u16 first, u16 count, u32 color, u16 durationMs, FadeEasing easing = FADE_EASE_IN_OUT);
+
+        /**
+         * Fade every logical pixel to one color
+         */
+        void fadeAll(u32 color, u16 durationMs, FadeEasing easing = FADE_EASE_IN_OUT) { fadeRange(0, logicalCount, color, durationMs, easing); }
+
+        /**
+         * Advance all running fades to the current time (one pass over the
+         * fading range); the caller sends the frame with applyBuffer()
+         * @return ms until the next step, 0 when no fade is running
+         */
+        u32 updateFades();
+
+        /**
+         * Check if any fade is running
+         */
+        bool isFading() const { return fadeCount != 0; }
+
+        /**
+         * Check if one logical pixel is fading
+         */
+        bool isFading(u16 index) const { return fadeCount && index < logicalCount && fadeSlot[index] != PixelConfig::FADE_NONE; }
+
+        /**
+         * Set the hook called when a fade starts
+         */
+        void setWakeCallback(PixelWakeCallback callback) { wake = callback; }
+
+        /**
+         * Update the strip with current pixel values (skipped if nothing changed)
          */
         void show();
 
+        /**
+         * Mark the whole frame changed (after writing through getFrame())
+         */
+        void markDirty() { markDirty(0, logicalCount ? logicalCount - 1 : 0); }
+
+        /**
+         * Mark a range of logical pixels changed
+         * @param first First logical index
+         * @param last Last logical index (inclusive)
+         */
+        void markDirty(u16 first, u16 last);
+
+        /**
+         * Check if the frame differs from what was last sent
+         */
+        bool isDirty() const { return dirty; }
+
         /**
          * Set brightness (0-255)
          */
         void setBrightness(u8 brightness);
 
         /**
-         * Get pointer to the color buffer (for ISR updates)
-         * Buffer size is logicalCount, each entry is a 24-bit RGB color
+         * Enable gamma correction (folded into the output LUT with brightness)
+         */
+        void setGamma(bool enable);
+
+        /**
+         * Enable temporal dithering of the 16-bit output LUT
+         * Low brightness and gamma leave fractional output levels; dithering
+         * alternates between neighbours across refreshes so fades stay smooth.
+         * Fractions are rounded to PixelConfig::DITHER_BITS, so the pattern of
+         * a level repeats within 1 << DITHER_BITS refreshes (25 Hz at 100 Hz).
+         * Allocates one residual byte per frame byte on first use.
+         */
+        void setDither(bool enable);
+
+        /**
+         * Check if frames need periodic re-sending (dithering with a fractional LUT)
+         */
+        bool isDithering() const { return dither && !lutExact && residual; }
+        /**
+         * Get pointer to the frame buffer (for bulk updates)
+         * logicalCount entries of PixelConfig::BYTES_PER_PIXEL bytes each,
+         * channel order given by PixelConfig::OFFSET_*; call markDirty() after writing
          */
-        u32 *getBuffer() { return colorBuffer; }
+        u8 *getFrame() { return frame; }
 
         /**
-         * Apply the color buffer to the actual NeoPixels
+         * Apply the frame buffer to the actual NeoPixels
          * This should be called from the ISR to refresh the display
+         * One pass through the brightness/gamma LUT into the output buffer, or
+         * a plain memcpy when the LUT is identity and groups are single LEDs.
+         * Only the dirty range is converted; a clean frame is not sent at all,
+         * except every DITHER_REFRESH_MS while dithering.
+         * With PIXEL_OUTPUT_RMT the frame is handed to the RMT peripheral;
+         * the call returns while the frame is still transmitting.
          */
         void IRAM_ATTR applyBuffer();
 
+        /**
+         * Check if a frame is still being transmitted
+         * @return true while the RMT backend is busy (always false with Adafruit show())
+         */
+        bool isShowing() const;
+
         /**
          * Get the number of logical pixels (groups)
          */
-        u8 getCount() const { return logicalCount; }
+        u16 getCount() const { return logicalCount; }
 
         /**
          * Get the group size (LEDs per logical pixel)
          */
-        u8 getGroupSize() const { return groupSize; }
+        u16 getGroupSize() const { return groupSize; }
 
         /**
          * Get the total number of physical LEDs
          */
-        u8 getPhysicalCount() const { return physicalCount; }
+        u16 getPhysicalCount() const { return physicalCount; }
 
         /**
          * Get direct access to underlying Adafruit_NeoPixel object
+         * (zero length with PIXEL_OUTPUT_RMT: the RMT backend keeps the wire frames)
+         * Its buffer is overwritten by applyBuffer(); draw through setColor().
          */
         Adafruit_NeoPixel &getPixels() { return pixels; }
 
@@ -107,12 +259,64 @@ public:
          */
         void pixelCheck(u16 delayMs = 200);
 
+        /**
+         * Measure heap use and frame-render time at 264, 1000 and 2000 pixels
+         * Temporary strips have no pin (PixelConfig::NO_PIN) and are converted
+         * into a scratch buffer, never sent, so the live strip keeps its GPIO.
+         */
+        void benchmark();
+
 private:
         Adafruit_NeoPixel pixels;
-        u8 physicalCount; // Total physical LEDs
-        u8 groupSize;     // LEDs per logical group
-        u8 logicalCount;  // Number of logical groups
-        u32 *colorBuffer; // Color buffer for animations (logicalCount entries)
+        u16 physicalCount; // Total physical LEDs
+        u16 groupSize;     // LEDs per logical group
+        u16 logicalCount;  // Number of logical groups
+        u8 *frame;         // Logical frame (logicalCount * BYTES_PER_PIXEL)
+        u8 pin;            // Data GPIO
+        u8 brightness;     // Global brightness (folded into the LUTs)
+        bool gamma;        // Gamma correction (folded into the LUTs)
+        bool dither;       // Temporal dithering requested
+        bool lutIdentity;  // lut[i] == i: applyBuffer() can memcpy
+        bool lutExact;     // lut16 has no fractional part: nothing to dither
+        u8 lut[256];       // Rounded output value for each frame byte
+        u16 lut16[256];    // Output value in 8.8 fixed point
+        u8 *residual;      // Dither error per frame byte (fractional part carried over)
+        u32 lastSendMs;    // millis() of the last transmission
+        bool dirty;        // Frame changed since the last send
+        u16 dirtyFirst;    // Changed logical range (valid while dirty)
+        u16 dirtyLast;
+
+        // Transitions (per-pixel arrays allocated on the first fade)
+        struct FadeSlot
+        {
+                u32 startMs;
+                u16 durationMs;
+                FadeEasing easing;
+                u16 users;     // Pixels following this fade
+        };
+        FadeSlot fades[PixelConfig::FADE_SLOTS];
+        u8 *fadeFrom;      // Start color per pixel (frame layout)
+        u8 *fadeTarget;    // Target color per pixel (frame layout)
+        u8 *fadeSlot;      // Slot per pixel, FADE_NONE = not fading
+        u16 fadeCount;     // Pixels fading
+        u16 fadeFirst;     // Range holding every fading pixel (valid while fadeCount)
+        u16 fadeLast;
+        PixelWakeCallback wake;
+
+#ifdef PIXEL_OUTPUT_RMT
+        u16 sentFirst;     // Range of the previous frame: the back frame lacks it
+        u16 sentLast;
+#endif
+
+        void buildLut();
+        void IRAM_ATTR convert(u8 *dst, u16 first, u16 last, bool dithering);
+        bool allocFades();
+        u8 acquireFade(u32 now, u16 durationMs, FadeEasing easing);
+        bool startFade(u16 index, u32 color, u8 slot);
+        void cancelFade(u16 index);
+#ifdef PIXEL_OUTPUT_RMT
+        PixelOutput output; // Non-blocking RMT backend (replaces pixels.show())
+#endif
 };
 
 #endif // PIXEL_H
@@ -0,0 +1,90 @@
+/************************* pixeloutput.h ************************
+ * Non-blocking WS2812B output via the RMT peripheral
+ * Double-buffered GRB byte frames with a completion flag
+ * Created by MSK, November 2025
+ * Compiled in only when PIXEL_OUTPUT_RMT is defined
+ ***************************************************************/
+
+#ifndef PIXELOUTPUT_H
+#define PIXELOUTPUT_H
+
+#include <Arduino.h>
+#include "msk.h"
+
+#ifdef PIXEL_OUTPUT_RMT
+
+#include "driver/rmt.h"
+
+namespace PixelOutputConfig
+{
+        constexpr rmt_channel_t CHANNEL = RMT_CHANNEL_0;
+        constexpr u8 CLK_DIV = 2;       // 80 MHz / 2 = 25 ns per tick
+        constexpr u32 MAX_WAIT_MS = 70; // Longest wait for a previous frame (~2300 LEDs)
+
+        // WS2812B bit timing in ticks (datasheet +-150 ns)
+        constexpr u16 T0H = 16; // 0.40 us
+        constexpr u16 T0L = 34; // 0.85 us
+        constexpr u16 T1H = 32; // 0.80 us
+        constexpr u16 T1L = 18; // 0.45 us
+}
+
+/**
+ * RMT pixel output
+ * The caller fills the back frame while the front frame transmits; send()
+ * swaps them and starts the RMT without waiting. Frames hold 3 wire-order
+ * bytes per LED; the driver ISR expands them to RMT items a block at a time,
+ * so RAM stays at 6 bytes per LED instead of 2 x 96 for pre-built items.
+ */
+class PixelOutput
+{
+public:
+        PixelOutput();
+        ~PixelOutput();
+
+        /**
+         * Install the RMT driver and allocate both frames
+         * @param pin GPIO driving the strip
+         * @param ledCount Physical LEDs
+         * @return true on success
+         */
+        bool begin(u8 pin, u16 ledCount);
+
+        /**
+         * Back frame to fill before send() (wire order G, R, B per LED)
+         * @return nullptr until begin() succeeded
+         */
+        u8 *getBackFrame() { return m_ready ? m_frames[m_back] : nullptr; }
+
+        /**
+         * Start transmitting the back frame (returns immediately unless the
+         * previous frame is still in flight)
+         * @return true if transmission started
+         */
+        bool send();
+
+        /**
+         * Check if a frame is being transmitted (completion flag)
+         */
+        bool isBusy() const { return m_busy; }
+
+        /**
+         * Number of send() calls that had to wait for the previous frame
+         */
+        u32 getStalls() const { return m_stalls; }
+
+private:
+        u8 *m_frames[2];           // 3 bytes per LED each (G, R, B)
+        u8 m_back;                 // Frame being filled
+        u16 m_ledCount;
+        volatile bool m_busy;      // Cleared by the RMT TX-end callback
+        u32 m_stalls;
+        bool m_ready;
+
+        static void onTxEnd(rmt_channel_t channel, void *arg);
+        static void translate(const void *src, rmt_item32_t *dest, size_t srcSize,
+                              size_t wanted, size_t *translated, size_t *itemCount);
+};
+
+#endif // PIXEL_OUTPUT_RMT
+
+#endif // PIXELOUTPUT_H
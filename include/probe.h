@@ -0,0 +1,118 @@
+/************************* probe.h ******************************
+ * Hot-path timing probes
+ * Scoped cycle-counter probes with min/max/avg and a log2 histogram
+ * Created by MSK, November 2025
+ * Compiled out entirely unless ENABLE_PROBES is defined
+ ***************************************************************/
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <Arduino.h>
+#include "msk.h"
+
+// Probe slots (one static table entry each). Add new probes before PROBE_COUNT
+// and give them a name in probe.cpp (kProbeNames).
+enum ProbeId : u8
+{
+        PROBE_CORE_UPDATE = 0, // Core::update (whole main loop pass)
+        PROBE_INPUT_POLL,      // InputManager::poll
+        PROBE_KEYPAD_SCAN,     // IOExpander::scanKeypad
+        PROBE_ANIM_UPDATE,     // Animation::update
+        PROBE_PIXEL_APPLY,     // PixelStrip::applyBuffer
+        PROBE_SYNTH_SAMPLE,    // Synth::updateSample (ISR)
+        PROBE_SYNTH_PERIOD,    // Time between sample ISR entries (audio jitter; load column n/a)
+        PROBE_ANIM_DECODE,     // Animation::decodePackedFrame (one packed frame)
+        PROBE_SHADER_FRAME,    // Animation::updateShader (all pixels of one frame)
+        PROBE_COUNT
+};
+
+namespace ProbeConfig
+{
+        constexpr u8 HIST_BUCKETS = 16;          // log2 buckets
+        constexpr u8 HIST_FIRST_SHIFT = 8;       // Bucket 0 = < 256 cycles, bucket 15 = >= 2^22 cycles
+        constexpr u32 DUMP_INTERVAL_MS = 10000;  // Periodic Serial dump from Core (0 = off)
+}
+
+// Accumulated timing for one probe (CPU cycles)
+struct ProbeStats
+{
+        u32 count;
+        u32 minCycles;
+        u32 maxCycles;
+        uint64_t totalCycles;
+        u32 hist[ProbeConfig::HIST_BUCKETS];
+};
+
+#ifdef ENABLE_PROBES
+
+class Probe
+{
+public:
+        /**
+         * Read the CPU cycle counter (RISC-V mcycle on ESP32-C3)
+         */
+        static inline u32 cycles() { return ESP.getCycleCount(); }
+
+        /**
+         * Record one measurement (ISR safe, no allocation)
+         * @param id Probe slot
+         * @param cycles Elapsed CPU cycles
+         */
+        static void record(ProbeId id, u32 cycles);
+
+        /**
+         * Clear all probes and restart the measurement window
+         */
+        static void reset();
+
+        /**
+         * Get accumulated stats for one probe
+         * @return Pointer into the static table, nullptr for invalid id
+         */
+        static const ProbeStats *get(ProbeId id);
+
+        /**
+         * Get probe display name
+         */
+        static const char *name(ProbeId id);
+
+        /**
+         * Length of the current measurement window in microseconds (esp_timer)
+         */
+        static u32 windowUs();
+
+        /**
+         * Print a table of all probes to Serial
+         */
+        static void dump();
+};
+
+/**
+ * Scoped probe: records the cycles between construction and destruction
+ */
+class ProbeScope
+{
+public:
+        explicit ProbeScope(ProbeId id) : m_id(id), m_start(Probe::cycles()) {}
+        ~ProbeScope() { Probe::record(m_id, Probe::cycles() - m_start); }
+
+private:
+        ProbeId m_id;
+        u32 m_start;
+};
+
+#define PROBE_CONCAT_(a, b) a##b
+#define PROBE_CONCAT(a, b) PROBE_CONCAT_(a, b)
+#define PROBE_SCOPE(id) ProbeScope PROBE_CONCAT(_probeScope, __LINE__)(id)
+
+#else
+
+#define PROBE_SCOPE(id) \
+        do              \
+        {               \
+        } while (0)
+
+#endif // ENABLE_PROBES
+
+#endif // PROBE_H
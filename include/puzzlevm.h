@@ -0,0 +1,230 @@
+/************************* puzzlevm.h ***************************
+ * Puzzle logic VM
+ * Event-driven bytecode scripts that run a prop without reflashing
+ * Created by MSK, November 2025
+ * Fixed memory, checked once at load, bounded steps per event
+ ***************************************************************/
+
+#ifndef PUZZLEVM_H
+#define PUZZLEVM_H
+
+#include <stdint.h>
+#include "msk.h"
+
+namespace PuzzleConfig
+{
+        constexpr u16 MAX_CODE = 1024;   // Bytecode bytes per script
+        constexpr u8 VAR_COUNT = 64;     // int32 variables (persist across events)
+        constexpr u8 STACK_DEPTH = 16;   // Operand stack per event
+        constexpr u16 MAX_STEPS = 4096;  // Instructions per event before it is aborted
+        constexpr u8 MAX_SYS_CALLS = 32; // Host calls (PZ_SYS) per event before it is aborted
+        constexpr u8 TIMERS = 4;         // One-shot timers (ON_TIMER, arg = timer id)
+        constexpr u8 PARAM_BYTES = 19;   // PUZZLE_INPUT payload visible to PARAM
+        constexpr u16 NO_ENTRY = 0xFFFF;
+        constexpr bool THREADED = true;  // Computed-goto dispatch (false = switch)
+}
+
+/**
+ * Script entry points. A script has one optional handler per event; ARG
+ * pushes the event's argument.
+ */
+enum PuzzleEvent : u8
+{
+        PUZZLE_ON_START = 0, // After load and PUZZLE_RESET        arg 0
+        PUZZLE_ON_KEY,       // Keypad press                        arg key 0-15
+        PUZZLE_ON_KEY_UP,    // Keypad release                      arg key 0-15
+        PUZZLE_ON_KEY_HOLD,  // Keypad held                         arg key 0-15
+        PUZZLE_ON_BUTTON,    // Button 1 press                      arg 0
+        PUZZLE_ON_TIMER,     // TIMER expired                       arg timer id
+        PUZZLE_ON_COMMAND,   // PUZZLE_INPUT from the server        arg p[0] (PARAM reads the rest)
+        PUZZLE_EVENT_COUNT
+};
+
+/**
+ * Opcodes. All values are int32. Operands follow the opcode byte
+ * (little-endian); jump offsets are relative to the next instruction.
+ *
+ * Stack effect notation: (inputs -- outputs), rightmost = top.
+ */
+enum PuzzleOp : u8
+{
+        PZ_END = 0,  // ( -- )          end of the handler
+        PZ_PUSH8,    // ( -- n )        next byte, signed
+        PZ_PUSH16,   // ( -- n )        next 2 bytes, signed
+        PZ_PUSH32,   // ( -- n )        next 4 bytes
+        PZ_ARG,      // ( -- a )        event argument
+        PZ_LOAD,     // ( -- x )        var[next byte]
+        PZ_STORE,    // ( x -- )        var[next byte] = x
+        PZ_LOADX,    // ( i -- x )      var[next byte + i]
+        PZ_STOREX,   // ( x i -- )      var[next byte + i] = x
+        PZ_INC,      // ( -- )          var[next byte] += 1
+
+        // Stack
+        PZ_DUP,      // ( a -- a a )
+        PZ_DROP,     // ( a -- )
+        PZ_SWAP,     // ( a b -- b a )
+        PZ_OVER,     // ( a b -- a b a )
+
+        // Arithmetic and logic
+        PZ_ADD,      // ( a b -- a+b )
+        PZ_SUB,      // ( a b -- a-b )
+        PZ_MUL,      // ( a b -- a*b )
+        PZ_DIV,      // ( a b -- a/b )  0 when b = 0
+        PZ_MOD,      // ( a b -- a%b )  0 when b = 0
+        PZ_NEG,      // ( a -- -a )
+        PZ_AND,      // ( a b -- a&b )
+        PZ_OR,       // ( a b -- a|b )
+        PZ_XOR,      // ( a b -- a^b )
+        PZ_SHL,      // ( a n -- a<<n )
+        PZ_SHR,      // ( a n -- a>>n ) arithmetic
+        PZ_NOT,      // ( a -- !a )     1 if a = 0, else 0
+        PZ_EQ,       // ( a b -- a==b )
+        PZ_NE,       // ( a b -- a!=b )
+        PZ_LT,       // ( a b -- a<b )
+        PZ_LE,       // ( a b -- a<=b )
+        PZ_GT,       // ( a b -- a>b )
+        PZ_GE,       // ( a b -- a>=b )
+        PZ_MIN,      // ( a b -- min )
+        PZ_MAX,      // ( a b -- max )
+
+        // Control flow
+        PZ_JMP,      // ( -- )          jump by next 2 bytes (signed)
+        PZ_JZ,       // ( c -- )        jump if c = 0
+        PZ_JNZ,      // ( c -- )        jump if c != 0
+
+        // Built-ins
+        PZ_NOW,      // ( -- ms )       ms since the script started
+        PZ_RAND,     // ( n -- r )      0..n-1 (0 when n <= 0)
+        PZ_PARAM,    // ( i -- b )      byte i of the last PUZZLE_INPUT payload after p[0]
+        PZ_TIMER,    // ( id ms -- )    ON_TIMER(id) after ms (0 = cancel)
+        PZ_SYS,      // ( args -- [r] ) host call next byte (PuzzleSys)
+
+        PZ_OP_COUNT
+};
+
+/**
+ * Host calls (PZ_SYS). Argument and result counts are in PUZZLE_SYS_ARGS /
+ * PUZZLE_SYS_RESULT; the App hosting the VM implements them.
+ */
+enum PuzzleSys : u8
+{
+        SYS_LED = 0,  // ( cell color -- )     MatrixPanel cell, 0x00RRGGBB
+        SYS_FILL,     // ( color -- )          all cells
+        SYS_FADE,     // ( cell color ms -- )  fade a cell (cell -1 = all)
+        SYS_SHOW,     // ( -- )                send the LEDs
+        SYS_TONE,     // ( freq ms -- )        one synth note
+        SYS_SONG,     // ( asset -- ok )       play an ASSET_SONG
+        SYS_SILENCE,  // ( -- )                stop song and note
+        SYS_MOTOR,    // ( motor speed -- )    -100..100
+        SYS_EVENT,    // ( event p0 p1 -- )    sendEvent() to the server
+        SYS_COUNT
+};
+
+constexpr u8 PUZZLE_SYS_ARGS[SYS_COUNT] = {2, 1, 3, 0, 2, 1, 0, 2, 3};
+constexpr u8 PUZZLE_SYS_RESULT[SYS_COUNT] = {0, 0, 0, 0, 0, 1, 0, 0, 0};
+
+// Why an event handler was aborted (0 = ran to END)
+enum PuzzleFault : u8
+{
+        PZ_FAULT_NONE = 0,
+        PZ_FAULT_STEPS,     // MAX_STEPS reached (endless loop?)
+        PZ_FAULT_INDEX,     // LOADX/STOREX outside the variables
+        PZ_FAULT_HOST_CALLS // MAX_SYS_CALLS reached (drivers would run too long)
+};
+
+// Host call: args[0] is the deepest argument; return the result (if any)
+typedef int32_t (*PuzzleSysFn)(void *ctx, u8 id, const int32_t *args);
+
+/**
+ * PuzzleVM
+ * One loaded script, its variables and timers, all in fixed arrays: the
+ * object never allocates. load() follows every path from every entry point
+ * and rejects bad opcodes, operands, variable indices, host calls, jump
+ * targets, and any instruction reached with two different stack depths or
+ * one that could underflow or overflow the stack. run() then only checks
+ * the step and host-call budgets and LOADX/STOREX indices. A handler that faults is
+ * aborted; variables keep what it stored so far.
+ */
+class PuzzleVM
+{
+public:
+        PuzzleVM();
+
+        /**
+         * Route PZ_SYS to the host
+         */
+        void setHost(PuzzleSysFn fn, void *ctx);
+
+        /**
+         * Validate and copy a script (the source may be freed afterwards)
+         * @param entries PUZZLE_EVENT_COUNT code offsets (NO_ENTRY = no handler)
+         * @return false if the script is malformed (nothing is loaded then)
+         */
+        bool load(const u8 *code, u16 codeSize, const u16 *entries);
+
+        /**
+         * Load an ASSET_PUZZLE from the AssetStore
+         */
+        bool loadAsset(u16 id);
+
+        void unload();
+        bool isLoaded() const { return m_loaded; }
+        bool hasHandler(PuzzleEvent event) const;
+
+        /**
+         * Clear variables and timers and restart NOW at 0 (the script stays)
+         */
+        void reset();
+
+        /**
+         * Run one event handler (no-op without a handler)
+         * @return PZ_FAULT_NONE or why the handler was aborted
+         */
+        PuzzleFault run(PuzzleEvent event, int32_t arg = 0);
+
+        /**
+         * Payload for PARAM, set before running PUZZLE_ON_COMMAND
+         */
+        void setParams(const u8 *params, u8 len);
+
+        /**
+         * Fire due timers (call from the App loop)
+         * @return first fault of a timer handler
+         */
+        PuzzleFault tick();
+
+        u32 getStepCount() const { return m_steps; } // Instructions of the last run()
+        u32 getFaultCount() const { return m_faults; }
+
+        /**
+         * Time the interpreter on a counting loop and print ns/instruction
+         * (probe builds)
+         */
+        static void benchmark();
+
+        /**
+         * Check a script without loading it
+         */
+        static bool validate(const u8 *code, u16 codeSize, const u16 *entries);
+
+private:
+        template <bool Threaded>
+        PuzzleFault exec(u16 entry, int32_t arg);
+
+        u8 m_code[PuzzleConfig::MAX_CODE];
+        u16 m_codeSize;
+        u16 m_entries[PUZZLE_EVENT_COUNT];
+        int32_t m_vars[PuzzleConfig::VAR_COUNT];
+        u32 m_timerDue[PuzzleConfig::TIMERS]; // millis() deadline
+        u8 m_timersArmed;                     // Bit per timer
+        u8 m_params[PuzzleConfig::PARAM_BYTES];
+        u32 m_startMs;
+        u32 m_random;
+        u32 m_steps;
+        u32 m_faults;
+        PuzzleSysFn m_host;
+        void *m_hostCtx;
+        bool m_loaded;
+};
+
+#endif // PUZZLEVM_H
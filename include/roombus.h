@@ -52,6 +52,10 @@ typedef enum
     CORE_PING = 0x03,        // liveness check
     CORE_RESET = 0x04,       // soft reset/restart
     CORE_SET_ADDRESS = 0x05, // server assigns address to device
+    CORE_STATS = 0x06,       // runtime statistics request/response (see below)
+    CORE_PROBE = 0x07,       // timing probe readout (ENABLE_PROBES builds only)
+    CORE_ASSET = 0x08,       // asset store upload/delete/info/play (see below)
+    CORE_FADE = 0x09,        // fade LEDs to a color on the device (see below)
 
     // Device-specific commands start at 0x40
 
@@ -74,6 +78,8 @@ typedef enum
     TMR_SET_VALUE = 0x41,
     TMR_START = 0x42,
     TMR_PAUSE = 0x43,
+    TMR_ADD_TIME = 0x44,
+    TMR_SYNC = 0x45,
 
     // QB
     QB_SET_COLORS = 0x40,
@@ -107,6 +113,8 @@ typedef enum
 
     // Puzzle
     PUZZLE_RESET = 0x40,
+    PUZZLE_LOAD = 0x41,
+    PUZZLE_INPUT = 0x42,
 
 } RoomServerCommand;
 
@@ -128,6 +136,144 @@ typedef enum
     EV_PUZZLE_FAILED = 0x91,
 } RoomDeviceEvent;
 
+// ---------- EV_DEVICE_ERROR ----------
+// Event (device→server): cmd_dev = EV_DEVICE_ERROR
+//   p[0] = device address, p[1] = error (DEVICE_ERROR_*), p[2] = detail
+// DEVICE_ERROR_UNSUPPORTED: p[2] = the cmd_srv this device type has no
+//   handler for. Sent for addressed frames only, never for broadcasts.
+// DEVICE_ERROR_SCRIPT (Puzzle): p[2] = 0 if PUZZLE_LOAD failed, else the
+//   PuzzleFault that aborted a script handler (puzzlevm.h)
+#define DEVICE_ERROR_UNSUPPORTED 0x01
+#define DEVICE_ERROR_SCRIPT 0x02
+
+// ---------- CORE_STATS ----------
+// Request  (server→device): cmd_srv = CORE_STATS
+//   p[0] = page (STATS_PAGE_*)
+//   p[1] = flags (STATS_FLAG_RESET clears the loop timing window after reply;
+//          on STATS_PAGE_COMMANDS it clears the command counters instead)
+//   p[2] = command (STATS_PAGE_COMMANDS only)
+// Response (device→server): cmd_dev = CORE_STATS
+//   p[0] = device address, p[1] = page, p[2..19] = page data (little-endian)
+//
+// STATS_PAGE_RUNTIME:
+//   (loop period = time between scheduler wake-ups in Core::update)
+//   p[2..3]   loop period min (us)      p[4..5]   loop period avg (us)
+//   p[6..7]   loop period max (us)      p[8..9]   audio ISR load (per mille)
+//   p[10..11] I2C errors                p[12..13] RX CRC failures
+//   p[14..15] RX dropped bytes          p[16..19] loop iterations in window
+// STATS_PAGE_SYSTEM:
+//   p[2..5]   free heap (bytes)         p[6..9]   min-ever free heap (bytes)
+//   p[10..13] uptime (s)                p[14]     reset reason (esp_reset_reason_t)
+//   p[15..16] RX frames accepted
+// STATS_PAGE_COMMANDS (one command handler):
+//   p[2]      command               p[3..6]   calls handled
+//   p[7..10]  avg handler time (us) p[11..14] max handler time (us)
+//   p[15..18] commands rejected as unsupported (all commands)
+//   p[19]     1 if this device has a handler for the command
+//
+// Error counters are free-running 16-bit values that wrap; the server should
+// work with deltas between polls. Timing values saturate at 0xFFFF.
+#define STATS_PAGE_RUNTIME 0x00
+#define STATS_PAGE_SYSTEM 0x01
+#define STATS_PAGE_COMMANDS 0x02
+#define STATS_FLAG_RESET 0x01
+
+// ---------- CORE_PROBE ----------
+// Request  (server→device): cmd_srv = CORE_PROBE
+//   p[0] = probe id (ProbeId in probe.h), p[1] = page (PROBE_PAGE_*)
+//   p[2] = flags (STATS_FLAG_RESET clears all probes after reply)
+// Response (device→server): cmd_dev = CORE_PROBE
+//   p[0] = device address, p[1] = probe id, p[2] = page
+// PROBE_PAGE_SUMMARY (CPU cycles, little-endian):
+//   p[3..6] calls  p[7..10] min  p[11..14] avg  p[15..18] max  p[19] CPU MHz
+// PROBE_PAGE_HISTOGRAM:
+//   p[3..18] log2 buckets (bucket n = < 2^(n+8) cycles), each scaled 0-255
+//            as share of calls; p[19] = number of probes on this device
+// Firmware built without ENABLE_PROBES answers EV_DEVICE_ERROR (unsupported).
+#define PROBE_PAGE_SUMMARY 0x00
+#define PROBE_PAGE_HISTOGRAM 0x01
+
+// ---------- CORE_ASSET ----------
+// Request  (server→device): cmd_srv = CORE_ASSET, p[0] = op (ASSET_OP_*)
+//   ASSET_OP_BEGIN : p[1..2] asset id  p[3] type (AssetType in assetstore.h)
+//                    p[4..7] payload size  p[8..11] payload CRC-32 (zlib)
+//   ASSET_OP_DATA  : p[1..4] payload offset  p[5] length (1-14)  p[6..19] bytes
+//                    (offsets must arrive in order; no reply unless rejected)
+//   ASSET_OP_COMMIT: size and CRC are checked, then the asset replaces any
+//                    previous one with the same id
+//   ASSET_OP_ABORT : drop the upload in progress
+//   ASSET_OP_DELETE: p[1..2] asset id
+//   ASSET_OP_INFO  : p[1..2] asset id
+//   ASSET_OP_PLAY  : p[1..2] asset id  p[3] flags (ASSET_PLAY_LOOP)
+//                    starts a packed animation or shader on the device LEDs
+// Response (device→server): cmd_dev = CORE_ASSET
+//   p[0] = device address, p[1] = op, p[2] = status (ASSET_STATUS_*)
+//   p[3..4] asset id, p[5..8] next upload offset expected,
+//   p[9..12] free bytes on the partition
+//   INFO only: p[13] type, p[14..17] payload size, p[18..19] asset count
+// Frames sent to ADDR_BROADCAST are applied but never answered, so one upload
+// can load every device; poll each device with ASSET_OP_INFO afterwards.
+#define ASSET_OP_BEGIN 0x00
+#define ASSET_OP_DATA 0x01
+#define ASSET_OP_COMMIT 0x02
+#define ASSET_OP_ABORT 0x03
+#define ASSET_OP_DELETE 0x04
+#define ASSET_OP_INFO 0x05
+#define ASSET_OP_PLAY 0x06
+#define ASSET_PLAY_LOOP 0x01 // packed animations: loop instead of one-shot
+#define ASSET_DATA_MAX 14
+#define ASSET_STATUS_OK 0x00
+#define ASSET_STATUS_ERROR 0x01     // rejected (no space, bad offset, CRC mismatch, ...)
+#define ASSET_STATUS_NOT_FOUND 0x02 // no such asset / no upload in progress
+
+// ---------- CORE_FADE ----------
+// Request  (server→device): cmd_srv = CORE_FADE, no response
+//   p[0..2] target color R, G, B   p[3..4] duration (ms, 0 = set immediately)
+//   p[5] easing (FADE_EASING_*)    p[6..7] first LED   p[8..9] LED count (0 = to the end)
+// The device steps the fade itself (50 Hz), so one frame replaces a stream
+// of color updates. A running animation is paused and faded from where it
+// stopped; anything drawing the LEDs afterwards cancels the fade.
+#define FADE_EASING_LINEAR 0x00
+#define FADE_EASING_IN 0x01
+#define FADE_EASING_OUT 0x02
+#define FADE_EASING_IN_OUT 0x03
+
+// ---------- Num Box / Timer digits ----------
+// 11-segment digits (glyph.h); characters are ASCII, unknown ones show blank.
+// Num Box: 24 digits, 4 rows of 6
+//   NUM_SET_DIGIT_COLOR: p[0] digit (NUM_ALL_DIGITS = every digit)  p[1..3] R, G, B
+//   NUM_SET_DIGIT_VAL  : p[0] digit  p[1] character  p[2] flags (NUM_FLAG_DOT)
+//   NUM_SET_ROW_NUM    : p[0] row  p[1..4] value (int32, little-endian)
+//                        p[5] flags (NUM_FLAG_LEADING_ZEROS); right-aligned,
+//                        dashes if it does not fit
+// Timer: 4 digits shown as mm.ss, dimmed while paused. The device counts
+// down itself and sends EV_TMR_DONE at 0.
+//   TMR_SET_COLOR: p[0..2] R, G, B
+//   TMR_SET_VALUE: p[0..3] seconds (u32, little-endian); TMR_START/TMR_PAUSE
+//   TMR_ADD_TIME : p[0..3] ms to add (int32, little-endian, negative removes)
+//   TMR_SYNC     : p[0..3] server's remaining ms (u32)  p[4] flags (TMR_SYNC_RUNNING)
+//                  Broadcast every few seconds to keep all timers together
+//                  (keep 0x45 unused by other device types);
+//                  errors up to 2 s are slewed in (clock runs up to 10% off)
+//                  instead of jumping, larger ones are applied at once.
+#define NUM_ALL_DIGITS 0xFF
+#define NUM_FLAG_DOT 0x01
+#define NUM_FLAG_LEADING_ZEROS 0x01
+#define TMR_SYNC_RUNNING 0x01
+
+// ---------- Puzzle scripts ----------
+// The Puzzle device runs an ASSET_PUZZLE script (tools/puzzle_asm.py, upload
+// with CORE_ASSET) on the PuzzleVM: keypad, button, timer and PUZZLE_INPUT
+// events run its handlers, which drive the matrix LEDs, synth, songs and
+// motors and report with events (EV_PUZZLE_SOLVED, EV_PUZZLE_FAILED, ...).
+//   PUZZLE_RESET: clear the script's variables and timers, run its start handler
+//   PUZZLE_LOAD : p[0..1] asset ID (u16)  p[2] flags (PUZZLE_LOAD_BOOT = also
+//                 load it at every boot); answered with EV_DEVICE_ERROR
+//                 (DEVICE_ERROR_SCRIPT) if the asset is missing or rejected
+//   PUZZLE_INPUT: p[0] value for the command handler's ARG  p[1..19] bytes
+//                 its PARAM reads (0..18)
+#define PUZZLE_LOAD_BOOT 0x01
+
 // ---------- Helpers ----------
 
 // device -> server (events, HELLO, ACK, etc.)
@@ -150,4 +296,30 @@ static inline void room_frame_init_server(RoomFrame *f, u8 deviceAddr, u8 cmd_sr
     f->reserved = 0;
 }
 
+// little-endian payload packing
+static inline void room_put_u16(u8 *p, u16 v)
+{
+    p[0] = (u8)(v & 0xFF);
+    p[1] = (u8)(v >> 8);
+}
+
+static inline void room_put_u32(u8 *p, u32 v)
+{
+    p[0] = (u8)(v & 0xFF);
+    p[1] = (u8)((v >> 8) & 0xFF);
+    p[2] = (u8)((v >> 16) & 0xFF);
+    p[3] = (u8)(v >> 24);
+}
+
+// little-endian payload unpacking
+static inline u16 room_get_u16(const u8 *p)
+{
+    return (u16)(p[0] | (p[1] << 8));
+}
+
+static inline u32 room_get_u32(const u8 *p)
+{
+    return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24);
+}
+
 #endif // ROOM_BUS_H
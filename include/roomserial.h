@@ -76,10 +76,15 @@ extern "C"
                 uint8_t idx;                         // index into frameBytes
                 uint8_t frameBytes[ROOM_FRAME_SIZE]; // raw payload bytes
                 uint16_t rxCrc;                      // CRC received from wire
+
+                // Link statistics (free-running, wrap at 16 bits)
+                uint16_t crcErrors;    // frames rejected by CRC check
+                uint16_t droppedBytes; // bytes discarded (noise, bad framing, bad CRC)
+                uint16_t frameCount;   // frames accepted
         } RoomBusParser;
 
         /**
-         * Initialize a parser context.
+         * Initialize a parser context (also clears link statistics).
          */
         void parserInit(RoomBusParser *parser);
 
@@ -141,6 +146,20 @@ public:
          */
         HardwareSerial &getSerial() { return serial; }
 
+        /**
+         * Register a callback for received data (runs on the UART event task,
+         * not in an ISR). Used to wake the bus RX task instead of polling.
+         * @param callback Function to call when bytes arrive
+         */
+        void setReceiveCallback(void (*callback)());
+
+        /**
+         * Link statistics from the frame parser (free-running 16-bit counters)
+         */
+        uint16_t getCrcErrors() const { return parser.crcErrors; }
+        uint16_t getDroppedBytes() const { return parser.droppedBytes; }
+        uint16_t getFrameCount() const { return parser.frameCount; }
+
 private:
         HardwareSerial serial;
         RoomBusParser parser;
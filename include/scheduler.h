@@ -0,0 +1,97 @@
+/************************* scheduler.h **************************
+ * Deadline-driven cooperative scheduler
+ * Runs periodic and event-driven tasks from the main loop task
+ * Created by MSK, November 2025
+ * Sleeps on a FreeRTOS task notification between deadlines
+ ***************************************************************/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "msk.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace SchedulerConfig
+{
+        constexpr u8 MAX_TASKS = 8;       // Task slots (one notification bit each)
+        constexpr u32 MAX_SLEEP_MS = 100; // Upper bound on one sleep (keeps watchdog fed)
+}
+
+// Task body; ctx is the pointer given at registration
+typedef void (*TaskFn)(void *ctx);
+
+// One scheduler slot
+struct SchedTask
+{
+        const char *name; // For diagnostics
+        TaskFn fn;        // nullptr = slot unused
+        void *ctx;        // Passed to fn
+        u32 periodMs;     // 0 = event-driven only
+        u32 nextDue;      // millis() deadline of next periodic run
+};
+
+/**
+ * Cooperative scheduler
+ * All tasks run on the owner (Arduino loop) task, one after another.
+ * Periodic tasks run when their deadline passes; any task also runs as soon
+ * as it is triggered (from task or ISR context) via a notification bit.
+ */
+class Scheduler
+{
+public:
+        Scheduler();
+
+        /**
+         * Bind the scheduler to the calling FreeRTOS task (the one that will
+         * call runDue()/waitForWork()). Call once before triggering.
+         */
+        void begin();
+
+        /**
+         * Register a task in a fixed slot
+         * @param id Slot (0 to MAX_TASKS-1); doubles as notification bit
+         * @param name Diagnostic name
+         * @param fn Task body
+         * @param ctx Context pointer passed to fn
+         * @param periodMs Run period in ms, or 0 for event-driven only
+         * @return true if registered
+         */
+        bool setTask(u8 id, const char *name, TaskFn fn, void *ctx, u32 periodMs);
+
+        /**
+         * Change a task's period (takes effect from now)
+         * @param id Slot
+         * @param periodMs New period in ms, or 0 for event-driven only
+         */
+        void setPeriod(u8 id, u32 periodMs);
+
+        /**
+         * Request a task to run as soon as possible (task context)
+         */
+        void trigger(u8 id);
+
+        /**
+         * Request a task to run as soon as possible (ISR context)
+         */
+        void triggerFromISR(u8 id);
+
+        /**
+         * Run every task that is due or triggered
+         */
+        void runDue();
+
+        /**
+         * Block until the earliest periodic deadline or a trigger arrives
+         * (bounded by MAX_SLEEP_MS)
+         */
+        void waitForWork();
+
+private:
+        SchedTask m_tasks[SchedulerConfig::MAX_TASKS];
+        TaskHandle_t m_owner; // Task that sleeps on notifications
+        u32 m_pending;        // Trigger bits collected by waitForWork()
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,148 @@
+/************************* shader.h *****************************
+ * Procedural LED shader VM
+ * Per-pixel stack programs f(index, x, y, t) -> RGB
+ * Created by MSK, November 2025
+ * Fixed point Q8.8 throughout; no floats in the pixel loop
+ ***************************************************************/
+
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <stdint.h>
+#include "msk.h"
+
+namespace ShaderConfig
+{
+        constexpr u8 STACK_DEPTH = 16;  // Deepest stack a program may use
+        constexpr u16 MAX_CODE = 256;   // Bytecode bytes per program
+        constexpr u8 MAX_PALETTE = 16;  // Palette entries per program
+        constexpr int32_t ONE = 256;    // 1.0 in Q8.8
+        constexpr bool THREADED = true; // Computed-goto dispatch (false = switch)
+}
+
+/**
+ * Opcodes. Values are Q8.8 fixed point in 32-bit words (1.0 = 256).
+ * Angles and hues are in turns (1.0 = full circle, wraps). Colors are
+ * packed 0x00RRGGBB words on the same stack. The program's result is the
+ * value on top of the stack at END.
+ *
+ * Stack effect notation: (inputs -- outputs), rightmost = top.
+ */
+enum ShaderOp : u8
+{
+        SH_END = 0,  // ( c -- )        finish, top = pixel color
+        SH_PUSH8,    // ( -- n )        next byte as signed integer (n << 8)
+        SH_PUSH16,   // ( -- v )        next 2 bytes as Q8.8 (little-endian, signed)
+        SH_PUSHC,    // ( -- c )        next 3 bytes as color (R, G, B)
+
+        // Inputs
+        SH_INDEX,    // ( -- i )        logical pixel index
+        SH_X,        // ( -- x )        column (index % width)
+        SH_Y,        // ( -- y )        row (index / width)
+        SH_TIME,     // ( -- t )        seconds since start
+        SH_COUNT,    // ( -- n )        pixel count
+
+        // Stack
+        SH_DUP,      // ( a -- a a )
+        SH_DROP,     // ( a -- )
+        SH_SWAP,     // ( a b -- b a )
+        SH_OVER,     // ( a b -- a b a )
+
+        // Arithmetic
+        SH_ADD,      // ( a b -- a+b )
+        SH_SUB,      // ( a b -- a-b )
+        SH_MUL,      // ( a b -- a*b )
+        SH_DIV,      // ( a b -- a/b )  0 when b = 0
+        SH_MOD,      // ( a b -- a mod b ) floored, 0 when b <= 0
+        SH_NEG,      // ( a -- -a )
+        SH_ABS,      // ( a -- |a| )
+        SH_MIN,      // ( a b -- min )
+        SH_MAX,      // ( a b -- max )
+        SH_FRACT,    // ( a -- a - floor(a) )
+        SH_FLOOR,    // ( a -- floor(a) )
+        SH_CLAMP,    // ( a -- a clamped to 0..1 )
+        SH_LT,       // ( a b -- a<b ? 1 : 0 )
+        SH_SEL,      // ( c a b -- c>0 ? a : b )
+
+        // Built-ins
+        SH_SIN,      // ( turns -- -1..1 )    256-entry LUT
+        SH_TRI,      // ( turns -- 0..1..0 )  triangle wave
+        SH_NOISE,    // ( x -- 0..1 )         smooth 1D value noise (lattice = 1.0)
+        SH_NOISE2,   // ( x y -- 0..1 )       smooth 2D value noise
+        SH_HSV,      // ( h s v -- c )        hue in turns, s/v 0..1
+        SH_RGB,      // ( r g b -- c )        channels 0..1
+        SH_PAL,      // ( p -- c )            palette at p turns, interpolated
+        SH_MIXC,     // ( c1 c2 t -- c )      blend colors, t 0..1
+        SH_SCALEC,   // ( c v -- c*v )        dim a color, v 0..1
+
+        SH_OP_COUNT
+};
+
+// A shader program: bytecode plus optional palette (flash or RAM)
+struct ShaderProgram
+{
+        const u8 *code;
+        u16 codeSize;
+        const u32 *palette; // 0x00RRGGBB, nullptr if paletteSize = 0
+        u8 paletteSize;
+        u16 width; // Pixels per row for X/Y (0 = one row)
+};
+
+// Q8.8 helpers for building programs in C++
+constexpr int16_t shaderFixed(float v) { return (int16_t)(v * ShaderConfig::ONE); }
+
+/**
+ * Shader
+ * load() checks a program once (opcodes, operands, stack depth, ends in
+ * END), so eval() runs without any bounds or underflow checks.
+ */
+class Shader
+{
+public:
+        Shader();
+
+        /**
+         * Validate and select a program (the program memory must stay valid)
+         * @return true if the program is well-formed
+         */
+        bool load(const ShaderProgram &program);
+
+        void unload() { m_loaded = false; }
+        bool isLoaded() const { return m_loaded; }
+
+        /**
+         * Set the frame inputs shared by all pixels
+         * @param timeMs Time since start (ms)
+         * @param count Pixel count
+         */
+        void beginFrame(u32 timeMs, u16 count);
+
+        /**
+         * Evaluate the program for one pixel
+         * @return 0x00RRGGBB
+         */
+        u32 eval(u16 index) const;
+
+        /**
+         * Time sample programs with both dispatch modes and print
+         * pixels/second and LEDs per 50 Hz frame (probe builds)
+         */
+        static void benchmark(u16 count = 1000);
+
+        /**
+         * Check a program without loading it
+         * @param maxDepth Receives the deepest stack use
+         */
+        static bool validate(const ShaderProgram &program, u8 *maxDepth = nullptr);
+
+private:
+        ShaderProgram m_program;
+        bool m_loaded;
+        int32_t m_time;  // Q8.8 seconds
+        int32_t m_count; // Q8.8
+
+        template <bool Threaded>
+        u32 run(u16 index) const;
+};
+
+#endif // SHADER_H
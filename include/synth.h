@@ -197,6 +197,9 @@ public:
 
         // Called by timer ISR
         void updateSample();
+
+        // Sample ISR CPU load over the last ~1 s window (per mille)
+        u16 getIsrLoad() const;
         // Optionally allow custom pin/channel for secondary output in future
         void setSecondaryOutput(u8 pin, u8 channel);
 };
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "msk.h"
+#include "animation.h"
+
+// Generated by tools/anim_encode.py - do not edit
+// 20 frames x 16 LEDs, 5 colors, 151 bytes (raw u32: 1280 bytes)
+
+static const u32 kTestAnimDataPackedPalette[] = {
+    0xFF0000, 0x880088, 0x550000, 0x110008, 0x080008,
+};
+
+static const u8 kTestAnimDataPackedData[] = {
+    0x80, 0x00, 0x0E, 0x01, 0x81, 0x02, 0x00, 0xCD, 0x82, 0x03, 0x02, 0x00, 0xCC, 0x83, 0x04, 0x03,
+    0x02, 0x00, 0xCB, 0x84, 0x01, 0x04, 0x03, 0x02, 0x00, 0xCA, 0xC0, 0x84, 0x01, 0x04, 0x03, 0x02,
+    0x00, 0xC9, 0xC1, 0x84, 0x01, 0x04, 0x03, 0x02, 0x00, 0xC8, 0xC2, 0x84, 0x01, 0x04, 0x03, 0x02,
+    0x00, 0xC7, 0xC3, 0x84, 0x01, 0x04, 0x03, 0x02, 0x00, 0xC6, 0xC4, 0x84, 0x01, 0x04, 0x03, 0x02,
+    0x00, 0xC5, 0xC5, 0x84, 0x01, 0x04, 0x03, 0x02, 0x00, 0xC4, 0xC6, 0x84, 0x01, 0x04, 0x03, 0x02,
+    0x00, 0xC3, 0xC7, 0x84, 0x01, 0x04, 0x03, 0x02, 0x00, 0xC2, 0xC8, 0x84, 0x01, 0x04, 0x03, 0x02,
+    0x00, 0xC1, 0xC9, 0x85, 0x01, 0x04, 0x03, 0x02, 0x00, 0x01, 0xCA, 0x84, 0x01, 0x04, 0x03, 0x02,
+    0x00, 0xCB, 0x83, 0x01, 0x04, 0x03, 0x02, 0xCC, 0x82, 0x01, 0x04, 0x03, 0xCD, 0x81, 0x01, 0x04,
+    0xCE, 0x80, 0x01,
+};
+
+const PackedAnimation kTestAnimDataPacked = {kTestAnimDataPackedPalette, kTestAnimDataPackedData, sizeof(kTestAnimDataPackedData), 20, 16, 5, 15};
+
+// Generated by tools/anim_encode.py - do not edit
+// 11 frames x 16 LEDs, 11 colors, 66 bytes (raw u32: 704 bytes)
+
+static const u32 kColorTestAnimDataPackedPalette[] = {
+    0xE00000, 0xFF4000, 0xE0FF00, 0x00FF00, 0x00FFFF, 0x0000FF, 0x5000FF, 0xE000FF,
+    0xFF5050, 0xE0FFFF, 0x000000,
+};
+
+static const u8 kColorTestAnimDataPackedData[] = {
+    0x0F, 0x00, 0x0F, 0x01, 0x0F, 0x02, 0x0F, 0x03, 0x0F, 0x04, 0x0F, 0x05, 0x0F, 0x06, 0x0F, 0x07,
+    0x0F, 0x08, 0x0F, 0x09, 0x0F, 0x0A,
+};
+
+const PackedAnimation kColorTestAnimDataPacked = {kColorTestAnimDataPackedPalette, kColorTestAnimDataPackedData, sizeof(kColorTestAnimDataPackedData), 11, 16, 11, 2};
+
@@ -36,24 +36,26 @@ export interface RoomFrame {
 }
 
 // ---------- Device Types ----------
-// Should match DeviceType enum in deviceconfig.h
+// Generated from DeviceType in deviceconfig.h by tools/device_types.py - do not edit
 export enum DeviceType {
-    Terminal = 0,
-    GlowButton = 1,
-    NumBox = 2,
-    Timer = 3,
-    GlowDots = 4,
-    QB = 5,
-    RGBMixer = 6,
-    Purger = 7,
-    FinalOrder = 8,
-    BallGate = 9,
-    Actuator = 10,
-    TheWall = 11,
-    Scores = 12,
-    BallBase = 13,
-    // ... others
+    Terminal = 0, // TERMINAL
+    GlowButton = 1, // GLOW_BUTTON
+    NumBox = 2, // NUM_BOX
+    Timer = 3, // TIMER
+    GlowDots = 4, // GLOW_DOTS
+    QB = 5, // QB
+    RGBMixer = 6, // RGB_MIXER
+    Prototype = 7, // PROTO
+    FinalOrder = 8, // FINAL_ORDER
+    BallGate = 9, // BALL_GATE
+    Actuator = 10, // ACTUATOR
+    TheWall = 11, // THE_WALL
+    Scores = 12, // SCORES
+    BallBase = 13, // BALL_BASE
+    Purger = 14, // PURGER
+    Puzzle = 15, // PUZZLE
 }
+// End of generated DeviceType
 
 // ---------- Server Commands (0x01-0x7F) ----------
 export enum RoomServerCommand {
@@ -62,6 +64,11 @@ export enum RoomServerCommand {
     CORE_ACK = 0x02,
     CORE_PING = 0x03,
     CORE_RESET = 0x04,
+    CORE_SET_ADDRESS = 0x05,
+    CORE_STATS = 0x06,
+    CORE_PROBE = 0x07, // only answered by firmware built with ENABLE_PROBES
+    CORE_ASSET = 0x08, // asset store upload/delete/info/play
+    CORE_FADE = 0x09, // fade LEDs to a color on the device
 
     // Device Specific (0x40+)
     // Glow Button
@@ -83,6 +90,8 @@ export enum RoomServerCommand {
     TMR_SET_VALUE = 0x41,
     TMR_START = 0x42,
     TMR_PAUSE = 0x43,
+    TMR_ADD_TIME = 0x44,
+    TMR_SYNC = 0x45,
 
     // QB
     QB_SET_COLORS = 0x40,
@@ -116,6 +125,8 @@ export enum RoomServerCommand {
 
     // Puzzle
     PUZZLE_RESET = 0x40,
+    PUZZLE_LOAD = 0x41,
+    PUZZLE_INPUT = 0x42,
 }
 
 // ---------- Device Events (0x80-0xFF) ----------
@@ -206,8 +217,318 @@ export function isCoreOp(cmd: number): boolean {
 // Example helper: build a Timer SET_VALUE frame
 export function makeTimerSetValue(deviceAddr: number, seconds: number): RoomFrame {
     // TMR_SET_VALUE = 0x41
-    // param[0..3] = seconds (little endian or big endian? C code usually does manual shift)
-    // Let's assume Little Endian for ESP32
+    // param[0..3] = seconds, little-endian (shown as mm.ss, see roombus.h)
     const p = [seconds & 0xff, (seconds >> 8) & 0xff, (seconds >> 16) & 0xff, (seconds >> 24) & 0xff];
     return createServerFrame(deviceAddr, RoomServerCommand.TMR_SET_VALUE, p);
 }
+
+// ---------- CORE_STATS ----------
+// Should match the CORE_STATS layout documented in roombus.h
+export const STATS_PAGE_RUNTIME = 0x00;
+export const STATS_PAGE_SYSTEM = 0x01;
+export const STATS_PAGE_COMMANDS = 0x02;
+export const STATS_FLAG_RESET = 0x01;
+
+export interface CoreStatsRuntime {
+    addr: number;
+    loopMinUs: number;
+    loopAvgUs: number;
+    loopMaxUs: number;
+    audioLoadPermille: number;
+    i2cErrors: number; // free-running, wraps at 16 bits
+    crcErrors: number; // free-running, wraps at 16 bits
+    droppedBytes: number; // free-running, wraps at 16 bits
+    loopCount: number;
+}
+
+export interface CoreStatsSystem {
+    addr: number;
+    freeHeap: number;
+    minFreeHeap: number;
+    uptimeSec: number;
+    resetReason: number; // esp_reset_reason_t
+    rxFrames: number; // free-running, wraps at 16 bits
+}
+
+export interface CoreStatsCommand {
+    addr: number;
+    command: number;
+    calls: number;
+    avgUs: number;
+    maxUs: number;
+    unsupported: number; // all commands rejected by the device
+    handled: boolean; // device has a handler for `command`
+}
+
+// `command` selects the handler on STATS_PAGE_COMMANDS
+export function makeStatsRequest(deviceAddr: number, page: number, resetWindow = false, command = 0): RoomFrame {
+    return createServerFrame(deviceAddr, RoomServerCommand.CORE_STATS, [
+        page,
+        resetWindow ? STATS_FLAG_RESET : 0,
+        command,
+    ]);
+}
+
+function u16le(p: Uint8Array, i: number): number {
+    return p[i] | (p[i + 1] << 8);
+}
+
+function u32le(p: Uint8Array, i: number): number {
+    return (p[i] | (p[i + 1] << 8) | (p[i + 2] << 16) | (p[i + 3] << 24)) >>> 0;
+}
+
+// Decode a CORE_STATS reply (returns null for other frames/pages)
+export function decodeCoreStats(frame: RoomFrame): CoreStatsRuntime | CoreStatsSystem | CoreStatsCommand | null {
+    if (frame.cmd_dev !== RoomServerCommand.CORE_STATS) return null;
+    const p = frame.p;
+    if (p[1] === STATS_PAGE_RUNTIME) {
+        return {
+            addr: p[0],
+            loopMinUs: u16le(p, 2),
+            loopAvgUs: u16le(p, 4),
+            loopMaxUs: u16le(p, 6),
+            audioLoadPermille: u16le(p, 8),
+            i2cErrors: u16le(p, 10),
+            crcErrors: u16le(p, 12),
+            droppedBytes: u16le(p, 14),
+            loopCount: u32le(p, 16),
+        };
+    }
+    if (p[1] === STATS_PAGE_SYSTEM) {
+        return {
+            addr: p[0],
+            freeHeap: u32le(p, 2),
+            minFreeHeap: u32le(p, 6),
+            uptimeSec: u32le(p, 10),
+            resetReason: p[14],
+            rxFrames: u16le(p, 15),
+        };
+    }
+    if (p[1] === STATS_PAGE_COMMANDS) {
+        return {
+            addr: p[0],
+            command: p[2],
+            calls: u32le(p, 3),
+            avgUs: u32le(p, 7),
+            maxUs: u32le(p, 11),
+            unsupported: u32le(p, 15),
+            handled: p[19] !== 0,
+        };
+    }
+    return null;
+}
+
+// ---------- EV_DEVICE_ERROR ----------
+// Should match the EV_DEVICE_ERROR layout documented in roombus.h
+export const DEVICE_ERROR_UNSUPPORTED = 0x01;
+export const DEVICE_ERROR_SCRIPT = 0x02;
+
+export interface DeviceError {
+    addr: number;
+    error: number;
+    detail: number; // DEVICE_ERROR_UNSUPPORTED: the rejected command; DEVICE_ERROR_SCRIPT: 0 = load failed, else PuzzleFault
+}
+
+export function decodeDeviceError(frame: RoomFrame): DeviceError | null {
+    if (frame.cmd_dev !== RoomDeviceEvent.EV_DEVICE_ERROR) return null;
+    return { addr: frame.p[0], error: frame.p[1], detail: frame.p[2] };
+}
+
+// ---------- CORE_ASSET ----------
+// Should match the CORE_ASSET layout documented in roombus.h
+export const ASSET_OP_BEGIN = 0x00;
+export const ASSET_OP_DATA = 0x01;
+export const ASSET_OP_COMMIT = 0x02;
+export const ASSET_OP_ABORT = 0x03;
+export const ASSET_OP_DELETE = 0x04;
+export const ASSET_OP_INFO = 0x05;
+export const ASSET_OP_PLAY = 0x06;
+export const ASSET_PLAY_LOOP = 0x01;
+export const ASSET_DATA_MAX = 14;
+export const ASSET_STATUS_OK = 0x00;
+export const ASSET_STATUS_ERROR = 0x01;
+export const ASSET_STATUS_NOT_FOUND = 0x02;
+
+// Should match AssetType in assetstore.h
+export enum AssetType {
+    PackedAnimation = 1,
+    Song = 2,
+    Shader = 3,
+    Puzzle = 4,
+}
+
+export interface CoreAssetReply {
+    addr: number;
+    op: number;
+    status: number;
+    id: number;
+    nextOffset: number; // next upload byte the device expects (resend from here)
+    freeBytes: number;
+    type?: number; // INFO only
+    size?: number; // INFO only
+    assetCount?: number; // INFO only
+}
+
+// CRC-32 as used by the firmware (same as zlib.crc32)
+export function crc32(data: Uint8Array): number {
+    let crc = 0xffffffff;
+    for (let i = 0; i < data.length; i++) {
+        crc ^= data[i];
+        for (let k = 0; k < 8; k++) crc = (crc >>> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+    return (crc ^ 0xffffffff) >>> 0;
+}
+
+function putU16(p: number[], v: number) {
+    p.push(v & 0xff, (v >> 8) & 0xff);
+}
+
+function putU32(p: number[], v: number) {
+    p.push(v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, (v >>> 24) & 0xff);
+}
+
+// Payload data frames starting at `fromOffset` (use a reply's nextOffset to resume)
+export function makeAssetData(deviceAddr: number, payload: Uint8Array, fromOffset = 0): RoomFrame[] {
+    const frames: RoomFrame[] = [];
+    for (let off = fromOffset; off < payload.length; off += ASSET_DATA_MAX) {
+        const chunk = payload.subarray(off, Math.min(off + ASSET_DATA_MAX, payload.length));
+        const p = [ASSET_OP_DATA];
+        putU32(p, off);
+        p.push(chunk.length, ...chunk);
+        frames.push(createServerFrame(deviceAddr, RoomServerCommand.CORE_ASSET, p));
+    }
+    return frames;
+}
+
+// Full upload: BEGIN, DATA..., COMMIT. Wait for the BEGIN reply before sending
+// data; the COMMIT reply tells whether the asset was stored.
+export function makeAssetUpload(deviceAddr: number, id: number, type: AssetType, payload: Uint8Array): RoomFrame[] {
+    const begin = [ASSET_OP_BEGIN];
+    putU16(begin, id);
+    begin.push(type);
+    putU32(begin, payload.length);
+    putU32(begin, crc32(payload));
+    return [
+        createServerFrame(deviceAddr, RoomServerCommand.CORE_ASSET, begin),
+        ...makeAssetData(deviceAddr, payload),
+        createServerFrame(deviceAddr, RoomServerCommand.CORE_ASSET, [ASSET_OP_COMMIT]),
+    ];
+}
+
+export function makeAssetRequest(deviceAddr: number, op: number, id = 0): RoomFrame {
+    return createServerFrame(deviceAddr, RoomServerCommand.CORE_ASSET, [op, id & 0xff, (id >> 8) & 0xff]);
+}
+
+// Start a stored packed animation or shader on the device LEDs
+export function makeAssetPlay(deviceAddr: number, id: number, loop = true): RoomFrame {
+    return createServerFrame(deviceAddr, RoomServerCommand.CORE_ASSET, [
+        ASSET_OP_PLAY, id & 0xff, (id >> 8) & 0xff, loop ? ASSET_PLAY_LOOP : 0,
+    ]);
+}
+
+// Decode a CORE_ASSET reply (returns null for other frames)
+export function decodeCoreAsset(frame: RoomFrame): CoreAssetReply | null {
+    if (frame.cmd_dev !== RoomServerCommand.CORE_ASSET) return null;
+    const p = frame.p;
+    const reply: CoreAssetReply = {
+        addr: p[0],
+        op: p[1],
+        status: p[2],
+        id: u16le(p, 3),
+        nextOffset: u32le(p, 5),
+        freeBytes: u32le(p, 9),
+    };
+    if (p[1] === ASSET_OP_INFO) {
+        reply.type = p[13];
+        reply.size = u32le(p, 14);
+        reply.assetCount = u16le(p, 18);
+    }
+    return reply;
+}
+
+// ---------- CORE_FADE ----------
+// Should match the CORE_FADE layout documented in roombus.h
+export enum FadeEasing {
+    Linear = 0x00,
+    EaseIn = 0x01,
+    EaseOut = 0x02,
+    EaseInOut = 0x03,
+}
+
+// One frame fades the LEDs [first, first + count) to a color (count 0 = to the end)
+export function makeFade(
+    deviceAddr: number,
+    rgb: number,
+    durationMs: number,
+    easing = FadeEasing.EaseInOut,
+    first = 0,
+    count = 0,
+): RoomFrame {
+    const p = [(rgb >> 16) & 0xff, (rgb >> 8) & 0xff, rgb & 0xff];
+    putU16(p, durationMs);
+    p.push(easing);
+    putU16(p, first);
+    putU16(p, count);
+    return createServerFrame(deviceAddr, RoomServerCommand.CORE_FADE, p);
+}
+
+// ---------- Num Box digits ----------
+// Should match the Num Box layout documented in roombus.h
+export const NUM_ALL_DIGITS = 0xff;
+export const NUM_FLAG_DOT = 0x01;
+export const NUM_FLAG_LEADING_ZEROS = 0x01;
+
+export function makeNumDigitColor(deviceAddr: number, digit: number, rgb: number): RoomFrame {
+    const p = [digit & 0xff, (rgb >> 16) & 0xff, (rgb >> 8) & 0xff, rgb & 0xff];
+    return createServerFrame(deviceAddr, RoomServerCommand.NUM_SET_DIGIT_COLOR, p);
+}
+
+export function makeNumDigitValue(deviceAddr: number, digit: number, char: string, dot = false): RoomFrame {
+    const p = [digit & 0xff, char.charCodeAt(0) & 0xff, dot ? NUM_FLAG_DOT : 0];
+    return createServerFrame(deviceAddr, RoomServerCommand.NUM_SET_DIGIT_VAL, p);
+}
+
+// Right-aligned in the row's 6 digits (int32)
+export function makeNumRowNumber(deviceAddr: number, row: number, value: number, leadingZeros = false): RoomFrame {
+    const p = [row & 0xff];
+    putU32(p, value >>> 0);
+    p.push(leadingZeros ? NUM_FLAG_LEADING_ZEROS : 0);
+    return createServerFrame(deviceAddr, RoomServerCommand.NUM_SET_ROW_NUM, p);
+}
+
+// ---------- Timer countdown ----------
+// Should match the Timer layout documented in roombus.h
+export const TMR_SYNC_RUNNING = 0x01;
+
+export function makeTimerAddTime(deviceAddr: number, deltaMs: number): RoomFrame {
+    const p: number[] = [];
+    putU32(p, deltaMs >>> 0);
+    return createServerFrame(deviceAddr, RoomServerCommand.TMR_ADD_TIME, p);
+}
+
+// Send to ADDR_BROADCAST every few seconds instead of per-second TMR_SET_VALUE
+export function makeTimerSync(deviceAddr: number, remainingMs: number, running: boolean): RoomFrame {
+    const p: number[] = [];
+    putU32(p, remainingMs);
+    p.push(running ? TMR_SYNC_RUNNING : 0);
+    return createServerFrame(deviceAddr, RoomServerCommand.TMR_SYNC, p);
+}
+
+// ---------- Puzzle scripts ----------
+// Should match the Puzzle layout documented in roombus.h
+export const PUZZLE_LOAD_BOOT = 0x01;
+
+// Upload the asset (tools/puzzle_asm.py --asset) with makeAssetUpload() first
+export function makePuzzleLoad(deviceAddr: number, assetId: number, boot = false): RoomFrame {
+    const p: number[] = [];
+    putU16(p, assetId);
+    p.push(boot ? PUZZLE_LOAD_BOOT : 0);
+    return createServerFrame(deviceAddr, RoomServerCommand.PUZZLE_LOAD, p);
+}
+
+// Runs the script's command handler: arg is its ARG, params (up to 19 bytes) its PARAM 0..18
+export function makePuzzleInput(deviceAddr: number, arg: number, params: ArrayLike<number> = []): RoomFrame {
+    const p = [arg & 0xff];
+    for (let i = 0; i < Math.min(19, params.length); i++) p.push(params[i] & 0xff);
+    return createServerFrame(deviceAddr, RoomServerCommand.PUZZLE_INPUT, p);
+}
@@ -6,16 +6,15 @@
  ***************************************************************/
 
 #include "animation.h"
+#include "compositor.h"
 #include "colors.h"
+#include "probe.h"
 
 //============================================================================
 // CONFIGURATION
 //============================================================================
 
-// Animation timing constants
-constexpr u8 ANIM_REFRESH_MS = 40; // 40 ms = 25 Hz pixel buffer update
-constexpr u16 ANIM_STEP_MS = 50;   // 50 ms per step = 20 Hz animation movement
-constexpr u8 FRAME_DIVISOR = ANIM_STEP_MS / ANIM_REFRESH_MS;
+constexpr u16 NO_FRAME = 0xFFFF; // m_position before the first frame is shown
 
 //============================================================================
 // CONSTRUCTOR
@@ -28,12 +27,28 @@ Animation::Animation(PixelStrip *pixelStrip)
     : m_pixels(pixelStrip),
       m_active(false),
       m_type(ANIM_NONE),
-      m_position(0),
-      m_frameCounter(0),
-      m_stepDelay(FRAME_DIVISOR),
+      m_startTime(0),
+      m_refreshMs(AnimConfig::REFRESH_MS),
+      m_position(NO_FRAME),
+      m_shownFrac(0),
       m_currentBitmap(nullptr),
+      m_currentPacked(nullptr),
+      m_streamPos(0),
+      m_decodedFrame(NO_FRAME),
       m_bitmapLoop(false),
-      m_lastFrameTime(0)
+      m_bitmapHeld(false),
+      m_crossfade(false),
+      m_keyA(nullptr),
+      m_keyB(nullptr),
+      m_asset(),
+      m_assetPalette(nullptr),
+      m_assetStreamStart(0),
+      m_shader(),
+      m_shaderCode(nullptr),
+      m_shaderPalette(nullptr),
+      m_wake(nullptr),
+      m_compositor(nullptr),
+      m_layer(0)
 {
 }
 
@@ -48,9 +63,8 @@ void Animation::init()
 {
         m_active = false;
         m_type = ANIM_NONE;
-        m_position = 0;
-        m_frameCounter = 0;
-        m_currentBitmap = nullptr;
+        m_position = NO_FRAME;
+        releaseBitmap();
 }
 
 /************************* start ******************************************
@@ -59,10 +73,13 @@ void Animation::init()
  ***************************************************************/
 void Animation::start(AnimationType type)
 {
+        releaseBitmap();
         m_type = type;
         m_active = true;
-        m_position = 0;
-        m_frameCounter = 0;
+        m_startTime = millis();
+
+        if (m_wake)
+                m_wake();
 }
 
 /************************* startBitmap ************************************
@@ -72,19 +89,236 @@ void Animation::start(AnimationType type)
  ***************************************************************/
 void Animation::startBitmap(const BitmapAnimation *animData, bool loop)
 {
-        if (!animData || !animData->data)
+        if (!animData || !animData->data || animData->frameCount == 0 || animData->frameRate == 0)
                 return;
 
+        releaseBitmap();
         m_currentBitmap = animData;
         m_bitmapLoop = loop;
+        m_bitmapHeld = false;
         m_type = ANIM_BITMAP;
         m_active = true;
-        m_position = 0; // Current frame index
-        m_lastFrameTime = millis();
+        m_position = NO_FRAME;
+        m_startTime = millis();
+
+        // Force immediate update of first frame (a compositor sends it on wake)
+        updateBitmap(0);
+        if (!m_compositor)
+                m_pixels->applyBuffer();
+
+        if (m_wake)
+                m_wake();
+}
+
+/************************* startBitmap (packed) ***************************
+ * Start a packed bitmap animation sequence.
+ * @param animData Pointer to the packed descriptor.
+ * @param loop Whether to loop when finished.
+ ***************************************************************/
+void Animation::startBitmap(const PackedAnimation *animData, bool loop)
+{
+        if (!animData || !animData->data || !animData->palette)
+                return;
+
+        releaseBitmap();
+        startPacked(animData, loop);
+}
+
+/************************* startBitmap (asset) ****************************
+ * Start a packed animation from the AssetStore.
+ * Only the palette is loaded; frames are decoded from a chunk window.
+ * @param assetId ASSET_PACKED_ANIMATION asset ID.
+ * @param loop Whether to loop when finished.
+ * @return false if the asset is missing or malformed.
+ ***************************************************************/
+bool Animation::startBitmap(u16 assetId, bool loop)
+{
+        releaseBitmap();
+
+        PackedAssetHeader header;
+        if (!m_reader.open(assetId, ASSET_PACKED_ANIMATION) ||
+            !m_reader.read(0, &header, sizeof(header)))
+        {
+                Serial.printf("Animation: asset 0x%04x not found\n", assetId);
+                m_reader.close();
+                return false;
+        }
+
+        u32 paletteBytes = (u32)header.paletteSize * sizeof(u32);
+        u32 streamStart = sizeof(header) + paletteBytes;
+        if (header.paletteSize == 0 || header.paletteSize > 256 || header.frameCount == 0 ||
+            header.frameRate == 0 || streamStart >= m_reader.size())
+        {
+                Serial.printf("Animation: asset 0x%04x malformed\n", assetId);
+                m_reader.close();
+                return false;
+        }
+
+        m_assetPalette = new u32[header.paletteSize];
+        if (!m_reader.read(sizeof(header), m_assetPalette, paletteBytes))
+        {
+                releaseBitmap();
+                return false;
+        }
+
+        m_asset.palette = m_assetPalette;
+        m_asset.data = nullptr; // Streamed through m_reader
+        m_asset.dataSize = m_reader.size() - streamStart;
+        m_asset.frameCount = header.frameCount;
+        m_asset.ledCount = header.ledCount;
+        m_asset.paletteSize = header.paletteSize;
+        m_asset.frameRate = header.frameRate;
+        m_assetStreamStart = streamStart;
+
+        startPacked(&m_asset, loop);
+        return true;
+}
+
+/************************* startPacked ************************************
+ * Common start for flash and asset packed animations.
+ * Decodes frame 0 (and frame 1 into keyframe B when cross-fading).
+ ***************************************************************/
+void Animation::startPacked(const PackedAnimation *animData, bool loop)
+{
+        if (animData->frameCount == 0 || animData->frameRate == 0)
+                return;
+
+        m_currentPacked = animData;
+        m_streamPos = 0;
+        m_decodedFrame = NO_FRAME;
+        m_bitmapLoop = loop;
+        m_bitmapHeld = false;
+        m_type = ANIM_BITMAP;
+        m_active = true;
+        m_position = 0;
+        m_shownFrac = 0;
+        m_startTime = millis();
+
+        if (m_crossfade && animData->frameCount > 1)
+        {
+                m_keyA = new u32[animData->ledCount]();
+                m_keyB = new u32[animData->ledCount];
+                decodeNextPacked(m_keyA);
+                memcpy(m_keyB, m_keyA, animData->ledCount * sizeof(u32));
+                decodeNextPacked(m_keyB); // Skips in frame 1 keep frame 0's colors
+                showPackedFrame(0, 0);
+        }
+        else
+        {
+                decodeNextPacked(nullptr);
+        }
+
+        // Force immediate update of first frame (a compositor sends it on wake)
+        if (!m_compositor)
+                m_pixels->applyBuffer();
+
+        if (m_wake)
+                m_wake();
+}
+
+/************************* startShader ************************************
+ * Start a shader program from flash or RAM.
+ * @param program Bytecode, palette and row width.
+ * @return false if the program fails validation.
+ ***************************************************************/
+bool Animation::startShader(const ShaderProgram &program)
+{
+        releaseBitmap();
+        return runShader(program);
+}
+
+/************************* startShader (asset) ****************************
+ * Start a shader from the AssetStore. Code and palette are small
+ * (ShaderConfig limits), so both are loaded to RAM once.
+ * @param assetId ASSET_SHADER asset ID.
+ * @return false if the asset is missing, malformed or fails validation.
+ ***************************************************************/
+bool Animation::startShader(u16 assetId)
+{
+        releaseBitmap();
+
+        ShaderAssetHeader header;
+        if (!m_reader.open(assetId, ASSET_SHADER) ||
+            !m_reader.read(0, &header, sizeof(header)))
+        {
+                Serial.printf("Animation: asset 0x%04x not found\n", assetId);
+                m_reader.close();
+                return false;
+        }
+
+        u32 paletteBytes = (u32)header.paletteSize * sizeof(u32);
+        if (header.codeSize == 0 || header.codeSize > ShaderConfig::MAX_CODE ||
+            header.paletteSize > ShaderConfig::MAX_PALETTE ||
+            sizeof(header) + paletteBytes + header.codeSize != m_reader.size())
+        {
+                Serial.printf("Animation: asset 0x%04x malformed\n", assetId);
+                m_reader.close();
+                return false;
+        }
+
+        m_shaderCode = new u8[header.codeSize];
+        m_shaderPalette = header.paletteSize ? new u32[header.paletteSize] : nullptr;
+        bool ok = (!paletteBytes || m_reader.read(sizeof(header), m_shaderPalette, paletteBytes)) &&
+                  m_reader.read(sizeof(header) + paletteBytes, m_shaderCode, header.codeSize);
+        m_reader.close();
+
+        ShaderProgram program = {m_shaderCode, header.codeSize, m_shaderPalette, header.paletteSize, header.width};
+        if (!ok || !runShader(program))
+        {
+                releaseBitmap();
+                return false;
+        }
+        return true;
+}
+
+/************************* runShader **************************************
+ * Validate a program and make it the running animation.
+ ***************************************************************/
+bool Animation::runShader(const ShaderProgram &program)
+{
+        if (!m_shader.load(program))
+        {
+                Serial.println("Animation: shader program rejected");
+                return false;
+        }
+
+        m_type = ANIM_SHADER;
+        m_active = true;
+        m_startTime = millis();
 
-        // Force immediate update of first frame
-        updateBitmap();
-        m_pixels->applyBuffer();
+        if (m_wake)
+                m_wake();
+        return true;
+}
+
+/************************* releaseBitmap **********************************
+ * Drop the current bitmap or shader: close a streamed asset, free its
+ * palette/code and the cross-fade keyframes.
+ ***************************************************************/
+void Animation::releaseBitmap()
+{
+        if (m_type == ANIM_BITMAP || m_type == ANIM_SHADER)
+        {
+                m_active = false;
+                m_type = ANIM_NONE;
+        }
+        m_currentBitmap = nullptr;
+        m_currentPacked = nullptr;
+
+        m_reader.close();
+        delete[] m_assetPalette;
+        m_assetPalette = nullptr;
+
+        delete[] m_keyA;
+        delete[] m_keyB;
+        m_keyA = nullptr;
+        m_keyB = nullptr;
+
+        m_shader.unload();
+        delete[] m_shaderCode;
+        delete[] m_shaderPalette;
+        m_shaderCode = nullptr;
+        m_shaderPalette = nullptr;
 }
 
 /************************* stop *******************************************
@@ -97,56 +331,84 @@ void Animation::stop(bool clearPixels)
         m_type = ANIM_NONE;
         if (clearPixels)
         {
-                m_pixels->clear();
+                if (m_compositor)
+                {
+                        m_compositor->clear(m_layer); // Wakes the frame task to send it
+                }
+                else
+                {
+                        m_pixels->clear();
+                }
         }
 }
 
-/************************* refresh ****************************************
- * Tick animations when the ISR flag is set.
- * @param flag ISR-raised refresh flag (cleared here).
+/************************* setLayer ***************************************
+ * Redirect drawing into a compositor layer (nullptr = the strip).
  ***************************************************************/
-void Animation::refresh(volatile bool &flag)
+void Animation::setLayer(Compositor *compositor, u8 layer)
 {
-        if (flag)
-        {
-                flag = false;
-                update();
-        }
+        m_compositor = compositor;
+        m_layer = layer;
+}
+
+/************************* put ********************************************
+ * Draw one logical pixel into the current target. A pixel that is fading
+ * on the strip is left to the fade (the compositor skips it at render).
+ ***************************************************************/
+void Animation::put(u16 index, u32 color)
+{
+        if (m_compositor)
+                m_compositor->setColor(m_layer, index, color);
+        else if (!m_pixels->isFading(index))
+                m_pixels->setColor(index, color);
 }
 
 /************************* update *****************************************
- * Advance the current animation one frame.
+ * Render the current animation at the time elapsed since it started.
+ * The strip only transmits if the frame actually changed.
+ * @return ms until the next update is needed, 0 = wait for start().
  ***************************************************************/
-void Animation::update()
+u32 Animation::update()
 {
+        PROBE_SCOPE(PROBE_ANIM_UPDATE);
+
         if (!m_active || m_type == ANIM_NONE)
         {
-                return;
+                return 0;
         }
 
+        u32 elapsed = millis() - m_startTime;
+        u32 next = 0;
+
         // Update animation based on type
         switch (m_type)
         {
         case ANIM_RED_DOT_CHASE:
-                updateRedDotChase();
+                next = updateRedDotChase(elapsed);
                 break;
         case ANIM_RAINBOW_CYCLE:
-                updateRainbowCycle();
+                next = updateRainbowCycle(elapsed);
                 break;
         case ANIM_BREATHING:
-                updateBreathing();
+                next = updateBreathing(elapsed);
                 break;
         case ANIM_SPARKLE:
-                updateSparkle();
+                next = updateSparkle(elapsed);
                 break;
         case ANIM_BITMAP:
-                updateBitmap();
+                next = updateBitmap(elapsed);
+                break;
+        case ANIM_SHADER:
+                next = updateShader(elapsed);
                 break;
         default:
                 break;
         }
 
-        m_pixels->applyBuffer();
+        if (!m_compositor)
+                m_pixels->applyBuffer(); // Otherwise the compositor blends and sends
+
+        return next;
 }
 
 //============================================================================
@@ -154,160 +416,363 @@ void Animation::update()
 //============================================================================
 
 /************************* updateBitmap ***********************************
- * Render the current bitmap frame and advance timing.
+ * Show the bitmap frame for this point in time.
+ * The position is kept in 1/256 frames: the integer part picks the
+ * keyframe, the fraction cross-fades towards the next one if enabled.
+ * @return ms until the next frame (or refresh while cross-fading).
  ***************************************************************/
-void Animation::updateBitmap()
+u32 Animation::updateBitmap(u32 elapsed)
 {
-        if (!m_currentBitmap)
-                return;
+        if (!m_currentBitmap && !m_currentPacked)
+                return 0;
+
+        u16 count = bitmapFrameCount();
+        u8 rate = bitmapFrameRate();
+        uint64_t pos = (uint64_t)elapsed * rate * 256 / 1000;
+        u32 frame = (u32)(pos >> 8);
+
+        // Packed animations fade only if started with keyframe buffers
+        bool fade = m_crossfade && count > 1 && (m_currentBitmap || m_keyA);
+        u16 frac = fade ? (u16)(pos & 0xFF) : 0;
+
+        if (!m_bitmapLoop && frame >= (u32)count - 1)
+        {
+                // One-shot finished: hold the last frame
+                frame = count - 1;
+                frac = 0;
+                m_bitmapHeld = true;
+        }
+        else
+        {
+                frame %= count;
+        }
+
+        if (m_currentPacked)
+                showPackedFrame((u16)frame, frac);
+        else
+                showRawFrame((u16)frame, frac);
+
+        if (m_bitmapHeld)
+                return 0;
+
+        if (fade)
+                return m_refreshMs;
+
+        // Sleep until the next whole frame is due
+        u32 nextFrameMs = (u32)((((pos >> 8) + 1) * 1000 + rate - 1) / rate);
+        return nextFrameMs > elapsed ? nextFrameMs - elapsed : 1;
+}
+
+/************************* showRawFrame ***********************************
+ * Draw a raw bitmap frame, optionally mixed with the following one.
+ * @param frame Keyframe index.
+ * @param frac Mix towards frame + 1 (0-255).
+ ***************************************************************/
+void Animation::showRawFrame(u16 frame, u16 frac)
+{
+        if (frame == m_position && frac == m_shownFrac)
+                return; // Nothing new to draw
 
-        // Check timing
-        u32 now = millis();
-        u32 frameDelay = 1000 / m_currentBitmap->frameRate;
+        const BitmapAnimation *anim = m_currentBitmap;
+        u16 leds = anim->ledCount < m_pixels->getCount() ? anim->ledCount : m_pixels->getCount();
+        const u32 *a = anim->data + (u32)frame * anim->ledCount;
 
-        if (now - m_lastFrameTime < frameDelay && m_position > 0)
+        if (frac == 0)
+        {
+                for (u16 i = 0; i < leds; i++)
+                        put(i, a[i]);
+        }
+        else
         {
-                return; // Not time for next frame yet
+                u16 nextFrame = frame + 1 < anim->frameCount ? frame + 1 : 0;
+                const u32 *b = anim->data + (u32)nextFrame * anim->ledCount;
+                for (u16 i = 0; i < leds; i++)
+                        put(i, colorLerp(a[i], b[i], frac));
         }
 
-        // Update frame time
-        m_lastFrameTime = now;
+        m_position = frame;
+        m_shownFrac = frac;
+}
 
-        // Calculate offset in data array
-        // Layout: [Frame0_LED0, Frame0_LED1, ... Frame1_LED0...]
-        u32 offset = (u32)m_position * m_currentBitmap->ledCount;
+/************************* showPackedFrame ********************************
+ * Bring the packed stream up to a keyframe and draw it.
+ * The stream is sequential, so every frame in between is decoded; with a
+ * low refresh rate whole frames are decoded but not shown.
+ * @param frame Keyframe index.
+ * @param frac Mix towards frame + 1 (0-255, cross-fade only).
+ ***************************************************************/
+void Animation::showPackedFrame(u16 frame, u16 frac)
+{
+        const PackedAnimation *anim = m_currentPacked;
+        u16 count = anim->frameCount;
+        u16 steps = (u16)((frame + count - m_position) % count);
 
-        // Copy pixels
-        for (u16 i = 0; i < m_currentBitmap->ledCount; i++)
+        if (!m_keyA)
         {
-                // Ensure we don't write past the strip length
-                if (i < m_pixels->getCount())
+                // Decode straight into the target; skipped LEDs keep their color
+                while (steps--)
                 {
-                        m_pixels->setColor(i, m_currentBitmap->data[offset + i]);
+                        decodeNextPacked(nullptr);
+                        m_position = m_decodedFrame;
                 }
+                return;
         }
 
-        // Advance frame
-        m_position++;
-        if (m_position >= m_currentBitmap->frameCount)
+        while (steps--)
+        {
+                memcpy(m_keyA, m_keyB, anim->ledCount * sizeof(u32));
+                m_position = m_position + 1 < count ? m_position + 1 : 0;
+                if (m_bitmapLoop || m_position + 1 < count)
+                        decodeNextPacked(m_keyB);
+        }
+
+        for (u16 i = 0; i < anim->ledCount; i++)
+        {
+                put(i, frac ? colorLerp(m_keyA[i], m_keyB[i], frac) : m_keyA[i]);
+        }
+        m_shownFrac = frac;
+}
+
+/************************* decodeNextPacked *******************************
+ * Decode the frame after m_decodedFrame, restarting the stream after the
+ * last frame (frame 0 is self-contained).
+ * @param dst Keyframe buffer, nullptr = draw into the target.
+ ***************************************************************/
+void Animation::decodeNextPacked(u32 *dst)
+{
+        if (m_decodedFrame + 1 >= m_currentPacked->frameCount)
+        {
+                m_streamPos = 0;
+                m_decodedFrame = 0;
+        }
+        else
+        {
+                m_decodedFrame++;
+        }
+
+        decodePackedFrame(dst);
+}
+
+/************************* decodePackedFrame *******************************
+ * Decode one frame of the packed stream into the target or a keyframe.
+ * Skipped LEDs are not written, so unchanged pixels stay clean.
+ * @param dst Keyframe buffer (ledCount colors), nullptr = the target.
+ ***************************************************************/
+void Animation::decodePackedFrame(u32 *dst)
+{
+        PROBE_SCOPE(PROBE_ANIM_DECODE);
+
+        const PackedAnimation *anim = m_currentPacked;
+        const u8 *base = nullptr; // Start of the current window
+        const u8 *p = nullptr;
+        const u8 *end = nullptr;
+        u32 pos = m_streamPos; // Stream offset of base
+        u16 led = 0;
+
+        // Next stream byte; a flash stream is one window, an asset refills per chunk
+        auto next = [&](u8 &out) -> bool
+        {
+                if (p == end)
+                {
+                        pos += p - base;
+                        if (!packedWindow(pos, base, end))
+                                return false;
+                        p = base;
+                }
+                out = *p++;
+                return true;
+        };
+
+        auto emit = [&](u32 color)
+        {
+                if (!dst)
+                        put(led, color);
+                else if (led < anim->ledCount)
+                        dst[led] = color;
+                led++;
+        };
+
+        u8 token;
+        while (led < anim->ledCount && next(token))
         {
-                if (m_bitmapLoop)
+                if ((token & PackedAnimToken::LITERAL) == PackedAnimToken::RUN)
                 {
-                        m_position = 0;
+                        u16 count = (token & PackedAnimToken::RUN_MASK) + 1;
+                        u8 index;
+                        if (!next(index))
+                                break;
+                        u32 color = index < anim->paletteSize ? anim->palette[index] : 0;
+                        while (count--)
+                                emit(color);
+                }
+                else if ((token & PackedAnimToken::SKIP) == PackedAnimToken::LITERAL)
+                {
+                        u16 count = (token & PackedAnimToken::COUNT_MASK) + 1;
+                        u8 index;
+                        while (count-- && next(index))
+                        {
+                                emit(index < anim->paletteSize ? anim->palette[index] : 0);
+                        }
                 }
                 else
                 {
-                        // Stop at last frame or disable?
-                        // Usually one-shot means stop at end or turn off.
-                        // Let's hold the last frame.
-                        m_position = m_currentBitmap->frameCount - 1;
-                        // Optional: m_active = false; if we want to stop updating
+                        led += (token & PackedAnimToken::COUNT_MASK) + 1;
                 }
         }
+
+        m_streamPos = pos + (p - base);
+}
+
+/************************* packedWindow ************************************
+ * Contiguous stream bytes starting at pos: the rest of the flash array,
+ * or the AssetReader chunk holding pos.
+ ***************************************************************/
+bool Animation::packedWindow(u32 pos, const u8 *&p, const u8 *&end)
+{
+        const PackedAnimation *anim = m_currentPacked;
+        if (pos >= anim->dataSize)
+                return false;
+
+        if (anim->data)
+        {
+                p = anim->data + pos;
+                end = anim->data + anim->dataSize;
+                return true;
+        }
+
+        return m_reader.window(m_assetStreamStart + pos, p, end);
+}
+
+/************************* bitmapFrameCount ********************************
+ * Frame count of the current raw or packed bitmap.
+ ***************************************************************/
+u16 Animation::bitmapFrameCount() const
+{
+        return m_currentPacked ? m_currentPacked->frameCount : m_currentBitmap->frameCount;
+}
+
+/************************* bitmapFrameRate *********************************
+ * Frame rate of the current raw or packed bitmap.
+ ***************************************************************/
+u8 Animation::bitmapFrameRate() const
+{
+        return m_currentPacked ? m_currentPacked->frameRate : m_currentBitmap->frameRate;
+}
+
+/************************* updateShader ***********************************
+ * Evaluate the shader for every pixel at this point in time.
+ * @return The refresh period (shaders are continuous).
+ ***************************************************************/
+u32 Animation::updateShader(u32 elapsed)
+{
+        PROBE_SCOPE(PROBE_SHADER_FRAME);
+
+        u16 count = m_pixels->getCount();
+        m_shader.beginFrame(elapsed, count);
+        for (u16 i = 0; i < count; i++)
+        {
+                put(i, m_shader.eval(i));
+        }
+
+        return m_refreshMs;
 }
+
 //============================================================================
 
+/************************* stepDelay ***************************************
+ * ms until the next step of a stepped effect, never below the refresh period.
+ ***************************************************************/
+static u32 stepDelay(u32 elapsed, u32 stepMs, u16 refreshMs)
+{
+        u32 remaining = stepMs - elapsed % stepMs;
+        return remaining < refreshMs ? refreshMs : remaining;
+}
+
 /************************* updateRedDotChase *******************************
  * Red dot chase with blue background.
+ * The dot moves one LED per STEP_MS.
  ***************************************************************/
-void Animation::updateRedDotChase()
+u32 Animation::updateRedDotChase(u32 elapsed)
 {
-        // Update position based on frame counter
-        m_frameCounter++;
-        if (m_frameCounter >= m_stepDelay)
-        {
-                m_frameCounter = 0;
-                m_position++;
-                if (m_position >= m_pixels->getCount())
-                {
-                        m_position = 0;
-                }
-        }
+        u16 count = m_pixels->getCount();
+        u16 dot = (u16)((elapsed / AnimConfig::STEP_MS) % count);
 
         // Set all pixels to blue, except the current position which is red
-        u32 *buffer = m_pixels->getBuffer();
-        for (u8 i = 0; i < m_pixels->getCount(); i++)
+        for (u16 i = 0; i < count; i++)
         {
-                if (i == m_position)
+                if (i == dot)
                 {
-                        buffer[i] = CLR_RD; // Red dot
+                        put(i, CLR_RD); // Red dot
                 }
                 else
                 {
-                        buffer[i] = CLR_BL; // Blue background
+                        put(i, CLR_BL); // Blue background
                 }
         }
+
+        return stepDelay(elapsed, AnimConfig::STEP_MS, m_refreshMs);
 }
 
 /************************* updateRainbowCycle ******************************
  * Rainbow cycling effect across the strip.
+ * The colors shift one LED per STEP_MS.
  ***************************************************************/
-void Animation::updateRainbowCycle()
+u32 Animation::updateRainbowCycle(u32 elapsed)
 {
-        // Cycle through colors
-        m_frameCounter++;
-        if (m_frameCounter >= m_stepDelay)
-        {
-                m_frameCounter = 0;
-                m_position++;
-        }
-
         // Create rainbow effect
         constexpr u32 rainbow[] = {CLR_RD, CLR_OR, CLR_YL, CLR_GR, CLR_CY, CLR_BL, CLR_PR, CLR_MG};
         constexpr u8 rainbowSize = sizeof(rainbow) / sizeof(rainbow[0]);
 
-        u32 *buffer = m_pixels->getBuffer();
-        for (u8 i = 0; i < m_pixels->getCount(); i++)
+        u8 shift = (u8)((elapsed / AnimConfig::STEP_MS) % rainbowSize);
+        for (u16 i = 0; i < m_pixels->getCount(); i++)
         {
-                buffer[i] = rainbow[(i + m_position) % rainbowSize];
+                put(i, rainbow[(i + shift) % rainbowSize]);
         }
+
+        return stepDelay(elapsed, AnimConfig::STEP_MS, m_refreshMs);
 }
 
 /************************* updateBreathing *******************************
- * Simple breathing/pulse white effect.
+ * White pulse: a triangle wave from off to BREATH_PEAK and back over
+ * BREATH_PERIOD_MS.
  ***************************************************************/
-void Animation::updateBreathing()
+u32 Animation::updateBreathing(u32 elapsed)
 {
-        // Simple breathing effect using brightness modulation
-        // This is a placeholder - you'd need to implement brightness control in PixelStrip
-        m_frameCounter++;
-        if (m_frameCounter >= 2)
+        constexpr u32 half = AnimConfig::BREATH_PERIOD_MS / 2;
+
+        u32 phase = elapsed % AnimConfig::BREATH_PERIOD_MS;
+        u32 ramp = phase < half ? phase : AnimConfig::BREATH_PERIOD_MS - phase;
+        u32 level = ramp * AnimConfig::BREATH_PEAK / half;
+        u32 color = level * 0x010101;
+
+        for (u16 i = 0; i < m_pixels->getCount(); i++)
         {
-                m_frameCounter = 0;
-                m_position++;
-                if (m_position >= 100)
-                        m_position = 0;
+                put(i, color);
         }
 
-        // For now, just pulse white
-        u8 brightness = (m_position < 50) ? m_position * 2 : (100 - m_position) * 2;
-        u32 color = (brightness << 16) | (brightness << 8) | brightness;
-        m_pixels->setAll(color);
+        return m_refreshMs;
 }
 
 /************************* updateSparkle **********************************
  * Random sparkle effect with single white pixel.
+ * The dot jumps 7 LEDs ahead every SPARKLE_STEP_MS.
  ***************************************************************/
-void Animation::updateSparkle()
+u32 Animation::updateSparkle(u32 elapsed)
 {
-        // Random sparkle effect
-        m_frameCounter++;
-        if (m_frameCounter >= 3)
-        {
-                m_frameCounter = 0;
-                m_position = (m_position + 7) % m_pixels->getCount(); // Pseudo-random
-        }
+        u16 count = m_pixels->getCount();
+        u16 dot = (u16)(((elapsed / AnimConfig::SPARKLE_STEP_MS) * 7) % count); // Pseudo-random
 
-        u32 *buffer = m_pixels->getBuffer();
-        for (u8 i = 0; i < m_pixels->getCount(); i++)
+        for (u16 i = 0; i < count; i++)
         {
-                if (i == m_position)
+                if (i == dot)
                 {
-                        buffer[i] = CLR_WT; // White sparkle
+                        put(i, CLR_WT); // White sparkle
                 }
                 else
                 {
-                        buffer[i] = 0; // Off
+                        put(i, 0); // Off
                 }
         }
+
+        return stepDelay(elapsed, AnimConfig::SPARKLE_STEP_MS, m_refreshMs);
 }
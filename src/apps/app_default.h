@@ -32,8 +32,9 @@ public:
          * If this loop takes longer than the watchdog timeout,
          * the system will reset. Use millis() for timing instead.
          *
-         * Performance Note: Typical loop cycle time is ~13ms (~75Hz)
-         * due to Core overhead (Input polling, I2C, etc).
+         * Performance Note: Called by the Core scheduler every 10ms
+         * (TaskTiming::APP_MS); inputs and bus frames are handled
+         * in their own tasks as soon as they arrive.
          ***************************************************************/
         void loop() override
         {
@@ -6,8 +6,10 @@
 
 #include "app_base.h"
 #include "apps/app_default.h"
+#include "apps/app_numbox.h"
 #include "apps/app_proto.h"
 #include "apps/app_purger.h"
+#include "apps/app_puzzle.h"
 #include "apps/app_timer.h"
 
 // Include specific apps here as they are created
@@ -25,9 +27,15 @@ AppBase *AppBase::create(DeviceType type)
         case PROTO:
                 return new AppProto();
 
+        case NUM_BOX:
+                return new AppNumBox();
+
         case PURGER:
                 return new AppPurger();
 
+        case PUZZLE:
+                return new AppPuzzle();
+
         case TIMER:
                 return new AppTimer();
 
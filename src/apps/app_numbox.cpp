@@ -0,0 +1,97 @@
+/************************* app_numbox.cpp **********************
+ * Num Box Application Implementation
+ * Logic for the Num Box device type
+ * Created by MSK, November 2025
+ * 4 rows of 6 segment digits, drawn with SegmentDisplay
+ ***************************************************************/
+
+#include "app_numbox.h"
+#include <Arduino.h>
+#include "pixel.h"
+#include "roombus.h"
+
+/************************* AppNumBox ***********************************
+ * Constructor. The display is created once the strip is known.
+ ***************************************************************/
+AppNumBox::AppNumBox() : m_display(nullptr)
+{
+}
+
+/************************* ~AppNumBox ***********************************
+ * Destructor.
+ ***************************************************************/
+AppNumBox::~AppNumBox()
+{
+        delete m_display;
+}
+
+/************************* setup ***********************************
+ * Initializes the Num Box application.
+ * All digits start blank.
+ * @param context The application context.
+ ***************************************************************/
+void AppNumBox::setup(const AppContext &context)
+{
+        AppBase::setup(context);
+        Serial.println("--- NUM BOX APP STARTED ---");
+
+        if (m_context.pixels)
+        {
+                m_display = new SegmentDisplay(m_context.pixels, 0, ROWS * ROW_DIGITS);
+                m_context.pixels->clear();
+                refresh();
+
+                onCommand(NUM_SET_DIGIT_COLOR, cmdSetDigitColor, this);
+                onCommand(NUM_SET_DIGIT_VAL, cmdSetDigitValue, this);
+                onCommand(NUM_SET_ROW_NUM, cmdSetRowNumber, this);
+        }
+}
+
+/************************* refresh ***********************************
+ * Blits changed digits and sends the frame.
+ ***************************************************************/
+void AppNumBox::refresh()
+{
+        m_display->render();
+        m_context.pixels->show();
+}
+
+/************************* cmdSetDigitColor ***********************************
+ * NUM_SET_DIGIT_COLOR: p[0] digit (NUM_ALL_DIGITS = all), p[1..3] RGB.
+ ***************************************************************/
+void AppNumBox::cmdSetDigitColor(void *ctx, const RoomFrame &frame)
+{
+        AppNumBox *self = static_cast<AppNumBox *>(ctx);
+        const u8 *p = frame.p;
+        u32 color = ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3];
+        if (p[0] == NUM_ALL_DIGITS)
+                self->m_display->setColor(color);
+        else
+                self->m_display->setDigitColor(p[0], color);
+        self->refresh();
+}
+
+/************************* cmdSetDigitValue ***********************************
+ * NUM_SET_DIGIT_VAL: p[0] digit, p[1] character, p[2] flags.
+ ***************************************************************/
+void AppNumBox::cmdSetDigitValue(void *ctx, const RoomFrame &frame)
+{
+        AppNumBox *self = static_cast<AppNumBox *>(ctx);
+        self->m_display->setGlyph(frame.p[0], (char)frame.p[1], frame.p[2] & NUM_FLAG_DOT);
+        self->refresh();
+}
+
+/************************* cmdSetRowNumber ***********************************
+ * NUM_SET_ROW_NUM: p[0] row, p[1..4] int32, p[5] flags.
+ ***************************************************************/
+void AppNumBox::cmdSetRowNumber(void *ctx, const RoomFrame &frame)
+{
+        AppNumBox *self = static_cast<AppNumBox *>(ctx);
+        const u8 *p = frame.p;
+        if (p[0] >= ROWS)
+                return;
+
+        self->m_display->printNumber(p[0] * ROW_DIGITS, ROW_DIGITS, (int32_t)room_get_u32(&p[1]),
+                                     p[5] & NUM_FLAG_LEADING_ZEROS);
+        self->refresh();
+}
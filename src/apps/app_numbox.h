@@ -0,0 +1,25 @@
+#pragma once
+#include "app_base.h"
+#include "glyph.h"
+
+class AppNumBox : public AppBase
+{
+public:
+        AppNumBox();
+        ~AppNumBox();
+
+        void setup(const AppContext &context) override;
+
+        static constexpr u8 ROWS = 4;
+        static constexpr u8 ROW_DIGITS = GlyphConfig::MAX_DIGITS / ROWS;
+
+private:
+        SegmentDisplay *m_display;
+
+        void refresh();
+
+        // Room Bus command handlers (ctx = AppNumBox)
+        static void cmdSetDigitColor(void *ctx, const RoomFrame &frame);
+        static void cmdSetDigitValue(void *ctx, const RoomFrame &frame);
+        static void cmdSetRowNumber(void *ctx, const RoomFrame &frame);
+};
@@ -142,12 +142,3 @@ bool AppProto::handleInput(InputEvent event)
         }
         return false; // Let Core handle default actions
 }
-
-/************************* handleCommand ***********************************
- * Handles RoomBus commands for the Proto application.
- * @param frame The received command frame.
- ***************************************************************/
-void AppProto::handleCommand(const RoomFrame &frame)
-{
-        // Handle proto-specific commands here
-}
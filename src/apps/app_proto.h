@@ -10,7 +10,6 @@ public:
         void setup(const AppContext &context) override;
         void loop() override;
         bool handleInput(InputEvent event) override;
-        void handleCommand(const RoomFrame &frame) override;
 
 private:
         MusicPlayer *m_player = nullptr;
@@ -32,17 +32,7 @@ void AppPurger::setup(const AppContext &context)
  ***************************************************************/
 void AppPurger::loop()
 {
-        // static u32 loopCount = 0;
-        // static u32 lastTime = millis();
-
-        // loopCount++;
-        // if (loopCount >= 1000)
-        // {
-        //         u32 now = millis();
-        //         Serial.printf("Purger: Ech loop took %u ms\n", (now - lastTime) / 1000);
-        //         lastTime = now;
-        //         loopCount = 0;
-        // }
+        // Loop timing: build with -D ENABLE_PROBES (include/probe.h) instead of ad-hoc prints
 
         //  Purger logic would go here
 }
@@ -67,12 +57,3 @@ bool AppPurger::handleInput(InputEvent event)
         }
         return false; // Let Core handle default actions
 }
-
-/************************* handleCommand ***********************************
- * Handles RoomBus commands for the Purger application.
- * @param frame The received command frame.
- ***************************************************************/
-void AppPurger::handleCommand(const RoomFrame &frame)
-{
-        // Handle purger-specific commands here
-}
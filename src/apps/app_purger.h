@@ -7,5 +7,4 @@ public:
         void setup(const AppContext &context) override;
         void loop() override;
         bool handleInput(InputEvent event) override;
-        void handleCommand(const RoomFrame &frame) override;
 };
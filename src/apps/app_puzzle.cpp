@@ -0,0 +1,248 @@
+/************************* app_puzzle.cpp **********************
+ * Puzzle Application Implementation
+ * Logic for the Puzzle device type
+ * Created by MSK, November 2025
+ * Puzzle logic is a PuzzleVM script: changed by upload, not by reflashing
+ ***************************************************************/
+
+#include "app_puzzle.h"
+#include <Arduino.h>
+#include "pixel.h"
+#include "matrixpanel.h"
+#include "synth.h"
+#include "music.h"
+#include "motors.h"
+#include "roombus.h"
+
+static inline int32_t clampArg(int32_t v, int32_t lo, int32_t hi)
+{
+        return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/************************* AppPuzzle ***********************************
+ * Constructor. The script is loaded in setup().
+ ***************************************************************/
+AppPuzzle::AppPuzzle() : m_player(nullptr), m_faultReported(false)
+{
+}
+
+/************************* ~AppPuzzle ***********************************
+ * Destructor.
+ ***************************************************************/
+AppPuzzle::~AppPuzzle()
+{
+        if (m_player)
+        {
+                if (m_context.synth)
+                        m_context.synth->setMusicPlayer(nullptr);
+                delete m_player;
+                m_player = nullptr;
+        }
+}
+
+/************************* setup ***********************************
+ * Initializes the Puzzle application.
+ * Loads the boot script saved by PUZZLE_LOAD (if any) and starts it.
+ * @param context The application context.
+ ***************************************************************/
+void AppPuzzle::setup(const AppContext &context)
+{
+        AppBase::setup(context);
+        Serial.println("--- PUZZLE APP STARTED ---");
+
+        m_vm.setHost(sysCall, this);
+        if (m_context.synth)
+        {
+                m_player = new MusicPlayer(m_context.synth);
+                m_context.synth->setMusicPlayer(m_player);
+        }
+
+        onCommand(PUZZLE_RESET, cmdReset, this);
+        onCommand(PUZZLE_LOAD, cmdLoad, this);
+        onCommand(PUZZLE_INPUT, cmdInput, this);
+
+        m_preferences.begin("puzzle", false);
+        u32 boot = m_preferences.getUInt("boot", NO_BOOT_SCRIPT);
+        if (boot == NO_BOOT_SCRIPT || !loadScript((u16)boot))
+                Serial.println("Puzzle: no script, waiting for PUZZLE_LOAD");
+}
+
+/************************* loadScript ***********************************
+ * Load an ASSET_PUZZLE and run its start handler.
+ ***************************************************************/
+bool AppPuzzle::loadScript(u16 assetId)
+{
+        if (!m_vm.loadAsset(assetId))
+                return false;
+
+        Serial.printf("Puzzle: script 0x%04x loaded\n", assetId);
+        m_faultReported = false;
+        runEvent(PUZZLE_ON_START, 0);
+        return true;
+}
+
+/************************* runEvent ***********************************
+ * Run a script handler and report it if it was aborted.
+ ***************************************************************/
+void AppPuzzle::runEvent(PuzzleEvent event, int32_t arg)
+{
+        report(m_vm.run(event, arg));
+}
+
+/************************* report ***********************************
+ * EV_DEVICE_ERROR (DEVICE_ERROR_SCRIPT) for an aborted handler.
+ * Only the first fault is sent: a timer that re-arms itself and faults
+ * would otherwise flood the bus. PUZZLE_RESET and PUZZLE_LOAD re-enable it.
+ ***************************************************************/
+void AppPuzzle::report(PuzzleFault fault)
+{
+        if (fault == PZ_FAULT_NONE || m_faultReported)
+                return;
+
+        m_faultReported = true;
+        sendEvent(EV_DEVICE_ERROR, DEVICE_ERROR_SCRIPT, fault);
+}
+
+/************************* loop ***********************************
+ * Main loop for the Puzzle application.
+ * Fires the script's timers; all other handlers run on their event.
+ ***************************************************************/
+void AppPuzzle::loop()
+{
+        report(m_vm.tick());
+}
+
+/************************* handleInput ***********************************
+ * Handles input events for the Puzzle application.
+ * Keypad and button events go to the script; events it has no handler
+ * for are left to Core.
+ * @param event The input event ID.
+ ***************************************************************/
+bool AppPuzzle::handleInput(InputEvent event)
+{
+        PuzzleEvent target = PUZZLE_ON_BUTTON;
+        int key = 0;
+        if ((key = getKeypadIndex(event)) != -1)
+                target = PUZZLE_ON_KEY;
+        else if ((key = getKeypadReleaseIndex(event)) != -1)
+                target = PUZZLE_ON_KEY_UP;
+        else if ((key = getKeypadHoldIndex(event)) != -1)
+                target = PUZZLE_ON_KEY_HOLD;
+        else if (event == INPUT_BTN1_PRESS)
+                key = 0;
+        else
+                return false;
+
+        if (!m_vm.hasHandler(target))
+                return false;
+
+        runEvent(target, key);
+        return true;
+}
+
+/************************* sysCall ***********************************
+ * PZ_SYS: the script's outputs. Arguments are clamped to what the driver
+ * takes; a missing driver makes the call a no-op.
+ ***************************************************************/
+int32_t AppPuzzle::sysCall(void *ctx, u8 id, const int32_t *args)
+{
+        AppPuzzle *self = static_cast<AppPuzzle *>(ctx);
+        const AppContext &c = self->m_context;
+
+        switch (id)
+        {
+        case SYS_LED:
+                if (c.matrixPanel && (u32)args[0] < KEYPAD_SIZE)
+                        c.matrixPanel->ledControl((u8)args[0], (u32)args[1]);
+                break;
+
+        case SYS_FILL:
+                if (c.matrixPanel)
+                        c.matrixPanel->fill((u32)args[0]);
+                break;
+
+        case SYS_FADE:
+                if (!c.matrixPanel)
+                        break;
+                if (args[0] < 0)
+                        c.matrixPanel->fadeAll((u32)args[1], (u16)clampArg(args[2], 0, 0xFFFF));
+                else if (args[0] < KEYPAD_SIZE)
+                        c.matrixPanel->fadeCell((u8)args[0], (u32)args[1], (u16)clampArg(args[2], 0, 0xFFFF));
+                break;
+
+        case SYS_SHOW:
+                if (c.pixels)
+                        c.pixels->show();
+                break;
+
+        case SYS_TONE:
+                if (c.synth)
+                        c.synth->playNote((u16)clampArg(args[0], 0, 0xFFFF), (u16)clampArg(args[1], 0, 0xFFFF));
+                break;
+
+        case SYS_SONG:
+                return self->m_player && self->m_player->playAsset((u16)args[0]);
+
+        case SYS_SILENCE:
+                if (self->m_player)
+                        self->m_player->stop();
+                if (c.synth)
+                        c.synth->stopNote();
+                break;
+
+        case SYS_MOTOR:
+                if (c.motors && (u32)args[0] < MOTOR_COUNT)
+                        c.motors->setSpeed((u8)args[0], (int8_t)clampArg(args[1], -100, 100));
+                break;
+
+        case SYS_EVENT:
+                if (args[0] >= 0x80 && args[0] <= 0xFF) // Device→server events only
+                        self->sendEvent((u8)args[0], (u8)args[1], (u8)args[2]);
+                break;
+
+        default:
+                break;
+        }
+        return 0;
+}
+
+/************************* cmdReset ***********************************
+ * PUZZLE_RESET: clear variables and timers, run the start handler.
+ ***************************************************************/
+void AppPuzzle::cmdReset(void *ctx, const RoomFrame &frame)
+{
+        AppPuzzle *self = static_cast<AppPuzzle *>(ctx);
+        Serial.println("-> PUZZLE RESET");
+        self->m_vm.reset();
+        self->m_faultReported = false;
+        self->runEvent(PUZZLE_ON_START, 0);
+}
+
+/************************* cmdLoad ***********************************
+ * PUZZLE_LOAD: p[0..1] asset ID, p[2] flags (PUZZLE_LOAD_BOOT).
+ * The boot script is only replaced by a script that loaded.
+ ***************************************************************/
+void AppPuzzle::cmdLoad(void *ctx, const RoomFrame &frame)
+{
+        AppPuzzle *self = static_cast<AppPuzzle *>(ctx);
+        u16 id = room_get_u16(frame.p);
+        if (!self->loadScript(id))
+        {
+                if (frame.addr != ADDR_BROADCAST)
+                        self->sendEvent(EV_DEVICE_ERROR, DEVICE_ERROR_SCRIPT, PZ_FAULT_NONE);
+                return;
+        }
+
+        if (frame.p[2] & PUZZLE_LOAD_BOOT)
+                self->m_preferences.putUInt("boot", id);
+}
+
+/************************* cmdInput ***********************************
+ * PUZZLE_INPUT: p[0] ARG, p[1..19] PARAM bytes for the command handler.
+ ***************************************************************/
+void AppPuzzle::cmdInput(void *ctx, const RoomFrame &frame)
+{
+        AppPuzzle *self = static_cast<AppPuzzle *>(ctx);
+        self->m_vm.setParams(frame.p + 1, sizeof(frame.p) - 1);
+        self->runEvent(PUZZLE_ON_COMMAND, frame.p[0]);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "app_base.h"
+#include "puzzlevm.h"
+#include <Preferences.h>
+
+class MusicPlayer;
+
+class AppPuzzle : public AppBase
+{
+public:
+        AppPuzzle();
+        ~AppPuzzle();
+
+        void setup(const AppContext &context) override;
+        void loop() override;
+        bool handleInput(InputEvent event) override;
+
+        static constexpr u32 NO_BOOT_SCRIPT = 0xFFFFFFFF;
+
+private:
+        PuzzleVM m_vm;
+        MusicPlayer *m_player;
+        Preferences m_preferences; // "puzzle": boot script asset ID
+        bool m_faultReported;      // EV_DEVICE_ERROR sent since the last (re)start
+
+        bool loadScript(u16 assetId);
+        void runEvent(PuzzleEvent event, int32_t arg);
+        void report(PuzzleFault fault);
+
+        // PZ_SYS host calls (ctx = AppPuzzle)
+        static int32_t sysCall(void *ctx, u8 id, const int32_t *args);
+
+        // Room Bus command handlers (ctx = AppPuzzle)
+        static void cmdReset(void *ctx, const RoomFrame &frame);
+        static void cmdLoad(void *ctx, const RoomFrame &frame);
+        static void cmdInput(void *ctx, const RoomFrame &frame);
+};
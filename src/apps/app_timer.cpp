@@ -7,11 +7,30 @@
 #include "app_timer.h"
 #include <Arduino.h>
 #include "pixel.h"
+#include "compositor.h"
 #include "roombus.h"
 
+/************************* AppTimer ***********************************
+ * Constructor. The display is created once the strip is known.
+ ***************************************************************/
+AppTimer::AppTimer() : m_display(nullptr), m_color(0x0000FF), m_shownSeconds(0), m_shownRunning(false),
+                       m_layered(false)
+{
+}
+
+/************************* ~AppTimer ***********************************
+ * Destructor.
+ ***************************************************************/
+AppTimer::~AppTimer()
+{
+        delete m_display;
+}
+
 /************************* setup ***********************************
  * Initializes the Timer application.
- * Sets initial LED state.
+ * The digits go on a compositor layer above the animation, blended with
+ * BLEND_MAX, so an animation the server starts shows through the unlit
+ * segments instead of overwriting the time.
  * @param context The application context.
  ***************************************************************/
 void AppTimer::setup(const AppContext &context)
@@ -19,20 +38,84 @@ void AppTimer::setup(const AppContext &context)
         AppBase::setup(context);
         Serial.println("--- TIMER APP STARTED ---");
 
-        // Example: Set LEDs to Blue to indicate timer
+        onCommand(TMR_SET_COLOR, cmdSetColor, this);
+        onCommand(TMR_SET_VALUE, cmdSetValue, this);
+        onCommand(TMR_START, cmdStart, this);
+        onCommand(TMR_PAUSE, cmdPause, this);
+        onCommand(TMR_ADD_TIME, cmdAddTime, this);
+        onCommand(TMR_SYNC, cmdSync, this);
+
         if (m_context.pixels)
         {
-                m_context.pixels->setAll(0x0000FF); // Blue
-                m_context.pixels->show();
+                m_display = new SegmentDisplay(m_context.pixels, 0, DIGITS);
+                Compositor *layers = m_context.compositor;
+                m_layered = layers && layers->begin(LAYER_COUNT);
+                if (m_layered)
+                {
+                        layers->setSource(LAYER_ANIMATION, m_context.animation);
+                        layers->setBlendMode(LAYER_DIGITS, BLEND_MAX);
+                        m_display->setLayer(layers, LAYER_DIGITS);
+                }
+                else
+                {
+                        m_context.pixels->clear();
+                }
+                showTime(0);
         }
 }
 
+/************************* showTime ***********************************
+ * Draws whole seconds as mm.ss (the dot is the separator), dimmed while
+ * paused. Values past 99:59 show 99.59.
+ ***************************************************************/
+void AppTimer::showTime(u32 totalSeconds)
+{
+        m_shownSeconds = totalSeconds;
+        m_shownRunning = m_countdown.isRunning();
+        if (!m_display)
+                return;
+
+        u32 minutes = totalSeconds / 60;
+        u32 seconds = totalSeconds % 60;
+        if (minutes > 99)
+        {
+                minutes = 99;
+                seconds = 59;
+        }
+
+        char text[6];
+        snprintf(text, sizeof(text), "%02lu.%02lu", (unsigned long)minutes, (unsigned long)seconds);
+        m_display->setColor(m_shownRunning ? m_color : (m_color >> 2) & 0x3F3F3F);
+        m_display->print(0, DIGITS, text);
+        m_display->render();
+        if (!m_layered)
+                m_context.pixels->show();
+}
+
+/************************* refresh ***********************************
+ * Redraws when the shown second or the running state changed.
+ * Seconds are rounded up, so 00.00 appears when the time is over.
+ ***************************************************************/
+void AppTimer::refresh()
+{
+        u32 seconds = (m_countdown.remainingMs() + 999) / 1000;
+        if (seconds != m_shownSeconds || m_countdown.isRunning() != m_shownRunning)
+                showTime(seconds);
+}
+
 /************************* loop ***********************************
  * Main loop for the Timer application.
+ * Advances the countdown and reports EV_TMR_DONE when it runs out.
  ***************************************************************/
 void AppTimer::loop()
 {
-        // Timer logic would go here
+        bool done = m_countdown.update();
+        refresh();
+        if (done)
+        {
+                sendEvent(EV_TMR_DONE);
+                Serial.println("Sent EV_TMR_DONE");
+        }
 }
 
 /************************* handleInput ***********************************
@@ -53,42 +136,77 @@ bool AppTimer::handleInput(InputEvent event)
         }
         return false; // Let Core handle other inputs
 }
-/************************* handleCommand ***********************************
- * Handles RoomBus commands for the Timer application.
- * @param frame The received command frame.
+
+/************************* cmdSetColor ***********************************
+ * TMR_SET_COLOR: p[0..2] RGB.
  ***************************************************************/
+void AppTimer::cmdSetColor(void *ctx, const RoomFrame &frame)
+{
+        AppTimer *self = static_cast<AppTimer *>(ctx);
+        self->m_color = ((u32)frame.p[0] << 16) | ((u32)frame.p[1] << 8) | frame.p[2];
+        self->showTime(self->m_shownSeconds);
+}
 
-// Handle RoomBus commands specific to Timer
-// Commands are defined in roombus.h
+/************************* cmdSetValue ***********************************
+ * TMR_SET_VALUE: p[0..3] seconds.
+ ***************************************************************/
+void AppTimer::cmdSetValue(void *ctx, const RoomFrame &frame)
+{
+        AppTimer *self = static_cast<AppTimer *>(ctx);
+        self->m_countdown.set(room_get_u32(frame.p) * 1000);
+        self->refresh();
+}
 
-void AppTimer::handleCommand(const RoomFrame &frame)
+/************************* cmdStart ***********************************
+ * TMR_START.
+ ***************************************************************/
+void AppTimer::cmdStart(void *ctx, const RoomFrame &frame)
 {
-        Serial.print("Timer received command: 0x");
-        Serial.println(frame.cmd_srv, HEX);
+        (void)frame;
+        AppTimer *self = static_cast<AppTimer *>(ctx);
+        Serial.println("-> START TIMER");
+        self->m_countdown.start();
+        self->refresh();
+}
 
-        switch (frame.cmd_srv)
-        {
-        case TMR_START:
-                Serial.println("-> START TIMER");
-                // Mock: Change color to Green
-                if (m_context.pixels)
-                {
-                        m_context.pixels->setAll(0x00FF00);
-                        m_context.pixels->show();
-                }
-                break;
+/************************* cmdPause ***********************************
+ * TMR_PAUSE.
+ ***************************************************************/
+void AppTimer::cmdPause(void *ctx, const RoomFrame &frame)
+{
+        (void)frame;
+        AppTimer *self = static_cast<AppTimer *>(ctx);
+        Serial.println("-> PAUSE TIMER");
+        self->m_countdown.pause();
+        self->refresh();
+}
 
-        case TMR_PAUSE:
-                Serial.println("-> PAUSE TIMER");
-                // Mock: Change color to Yellow
-                if (m_context.pixels)
-                {
-                        m_context.pixels->setAll(0xFFFF00);
-                        m_context.pixels->show();
-                }
-                break;
+/************************* cmdAddTime ***********************************
+ * TMR_ADD_TIME: p[0..3] signed ms.
+ ***************************************************************/
+void AppTimer::cmdAddTime(void *ctx, const RoomFrame &frame)
+{
+        AppTimer *self = static_cast<AppTimer *>(ctx);
+        self->m_countdown.add((int32_t)room_get_u32(frame.p));
+        self->refresh();
+}
 
-        default:
-                break;
+/************************* cmdSync ***********************************
+ * TMR_SYNC: p[0..3] server's remaining ms, p[4] flags.
+ * Sync while paused snaps, so a timer that missed START catches up at once.
+ ***************************************************************/
+void AppTimer::cmdSync(void *ctx, const RoomFrame &frame)
+{
+        AppTimer *self = static_cast<AppTimer *>(ctx);
+        if (frame.p[4] & TMR_SYNC_RUNNING)
+        {
+                self->m_countdown.sync(room_get_u32(frame.p));
+                self->m_countdown.start();
+        }
+        else
+        {
+                self->m_countdown.pause();
+                self->m_countdown.sync(room_get_u32(frame.p));
         }
+        self->refresh();
 }
@@ -1,11 +1,41 @@
 #pragma once
 #include "app_base.h"
+#include "glyph.h"
+#include "countdown.h"
 
 class AppTimer : public AppBase
 {
 public:
+        AppTimer();
+        ~AppTimer();
+
         void setup(const AppContext &context) override;
         void loop() override;
         bool handleInput(InputEvent event) override;
-        void handleCommand(const RoomFrame &frame) override;
+
+        static constexpr u8 DIGITS = 4; // mm.ss
+
+        // Compositor layers: the digits over a background animation
+        static constexpr u8 LAYER_ANIMATION = 0;
+        static constexpr u8 LAYER_DIGITS = 1;
+        static constexpr u8 LAYER_COUNT = 2;
+
+private:
+        SegmentDisplay *m_display;
+        Countdown m_countdown;
+        u32 m_color;        // Digit color while running
+        u32 m_shownSeconds; // What the display shows
+        bool m_shownRunning;
+        bool m_layered; // Digits drawn on LAYER_DIGITS (the animation task sends them)
+
+        void refresh();
+        void showTime(u32 totalSeconds);
+
+        // Room Bus command handlers (ctx = AppTimer)
+        static void cmdSetColor(void *ctx, const RoomFrame &frame);
+        static void cmdSetValue(void *ctx, const RoomFrame &frame);
+        static void cmdStart(void *ctx, const RoomFrame &frame);
+        static void cmdPause(void *ctx, const RoomFrame &frame);
+        static void cmdAddTime(void *ctx, const RoomFrame &frame);
+        static void cmdSync(void *ctx, const RoomFrame &frame);
 };
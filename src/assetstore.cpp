@@ -0,0 +1,484 @@
+/************************* assetstore.cpp **********************
+ * Asset Store Implementation
+ * LittleFS-backed animation/song storage with a RAM index
+ * Created by MSK, November 2025
+ * Chunked reads and verified, atomic uploads
+ ***************************************************************/
+
+#include "assetstore.h"
+#include <LittleFS.h>
+#include "esp_rom_crc.h"
+#include "watchdog.h"
+
+//============================================================================
+// STATIC DATA
+//============================================================================
+
+static bool storeMounted = false;
+static AssetInfo assetIndex[AssetConfig::MAX_ASSETS];
+static u8 assetCount = 0;
+
+// Upload in progress
+static File uploadFile;
+static bool uploadActive = false;
+static AssetHeader uploadHeader;
+static u32 uploadPos = 0; // Payload bytes written so far
+static u32 uploadCrc = 0; // Running CRC of the payload
+
+//============================================================================
+// INDEX HELPERS
+//============================================================================
+
+/************************* readHeader **************************************
+ * Read and validate the AssetHeader at the start of an open file.
+ ***************************************************************/
+static bool readHeader(File &file, AssetHeader &header)
+{
+        if (file.read((u8 *)&header, sizeof(header)) != sizeof(header))
+                return false;
+
+        return header.magic == AssetConfig::MAGIC &&
+               header.version == AssetConfig::VERSION &&
+               header.size <= AssetConfig::MAX_SIZE &&
+               file.size() == sizeof(header) + header.size;
+}
+
+/************************* payloadCrcOk ************************************
+ * Check the payload after the header against header.crc (chunked reads).
+ ***************************************************************/
+static bool payloadCrcOk(File &file, const AssetHeader &header)
+{
+        u8 chunk[AssetConfig::CHUNK_SIZE];
+        u32 crc = 0;
+        for (u32 left = header.size; left;)
+        {
+                u32 n = left < sizeof(chunk) ? left : sizeof(chunk);
+                if (file.read(chunk, n) != n)
+                        return false;
+                crc = esp_rom_crc32_le(crc, chunk, n);
+                left -= n;
+                Watchdog::reset(); // Large assets take a while at boot
+        }
+        return crc == header.crc;
+}
+
+/************************* indexPut ****************************************
+ * Add or replace the index entry for a header.
+ ***************************************************************/
+static bool indexPut(const AssetHeader &header)
+{
+        u8 slot = assetCount;
+        for (u8 i = 0; i < assetCount; i++)
+        {
+                if (assetIndex[i].id == header.id)
+                {
+                        slot = i;
+                        break;
+                }
+        }
+
+        if (slot >= AssetConfig::MAX_ASSETS)
+                return false;
+
+        assetIndex[slot].id = header.id;
+        assetIndex[slot].type = (AssetType)header.type;
+        assetIndex[slot].size = header.size;
+        assetIndex[slot].crc = header.crc;
+        if (slot == assetCount)
+                assetCount++;
+        return true;
+}
+
+/************************* indexRemove *************************************
+ * Drop an index entry (order is not kept).
+ ***************************************************************/
+static void indexRemove(u16 id)
+{
+        for (u8 i = 0; i < assetCount; i++)
+        {
+                if (assetIndex[i].id == id)
+                {
+                        assetIndex[i] = assetIndex[--assetCount];
+                        return;
+                }
+        }
+}
+
+/************************* buildIndex **************************************
+ * Scan the asset directory and index every valid file (header and payload
+ * CRC), so a corrupted asset is never played.
+ ***************************************************************/
+static void buildIndex()
+{
+        assetCount = 0;
+
+        File dir = LittleFS.open(AssetConfig::DIR);
+        if (!dir || !dir.isDirectory())
+                return;
+
+        for (File file = dir.openNextFile(); file; file = dir.openNextFile())
+        {
+                AssetHeader header;
+                if (!file.isDirectory() && readHeader(file, header))
+                {
+                        if (!payloadCrcOk(file, header))
+                        {
+                                Serial.printf("Assets: %s fails its CRC, not indexed\n", file.path());
+                                file.close();
+                                continue;
+                        }
+
+                        char expected[24];
+                        AssetStore::path(header.id, expected, sizeof(expected));
+                        // Only files under their own name (skips the upload temp file)
+                        if (strcmp(file.path(), expected) == 0 && !indexPut(header))
+                        {
+                                Serial.println("Assets: index full, ignoring the rest");
+                        }
+                }
+                file.close();
+        }
+}
+
+//============================================================================
+// ASSET STORE
+//============================================================================
+
+/************************* begin *******************************************
+ * Mount LittleFS (format on first use) and index the stored assets.
+ ***************************************************************/
+bool AssetStore::begin()
+{
+        if (storeMounted)
+                return true;
+
+        if (!LittleFS.begin(true))
+        {
+                Serial.println("Assets: LittleFS mount failed");
+                return false;
+        }
+
+        if (!LittleFS.exists(AssetConfig::DIR))
+        {
+                LittleFS.mkdir(AssetConfig::DIR);
+        }
+
+        storeMounted = true;
+        buildIndex();
+        Serial.printf("Assets: %u stored, %lu bytes free\n", assetCount, (unsigned long)freeBytes());
+        return true;
+}
+
+/************************* isMounted ***************************************
+ * True once begin() mounted the partition.
+ ***************************************************************/
+bool AssetStore::isMounted()
+{
+        return storeMounted;
+}
+
+/************************* find ********************************************
+ * Index entry for an asset ID, nullptr if not stored.
+ ***************************************************************/
+const AssetInfo *AssetStore::find(u16 id)
+{
+        for (u8 i = 0; i < assetCount; i++)
+        {
+                if (assetIndex[i].id == id)
+                        return &assetIndex[i];
+        }
+        return nullptr;
+}
+
+/************************* count / at **************************************
+ * Iterate the index.
+ ***************************************************************/
+u8 AssetStore::count()
+{
+        return assetCount;
+}
+
+const AssetInfo *AssetStore::at(u8 index)
+{
+        return index < assetCount ? &assetIndex[index] : nullptr;
+}
+
+/************************* freeBytes ***************************************
+ * Unused bytes on the partition.
+ ***************************************************************/
+u32 AssetStore::freeBytes()
+{
+        if (!storeMounted)
+                return 0;
+        return (u32)(LittleFS.totalBytes() - LittleFS.usedBytes());
+}
+
+/************************* remove ******************************************
+ * Delete an asset file and its index entry.
+ ***************************************************************/
+bool AssetStore::remove(u16 id)
+{
+        if (!storeMounted || !find(id))
+                return false;
+
+        char name[24];
+        path(id, name, sizeof(name));
+        indexRemove(id);
+        return LittleFS.remove(name);
+}
+
+/************************* path ********************************************
+ * File path of an asset: /assets/<id as 4 hex digits>.bin
+ ***************************************************************/
+void AssetStore::path(u16 id, char *buf, size_t len)
+{
+        snprintf(buf, len, "%s/%04x.bin", AssetConfig::DIR, id);
+}
+
+/************************* list ********************************************
+ * Print the index to Serial.
+ ***************************************************************/
+void AssetStore::list()
+{
+        Serial.printf("Assets (%u):\n", assetCount);
+        for (u8 i = 0; i < assetCount; i++)
+        {
+                const AssetInfo &a = assetIndex[i];
+                Serial.printf("  0x%04x type=%u size=%lu crc=%08lx\n", a.id, a.type,
+                              (unsigned long)a.size, (unsigned long)a.crc);
+        }
+}
+
+//============================================================================
+// UPLOAD
+//============================================================================
+
+/************************* uploadBegin *************************************
+ * Start receiving an asset into the temp file (aborts any upload in progress).
+ * @param id Asset ID (replaces an existing asset on commit).
+ * @param type AssetType of the payload.
+ * @param size Payload bytes that will follow.
+ * @param crc CRC-32 of the payload.
+ ***************************************************************/
+bool AssetStore::uploadBegin(u16 id, AssetType type, u32 size, u32 crc)
+{
+        uploadAbort();
+
+        if (!storeMounted || type == ASSET_NONE || size == 0 || size > AssetConfig::MAX_SIZE)
+                return false;
+
+        // Room for the new copy while the old one still exists
+        if (size + sizeof(AssetHeader) > freeBytes())
+        {
+                Serial.println("Assets: not enough space for upload");
+                return false;
+        }
+
+        uploadFile = LittleFS.open(AssetConfig::UPLOAD_PATH, FILE_WRITE);
+        if (!uploadFile)
+                return false;
+
+        uploadHeader.magic = AssetConfig::MAGIC;
+        uploadHeader.id = id;
+        uploadHeader.type = type;
+        uploadHeader.version = AssetConfig::VERSION;
+        uploadHeader.size = size;
+        uploadHeader.crc = crc;
+
+        if (uploadFile.write((const u8 *)&uploadHeader, sizeof(uploadHeader)) != sizeof(uploadHeader))
+        {
+                uploadAbort();
+                return false;
+        }
+
+        uploadActive = true;
+        uploadPos = 0;
+        uploadCrc = 0;
+        return true;
+}
+
+/************************* uploadWrite *************************************
+ * Append payload bytes. Only the next expected offset is accepted, so a
+ * lost or repeated frame is caught instead of corrupting the file.
+ ***************************************************************/
+bool AssetStore::uploadWrite(u32 offset, const u8 *data, u8 len)
+{
+        if (!uploadActive || offset != uploadPos || len == 0 || uploadPos + len > uploadHeader.size)
+                return false;
+
+        if (uploadFile.write(data, len) != len)
+        {
+                uploadAbort();
+                return false;
+        }
+
+        uploadCrc = esp_rom_crc32_le(uploadCrc, data, len);
+        uploadPos += len;
+        return true;
+}
+
+/************************* uploadCommit ************************************
+ * Verify size and CRC, then move the temp file into place and index it.
+ ***************************************************************/
+bool AssetStore::uploadCommit()
+{
+        if (!uploadActive)
+                return false;
+
+        if (uploadPos != uploadHeader.size || uploadCrc != uploadHeader.crc)
+        {
+                Serial.println("Assets: upload size/CRC mismatch");
+                uploadAbort();
+                return false;
+        }
+
+        uploadFile.close();
+        uploadActive = false;
+
+        // rename() replaces an existing asset in one step: if it fails, the
+        // old file and its index entry are still there
+        char name[24];
+        path(uploadHeader.id, name, sizeof(name));
+        if (!LittleFS.rename(AssetConfig::UPLOAD_PATH, name))
+        {
+                Serial.println("Assets: rename failed, previous asset kept");
+                LittleFS.remove(AssetConfig::UPLOAD_PATH);
+                return false;
+        }
+
+        if (!indexPut(uploadHeader))
+        {
+                LittleFS.remove(name);
+                Serial.println("Assets: index full");
+                return false;
+        }
+
+        Serial.printf("Assets: stored 0x%04x (%lu bytes)\n", uploadHeader.id, (unsigned long)uploadHeader.size);
+        return true;
+}
+
+/************************* uploadAbort *************************************
+ * Drop an upload in progress and its temp file.
+ ***************************************************************/
+void AssetStore::uploadAbort()
+{
+        if (uploadFile)
+                uploadFile.close();
+
+        if (uploadActive || (storeMounted && LittleFS.exists(AssetConfig::UPLOAD_PATH)))
+                LittleFS.remove(AssetConfig::UPLOAD_PATH);
+
+        uploadActive = false;
+        uploadPos = 0;
+}
+
+/************************* isUploading / uploadOffset **********************
+ * Upload progress (offset = next payload byte expected).
+ ***************************************************************/
+bool AssetStore::isUploading()
+{
+        return uploadActive;
+}
+
+u32 AssetStore::uploadOffset()
+{
+        return uploadPos;
+}
+
+//============================================================================
+// ASSET READER
+//============================================================================
+
+/************************* AssetReader *************************************
+ * Construct a closed reader.
+ ***************************************************************/
+AssetReader::AssetReader()
+    : m_open(false),
+      m_size(0),
+      m_windowStart(0),
+      m_windowLen(0)
+{
+}
+
+/************************* open ********************************************
+ * Open an indexed asset and check its header and type.
+ ***************************************************************/
+bool AssetReader::open(u16 id, AssetType type)
+{
+        close();
+
+        const AssetInfo *info = AssetStore::find(id);
+        if (!info || info->type != type)
+                return false;
+
+        char name[24];
+        AssetStore::path(id, name, sizeof(name));
+        m_file = LittleFS.open(name, FILE_READ);
+        if (!m_file)
+                return false;
+
+        AssetHeader header;
+        if (!readHeader(m_file, header) || header.id != id || header.type != type)
+        {
+                m_file.close();
+                return false;
+        }
+
+        m_open = true;
+        m_size = header.size;
+        m_windowStart = 0;
+        m_windowLen = 0;
+        return true;
+}
+
+/************************* close *******************************************
+ * Release the file handle.
+ ***************************************************************/
+void AssetReader::close()
+{
+        if (m_open)
+                m_file.close();
+        m_open = false;
+        m_size = 0;
+        m_windowLen = 0;
+}
+
+/************************* read ********************************************
+ * Read payload bytes straight into dst (bypasses the window).
+ ***************************************************************/
+bool AssetReader::read(u32 offset, void *dst, u32 len)
+{
+        if (!m_open || offset + len > m_size)
+                return false;
+
+        if (!m_file.seek(sizeof(AssetHeader) + offset))
+                return false;
+        return m_file.read((u8 *)dst, len) == len;
+}
+
+/************************* window ******************************************
+ * Expose the buffered chunk holding a payload offset.
+ * Reloads a full chunk only when the offset leaves the current one.
+ ***************************************************************/
+bool AssetReader::window(u32 offset, const u8 *&p, const u8 *&end)
+{
+        if (!m_open || offset >= m_size)
+                return false;
+
+        if (offset - m_windowStart >= m_windowLen)
+        {
+                u32 len = m_size - offset;
+                if (len > AssetConfig::CHUNK_SIZE)
+                        len = AssetConfig::CHUNK_SIZE;
+
+                m_windowLen = 0;
+                if (!read(offset, m_window, len))
+                        return false;
+                m_windowStart = offset;
+                m_windowLen = (u16)len;
+        }
+
+        p = m_window + (offset - m_windowStart);
+        end = m_window + m_windowLen;
+        return true;
+}
@@ -0,0 +1,439 @@
+/************************* compositor.cpp ***********************
+ * Layered pixel compositor implementation
+ * Layer storage, packed-word blending and render to PixelStrip
+ * Created by MSK, November 2025
+ * Blends operate on two channels per multiply (R|B lanes, then G)
+ ***************************************************************/
+
+#include "compositor.h"
+#include "animation.h"
+#include "watchdog.h"
+#include "colors.h"
+#include <Arduino.h>
+
+//============================================================================
+// PACKED BLEND OPERATIONS
+//============================================================================
+
+// 0x00RRGGBB split into two 16-bit-lane words: R and B share one, G the other.
+// Each lane has 8 spare bits above the channel for carries and borrows.
+constexpr u32 LANES_RB = 0x00FF00FF;
+constexpr u32 LANES_G = 0x0000FF00;
+constexpr u32 CARRY_RB = 0x01000100; // Bit above each R/B channel
+constexpr u32 CARRY_G = 0x00010000;  // Bit above G
+
+static inline u32 blendOver(u32 dst, u32 src)
+{
+        (void)dst;
+        return src;
+}
+
+/************************* blendAdd ****************************************
+ * Saturating per-channel add: a lane carry is smeared to 0xFF.
+ ***************************************************************/
+static inline u32 blendAdd(u32 dst, u32 src)
+{
+        u32 rb = (dst & LANES_RB) + (src & LANES_RB);
+        u32 g = (dst & LANES_G) + (src & LANES_G);
+        rb |= ((rb & CARRY_RB) >> 8) * 0xFF;
+        g |= ((g & CARRY_G) >> 8) * 0xFF;
+        return (rb & LANES_RB) | (g & LANES_G);
+}
+
+/************************* blendMax ****************************************
+ * Per-channel maximum: the guard bit survives (dst | guard) - src only
+ * where dst >= src, giving a select mask per lane.
+ ***************************************************************/
+static inline u32 blendMax(u32 dst, u32 src)
+{
+        u32 rb = ((dst & LANES_RB) | CARRY_RB) - (src & LANES_RB);
+        u32 g = ((dst & LANES_G) | CARRY_G) - (src & LANES_G);
+        u32 keep = (((rb & CARRY_RB) >> 8) | ((g & CARRY_G) >> 8)) * 0xFF;
+        return (dst & keep) | (src & ~keep & 0x00FFFFFF);
+}
+
+/************************* blendMultiply ***********************************
+ * Per-channel dst * src / 256 (src 255 keeps dst). The multiplier differs
+ * per lane, so this one works channel by channel.
+ ***************************************************************/
+static inline u32 blendMultiply(u32 dst, u32 src)
+{
+        u32 r = (((dst >> 16) & 0xFF) * (((src >> 16) & 0xFF) + 1)) >> 8;
+        u32 g = (((dst >> 8) & 0xFF) * (((src >> 8) & 0xFF) + 1)) >> 8;
+        u32 b = ((dst & 0xFF) * ((src & 0xFF) + 1)) >> 8;
+        return (r << 16) | (g << 8) | b;
+}
+
+/************************* blendLoop ***************************************
+ * One layer row with the blend op inlined (no per-pixel mode switch).
+ ***************************************************************/
+template <u32 (*Op)(u32, u32)>
+static void blendLoop(u32 *dst, const u32 *src, const u8 *mask, u16 count, u32 alpha)
+{
+        for (u16 i = 0; i < count; i++)
+        {
+                if (mask && !(mask[i >> 3] & (1 << (i & 7))))
+                        continue;
+
+                u32 blended = Op(dst[i], src[i]);
+                dst[i] = (alpha == 256) ? blended : colorLerp(dst[i], blended, alpha);
+        }
+}
+
+//============================================================================
+// CONSTRUCTOR & SETUP
+//============================================================================
+
+/************************* Compositor constructor **************************
+ * No layers until begin().
+ ***************************************************************/
+Compositor::Compositor(PixelStrip *pixels)
+    : m_pixels(pixels), m_layerCount(0), m_count(0), m_changed(false), m_updating(false), m_wake(nullptr)
+{
+        for (u8 i = 0; i < CompositorConfig::MAX_LAYERS; i++)
+                m_layers[i] = {nullptr, nullptr, nullptr, 255, BLEND_OVER};
+}
+
+/************************* Compositor destructor ***************************
+ * Release layers (sources fall back to the strip).
+ ***************************************************************/
+Compositor::~Compositor()
+{
+        end();
+}
+
+/************************* begin *******************************************
+ * Allocate the layers at the strip's logical size.
+ ***************************************************************/
+bool Compositor::begin(u8 layerCount)
+{
+        end();
+
+        if (layerCount == 0 || layerCount > CompositorConfig::MAX_LAYERS)
+                return false;
+
+        m_count = m_pixels->getCount();
+        for (u8 i = 0; i < layerCount; i++)
+        {
+                m_layers[i].pixels = new u32[m_count];
+                memset(m_layers[i].pixels, 0, (size_t)m_count * sizeof(u32));
+        }
+
+        m_layerCount = layerCount;
+        markChanged();
+        return true;
+}
+
+/************************* end *********************************************
+ * Detach sources and free layer storage.
+ ***************************************************************/
+void Compositor::end()
+{
+        for (u8 i = 0; i < CompositorConfig::MAX_LAYERS; i++)
+        {
+                CompositorLayer &l = m_layers[i];
+                if (l.source)
+                        l.source->setLayer(nullptr, 0);
+
+                delete[] l.pixels;
+                delete[] l.mask;
+                l = {nullptr, nullptr, nullptr, 255, BLEND_OVER};
+        }
+        m_layerCount = 0;
+}
+
+/************************* markChanged *************************************
+ * Flag a render and wake the owner's frame task, except while update() is
+ * running the sources (it renders right after).
+ ***************************************************************/
+void Compositor::markChanged()
+{
+        m_changed = true;
+        if (m_wake && !m_updating)
+                m_wake();
+}
+
+/************************* layer *******************************************
+ * Layer by index, or nullptr if not allocated.
+ ***************************************************************/
+CompositorLayer *Compositor::layer(u8 index)
+{
+        return index < m_layerCount ? &m_layers[index] : nullptr;
+}
+
+//============================================================================
+// LAYER DRAWING & PROPERTIES
+//============================================================================
+
+/************************* setColor ****************************************
+ * Set one pixel of a layer (packed 0x00RRGGBB).
+ ***************************************************************/
+void Compositor::setColor(u8 layerIndex, u16 index, u32 color)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l || index >= m_count || l->pixels[index] == color)
+                return;
+
+        l->pixels[index] = color;
+        markChanged();
+}
+
+/************************* getColor ****************************************
+ * Read one pixel of a layer (0 if out of range).
+ ***************************************************************/
+u32 Compositor::getColor(u8 layerIndex, u16 index) const
+{
+        if (layerIndex >= m_layerCount || index >= m_count)
+                return 0;
+
+        return m_layers[layerIndex].pixels[index];
+}
+
+/************************* fill ********************************************
+ * Set every pixel of a layer.
+ ***************************************************************/
+void Compositor::fill(u8 layerIndex, u32 color)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l)
+                return;
+
+        for (u16 i = 0; i < m_count; i++)
+                l->pixels[i] = color;
+        markChanged();
+}
+
+/************************* setOpacity **************************************
+ * Layer opacity (0 = hidden, 255 = opaque).
+ ***************************************************************/
+void Compositor::setOpacity(u8 layerIndex, u8 opacity)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l || l->opacity == opacity)
+                return;
+
+        l->opacity = opacity;
+        markChanged();
+}
+
+/************************* setBlendMode ************************************
+ * How the layer combines with the result of the layers below.
+ ***************************************************************/
+void Compositor::setBlendMode(u8 layerIndex, BlendMode mode)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l || l->mode == mode)
+                return;
+
+        l->mode = mode;
+        markChanged();
+}
+
+/************************* setSource ***************************************
+ * Attach an animation; it draws into this layer from now on.
+ ***************************************************************/
+void Compositor::setSource(u8 layerIndex, Animation *source)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l)
+                return;
+
+        if (l->source)
+                l->source->setLayer(nullptr, 0);
+
+        l->source = source;
+        if (source)
+        {
+                source->setLayer(this, layerIndex);
+                if (m_wake)
+                        source->setWakeCallback(m_wake); // start() schedules update()
+        }
+        markChanged();
+}
+
+/************************* pauseSources ************************************
+ * Pause every running layer source; the layers keep their last frame.
+ ***************************************************************/
+void Compositor::pauseSources()
+{
+        for (u8 i = 0; i < m_layerCount; i++)
+        {
+                if (m_layers[i].source && m_layers[i].source->isActive())
+                        m_layers[i].source->pause();
+        }
+}
+
+/************************* setMask *****************************************
+ * Show or hide one pixel of the layer.
+ ***************************************************************/
+void Compositor::setMask(u8 layerIndex, u16 index, bool visible)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l || index >= m_count)
+                return;
+
+        if (!l->mask)
+        {
+                size_t bytes = ((size_t)m_count + 7) / 8;
+                l->mask = new u8[bytes];
+                memset(l->mask, 0xFF, bytes);
+        }
+
+        if (visible)
+                l->mask[index >> 3] |= (1 << (index & 7));
+        else
+                l->mask[index >> 3] &= ~(1 << (index & 7));
+        markChanged();
+}
+
+/************************* clearMask ***************************************
+ * Whole layer visible again.
+ ***************************************************************/
+void Compositor::clearMask(u8 layerIndex)
+{
+        CompositorLayer *l = layer(layerIndex);
+        if (!l || !l->mask)
+                return;
+
+        delete[] l->mask;
+        l->mask = nullptr;
+        markChanged();
+}
+
+//============================================================================
+// FRAME
+//============================================================================
+
+/************************* update ******************************************
+ * Advance every layer source, then render the result.
+ ***************************************************************/
+u32 Compositor::update()
+{
+        u32 next = 0;
+        m_updating = true;
+        for (u8 i = 0; i < m_layerCount; i++)
+        {
+                if (!m_layers[i].source)
+                        continue;
+
+                u32 period = m_layers[i].source->update();
+                if (period && (!next || period < next))
+                        next = period;
+        }
+        m_updating = false;
+
+        render();
+        return next;
+}
+
+/************************* render ******************************************
+ * Blend layers bottom-up over black into a scratch row, then hand the
+ * row to the strip (unchanged pixels stay clean there). Pixels that are
+ * fading are left to the fade; setColor() would cancel it.
+ ***************************************************************/
+void Compositor::render()
+{
+        if (!m_changed || !m_layerCount)
+                return;
+        m_changed = false;
+
+        // Scratch row on the stack, chunked so large strips need no extra heap
+        constexpr u16 CHUNK = 64;
+        u32 row[CHUNK];
+
+        for (u16 base = 0; base < m_count; base += CHUNK)
+        {
+                u16 n = (m_count - base < CHUNK) ? m_count - base : CHUNK;
+                memset(row, 0, sizeof(row));
+
+                for (u8 i = 0; i < m_layerCount; i++)
+                {
+                        const CompositorLayer &l = m_layers[i];
+                        if (l.opacity == 0)
+                                continue;
+
+                        // Mask bytes stay aligned: CHUNK is a multiple of 8
+                        const u8 *mask = l.mask ? l.mask + base / 8 : nullptr;
+                        blendRow(row, l.pixels + base, mask, n, l.mode, l.opacity);
+                }
+
+                for (u16 j = 0; j < n; j++)
+                {
+                        if (!m_pixels->isFading(base + j))
+                                m_pixels->setColor(base + j, row[j]);
+                }
+        }
+
+        m_pixels->applyBuffer();
+}
+
+/************************* blendRow ****************************************
+ * Blend one row of a layer onto dst.
+ * @param opacity 0-255, mapped to 0-256 so 255 is exact.
+ ***************************************************************/
+void Compositor::blendRow(u32 *dst, const u32 *src, const u8 *mask, u16 count, BlendMode mode, u8 opacity)
+{
+        u32 alpha = (u32)opacity + (opacity >> 7);
+
+        switch (mode)
+        {
+        case BLEND_ADD:
+                blendLoop<blendAdd>(dst, src, mask, count, alpha);
+                break;
+        case BLEND_MULTIPLY:
+                blendLoop<blendMultiply>(dst, src, mask, count, alpha);
+                break;
+        case BLEND_MAX:
+                blendLoop<blendMax>(dst, src, mask, count, alpha);
+                break;
+        case BLEND_OVER:
+        default:
+                blendLoop<blendOver>(dst, src, mask, count, alpha);
+                break;
+        }
+}
+
+//============================================================================
+// DIAGNOSTICS
+//============================================================================
+
+/************************* benchmark ***************************************
+ * Per-pixel cost of each blend mode, opaque and at half opacity.
+ * @param count Pixels per timed row.
+ ***************************************************************/
+void Compositor::benchmark(u16 count)
+{
+        static const char *const kNames[] = {"over", "add", "multiply", "max"};
+
+        u32 *dst = new u32[count];
+        u32 *src = new u32[count];
+        u32 seed = 0x2545F491;
+        for (u16 i = 0; i < count; i++)
+        {
+                seed = seed * 1664525 + 1013904223;
+                src[i] = seed & 0x00FFFFFF;
+        }
+
+        Serial.println("\n=== Compositor Benchmark ===");
+        for (u8 mode = BLEND_OVER; mode <= BLEND_MAX; mode++)
+        {
+                u32 ns[2];
+                const u8 opacities[2] = {255, 128};
+                for (u8 k = 0; k < 2; k++)
+                {
+                        for (u16 i = 0; i < count; i++)
+                                dst[i] = src[count - 1 - i];
+
+                        u32 start = micros();
+                        blendRow(dst, src, nullptr, count, (BlendMode)mode, opacities[k]);
+                        ns[k] = (micros() - start) * 1000 / count;
+                }
+                Watchdog::reset();
+                Serial.printf("[CMP] %-8s %4lu ns/px opaque, %4lu ns/px at 50%%\n",
+                              kNames[mode], (unsigned long)ns[0], (unsigned long)ns[1]);
+        }
+        Serial.println("=== Compositor Benchmark Complete ===\n");
+
+        delete[] dst;
+        delete[] src;
+}
@@ -16,13 +16,17 @@
 #include "ioexpander.h"
 #include <Wire.h>
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "probe.h"
+#include "assetstore.h"
+#include "glyph.h"
+#include "puzzlevm.h"
 
 // Timer ISR interval configuration (defined in main.cpp)
 extern const u8 ISR_INTERVAL_MS;
-extern const u8 ANIM_REFRESH_MS;
-extern volatile bool pixelUpdateFlag;
 
-// Timer ISR: refresh button logic and trigger pixel updates (defined in main.cpp)
+// Timer ISR: refresh button logic and wake the input task (defined in main.cpp)
 extern void IRAM_ATTR refreshTimer();
 
 //============================================================================
@@ -50,6 +54,15 @@ namespace TypeLimits
         constexpr u8 INVALID_TYPE = 0xFF;   // Marker for invalid/disconnected
 }
 
+// Scheduler task periods (animation sets its own from Animation::update())
+namespace TaskTiming
+{
+        constexpr u32 INPUT_MS = KeypadConfig::SCAN_RATE_MS; // Keypad scan rate
+        constexpr u32 BUS_RX_FALLBACK_MS = 20;               // Poll in case a UART wakeup is missed
+        constexpr u32 STATUS_MS = 20;                        // Status LED pattern resolution
+        constexpr u32 APP_MS = 10;                           // App loop() rate
+}
+
 // Type detection mode timing
 namespace DetectionTiming
 {
@@ -109,6 +122,12 @@ Core::Core(PixelStrip *pixels, Synth *synth, Animation *animation,
       m_ioExpander(ioExpander),
       m_matrixPanel(new MatrixPanel(pixels)), // Initialize matrix panel
       m_app(nullptr),
+      m_expanderBus(&Wire, ioExpander),
+      m_motors(ioExpander),
+      m_compositor(pixels),
+      m_inputPeriodMs(0),
+      m_motorPeriodMs(0),
+      m_animPeriodMs(0),
       m_mode(MODE_INTERACTIVE),
       m_colorIndex(0),
       m_address(0),
@@ -124,6 +143,10 @@ Core::Core(PixelStrip *pixels, Synth *synth, Animation *animation,
       m_typeBeforeCalibration(0) // Will be set when entering calibration
 {
         s_instance = this;
+        resetLoopStats();
+#ifdef ENABLE_PROBES
+        m_lastProbeDump = 0;
+#endif
 
         // Initialize keypad LED states to off
         for (int i = 0; i < 16; i++)
@@ -149,19 +172,30 @@ void Core::begin()
         // Disable I2C error logging to reduce Serial spam
         esp_log_level_set("i2c", ESP_LOG_NONE);
 
-        // Initialize I2C for I/O Expander
-        Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+        // Initialize I2C for I/O Expander (fast mode; expander falls back if needed)
+        Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2CConfig::FAST_HZ);
 
-        // Initialize I/O Expander
+        // Discover I/O Expanders (0x20-0x27); the primary one carries keypad + motors by default.
+        // Motor pins are cleared in assignExpanders(), once the device type names the motor expander.
+        m_expanderBus.discover();
         bool i2cOk = false;
-        if (m_ioExpander->begin())
+        if (m_ioExpander->isPresent())
         {
-                m_ioExpander->stopAllMotors();
                 i2cOk = true;
+#ifdef ENABLE_PROBES
+                m_ioExpander->benchmarkScan();
+#endif
         }
 
-        // Initialize pixel strip
-        m_pixels->begin();
+        // Hot-path benchmarks (before the scheduler starts)
+#ifdef ENABLE_PROBES
+        m_pixels->benchmark();
+        Compositor::benchmark();
+        Shader::benchmark();
+        SegmentDisplay::benchmark();
+        PuzzleVM::benchmark();
+#endif
+        // The pixel strip is sized and started in init(), once the device type is known
 
         // Initialize button handling (single button now)
         initButtons(BTN_1_PIN);
@@ -179,11 +213,30 @@ void Core::begin()
         // Initialize RS-485 communication for Room Bus
         m_roomBus->begin();
 
+        // Mount the asset store (animations/songs by ID, uploads over the bus)
+        AssetStore::begin();
+
         // Initialize core firmware modules
         m_animation->init();    // Animation system
         m_inputManager->init(); // Input management for keypad and switches
         init();                 // Core firmware logic
 
+        // Start the cooperative scheduler on this (loop) task
+        registerTasks();
+        m_scheduler.begin();
+        m_roomBus->setReceiveCallback(onBusReceive);
+        m_motors.setWakeCallback(onMotorWake);
+        m_animation->setWakeCallback(onAnimationWake);
+        m_pixels->setWakeCallback(onAnimationWake); // Fades run in the animation task
+        m_compositor.setWakeCallback(onAnimationWake); // Layers render in the animation task
+
+        // Keypad: park the matrix and wake on the expander INT line
+        // (INT follows the keypad expander assigned at boot)
+        if (m_inputManager->getExpander()->isPresent() && KeypadConfig::USE_INTERRUPT)
+        {
+                m_inputManager->getExpander()->enableInterrupt(IO_EXPANDER_INT_PIN, onKeypadInterrupt);
+        }
+
         // Set status LED based on I2C health
         if (!i2cOk)
         {
@@ -196,6 +249,11 @@ void Core::begin()
 
         // Print comprehensive boot report
         printBootReport();
+
+#ifdef ENABLE_PROBES
+        // Start the probe window after boot so setup time is not counted
+        Probe::reset();
+#endif
 }
 
 /************************* init ***********************************
@@ -236,6 +294,12 @@ void Core::init()
         }
         m_type = (DeviceType)typeVal;
 
+        // Size the pixel strip for this device type before anything draws
+        u16 cells = DeviceConfigurations::getCellCount(m_type);
+        if (cells)
+                m_pixels->setCount(cells);
+        m_pixels->begin();
+
         // 2. Load Device Address (Room Setup)
         m_address = loadAddress();
         if (m_address == 0xFF)
@@ -243,22 +307,12 @@ void Core::init()
                 m_address = ADDR_UNASSIGNED; // 0x00
         }
 
-        // Initialize Application
-        m_app = AppBase::create(m_type);
-        if (m_app)
-        {
-                AppContext context = {
-                    m_pixels,
-                    m_synth,
-                    m_animation,
-                    m_inputManager,
-                    m_roomBus,
-                    m_ioExpander,
-                    m_matrixPanel,
-                    &m_address,
-                    &m_type};
-                m_app->setup(context);
-        }
+        // Route keypad and motors to the expanders this device type uses
+        assignExpanders();
+
+        // Core Room Bus commands, then the Application (registers its own)
+        registerCommands();
+        startApp();
 
         // Send HELLO to server
         sendHello();
@@ -269,49 +323,272 @@ void Core::init()
 
 /************************* update ***********************************
  * Main loop update function.
- * Polls inputs, updates status LED, handles RoomBus commands, and updates the active App.
+ * Runs every due or triggered task (input, bus RX, status LED, app,
+ * motors, animation), flushes expander outputs once, then sleeps until the
+ * earliest deadline or a notification.
  ***************************************************************/
 void Core::update()
 {
-        // Poll inputs
-        m_inputManager->poll();
+        // Wake period telemetry (two cycle-counter reads, no allocation)
+        recordLoopTiming();
 
-        // Update type detection mode if active
-        if (m_mode == MODE_TYPE_DETECTION)
         {
-                updateTypeDetectionMode();
+                PROBE_SCOPE(PROBE_CORE_UPDATE); // Busy time only, not the sleep
+
+#ifdef ENABLE_PROBES
+                // Periodic probe report on the debug console
+                if (ProbeConfig::DUMP_INTERVAL_MS && millis() - m_lastProbeDump >= ProbeConfig::DUMP_INTERVAL_MS)
+                {
+                        m_lastProbeDump = millis();
+                        Probe::dump();
+                        Probe::reset();
+                }
+#endif
+
+                // Expander I/O: fresh input snapshot per pass, one coalesced write at the end
+                m_expanderBus.beginCycle();
+                m_scheduler.runDue();
+                m_expanderBus.flush();
         }
 
-        // Update status LED
-        updateStatusLed();
+        m_scheduler.waitForWork();
+}
+
+//============================================================================
+// SCHEDULER TASKS
+//============================================================================
+
+/************************* registerTasks ***********************************
+ * Registers the core tasks with the scheduler.
+ * Bus RX is woken by the UART receive callback and keeps a slow poll as backup.
+ ***************************************************************/
+void Core::registerTasks()
+{
+        m_inputPeriodMs = TaskTiming::INPUT_MS;
+        m_scheduler.setTask(TASK_INPUT, "input", taskInput, this, m_inputPeriodMs);
+        m_scheduler.setTask(TASK_BUS_RX, "bus", taskBusRx, this, TaskTiming::BUS_RX_FALLBACK_MS);
+        m_scheduler.setTask(TASK_STATUS, "status", taskStatus, this, TaskTiming::STATUS_MS);
+        m_scheduler.setTask(TASK_APP, "app", taskApp, this, TaskTiming::APP_MS);
+        m_scheduler.setTask(TASK_MOTOR, "motor", taskMotor, this, 0); // Woken by motor commands
+        m_animPeriodMs = m_pixels->isDithering() ? PixelConfig::DITHER_REFRESH_MS : 0;
+        m_scheduler.setTask(TASK_ANIMATION, "anim", taskAnimation, this, m_animPeriodMs); // Also woken by animation/fade start
+}
+
+/************************* taskInput ***********************************
+ * Polls buttons and keypad; events are dispatched synchronously.
+ * While the keypad is parked on INT the task only needs the idle safety
+ * poll rate; key and button activity wake it through notifications.
+ ***************************************************************/
+void Core::taskInput(void *ctx)
+{
+        Core *self = static_cast<Core *>(ctx);
+        self->m_inputManager->poll();
+
+        u32 period = self->m_inputManager->getExpander()->isKeypadIdle() ? KeypadConfig::IDLE_POLL_MS : TaskTiming::INPUT_MS;
+        if (period != self->m_inputPeriodMs)
+        {
+                self->m_inputPeriodMs = period;
+                self->m_scheduler.setPeriod(TASK_INPUT, period);
+        }
+}
 
-        // Check for Room Bus commands
+/************************* taskBusRx ***********************************
+ * Drains the UART and dispatches every complete Room Bus frame.
+ ***************************************************************/
+void Core::taskBusRx(void *ctx)
+{
+        Core *self = static_cast<Core *>(ctx);
         RoomFrame rxFrame;
-        if (m_roomBus->receiveFrame(&rxFrame))
+        while (self->m_roomBus->receiveFrame(&rxFrame))
         {
-                handleRoomBusFrame(rxFrame);
+                self->handleRoomBusFrame(rxFrame);
         }
+}
 
-        // Update Application
-        if (m_app && m_mode == MODE_INTERACTIVE)
+/************************* taskStatus ***********************************
+ * Updates the status LED and type detection mode (if active).
+ ***************************************************************/
+void Core::taskStatus(void *ctx)
+{
+        Core *self = static_cast<Core *>(ctx);
+        if (self->m_mode == MODE_TYPE_DETECTION)
+        {
+                self->updateTypeDetectionMode();
+        }
+        self->updateStatusLed();
+}
+
+/************************* taskApp ***********************************
+ * Runs the active App loop in interactive mode.
+ ***************************************************************/
+void Core::taskApp(void *ctx)
+{
+        Core *self = static_cast<Core *>(ctx);
+        if (self->m_app && self->m_mode == MODE_INTERACTIVE)
+        {
+                self->m_app->loop();
+        }
+}
+
+/************************* taskAnimation ***********************************
+ * Advances the running animation and pixel fades one frame and pushes
+ * them to the strip. Runs at the rate the animation asks for and goes back
+ * to event-only once nothing is animating (paused, stopped, one-shot
+ * finished), no fade is running and the strip is not dithering.
+ ***************************************************************/
+void Core::taskAnimation(void *ctx)
+{
+        Core *self = static_cast<Core *>(ctx);
+        // With layers, the compositor runs its sources and sends the blend
+        u32 period = self->m_compositor.isEnabled() ? self->m_compositor.update() : self->m_animation->update();
+
+        // Pixel fades (fadeTo) step after the frame; the animation and the
+        // compositor skip fading pixels, so a fade keeps them until it ends
+        if (self->m_pixels->isFading())
+        {
+                u32 fadePeriod = self->m_pixels->updateFades(); // 0 after the last step
+                self->m_pixels->applyBuffer();
+                if (fadePeriod && (!period || period > fadePeriod))
+                        period = fadePeriod;
+        }
+
+        // Temporal dithering re-sends even a static frame
+        if (self->m_pixels->isDithering())
         {
-                m_app->loop();
+                self->m_pixels->applyBuffer(); // No-op if update() just sent
+                if (!period || period > PixelConfig::DITHER_REFRESH_MS)
+                        period = PixelConfig::DITHER_REFRESH_MS;
+        }
+
+        if (period != self->m_animPeriodMs)
+        {
+                self->m_animPeriodMs = period;
+                self->m_scheduler.setPeriod(TASK_ANIMATION, period);
         }
 }
 
-/************************* refreshAnimations ***********************************
- * Updates the animation system.
- * @param flag Reference to the pixel update flag.
+/************************* taskMotor ***********************************
+ * Applies one PWM slice. Runs every MotorConfig::TICK_MS while a motor is
+ * active and goes back to event-only once all motors have stopped.
  ***************************************************************/
-void Core::refreshAnimations(volatile bool &flag)
+void Core::taskMotor(void *ctx)
 {
-        m_animation->refresh(flag);
+        Core *self = static_cast<Core *>(ctx);
+        self->m_motors.tick();
+
+        u32 period = self->m_motors.isActive() ? MotorConfig::TICK_MS : 0;
+        if (period != self->m_motorPeriodMs)
+        {
+                self->m_motorPeriodMs = period;
+                self->m_scheduler.setPeriod(TASK_MOTOR, period);
+        }
+}
+
+/************************* onMotorWake ***********************************
+ * Motor command issued (task context): start the motor task.
+ ***************************************************************/
+void Core::onMotorWake()
+{
+        if (s_instance)
+        {
+                s_instance->notify(TASK_MOTOR);
+        }
+}
+
+/************************* onAnimationWake ***********************************
+ * Animation started (task context): run the animation task.
+ ***************************************************************/
+void Core::onAnimationWake()
+{
+        if (s_instance)
+        {
+                s_instance->notify(TASK_ANIMATION);
+        }
+}
+
+/************************* onKeypadInterrupt ***********************************
+ * Expander INT ISR hook: wake the input task to start scanning.
+ ***************************************************************/
+void IRAM_ATTR Core::onKeypadInterrupt()
+{
+        if (s_instance)
+        {
+                s_instance->notifyFromISR(TASK_INPUT);
+        }
+}
+
+/************************* onBusReceive ***********************************
+ * UART receive callback (runs on the UART event task): wake bus RX.
+ ***************************************************************/
+void Core::onBusReceive()
+{
+        if (s_instance)
+        {
+                s_instance->notify(TASK_BUS_RX);
+        }
 }
 
 //============================================================================
 // CONFIGURATION
 //============================================================================
 
+/************************* assignExpanders ***********************************
+ * Points the keypad scanner and motor controller at the expander slots
+ * given by the device definition; absent slots fall back to the primary.
+ * Only the motor expander gets its P00-P07 driven LOW (coast): on the
+ * others those pins may be sensor inputs and stay HIGH.
+ ***************************************************************/
+void Core::assignExpanders()
+{
+        IOExpander *keypad = m_expanderBus.get(DeviceConfigurations::getKeypadExpander(m_type));
+        IOExpander *motors = m_expanderBus.get(DeviceConfigurations::getMotorExpander(m_type));
+        if (!motors)
+                motors = m_ioExpander;
+
+        m_inputManager->setExpander(keypad ? keypad : m_ioExpander);
+        m_motors.setExpander(motors);
+        m_motors.stopAll(); // H-bridge inputs power up HIGH (brake)
+        motors->flush();
+}
+
+/************************* startApp ***********************************
+ * Creates and sets up the App for m_type. Device command handlers of a
+ * previous App are dropped first; the new App registers its own in setup().
+ * Commands the device catalog lists without a handler are reported.
+ ***************************************************************/
+void Core::startApp()
+{
+        m_commands.clear(SERVER_MIN, SERVER_MAX);
+
+        m_app = AppBase::create(m_type);
+        if (!m_app)
+                return;
+
+        AppContext context = {
+            m_pixels,
+            m_synth,
+            m_animation,
+            m_inputManager,
+            m_roomBus,
+            m_ioExpander,
+            &m_expanderBus,
+            m_matrixPanel,
+            &m_motors,
+            &m_compositor,
+            &m_address,
+            &m_type,
+            &m_commands};
+        m_app->setup(context);
+
+        CommandSet listed = DeviceConfigurations::getMergedCommandSet(m_type);
+        for (u8 i = 0; i < listed.count; i++)
+        {
+                if (!m_commands.has(listed.cmds[i]))
+                        Serial.printf("[CMD] 0x%02X listed for %s has no handler\n",
+                                      listed.cmds[i], getDeviceTypeName());
+        }
+}
+
 /************************* readDeviceType ***********************************
  * Reads the device type from the configuration potentiometer.
  * Uses averaging and noise detection for reliability.
@@ -831,7 +1108,7 @@ void Core::handleButton1Press()
         m_colorIndex = (m_colorIndex + 1) % kColorCount;
 
         // Create a rainbow pattern across the LEDs
-        for (int i = 0; i < m_pixels->getCount(); i++)
+        for (u16 i = 0; i < m_pixels->getCount(); i++)
         {
                 int idx = (m_colorIndex + i) % kColorCount;
                 m_pixels->setColor(i, kColors[idx]);
@@ -878,16 +1155,17 @@ void Core::handleKeypadPress(u8 keyIndex)
 {
         int note = kNoteMap[keyIndex];
 
-        /************************* handleRoomBusFrame ***********************************
-         * Handles incoming RoomBus frames.
-         * Filters by address and dispatches commands to Core or App.
-         * @param frame The received RoomFrame.
-         ***************************************************************/
         m_synth->setWaveform(WAVE_SINE);
         m_synth->setADSR(5, 50, 100, 100);
         m_synth->playNote(note, 150, 100);
 }
 
+/************************* handleRoomBusFrame ***********************************
+ * Handles incoming RoomBus frames.
+ * Filters by address and dispatches commands through m_commands.
+ * Commands without a handler are answered with EV_DEVICE_ERROR.
+ * @param frame The received RoomFrame.
+ ***************************************************************/
 void Core::handleRoomBusFrame(const RoomFrame &frame)
 {
         // Filter by address
@@ -913,42 +1191,15 @@ void Core::handleRoomBusFrame(const RoomFrame &frame)
         Serial.print(" Cmd_dev: 0x");
         Serial.println(frame.cmd_dev, HEX);
 
-        // 1. Handle Common Commands (Core Level)
-        switch (frame.cmd_srv)
-        {
-        case CORE_PING:
-                // Respond with PONG (or just ACK)
-                // TODO: Send ACK
-                Serial.println("-> PING received");
-                return; // Handled
+        if (frame.cmd_srv < CORE_MIN || frame.cmd_srv > SERVER_MAX)
+                return; // Not a command (e.g. another device's event)
 
-        case CORE_RESET:
-                Serial.println("-> RESET received. Rebooting...");
-                delay(100);
-                ESP.restart();
-                return; // Handled
-
-        case CORE_HELLO:
-                // Server saying hello? Usually device says hello.
-                return;
-
-        case CORE_SET_ADDRESS:
-                // Payload[0] = New Address
-                if (frame.p[0] != 0 && frame.p[0] != 0xFF)
-                {
-                        Serial.print("-> SET_ADDRESS received: ");
-                        Serial.println(frame.p[0]);
-                        m_address = frame.p[0];
-                        saveAddress(m_address);
-                        sendHello(); // Announce new address
-                }
-                return;
-        }
-
-        // 2. Pass to Application (Device Specific)
-        if (m_app)
+        // Core and App handlers share one table indexed by cmd_srv
+        if (!m_commands.dispatch(frame))
         {
-                m_app->handleCommand(frame);
+                Serial.println("-> Unsupported command");
+                if (frame.addr != ADDR_BROADCAST)
+                        sendDeviceError(DEVICE_ERROR_UNSUPPORTED, frame.cmd_srv);
         }
 }
 
@@ -1010,6 +1261,419 @@ void Core::sendHello()
         }
 }
 
+//============================================================================
+// ROOM BUS COMMANDS
+//============================================================================
+
+/************************* registerCommands ***********************************
+ * Registers the core command handlers (CORE_MIN..CORE_MAX).
+ ***************************************************************/
+void Core::registerCommands()
+{
+        m_commands.set(CORE_HELLO, cmdIgnore, this); // Server saying hello? Usually device says hello.
+        m_commands.set(CORE_ACK, cmdIgnore, this);
+        m_commands.set(CORE_PING, cmdPing, this);
+        m_commands.set(CORE_RESET, cmdReset, this);
+        m_commands.set(CORE_SET_ADDRESS, cmdSetAddress, this);
+        m_commands.set(CORE_STATS, cmdStats, this);
+#ifdef ENABLE_PROBES
+        m_commands.set(CORE_PROBE, cmdProbe, this);
+#endif
+        m_commands.set(CORE_ASSET, cmdAsset, this);
+        m_commands.set(CORE_FADE, cmdFade, this);
+}
+
+/************************* cmdIgnore ***********************************
+ * Accepts a command without doing anything (HELLO, ACK).
+ ***************************************************************/
+void Core::cmdIgnore(void *ctx, const RoomFrame &frame)
+{
+}
+
+/************************* cmdPing ***********************************
+ * CORE_PING.
+ ***************************************************************/
+void Core::cmdPing(void *ctx, const RoomFrame &frame)
+{
+        // Respond with PONG (or just ACK)
+        // TODO: Send ACK
+        Serial.println("-> PING received");
+}
+
+/************************* cmdReset ***********************************
+ * CORE_RESET: soft restart.
+ ***************************************************************/
+void Core::cmdReset(void *ctx, const RoomFrame &frame)
+{
+        Serial.println("-> RESET received. Rebooting...");
+        delay(100);
+        ESP.restart();
+}
+
+/************************* cmdSetAddress ***********************************
+ * CORE_SET_ADDRESS: p[0] = new address.
+ ***************************************************************/
+void Core::cmdSetAddress(void *ctx, const RoomFrame &frame)
+{
+        Core *self = static_cast<Core *>(ctx);
+        if (frame.p[0] != 0 && frame.p[0] != 0xFF)
+        {
+                Serial.print("-> SET_ADDRESS received: ");
+                Serial.println(frame.p[0]);
+                self->m_address = frame.p[0];
+                self->saveAddress(self->m_address);
+                self->sendHello(); // Announce new address
+        }
+}
+
+/************************* cmdStats ***********************************
+ * CORE_STATS: p[0] = page, p[1] = flags, p[2] = command (commands page).
+ ***************************************************************/
+void Core::cmdStats(void *ctx, const RoomFrame &frame)
+{
+        Core *self = static_cast<Core *>(ctx);
+        self->sendStats(frame.p[0], (frame.p[1] & STATS_FLAG_RESET) != 0, frame.p[2]);
+}
+
+#ifdef ENABLE_PROBES
+/************************* cmdProbe ***********************************
+ * CORE_PROBE: p[0] = probe id, p[1] = page, p[2] = flags.
+ ***************************************************************/
+void Core::cmdProbe(void *ctx, const RoomFrame &frame)
+{
+        Core *self = static_cast<Core *>(ctx);
+        self->sendProbe(frame.p[0], frame.p[1], (frame.p[2] & STATS_FLAG_RESET) != 0);
+}
+#endif
+
+/************************* cmdAsset ***********************************
+ * CORE_ASSET.
+ ***************************************************************/
+void Core::cmdAsset(void *ctx, const RoomFrame &frame)
+{
+        static_cast<Core *>(ctx)->handleAssetFrame(frame);
+}
+
+/************************* cmdFade ***********************************
+ * CORE_FADE.
+ ***************************************************************/
+void Core::cmdFade(void *ctx, const RoomFrame &frame)
+{
+        static_cast<Core *>(ctx)->handleFadeFrame(frame);
+}
+
+/************************* sendDeviceError ***********************************
+ * Sends EV_DEVICE_ERROR (layout next to EV_DEVICE_ERROR in roombus.h).
+ * @param error DEVICE_ERROR_* code.
+ * @param detail Error-specific byte (the command for DEVICE_ERROR_UNSUPPORTED).
+ ***************************************************************/
+void Core::sendDeviceError(u8 error, u8 detail)
+{
+        if (!m_roomBus)
+                return;
+
+        RoomFrame frame;
+        room_frame_init_device(&frame, EV_DEVICE_ERROR);
+        frame.p[0] = m_address;
+        frame.p[1] = error;
+        frame.p[2] = detail;
+        m_roomBus->sendFrame(&frame);
+}
+
+//============================================================================
+// RUNTIME TELEMETRY
+//============================================================================
+
+/************************* recordLoopTiming ***********************************
+ * Records the period since the previous update() call into the loop window.
+ * Uses the CPU cycle counter; periods are far below its ~26 s wrap time.
+ ***************************************************************/
+void Core::recordLoopTiming()
+{
+        u32 now = ESP.getCycleCount();
+        if (m_loopStats.lastCycles != 0)
+        {
+                u32 period = now - m_loopStats.lastCycles;
+                if (period < m_loopStats.minCycles)
+                        m_loopStats.minCycles = period;
+                if (period > m_loopStats.maxCycles)
+                        m_loopStats.maxCycles = period;
+                m_loopStats.sumCycles += period;
+                m_loopStats.count++;
+        }
+        m_loopStats.lastCycles = now;
+}
+
+/************************* resetLoopStats ***********************************
+ * Starts a new loop timing window (min/avg/max).
+ ***************************************************************/
+void Core::resetLoopStats()
+{
+        m_loopStats.lastCycles = 0;
+        m_loopStats.minCycles = 0xFFFFFFFF;
+        m_loopStats.maxCycles = 0;
+        m_loopStats.sumCycles = 0;
+        m_loopStats.count = 0;
+}
+
+/************************* sendStats ***********************************
+ * Replies to CORE_STATS with one page of runtime statistics.
+ * Layout is documented next to CORE_STATS in roombus.h.
+ * @param page STATS_PAGE_RUNTIME, STATS_PAGE_SYSTEM or STATS_PAGE_COMMANDS.
+ * @param resetWindow Start a new loop timing window after replying
+ *        (commands page: clear the command counters).
+ * @param command Command to report on the commands page.
+ ***************************************************************/
+void Core::sendStats(u8 page, bool resetWindow, u8 command)
+{
+        if (!m_roomBus)
+                return;
+
+        RoomFrame frame;
+        room_frame_init_device(&frame, CORE_STATS);
+        frame.p[0] = m_address;
+        frame.p[1] = page;
+
+        if (page == STATS_PAGE_RUNTIME)
+        {
+                // Convert cycle counts to microseconds, saturating at 16 bits
+                u32 cyclesPerUs = ESP.getCpuFreqMHz();
+                u32 minUs = 0;
+                u32 avgUs = 0;
+                u32 maxUs = 0;
+                if (m_loopStats.count > 0 && cyclesPerUs > 0)
+                {
+                        minUs = m_loopStats.minCycles / cyclesPerUs;
+                        avgUs = (u32)(m_loopStats.sumCycles / m_loopStats.count) / cyclesPerUs;
+                        maxUs = m_loopStats.maxCycles / cyclesPerUs;
+                }
+
+                room_put_u16(&frame.p[2], (minUs > 0xFFFF) ? 0xFFFF : (u16)minUs);
+                room_put_u16(&frame.p[4], (avgUs > 0xFFFF) ? 0xFFFF : (u16)avgUs);
+                room_put_u16(&frame.p[6], (maxUs > 0xFFFF) ? 0xFFFF : (u16)maxUs);
+                room_put_u16(&frame.p[8], m_synth ? m_synth->getIsrLoad() : 0);
+                room_put_u16(&frame.p[10], m_expanderBus.getI2cErrorCount());
+                room_put_u16(&frame.p[12], m_roomBus->getCrcErrors());
+                room_put_u16(&frame.p[14], m_roomBus->getDroppedBytes());
+                room_put_u32(&frame.p[16], m_loopStats.count);
+        }
+        else if (page == STATS_PAGE_SYSTEM)
+        {
+                room_put_u32(&frame.p[2], ESP.getFreeHeap());
+                room_put_u32(&frame.p[6], ESP.getMinFreeHeap());
+                room_put_u32(&frame.p[10], (u32)(esp_timer_get_time() / 1000000ULL));
+                frame.p[14] = (u8)esp_reset_reason();
+                room_put_u16(&frame.p[15], m_roomBus->getFrameCount());
+        }
+        else if (page == STATS_PAGE_COMMANDS)
+        {
+                const CommandStats *s = m_commands.getStats(command);
+                u32 cyclesPerUs = ESP.getCpuFreqMHz();
+                frame.p[2] = command;
+                if (s && s->hits > 0 && cyclesPerUs > 0)
+                {
+                        room_put_u32(&frame.p[3], s->hits);
+                        room_put_u32(&frame.p[7], (u32)(s->totalCycles / s->hits) / cyclesPerUs);
+                        room_put_u32(&frame.p[11], s->maxCycles / cyclesPerUs);
+                }
+                room_put_u32(&frame.p[15], m_commands.getUnsupportedCount());
+                frame.p[19] = m_commands.has(command) ? 1 : 0;
+        }
+
+        m_roomBus->sendFrame(&frame);
+
+        if (resetWindow)
+        {
+                if (page == STATS_PAGE_COMMANDS)
+                        m_commands.resetStats();
+                else
+                        resetLoopStats();
+        }
+}
+
+#ifdef ENABLE_PROBES
+/************************* sendProbe ***********************************
+ * Replies to CORE_PROBE with one probe's summary or histogram page.
+ * Layout is documented next to CORE_PROBE in roombus.h.
+ * @param id Probe slot (ProbeId).
+ * @param page PROBE_PAGE_SUMMARY or PROBE_PAGE_HISTOGRAM.
+ * @param resetAll Clear all probes after replying.
+ ***************************************************************/
+void Core::sendProbe(u8 id, u8 page, bool resetAll)
+{
+        if (!m_roomBus)
+                return;
+
+        RoomFrame frame;
+        room_frame_init_device(&frame, CORE_PROBE);
+        frame.p[0] = m_address;
+        frame.p[1] = id;
+        frame.p[2] = page;
+
+        const ProbeStats *s = Probe::get((ProbeId)id);
+        if (s && s->count > 0)
+        {
+                if (page == PROBE_PAGE_SUMMARY)
+                {
+                        room_put_u32(&frame.p[3], s->count);
+                        room_put_u32(&frame.p[7], s->minCycles);
+                        room_put_u32(&frame.p[11], (u32)(s->totalCycles / s->count));
+                        room_put_u32(&frame.p[15], s->maxCycles);
+                        frame.p[19] = (u8)ESP.getCpuFreqMHz();
+                }
+                else if (page == PROBE_PAGE_HISTOGRAM)
+                {
+                        for (u8 b = 0; b < ProbeConfig::HIST_BUCKETS; b++)
+                        {
+                                frame.p[3 + b] = (u8)(((uint64_t)s->hist[b] * 255) / s->count);
+                        }
+                        frame.p[19] = PROBE_COUNT;
+                }
+        }
+
+        m_roomBus->sendFrame(&frame);
+
+        if (resetAll)
+        {
+                Probe::reset();
+        }
+}
+#endif
+
+/************************* handleAssetFrame ***********************************
+ * Runs one CORE_ASSET op (upload, delete, info, play) against the AssetStore.
+ * Layout is documented next to CORE_ASSET in roombus.h.
+ * Accepted DATA frames are not answered to keep the bus free for the next one;
+ * broadcast frames are never answered.
+ ***************************************************************/
+void Core::handleAssetFrame(const RoomFrame &frame)
+{
+        const u8 op = frame.p[0];
+        const u16 id = room_get_u16(&frame.p[1]);
+        u8 status = ASSET_STATUS_OK;
+
+        switch (op)
+        {
+        case ASSET_OP_BEGIN:
+                if (!AssetStore::uploadBegin(id, (AssetType)frame.p[3],
+                                             room_get_u32(&frame.p[4]), room_get_u32(&frame.p[8])))
+                        status = ASSET_STATUS_ERROR;
+                break;
+
+        case ASSET_OP_DATA:
+        {
+                u8 len = frame.p[5] <= ASSET_DATA_MAX ? frame.p[5] : 0;
+                if (AssetStore::uploadWrite(room_get_u32(&frame.p[1]), &frame.p[6], len))
+                        return; // Accepted: stay quiet
+                status = AssetStore::isUploading() ? ASSET_STATUS_ERROR : ASSET_STATUS_NOT_FOUND;
+                break;
+        }
+
+        case ASSET_OP_COMMIT:
+                if (!AssetStore::isUploading())
+                        status = ASSET_STATUS_NOT_FOUND;
+                else if (!AssetStore::uploadCommit())
+                        status = ASSET_STATUS_ERROR;
+                break;
+
+        case ASSET_OP_ABORT:
+                AssetStore::uploadAbort();
+                break;
+
+        case ASSET_OP_DELETE:
+                if (!AssetStore::remove(id))
+                        status = ASSET_STATUS_NOT_FOUND;
+                break;
+
+        case ASSET_OP_INFO:
+                if (!AssetStore::find(id))
+                        status = ASSET_STATUS_NOT_FOUND;
+                break;
+
+        case ASSET_OP_PLAY:
+        {
+                const AssetInfo *info = AssetStore::find(id);
+                bool ok = false;
+                if (!info)
+                        status = ASSET_STATUS_NOT_FOUND;
+                else if (info->type == ASSET_PACKED_ANIMATION)
+                        ok = m_animation->startBitmap(id, frame.p[3] & ASSET_PLAY_LOOP);
+                else if (info->type == ASSET_SHADER)
+                        ok = m_animation->startShader(id);
+                if (info && !ok)
+                        status = ASSET_STATUS_ERROR; // Songs are played by the app's MusicPlayer
+                break;
+        }
+
+        default:
+                status = ASSET_STATUS_ERROR;
+                break;
+        }
+
+        if (frame.addr != ADDR_BROADCAST)
+        {
+                sendAssetReply(op, status, id);
+        }
+}
+
+/************************* handleFadeFrame ************************************
+ * Starts a CORE_FADE: one fade of a pixel range to a color, stepped by the
+ * animation task. A running animation (or the compositor's layer sources)
+ * is paused first so it does not redraw the pixels once the fade ends; the
+ * fade starts from the frame it left.
+ * Layout is documented next to CORE_FADE in roombus.h.
+ ***************************************************************/
+void Core::handleFadeFrame(const RoomFrame &frame)
+{
+        u32 color = ((u32)frame.p[0] << 16) | ((u32)frame.p[1] << 8) | frame.p[2];
+        u16 durationMs = room_get_u16(&frame.p[3]);
+        u16 first = room_get_u16(&frame.p[6]);
+        u16 count = room_get_u16(&frame.p[8]);
+
+        if (m_animation->isActive())
+        {
+                m_animation->pause();
+        }
+        m_compositor.pauseSources();
+
+        m_pixels->fadeRange(first, count ? count : 0xFFFF, color, durationMs, (FadeEasing)frame.p[5]);
+        m_pixels->applyBuffer(); // Instant changes (duration 0) go out now
+}
+
+/************************* sendAssetReply *************************************
+ * Replies to CORE_ASSET with the op status and upload progress.
+ * @param op ASSET_OP_* being answered.
+ * @param status ASSET_STATUS_*.
+ * @param id Asset ID from the request.
+ ***************************************************************/
+void Core::sendAssetReply(u8 op, u8 status, u16 id)
+{
+        if (!m_roomBus)
+                return;
+
+        RoomFrame frame;
+        room_frame_init_device(&frame, CORE_ASSET);
+        frame.p[0] = m_address;
+        frame.p[1] = op;
+        frame.p[2] = status;
+        room_put_u16(&frame.p[3], id);
+        room_put_u32(&frame.p[5], AssetStore::uploadOffset());
+        room_put_u32(&frame.p[9], AssetStore::freeBytes());
+
+        const AssetInfo *info = AssetStore::find(id);
+        if (op == ASSET_OP_INFO && info)
+        {
+                frame.p[13] = info->type;
+                room_put_u32(&frame.p[14], info->size);
+        }
+        if (op == ASSET_OP_INFO)
+        {
+                room_put_u16(&frame.p[18], AssetStore::count());
+        }
+
+        m_roomBus->sendFrame(&frame);
+}
+
 //============================================================================
 // STATUS LED CONTROL
 //============================================================================
@@ -1189,25 +1853,13 @@ void Core::exitTypeDetectionMode()
                 delete m_app;
                 m_app = nullptr;
         }
+        m_compositor.end(); // Layers belong to the old App
 
         Serial.print("Initializing App for type: ");
         Serial.println(getDeviceTypeName());
 
-        m_app = AppBase::create(m_type);
-        if (m_app)
-        {
-                AppContext context = {
-                    m_pixels,
-                    m_synth,
-                    m_animation,
-                    m_inputManager,
-                    m_roomBus,
-                    m_ioExpander,
-                    m_matrixPanel,
-                    &m_address,
-                    &m_type};
-                m_app->setup(context);
-        }
+        assignExpanders();
+        startApp();
 
         // Restore previous mode
         m_mode = m_previousMode;
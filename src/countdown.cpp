@@ -0,0 +1,148 @@
+/************************* countdown.cpp ***********************
+ * Countdown engine
+ * Drift-free room countdown on the esp_timer microsecond timebase
+ * Created by MSK, November 2025
+ * Server resyncs are slewed in, so the shown time never jumps
+ ***************************************************************/
+
+#include "countdown.h"
+#include "esp_timer.h"
+
+/************************* Countdown ***********************************
+ * Constructor. Starts paused at 0.
+ ***************************************************************/
+Countdown::Countdown()
+    : m_baseUs(0), m_baseTime(esp_timer_get_time()), m_pendingUs(0), m_running(false)
+{
+}
+
+/************************* remainingAt ***********************************
+ * Remaining time at `now`: the base minus elapsed time, plus the share of
+ * the pending correction slewed in so far.
+ * @param applied Receives that share (may be null)
+ ***************************************************************/
+int64_t Countdown::remainingAt(int64_t now, int64_t *applied) const
+{
+        int64_t slewed = 0;
+        int64_t remaining = m_baseUs;
+        if (m_running)
+        {
+                int64_t elapsed = now - m_baseTime;
+                int64_t budget = elapsed * CountdownConfig::SLEW_PERMILLE / 1000;
+                if (m_pendingUs > 0)
+                        slewed = m_pendingUs < budget ? m_pendingUs : budget;
+                else if (m_pendingUs < 0)
+                        slewed = -m_pendingUs < budget ? m_pendingUs : -budget;
+                remaining += slewed - elapsed;
+        }
+
+        if (applied)
+                *applied = slewed;
+        return remaining > 0 ? remaining : 0;
+}
+
+/************************* rebase ***********************************
+ * Fold the time elapsed since m_baseTime into the base values.
+ ***************************************************************/
+void Countdown::rebase(int64_t now)
+{
+        int64_t applied;
+        m_baseUs = remainingAt(now, &applied);
+        m_pendingUs -= applied;
+        m_baseTime = now;
+}
+
+/************************* set ***********************************
+ * Set the remaining time.
+ ***************************************************************/
+void Countdown::set(u32 ms)
+{
+        m_baseTime = esp_timer_get_time();
+        m_baseUs = (int64_t)ms * 1000;
+        m_pendingUs = 0;
+}
+
+/************************* add ***********************************
+ * Add or remove time, clamped at 0.
+ ***************************************************************/
+void Countdown::add(int32_t ms)
+{
+        rebase(esp_timer_get_time());
+        m_baseUs += (int64_t)ms * 1000;
+        if (m_baseUs < 0)
+                m_baseUs = 0;
+}
+
+/************************* start ***********************************
+ * Start or resume counting down.
+ ***************************************************************/
+void Countdown::start()
+{
+        if (m_running)
+                return;
+
+        m_baseTime = esp_timer_get_time();
+        m_running = m_baseUs > 0;
+}
+
+/************************* pause ***********************************
+ * Freeze the remaining time.
+ ***************************************************************/
+void Countdown::pause()
+{
+        if (!m_running)
+                return;
+
+        rebase(esp_timer_get_time());
+        m_running = false;
+}
+
+/************************* sync ***********************************
+ * Reconcile with the server's remaining time: slew small errors while
+ * running, apply big ones (or any while paused) directly.
+ ***************************************************************/
+void Countdown::sync(u32 ms)
+{
+        int64_t now = esp_timer_get_time();
+        rebase(now);
+
+        int64_t error = (int64_t)ms * 1000 - m_baseUs;
+        int64_t limit = (int64_t)CountdownConfig::SNAP_MS * 1000;
+        if (!m_running || error > limit || error < -limit)
+        {
+                m_baseUs = (int64_t)ms * 1000;
+                m_pendingUs = 0;
+        }
+        else
+        {
+                m_pendingUs = error;
+        }
+}
+
+/************************* remainingMs ***********************************
+ * Remaining time now, rounded up to whole ms.
+ ***************************************************************/
+u32 Countdown::remainingMs() const
+{
+        return (u32)((remainingAt(esp_timer_get_time(), nullptr) + 999) / 1000);
+}
+
+/************************* update ***********************************
+ * Stops the countdown when it reaches 0.
+ * @return true on the call that stopped it
+ ***************************************************************/
+bool Countdown::update()
+{
+        if (!m_running)
+                return false;
+
+        int64_t now = esp_timer_get_time();
+        if (remainingAt(now, nullptr) > 0)
+                return false;
+
+        m_baseUs = 0;
+        m_baseTime = now;
+        m_pendingUs = 0;
+        m_running = false;
+        return true;
+}
@@ -15,20 +15,25 @@
 // MASTER DEVICE LIST
 // =================================================================================
 // This is the only place you need to edit to add/change devices.
-// IDs must be unique. Order doesn't strictly matter, but keeping them sorted helps.
+// Entry n must be DeviceType n: lookups index the table directly, and the
+// static_asserts below reject gaps, duplicates and out-of-order entries.
+// The table is constexpr, so it lives in flash with no static-init code.
+// Every entry names every field (-Wmissing-field-initializers).
 // =================================================================================
 
-static const DeviceDefinition DEVICE_CATALOG[] = {
+static constexpr DeviceDefinition DEVICE_CATALOG[] = {
 
     // ID 0: Terminal
     {
         TERMINAL, "Terminal", {.cellCount = 16, .keyNames = {}, // Default names
                                .motorNames = {},
-                               .commands = makeCommandSet({TERM_RESET})}},
+                               .commands = makeCommandSet({TERM_RESET}),
+                               .keypadExpander = 0,
+                               .motorExpander = 0}},
 
     // ID 1: Glow Button
     {
-        GLOW_BUTTON, "GlowButton", {.cellCount = 1, .keyNames = {"Activate"}, .motorNames = {}, .commands = makeCommandSet({GLOW_SET_COLOR})}},
+        GLOW_BUTTON, "GlowButton", {.cellCount = 1, .keyNames = {"Activate"}, .motorNames = {}, .commands = makeCommandSet({GLOW_SET_COLOR}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 2: Num Box
     {
@@ -36,57 +41,97 @@ static const DeviceDefinition DEVICE_CATALOG[] = {
         {.cellCount = 264, // 4*6 of my 11segments
          .keyNames = {},
          .motorNames = {},
-         .commands = makeCommandSet({NUM_SET_DIGIT_COLOR, NUM_SET_DIGIT_VAL, NUM_SET_ROW_NUM})}},
+         .commands = makeCommandSet({NUM_SET_DIGIT_COLOR, NUM_SET_DIGIT_VAL, NUM_SET_ROW_NUM}),
+         .keypadExpander = 0,
+         .motorExpander = 0}},
 
     // ID 3: Timer
     {
-        TIMER, "Timer", {.cellCount = 4, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({TMR_SET_COLOR, TMR_SET_VALUE, TMR_START, TMR_PAUSE})}},
+        TIMER, "Timer", {.cellCount = 44, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({TMR_SET_COLOR, TMR_SET_VALUE, TMR_START, TMR_PAUSE, TMR_ADD_TIME, TMR_SYNC}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 4: Glow Dots
     {
-        GLOW_DOTS, "GlowDots", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({DOTS_SET_COLORS, DOTS_SET_MOVE, DOTS_SET_DELAY, DOTS_SET_LED})}},
+        GLOW_DOTS, "GlowDots", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({DOTS_SET_COLORS, DOTS_SET_MOVE, DOTS_SET_DELAY, DOTS_SET_LED}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 5: QB
     {
-        QB, "QB", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({QB_SET_COLORS, QB_SET_MODES})}},
+        QB, "QB", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({QB_SET_COLORS, QB_SET_MODES}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 6: RGB Mixer
     {
-        RGB_MIXER, "RGBMixer", {.cellCount = 8, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({})}},
+        RGB_MIXER, "RGBMixer", {.cellCount = 8, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 7: Prototype
     {
-        PROTO, "Prototype", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({})}},
+        PROTO, "Prototype", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 8: Final Order
     {
-        FINAL_ORDER, "FinalOrder", {.cellCount = 12, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({FINAL_RESET})}},
+        FINAL_ORDER, "FinalOrder", {.cellCount = 12, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({FINAL_RESET}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 9: Ball Gate
     {
-        BALL_GATE, "BallGate", {.cellCount = 1, .keyNames = {}, .motorNames = {"Gate motor", "Reject motor"}, .commands = makeCommandSet({})}},
+        BALL_GATE, "BallGate", {.cellCount = 1, .keyNames = {}, .motorNames = {"Gate motor", "Reject motor"}, .commands = makeCommandSet({}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 10: Actuator
     {
-        ACTUATOR, "Actuator", {.cellCount = 0, .keyNames = {}, .motorNames = {"Actuator 1", "Actuator 2"}, .commands = makeCommandSet({ACT_OPEN, ACT_CLOSE})}},
+        ACTUATOR, "Actuator", {.cellCount = 0, .keyNames = {}, .motorNames = {"Actuator 1", "Actuator 2"}, .commands = makeCommandSet({ACT_OPEN, ACT_CLOSE}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 11: The Wall
     {
-        THE_WALL, "TheWall", {.cellCount = 0, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({})}},
+        THE_WALL, "TheWall", {.cellCount = 0, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 12: Scores
     {
-        SCORES, "Scores", {.cellCount = 0, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({})}},
+        SCORES, "Scores", {.cellCount = 0, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({}), .keypadExpander = 0, .motorExpander = 0}},
 
     // ID 13: Ball Base
     {
-        BALL_BASE, "BallBase", {.cellCount = 0, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({})}},
+        BALL_BASE, "BallBase", {.cellCount = 0, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({}), .keypadExpander = 0, .motorExpander = 0}},
     // ID 14: Purger
     {
-        PURGER, "Purger", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({PURGER_SET_STATE})}},
+        PURGER, "Purger", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({PURGER_SET_STATE}), .keypadExpander = 0, .motorExpander = 0}},
+    // ID 15: Puzzle (logic is an uploaded PuzzleVM script)
+    {
+        PUZZLE, "Puzzle", {.cellCount = 16, .keyNames = {}, .motorNames = {}, .commands = makeCommandSet({PUZZLE_RESET, PUZZLE_LOAD, PUZZLE_INPUT}), .keypadExpander = 0, .motorExpander = 0}},
 };
 
-static const size_t DEVICE_COUNT = sizeof(DEVICE_CATALOG) / sizeof(DEVICE_CATALOG[0]);
+static constexpr size_t DEVICE_COUNT = sizeof(DEVICE_CATALOG) / sizeof(DEVICE_CATALOG[0]);
+
+// Commands every device supports (prepended by getMergedCommandSet())
+static constexpr CommandSet CORE_COMMANDS = makeCommandSet({CORE_HELLO, CORE_ACK, CORE_PING, CORE_RESET});
+
+/************************* catalogInOrder ***********************************
+ * True if entry n of DEVICE_CATALOG is DeviceType n (which also makes the
+ * IDs unique).
+ ***************************************************************/
+static constexpr bool catalogInOrder()
+{
+        for (size_t i = 0; i < DEVICE_COUNT; i++)
+        {
+                if (DEVICE_CATALOG[i].type != i)
+                        return false;
+        }
+        return true;
+}
+
+/************************* commandsFit ***********************************
+ * True if every device's commands fit a merged set next to CORE_COMMANDS.
+ ***************************************************************/
+static constexpr bool commandsFit()
+{
+        for (size_t i = 0; i < DEVICE_COUNT; i++)
+        {
+                if (CORE_COMMANDS.count + DEVICE_CATALOG[i].config.commands.count > MAX_COMMANDS)
+                        return false;
+        }
+        return true;
+}
+
+static_assert(DEVICE_COUNT == DEVICE_TYPE_COUNT, "DEVICE_CATALOG needs exactly one entry per DeviceType");
+static_assert(catalogInOrder(), "DEVICE_CATALOG entry n must be DeviceType n");
+static_assert(DEVICE_TYPE_COUNT <= MAX_DEVICE_TYPES, "Too many device types");
+static_assert(commandsFit(), "A device's commands do not fit MAX_COMMANDS with the core commands");
 
 // =================================================================================
 // Implementation
@@ -99,14 +144,7 @@ static const size_t DEVICE_COUNT = sizeof(DEVICE_CATALOG) / sizeof(DEVICE_CATALO
  ***************************************************************/
 const DeviceDefinition *DeviceConfigurations::getDefinition(DeviceType type)
 {
-        for (size_t i = 0; i < DEVICE_COUNT; i++)
-        {
-                if (DEVICE_CATALOG[i].type == type)
-                {
-                        return &DEVICE_CATALOG[i];
-                }
-        }
-        return nullptr;
+        return type < DEVICE_COUNT ? &DEVICE_CATALOG[type] : nullptr;
 }
 
 /************************* getName ***********************************
@@ -128,7 +166,7 @@ const char *DeviceConfigurations::getName(DeviceType type)
  ***************************************************************/
 CommandSet DeviceConfigurations::getMergedCommandSet(DeviceType type)
 {
-        CommandSet merged = makeCommandSet({CORE_HELLO, CORE_ACK, CORE_PING, CORE_RESET});
+        CommandSet merged = CORE_COMMANDS;
 
         const DeviceDefinition *def = getDefinition(type);
         if (def)
@@ -138,17 +176,28 @@ CommandSet DeviceConfigurations::getMergedCommandSet(DeviceType type)
                         if (merged.count < MAX_COMMANDS)
                         {
                                 merged.cmds[merged.count++] = def->config.commands.cmds[i];
-                                /************************* getMotorCount ***********************************
-                                 * Gets the number of motors used by a device type.
-                                 * @param type The DeviceType.
-                                 * @return Number of motors.
-                                 ***************************************************************/
                         }
                 }
         }
         return merged;
 }
 
+/************************* getCellCount ***********************************
+ * Gets the number of LEDs/cells of a device type (the pixel strip length).
+ * @param type The DeviceType.
+ * @return Cell count, 0 if the type has none or is undefined.
+ ***************************************************************/
+u16 DeviceConfigurations::getCellCount(DeviceType type)
+{
+        const DeviceDefinition *def = getDefinition(type);
+        return def ? def->config.cellCount : 0;
+}
+
+/************************* getMotorCount ***********************************
+ * Gets the number of motors used by a device type.
+ * @param type The DeviceType.
+ * @return Number of motors.
+ ***************************************************************/
 u8 DeviceConfigurations::getMotorCount(DeviceType type)
 {
         const DeviceDefinition *def = getDefinition(type);
@@ -159,17 +208,17 @@ u8 DeviceConfigurations::getMotorCount(DeviceType type)
         for (int i = 0; i < MAX_MOTORS; i++)
         {
                 if (def->config.motorNames[i] != nullptr)
-                        /************************* getKeyName ***********************************
-                         * Gets the name of a specific key/button for a device type.
-                         * @param type The DeviceType.
-                         * @param keyIndex The index of the key.
-                         * @return C-string name of the key.
-                         ***************************************************************/
                         count++;
         }
         return count;
 }
 
+/************************* getKeyName ***********************************
+ * Gets the name of a specific key/button for a device type.
+ * @param type The DeviceType.
+ * @param keyIndex The index of the key.
+ * @return C-string name of the key.
+ ***************************************************************/
 const char *DeviceConfigurations::getKeyName(DeviceType type, u8 keyIndex)
 {
         const DeviceDefinition *def = getDefinition(type);
@@ -181,22 +230,18 @@ const char *DeviceConfigurations::getKeyName(DeviceType type, u8 keyIndex)
         // Default names if not specified
         static char defaultName[4];
         if (keyIndex < 10)
-                /************************* getMotorName ***********************************
-                 * Gets the name of a specific motor for a device type.
-                 * @param type The DeviceType.
-                 * @param motorIndex The index of the motor.
-                 * @return C-string name of the motor.
-                 ***************************************************************/
                 snprintf(defaultName, sizeof(defaultName), "%d", keyIndex);
         else
                 snprintf(defaultName, sizeof(defaultName), "%c", 'A' + (keyIndex - 10));
         return defaultName;
-        /************************* printConfig ***********************************
-         * Prints the configuration of a device type to Serial.
-         * @param type The DeviceType to print.
-         ***************************************************************/
 }
 
+/************************* getMotorName ***********************************
+ * Gets the name of a specific motor for a device type.
+ * @param type The DeviceType.
+ * @param motorIndex The index of the motor.
+ * @return C-string name of the motor.
+ ***************************************************************/
 const char *DeviceConfigurations::getMotorName(DeviceType type, u8 motorIndex)
 {
         const DeviceDefinition *def = getDefinition(type);
@@ -207,6 +252,30 @@ const char *DeviceConfigurations::getMotorName(DeviceType type, u8 motorIndex)
         return "Motor";
 }
 
+/************************* getKeypadExpander ***********************************
+ * Expander slot (0-7 = 0x20-0x27) that carries the keypad matrix.
+ * @param type The DeviceType.
+ ***************************************************************/
+u8 DeviceConfigurations::getKeypadExpander(DeviceType type)
+{
+        const DeviceDefinition *def = getDefinition(type);
+        return def ? def->config.keypadExpander : 0;
+}
+
+/************************* getMotorExpander ***********************************
+ * Expander slot (0-7 = 0x20-0x27) whose P00-P07 drive the motors.
+ * @param type The DeviceType.
+ ***************************************************************/
+u8 DeviceConfigurations::getMotorExpander(DeviceType type)
+{
+        const DeviceDefinition *def = getDefinition(type);
+        return def ? def->config.motorExpander : 0;
+}
+
+/************************* printConfig ***********************************
+ * Prints the configuration of a device type to Serial.
+ * @param type The DeviceType to print.
+ ***************************************************************/
 void DeviceConfigurations::printConfig(DeviceType type)
 {
         const DeviceDefinition *def = getDefinition(type);
@@ -218,6 +287,9 @@ void DeviceConfigurations::printConfig(DeviceType type)
 
         Serial.printf("Device Type %d: %s\n", def->type, def->name);
         Serial.printf("  - LEDs/Cells: %d\n", def->config.cellCount);
+        Serial.printf("  - Expanders: keypad 0x%02X, motors 0x%02X\n",
+                      IO_EXPANDER_BASE_ADDR + def->config.keypadExpander,
+                      IO_EXPANDER_BASE_ADDR + def->config.motorExpander);
 
         // Print Commands
         Serial.print("  - Cmds: ");
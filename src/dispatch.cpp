@@ -0,0 +1,91 @@
+/************************* dispatch.cpp *************************
+ * Room Bus command dispatch table
+ * Handlers registered per cmd_srv by Core and the active App
+ * Created by MSK, November 2025
+ * O(1) lookup, per-command hit and latency counters
+ ***************************************************************/
+
+#include "dispatch.h"
+#include <Arduino.h>
+
+/************************* CommandTable ***********************************
+ * Constructor. Starts with no handlers.
+ ***************************************************************/
+CommandTable::CommandTable() : m_unsupported(0)
+{
+        memset(m_entries, 0, sizeof(m_entries));
+}
+
+/************************* set ***********************************
+ * Register or remove the handler of a command.
+ ***************************************************************/
+bool CommandTable::set(u8 cmd, CommandFn fn, void *ctx)
+{
+        if (cmd < CORE_MIN || cmd > SERVER_MAX)
+                return false;
+
+        m_entries[cmd].fn = fn;
+        m_entries[cmd].ctx = fn ? ctx : nullptr;
+        return true;
+}
+
+/************************* clear ***********************************
+ * Remove all handlers in [first, last].
+ ***************************************************************/
+void CommandTable::clear(u8 first, u8 last)
+{
+        for (u16 cmd = first; cmd <= last && cmd < DispatchConfig::TABLE_SIZE; cmd++)
+        {
+                m_entries[cmd].fn = nullptr;
+                m_entries[cmd].ctx = nullptr;
+        }
+}
+
+/************************* has ***********************************
+ * True if the command has a handler.
+ ***************************************************************/
+bool CommandTable::has(u8 cmd) const
+{
+        return cmd < DispatchConfig::TABLE_SIZE && m_entries[cmd].fn;
+}
+
+/************************* dispatch ***********************************
+ * Index by cmd_srv, run the handler, count hits and cycles.
+ ***************************************************************/
+bool CommandTable::dispatch(const RoomFrame &frame)
+{
+        if (!has(frame.cmd_srv))
+        {
+                m_unsupported++;
+                return false;
+        }
+
+        Entry &e = m_entries[frame.cmd_srv];
+        u32 start = ESP.getCycleCount();
+        e.fn(e.ctx, frame);
+        u32 cycles = ESP.getCycleCount() - start;
+
+        e.stats.hits++;
+        e.stats.totalCycles += cycles;
+        if (cycles > e.stats.maxCycles)
+                e.stats.maxCycles = cycles;
+        return true;
+}
+
+/************************* getStats ***********************************
+ * Counters of one command.
+ ***************************************************************/
+const CommandStats *CommandTable::getStats(u8 cmd) const
+{
+        return cmd < DispatchConfig::TABLE_SIZE ? &m_entries[cmd].stats : nullptr;
+}
+
+/************************* resetStats ***********************************
+ * Clear all counters (handlers stay registered).
+ ***************************************************************/
+void CommandTable::resetStats()
+{
+        for (u16 cmd = 0; cmd < DispatchConfig::TABLE_SIZE; cmd++)
+                m_entries[cmd].stats = CommandStats{};
+        m_unsupported = 0;
+}
@@ -0,0 +1,154 @@
+/************************* expanderbus.cpp **********************
+ * I/O Expander Bus Manager Implementation
+ * Bus discovery, unified pin space and batched cycle I/O
+ * Created by MSK, November 2025
+ * Extra expanders are allocated once at boot and never freed
+ ***************************************************************/
+
+#include "expanderbus.h"
+
+//============================================================================
+// CONSTRUCTOR & DISCOVERY
+//============================================================================
+
+/************************* ExpanderBus constructor *************************
+ * Start with no expanders; discover() fills the slots.
+ ***************************************************************/
+ExpanderBus::ExpanderBus(TwoWire *wire, IOExpander *primary)
+    : m_wire(wire), m_primary(primary), m_count(0)
+{
+        for (u8 i = 0; i < ExpanderBusConfig::MAX_EXPANDERS; i++)
+                m_slots[i] = nullptr;
+}
+
+/************************* discover ****************************************
+ * Address-only probe of each slot, then begin() on the ones that ACK.
+ * The primary expander is always begun (its result drives the I2C status).
+ ***************************************************************/
+u8 ExpanderBus::discover()
+{
+        m_count = 0;
+
+        for (u8 slot = 0; slot < ExpanderBusConfig::MAX_EXPANDERS; slot++)
+        {
+                u8 address = IO_EXPANDER_BASE_ADDR + slot;
+                bool isPrimary = m_primary && m_primary->getAddress() == address;
+
+                if (!isPrimary)
+                {
+                        m_wire->beginTransmission(address);
+                        if (m_wire->endTransmission() != 0)
+                                continue; // Nothing at this address
+                }
+
+                IOExpander *io = m_slots[slot];
+                if (!io)
+                        io = isPrimary ? m_primary : new IOExpander(address, m_wire);
+
+                if (!io->begin())
+                {
+                        if (!isPrimary)
+                                Serial.printf("[IOX] 0x%02X answered but failed init\n", address);
+                        continue;
+                }
+
+                m_slots[slot] = io;
+                m_count++;
+                Serial.printf("[IOX] Expander %u at 0x%02X%s\n", slot, address, isPrimary ? " (primary)" : "");
+        }
+
+        // One clock for the whole bus: if any expander needed standard mode, use it for all
+        for (u8 i = 0; i < ExpanderBusConfig::MAX_EXPANDERS; i++)
+        {
+                if (m_slots[i] && m_slots[i]->getBusSpeed() < I2CConfig::FAST_HZ)
+                {
+                        for (u8 j = 0; j < ExpanderBusConfig::MAX_EXPANDERS; j++)
+                        {
+                                if (m_slots[j])
+                                        m_slots[j]->setBusSpeed(I2CConfig::STANDARD_HZ);
+                        }
+                        break;
+                }
+        }
+
+        return m_count;
+}
+
+/************************* get *********************************************
+ * Expander in a slot, or nullptr if absent.
+ ***************************************************************/
+IOExpander *ExpanderBus::get(u8 slot) const
+{
+        if (slot >= ExpanderBusConfig::MAX_EXPANDERS)
+                return nullptr;
+
+        return m_slots[slot];
+}
+
+//============================================================================
+// UNIFIED PIN SPACE
+//============================================================================
+
+/************************* digitalWrite ************************************
+ * Set a unified pin in its expander's shadow register.
+ ***************************************************************/
+void ExpanderBus::digitalWrite(u8 pin, u8 value)
+{
+        IOExpander *io = get(pin / ExpanderBusConfig::PINS_PER_EXPANDER);
+        if (io)
+                io->digitalWrite(pin % ExpanderBusConfig::PINS_PER_EXPANDER, value);
+}
+
+/************************* digitalRead *************************************
+ * Read a unified pin from its expander's cycle snapshot.
+ ***************************************************************/
+u8 ExpanderBus::digitalRead(u8 pin)
+{
+        IOExpander *io = get(pin / ExpanderBusConfig::PINS_PER_EXPANDER);
+        if (!io)
+                return LOW;
+
+        return io->digitalRead(pin % ExpanderBusConfig::PINS_PER_EXPANDER);
+}
+
+//============================================================================
+// CYCLE I/O
+//============================================================================
+
+/************************* beginCycle **************************************
+ * Mark every snapshot stale (reads refresh lazily, once per expander).
+ ***************************************************************/
+void ExpanderBus::beginCycle()
+{
+        for (u8 i = 0; i < ExpanderBusConfig::MAX_EXPANDERS; i++)
+        {
+                if (m_slots[i])
+                        m_slots[i]->beginCycle();
+        }
+}
+
+/************************* flush *******************************************
+ * Write pending outputs; unchanged expanders cost nothing.
+ ***************************************************************/
+void ExpanderBus::flush()
+{
+        for (u8 i = 0; i < ExpanderBusConfig::MAX_EXPANDERS; i++)
+        {
+                if (m_slots[i])
+                        m_slots[i]->flush();
+        }
+}
+
+/************************* getI2cErrorCount ********************************
+ * Total failed transactions (wraps at 16 bits).
+ ***************************************************************/
+u16 ExpanderBus::getI2cErrorCount() const
+{
+        u16 total = 0;
+        for (u8 i = 0; i < ExpanderBusConfig::MAX_EXPANDERS; i++)
+        {
+                if (m_slots[i])
+                        total += m_slots[i]->getI2cErrorCount();
+        }
+        return total;
+}
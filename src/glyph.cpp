@@ -0,0 +1,313 @@
+/************************* glyph.cpp ***************************
+ * Segment glyph renderer for LED digit displays
+ * Per-digit LED masks and colors, blitted into the PixelStrip frame
+ * Created by MSK, November 2025
+ * Masks come from a compile-time table, so drawing is a lookup
+ ***************************************************************/
+
+#include "glyph.h"
+#include "compositor.h"
+#include "watchdog.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+        constexpr char FIRST_CHAR = ' ';
+        constexpr u8 CHAR_COUNT = 0x7F - FIRST_CHAR;
+
+        // LED mask per printable ASCII character, built by the compiler
+        struct GlyphTable
+        {
+                u16 leds[CHAR_COUNT];
+
+                constexpr GlyphTable() : leds()
+                {
+                        for (u8 i = 0; i < CHAR_COUNT; i++)
+                                leds[i] = glyphLeds(glyphSegments((char)(FIRST_CHAR + i)));
+                }
+        };
+
+        constexpr GlyphTable kGlyphs;
+        constexpr u16 kDotLed = glyphLeds(1u << SEG_DP);
+        constexpr u16 kAllLeds = (u16)((1u << GlyphConfig::LEDS_PER_DIGIT) - 1);
+
+        // Wiring must use every LED of a digit exactly once
+        static_assert(glyphLeds((1u << SEG_COUNT) - 1) == kAllLeds, "SEGMENT_LED is not a permutation");
+        static_assert(kGlyphs.leds['8' - FIRST_CHAR] == glyphLeds(0x00FF), "unexpected '8' glyph");
+        static_assert(kGlyphs.leds[' ' - FIRST_CHAR] == 0, "blank must light nothing");
+}
+
+/************************* lookup *******************************************
+ * LED mask for a character (0 outside printable ASCII).
+ ***************************************************************/
+static inline u16 lookup(char c)
+{
+        u8 i = (u8)(c - FIRST_CHAR);
+        return i < CHAR_COUNT ? kGlyphs.leds[i] : 0;
+}
+
+/************************* toFrameBytes ************************************
+ * Split a 0xRRGGBB color into the frame buffer's channel order.
+ ***************************************************************/
+static inline void toFrameBytes(u32 color, u8 *bytes)
+{
+        bytes[PixelConfig::OFFSET_R] = (u8)(color >> 16);
+        bytes[PixelConfig::OFFSET_G] = (u8)(color >> 8);
+        bytes[PixelConfig::OFFSET_B] = (u8)color;
+}
+
+/************************* SegmentDisplay ***********************************
+ * Constructor. Starts blank, white, on an off background.
+ ***************************************************************/
+SegmentDisplay::SegmentDisplay(PixelStrip *pixels, u16 firstLed, u8 digits)
+    : m_pixels(pixels), m_firstLed(firstLed),
+      m_digits(digits < GlyphConfig::MAX_DIGITS ? digits : GlyphConfig::MAX_DIGITS),
+      m_background(0), m_dirty(0), m_compositor(nullptr), m_layer(0)
+{
+        for (u8 d = 0; d < GlyphConfig::MAX_DIGITS; d++)
+        {
+                m_leds[d] = 0;
+                m_color[d] = 0xFFFFFF;
+        }
+        m_dirty = (1u << m_digits) - 1; // MAX_DIGITS < 32
+}
+
+/************************* setColor *****************************************
+ * Lit color of every digit.
+ ***************************************************************/
+void SegmentDisplay::setColor(u32 color)
+{
+        for (u8 d = 0; d < m_digits; d++)
+                setDigitColor(d, color);
+}
+
+/************************* setDigitColor ************************************
+ * Lit color of one digit.
+ ***************************************************************/
+void SegmentDisplay::setDigitColor(u8 digit, u32 color)
+{
+        if (digit >= m_digits || m_color[digit] == color)
+                return;
+
+        m_color[digit] = color;
+        m_dirty |= 1u << digit;
+}
+
+/************************* setBackground ************************************
+ * Color of unlit segments; redraws every digit.
+ ***************************************************************/
+void SegmentDisplay::setBackground(u32 color)
+{
+        if (color == m_background)
+                return;
+
+        m_background = color;
+        m_dirty = (1u << m_digits) - 1; // MAX_DIGITS < 32
+}
+
+/************************* setLeds *****************************************
+ * Store a digit's LED mask; marks it for render() only if it changed.
+ ***************************************************************/
+void SegmentDisplay::setLeds(u8 digit, u16 leds)
+{
+        if (digit >= m_digits || m_leds[digit] == leds)
+                return;
+
+        m_leds[digit] = leds;
+        m_dirty |= 1u << digit;
+}
+
+/************************* setGlyph *****************************************
+ * Show one character on a digit, optionally with its decimal point.
+ ***************************************************************/
+void SegmentDisplay::setGlyph(u8 digit, char c, bool dot)
+{
+        setLeds(digit, lookup(c) | (dot ? kDotLed : 0));
+}
+
+/************************* setLayer *****************************************
+ * Redirect rendering into a compositor layer (nullptr = the strip).
+ ***************************************************************/
+void SegmentDisplay::setLayer(Compositor *compositor, u8 layer)
+{
+        m_compositor = compositor;
+        m_layer = layer;
+        m_dirty = (1u << m_digits) - 1; // MAX_DIGITS < 32
+}
+
+/************************* setSegments **************************************
+ * Show a raw GlyphSegment mask on a digit.
+ ***************************************************************/
+void SegmentDisplay::setSegments(u8 digit, u16 segments)
+{
+        setLeds(digit, glyphLeds(segments));
+}
+
+/************************* print ********************************************
+ * Left-aligned text into [first, first + width). A '.' right after a
+ * character lights that digit's decimal point instead of taking a digit.
+ ***************************************************************/
+void SegmentDisplay::print(u8 first, u8 width, const char *text)
+{
+        if (first >= m_digits)
+                return;
+        u8 end = (width > m_digits - first) ? m_digits : (u8)(first + width);
+
+        u8 d = first;
+        for (const char *s = text; s && *s && d < end; s++)
+        {
+                u16 leds = lookup(*s);
+                if (*s != '.' && s[1] == '.')
+                {
+                        leds |= kDotLed;
+                        s++;
+                }
+                setLeds(d++, leds);
+        }
+
+        while (d < end)
+                setLeds(d++, 0);
+}
+
+/************************* printNumber **************************************
+ * Right-aligned number into [first, first + width); dashes if it does not fit.
+ ***************************************************************/
+void SegmentDisplay::printNumber(u8 first, u8 width, int32_t value, bool leadingZeros)
+{
+        char text[GlyphConfig::MAX_DIGITS + 1];
+        if (width > GlyphConfig::MAX_DIGITS)
+                width = GlyphConfig::MAX_DIGITS;
+
+        int len = snprintf(text, sizeof(text), leadingZeros ? "%0*ld" : "%*ld", width, (long)value);
+        if (len < 0 || len > width)
+        {
+                memset(text, '-', width);
+                text[width] = '\0';
+        }
+        print(first, width, text);
+}
+
+/************************* clear ********************************************
+ * Blank all digits (colors are kept).
+ ***************************************************************/
+void SegmentDisplay::clear()
+{
+        for (u8 d = 0; d < m_digits; d++)
+                setLeds(d, 0);
+}
+
+/************************* render *******************************************
+ * Blit changed digits into the strip's frame: per LED, copy either the
+ * digit's lit bytes or the background bytes. Digits past the end of the
+ * strip are clipped, and LEDs in a fade are left to it (same rule as
+ * Animation::put). Call PixelStrip::show() to transmit.
+ ***************************************************************/
+void SegmentDisplay::render()
+{
+        if (!m_pixels || !m_dirty)
+                return;
+
+        if (m_compositor)
+        {
+                renderLayer();
+                return;
+        }
+
+        u8 *frame = m_pixels->getFrame();
+        u16 count = m_pixels->getCount();
+        u8 off[PixelConfig::BYTES_PER_PIXEL];
+        toFrameBytes(m_background, off);
+
+        u16 firstLed = 0xFFFF, lastLed = 0;
+        for (u8 d = 0; d < m_digits; d++)
+        {
+                if (!(m_dirty & (1u << d)))
+                        continue;
+
+                u32 base = m_firstLed + (u32)d * GlyphConfig::LEDS_PER_DIGIT;
+                if (base >= count)
+                        break;
+                u8 n = GlyphConfig::LEDS_PER_DIGIT;
+                if (base + n > count)
+                        n = (u8)(count - base);
+
+                u8 on[PixelConfig::BYTES_PER_PIXEL];
+                toFrameBytes(m_color[d], on);
+                u8 *px = frame + base * PixelConfig::BYTES_PER_PIXEL;
+                u16 leds = m_leds[d];
+                for (u8 l = 0; l < n; l++, px += PixelConfig::BYTES_PER_PIXEL)
+                {
+                        if (m_pixels->isFading((u16)(base + l)))
+                                continue;
+                        memcpy(px, (leds & (1u << l)) ? on : off, PixelConfig::BYTES_PER_PIXEL);
+                }
+
+                if (base < firstLed)
+                        firstLed = (u16)base;
+                lastLed = (u16)(base + n - 1);
+        }
+
+        if (firstLed != 0xFFFF)
+                m_pixels->markDirty(firstLed, lastLed);
+        m_dirty = 0;
+}
+
+/************************* renderLayer **************************************
+ * render() into the compositor layer: lit or background color per LED.
+ * The compositor skips unchanged pixels and wakes its frame task.
+ ***************************************************************/
+void SegmentDisplay::renderLayer()
+{
+        u16 count = m_pixels->getCount();
+        for (u8 d = 0; d < m_digits; d++)
+        {
+                if (!(m_dirty & (1u << d)))
+                        continue;
+
+                u32 base = m_firstLed + (u32)d * GlyphConfig::LEDS_PER_DIGIT;
+                for (u8 l = 0; l < GlyphConfig::LEDS_PER_DIGIT && base + l < count; l++)
+                        m_compositor->setColor(m_layer, (u16)(base + l), (m_leds[d] & (1u << l)) ? m_color[d] : m_background);
+        }
+        m_dirty = 0;
+}
+
+/************************* benchmark ****************************************
+ * Time a full-width number print and render of MAX_DIGITS digits on a
+ * strip without a pin (never started, the live strip keeps its GPIO),
+ * first cold and then with nothing changed.
+ ***************************************************************/
+void SegmentDisplay::benchmark()
+{
+        const u8 digits = GlyphConfig::MAX_DIGITS;
+        PixelStrip strip(PixelConfig::NO_PIN, (u16)digits * GlyphConfig::LEDS_PER_DIGIT);
+        SegmentDisplay display(&strip, 0, digits);
+
+        Serial.println("\n=== Glyph Benchmark ===");
+        const u8 rows = 4, width = digits / rows;
+        u32 printUs = 0, renderUs = 0;
+        const u8 runs = 16;
+        for (u8 run = 0; run < runs; run++)
+        {
+                display.setDigitColor(run % digits, 0x00FF00 + run);
+
+                u32 start = micros();
+                for (u8 r = 0; r < rows; r++)
+                        display.printNumber(r * width, width, (int32_t)(run * 12345 + r * 777), run & 1);
+                u32 mid = micros();
+                display.render();
+                u32 end = micros();
+
+                printUs += mid - start;
+                renderUs += end - mid;
+        }
+        Watchdog::reset();
+        Serial.printf("[GLY] %u digits: print %lu us, render %lu us (avg of %u)\n",
+                      digits, (unsigned long)(printUs / runs), (unsigned long)(renderUs / runs), runs);
+
+        u32 start = micros();
+        display.render();
+        Serial.printf("[GLY] unchanged render %lu us\n", (unsigned long)(micros() - start));
+        Serial.println("=== Glyph Benchmark Complete ===\n");
+}
@@ -6,6 +6,7 @@
  ***************************************************************/
 
 #include "inputmanager.h"
+#include "probe.h"
 
 //============================================================================
 // CONSTRUCTOR
@@ -38,6 +39,8 @@ void InputManager::init()
  ***************************************************************/
 void InputManager::poll()
 {
+        PROBE_SCOPE(PROBE_INPUT_POLL);
+
         // Always check buttons (no I2C needed)
         checkButtons();
 
@@ -99,14 +102,29 @@ void InputManager::checkButtons()
 
 /************************* checkKeypad ************************************
  * Scan keypad via IOExpander and fire events.
+ * Releases go first so a fast re-press in one scan stays ordered.
  ***************************************************************/
 void InputManager::checkKeypad()
 {
-        u8 keyIndex = m_ioExpander->scanKeypad();
-        if (keyIndex != 255 && keyIndex <= 15)
+        KeypadEvents events;
+        if (!m_ioExpander->scanKeypad(events) || !m_callback)
+                return;
+
+        dispatchKeys(events.released, INPUT_KEYPAD_RELEASE_0);
+        dispatchKeys(events.pressed, INPUT_KEYPAD_0);
+        dispatchKeys(events.held, INPUT_KEYPAD_HOLD_0);
+}
+
+/************************* dispatchKeys ***********************************
+ * Fire one event per set bit, lowest key first.
+ * @param keys Key bitmap.
+ * @param base Event for key 0 (keys 1-15 follow in enum order).
+ ***************************************************************/
+void InputManager::dispatchKeys(u16 keys, InputEvent base)
+{
+        for (u8 i = 0; keys; i++, keys >>= 1)
         {
-                InputEvent event = static_cast<InputEvent>(INPUT_KEYPAD_0 + keyIndex);
-                if (m_callback)
-                        m_callback(event);
+                if (keys & 1)
+                        m_callback(static_cast<InputEvent>(base + i));
         }
 }
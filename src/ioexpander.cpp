@@ -6,6 +6,10 @@
  ***************************************************************/
 
 #include "ioexpander.h"
+#include "probe.h"
+
+// Instance served by the INT ISR (one keypad expander per board)
+IOExpander *IOExpander::s_intInstance = nullptr;
 
 /************************* IOExpander constructor **************************
  * Construct IOExpander with I2C address and Wire instance.
@@ -13,40 +17,105 @@
 IOExpander::IOExpander(u8 address, TwoWire *wire)
     : _address(address), _outputState(0xFFFF) // All pins high by default (pull-ups)
       ,
-      _inputState(0x0000), _wire(wire), _isPresent(false), _lastKeyIndex(255), _lastKeyRow(0xFF), _lastKeyCol(0xFF), _lastKey(0), _keyPressed(false), _pressedKeyIndex(255),
-      _stableKeyIndex(255), _rawKeyIndex(255), _debounceCount(0), _lastScanTime(0), _lastKeyPressTime(0)
+      _inputState(0x0000), _wire(wire), _isPresent(false), _i2cErrors(0), _errorStreak(0), _busHz(I2CConfig::FAST_HZ), _dirty(false), _inputValid(false),
+      _keyState(0), _rawKeys(0), _ct0(0xFFFF), _ct1(0xFFFF), _heldKeys(0), _ghostKeys(0), _ghostCount(0), _lastScanTime(0),
+      _intEnabled(false), _keypadIdle(false), _intPending(false), _wakeCallback(nullptr)
 {
+        for (u8 i = 0; i < KEYPAD_SIZE; i++)
+                _pressTime[i] = 0;
 }
 
 /************************* begin *******************************************
  * Initialize the I/O expander (expects Wire ready).
- * PCF8575 supports up to 400 kHz; 100 kHz preferred for reliability.
+ * Tries 400 kHz fast mode first and drops to 100 kHz if the device does not
+ * answer (long cable, weak pull-ups).
  ***************************************************************/
 bool IOExpander::begin()
 {
         // Set all pins high initially (keypad columns, motor off, switches as inputs)
         // PCF8575 pins are quasi-bidirectional: write HIGH to configure as input
         _outputState = 0xFFFF;
+        setBusSpeed(I2CConfig::FAST_HZ);
 
-        // Try to write initial state to verify device presence
-        if (!writePort(_outputState))
-        {
-                _isPresent = false;
-                return false; // Device not found
-        }
-
-        // Read back to verify communication
+        // Write initial state and read back to verify device presence
         u16 readback;
-        if (!readPort(readback))
+        if (!writePort(_outputState) || !readPort(readback))
         {
-                _isPresent = false;
-                return false; // Communication failed
+                setBusSpeed(I2CConfig::STANDARD_HZ);
+                if (!writePort(_outputState) || !readPort(readback))
+                {
+                        _isPresent = false;
+                        return false; // Device not found
+                }
         }
 
         _isPresent = true;
         return true;
 }
 
+/************************* setBusSpeed *************************************
+ * Set the I2C clock and clear the error streak.
+ * @param hz Bus frequency in Hz.
+ ***************************************************************/
+void IOExpander::setBusSpeed(u32 hz)
+{
+        _busHz = hz;
+        _errorStreak = 0;
+        _wire->setClock(hz);
+}
+
+/************************* enableInterrupt *********************************
+ * Switch the keypad to interrupt-driven scanning.
+ * PCF8575 INT is open-drain and asserts on any input change since the last
+ * port read/write, so parking the rows LOW makes any key press pull INT.
+ * @param intPin GPIO wired to INT (pull-up enabled here).
+ * @param wakeCallback Optional ISR-context hook (e.g. wake the input task).
+ ***************************************************************/
+bool IOExpander::enableInterrupt(u8 intPin, ExpanderWakeCallback wakeCallback)
+{
+        if (!_isPresent)
+                return false;
+
+        s_intInstance = this;
+        _wakeCallback = wakeCallback;
+        _intEnabled = true;
+
+        parkKeypad();
+
+        pinMode(intPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(intPin), intISR, FALLING);
+        return true;
+}
+
+/************************* intISR ******************************************
+ * INT falling edge: flag a pending scan and wake the input task.
+ ***************************************************************/
+void IRAM_ATTR IOExpander::intISR()
+{
+        IOExpander *self = s_intInstance;
+        if (!self)
+                return;
+
+        self->_intPending = true;
+        if (self->_wakeCallback)
+                self->_wakeCallback();
+}
+
+/************************* parkKeypad **************************************
+ * Drive all rows LOW (columns HIGH = inputs) and read once to clear INT.
+ * Rows stay LOW in _outputState so motor writes keep the matrix parked.
+ ***************************************************************/
+void IOExpander::parkKeypad()
+{
+        _outputState = (_outputState & ~KEYPAD_ROW_MASK) | KEYPAD_COL_MASK;
+        _intPending = false; // Clear before the read so a new edge is not lost
+        writePort(_outputState);
+
+        u16 value;
+        readPort(value);
+        _keypadIdle = true;
+}
+
 /************************* writePort ***************************************
  * Write a 16-bit value to the expander port.
  * @param value Bitmask for all pins.
@@ -56,7 +125,11 @@ bool IOExpander::writePort(u16 value)
         _wire->beginTransmission(_address);
         _wire->write(value & 0xFF);        // Low byte (P00-P07)
         _wire->write((value >> 8) & 0xFF); // High byte (P10-P17)
-        return (_wire->endTransmission() == 0);
+        bool ok = (_wire->endTransmission() == 0);
+        trackResult(ok);
+        if (ok)
+                markWritten(value);
+        return ok;
 }
 
 /************************* readPort ****************************************
@@ -68,6 +141,7 @@ bool IOExpander::readPort(u16 &value)
         u8 bytesRead = _wire->requestFrom(_address, (u8)2);
         if (bytesRead != 2)
         {
+                trackResult(false);
                 return false;
         }
 
@@ -75,280 +149,452 @@ bool IOExpander::readPort(u16 &value)
         u8 highByte = _wire->read();
         value = (u16)lowByte | ((u16)highByte << 8);
         _inputState = value;
+        _inputValid = true;
 
+        trackResult(true);
         return true;
 }
 
-/************************* digitalWrite ************************************
- * Set a single pin state (0-15).
+/************************* transferPort ************************************
+ * Write the port, then read it back after a repeated START.
+ * One bus transaction instead of two; the PCF8575 latches the outputs on the
+ * write ACK, so the read address phase is enough settling time.
+ * @param value Bitmask for all pins.
+ * @param readValue Out parameter for pin states.
  ***************************************************************/
-void IOExpander::digitalWrite(u8 pin, u8 value)
+bool IOExpander::transferPort(u16 value, u16 &readValue)
 {
-        if (pin > 15)
-                return;
+        _wire->beginTransmission(_address);
+        _wire->write(value & 0xFF);
+        _wire->write((value >> 8) & 0xFF);
+        if (_wire->endTransmission(false) != 0) // No STOP: read follows
+        {
+                trackResult(false);
+                return false;
+        }
+
+        markWritten(value);
+        return readPort(readValue);
+}
 
-        if (value == HIGH)
+/************************* markWritten *************************************
+ * A successful write carries every pending non-keypad bit; keypad strobes
+ * differ from _outputState only in the matrix pins.
+ ***************************************************************/
+void IOExpander::markWritten(u16 value)
+{
+        if (((value ^ _outputState) & ~(KEYPAD_ROW_MASK | KEYPAD_COL_MASK)) == 0)
+                _dirty = false;
+}
+
+/************************* trackResult *************************************
+ * Count a transaction result. After FALLBACK_ERRORS failures in a row at
+ * fast mode, drop the bus to standard mode (stays there until reboot).
+ ***************************************************************/
+void IOExpander::trackResult(bool ok)
+{
+        if (ok)
         {
-                _outputState |= (1 << pin); // Set bit
+                _errorStreak = 0;
+                return;
         }
-        else
+
+        _i2cErrors++;
+        if (++_errorStreak >= I2CConfig::FALLBACK_ERRORS && _busHz > I2CConfig::STANDARD_HZ)
         {
-                _outputState &= ~(1 << pin); // Clear bit
+                Serial.printf("[IOX] %u I2C errors in a row, falling back to %lu Hz\n",
+                              (unsigned)_errorStreak, (unsigned long)I2CConfig::STANDARD_HZ);
+                setBusSpeed(I2CConfig::STANDARD_HZ);
         }
+}
 
-        writePort(_outputState);
+/************************* digitalWrite ************************************
+ * Set a single pin state (0-15) in the shadow register.
+ ***************************************************************/
+void IOExpander::digitalWrite(u8 pin, u8 value)
+{
+        if (pin > 15)
+                return;
+
+        setOutputBits(1 << pin, (value == HIGH) ? (1 << pin) : 0);
 }
 
 /************************* digitalRead *************************************
- * Read a single pin state (0-15).
+ * Read a single pin state (0-15) from the cycle snapshot.
  ***************************************************************/
 u8 IOExpander::digitalRead(u8 pin)
 {
         if (pin > 15)
                 return LOW;
 
-        u16 value;
-        if (!readPort(value))
-        {
-                return LOW; // Return LOW on error
-        }
-
-        return (value & (1 << pin)) ? HIGH : LOW;
+        return (read() & (1 << pin)) ? HIGH : LOW;
 }
 
 /************************* write ******************************************
- * Set all 16 pins at once.
+ * Set all 16 pins at once in the shadow register.
  * @param value Bitmask for outputs.
  ***************************************************************/
 void IOExpander::write(u16 value)
 {
-        _outputState = value;
-        writePort(_outputState);
+        setOutputBits(0xFFFF, value);
 }
 
 /************************* read *******************************************
- * Read all 16 pins at once.
+ * Read all 16 pins; hits the bus only once per cycle.
+ * On a failed read the previous snapshot is returned.
  * @return 16-bit port snapshot.
  ***************************************************************/
 u16 IOExpander::read()
 {
-        u16 value;
-        readPort(value);
-        return value;
+        if (!_inputValid && _isPresent)
+        {
+                u16 value;
+                readPort(value);
+        }
+        return _inputState;
 }
 
 /************************* scanKeypad **************************************
- * Scan keypad matrix with debouncing.
- * 1) Rate limit to SCAN_RATE_MS.
- * 2) Matrix scan row-by-row.
- * 3) Require DEBOUNCE_COUNT stable reads.
- * 4) Fire on release to avoid repeats.
- * @return Key index 0-15, or 255 if none.
+ * Scan keypad matrix with n-key rollover.
+ * 1) Rate limit to SCAN_RATE_MS (or stay parked while idle).
+ * 2) Read the matrix into a 16-bit raw bitmap (see readMatrix).
+ * 3) Freeze keys that may be ghosts (diode-less matrix).
+ * 4) Vertical-counter debounce: a key toggles after DEBOUNCE_COUNT equal reads.
+ * 5) Report press/release edges and hold crossings as bitmaps.
+ * @param events Out: event bitmaps (cleared when no scan runs).
+ * @return true if any event bit is set.
  ***************************************************************/
-u8 IOExpander::scanKeypad()
+bool IOExpander::scanKeypad(KeypadEvents &events)
 {
-        // Rate limiting: Only scan every SCAN_RATE_MS
+        events.pressed = 0;
+        events.released = 0;
+        events.held = 0;
+
         unsigned long currentTime = millis();
-        if (currentTime - _lastScanTime < KeypadConfig::SCAN_RATE_MS)
+
+        // Interrupt mode: stay parked until INT fires (or the slow safety poll)
+        if (_intEnabled && _keypadIdle)
+        {
+                if (!_intPending)
+                {
+                        if (currentTime - _lastScanTime < KeypadConfig::IDLE_POLL_MS)
+                                return false;
+
+                        // Safety poll: one read of the parked port
+                        _lastScanTime = currentTime;
+                        u16 parked;
+                        if (!readPort(parked) || (parked & KEYPAD_COL_MASK) == KEYPAD_COL_MASK)
+                                return false;
+                }
+
+                // Key activity: leave idle and scan immediately (no rate limit)
+                _intPending = false;
+                _keypadIdle = false;
+        }
+        else
         {
-                return _stableKeyIndex; // Return last stable key
+                // Rate limiting: Only scan every SCAN_RATE_MS
+                if (currentTime - _lastScanTime < KeypadConfig::SCAN_RATE_MS)
+                {
+                        return false; // No event between scans
+                }
         }
         _lastScanTime = currentTime;
 
-        // Perform raw matrix scan
-        u8 detectedKeyIndex = 255;
-        bool keyFound = false;
+        PROBE_SCOPE(PROBE_KEYPAD_SCAN); // Only real scans, not rate-limited calls
 
-        // Set all columns HIGH (inactive) and all rows HIGH (ready to scan)
-        u16 baseState = _outputState;
+        u16 raw = readMatrix();
 
-        // Set all keypad pins HIGH initially
-        for (u8 row = 0; row < KEYPAD_ROWS; row++)
+        // Ghosting: ambiguous keys keep their debounced state until resolved
+        _ghostKeys = ghostMask(raw);
+        if (_ghostKeys)
         {
-                baseState |= (1 << (KEYPAD_ROW_START + row));
+                _ghostCount++;
+                raw = (raw & ~_ghostKeys) | (_keyState & _ghostKeys);
         }
-        for (u8 col = 0; col < KEYPAD_COLS; col++)
+        _rawKeys = raw;
+
+        // Vertical counter: per-key 2-bit counter in (_ct1,_ct0), reset while
+        // raw == state, counts down while it differs, toggles on wrap
+        u16 delta = raw ^ _keyState;
+        _ct0 = ~(_ct0 & delta);
+        _ct1 = _ct0 ^ (_ct1 & delta);
+        u16 toggle = delta & _ct0 & _ct1;
+        _keyState ^= toggle;
+
+        events.pressed = toggle & _keyState;
+        events.released = toggle & ~_keyState;
+        _heldKeys &= _keyState;
+
+        // Per-key timing only for keys that changed or are waiting for hold
+        u16 timing = events.pressed | (_keyState & ~_heldKeys);
+        for (u8 i = 0; timing; i++, timing >>= 1)
         {
-                baseState |= (1 << (KEYPAD_COL_START + col));
+                if (!(timing & 1))
+                        continue;
+
+                u16 bit = 1 << i;
+                if (events.pressed & bit)
+                {
+                        _pressTime[i] = currentTime;
+                }
+                else if (currentTime - _pressTime[i] >= KeypadConfig::HOLD_MS)
+                {
+                        events.held |= bit;
+                        _heldKeys |= bit;
+                }
         }
 
-        // Scan each row
-        for (u8 row = 0; row < KEYPAD_ROWS; row++)
+        // Interrupt mode: everything released and settled -> park and wait for INT
+        if (_intEnabled && _keyState == 0 && raw == 0 && (u16)(_ct0 & _ct1) == 0xFFFF)
         {
-                // Set current row LOW, others HIGH
-                u16 scanState = baseState;
-                scanState &= ~(1 << (KEYPAD_ROW_START + row)); // Current row LOW
+                parkKeypad();
+        }
+
+        return (events.pressed | events.released | events.held) != 0;
+}
+
+/************************* readMatrix **************************************
+ * Read the matrix in as few I2C transactions as the wiring allows.
+ * 1) Rows LOW, read columns (1 transaction; the idle case ends here).
+ * 2) Columns LOW, read rows (the PCF8575 pins are quasi-bidirectional).
+ * 3) One active row or one active column: the bitmap is the row x column
+ *    product and is exact. Otherwise read each active row (chords).
+ * 4) Return to rows LOW, which is also the parked state for INT.
+ * A failed read keeps the previous raw bitmap.
+ * @return Raw key bitmap (bit row*KEYPAD_COLS+col, 1 = contact closed).
+ ***************************************************************/
+u16 IOExpander::readMatrix()
+{
+        u16 rest = (_outputState & ~KEYPAD_ROW_MASK) | KEYPAD_COL_MASK;
+        _outputState = rest;
 
-                writePort(scanState);
-                delayMicroseconds(10); // Allow signals to settle
+        // Columns pulled LOW by any closed key while all rows are LOW
+        u16 value;
+        if (!transferPort(rest, value))
+                return _rawKeys;
+
+        u8 cols = (~value >> KEYPAD_COL_START) & 0x000F;
+        if (cols == 0)
+                return 0; // Idle: matrix already in rest state
+
+        // Reverse drive: rows pulled LOW by any closed key while all columns are LOW
+        u16 raw = 0;
+        bool ok = transferPort((rest | KEYPAD_ROW_MASK) & ~KEYPAD_COL_MASK, value);
+        u8 rows = (~value >> KEYPAD_ROW_START) & 0x000F;
 
-                // Read the port
-                u16 readValue;
-                if (!readPort(readValue))
+        if (ok && ((rows & (rows - 1)) == 0 || (cols & (cols - 1)) == 0))
+        {
+                // Single row or single column: no ambiguity, build the product
+                for (u8 row = 0; row < KEYPAD_ROWS; row++)
                 {
-                        continue; // Skip on read error
+                        if (rows & (1 << row))
+                                raw |= (u16)cols << (row * KEYPAD_COLS);
                 }
+        }
+        else if (ok)
+        {
+                ok = readRows(rows, raw);
+        }
+
+        writePort(rest);
+        return ok ? raw : _rawKeys;
+}
 
-                // Check each column
-                for (u8 col = 0; col < KEYPAD_COLS; col++)
+/************************* readRows ****************************************
+ * Drive each requested row LOW in turn and read its columns.
+ * @param rowMask Rows to read (bit n = row n).
+ * @param raw Out: key bits for the requested rows.
+ ***************************************************************/
+bool IOExpander::readRows(u8 rowMask, u16 &raw)
+{
+        // All columns HIGH (inputs), all rows HIGH except the one being read
+        u16 baseState = _outputState | KEYPAD_ROW_MASK | KEYPAD_COL_MASK;
+
+        for (u8 row = 0; row < KEYPAD_ROWS; row++)
+        {
+                if (!(rowMask & (1 << row)))
+                        continue;
+
+                u16 value;
+                if (!transferPort(baseState & ~(1 << (KEYPAD_ROW_START + row)), value))
+                        return false;
+
+                // Columns read LOW where a key closes the contact
+                raw |= ((~value >> KEYPAD_COL_START) & 0x000F) << (row * KEYPAD_COLS);
+        }
+        return true;
+}
+
+/************************* benchmarkScan ***********************************
+ * Print average matrix read time for the legacy and the current scan at
+ * STANDARD_HZ and FAST_HZ. Press keys during the run to time the chord path.
+ * @param iterations Reads per measurement.
+ ***************************************************************/
+void IOExpander::benchmarkScan(u16 iterations)
+{
+        if (!_isPresent || iterations == 0)
+                return;
+
+        const u32 speeds[] = {I2CConfig::STANDARD_HZ, I2CConfig::FAST_HZ};
+        u32 savedHz = _busHz;
+
+        Serial.println("┌─ KEYPAD SCAN BENCHMARK ─────────────────────────────┐");
+        for (u8 s = 0; s < 2; s++)
+        {
+                setBusSpeed(speeds[s]);
+
+                // Legacy: 4x (write, settle, read) + restore = 9 transactions
+                u32 start = micros();
+                for (u16 i = 0; i < iterations; i++)
                 {
-                        u8 colPin = KEYPAD_COL_START + col;
-                        if ((readValue & (1 << colPin)) == 0)
-                        {                                                   // Column is LOW (key pressed)
-                                detectedKeyIndex = row * KEYPAD_COLS + col; // Calculate linear index (0-15)
-                                keyFound = true;
-                                break; // Found a key, stop scanning
+                        u16 baseState = _outputState | KEYPAD_ROW_MASK | KEYPAD_COL_MASK;
+                        for (u8 row = 0; row < KEYPAD_ROWS; row++)
+                        {
+                                u16 value;
+                                writePort(baseState & ~(1 << (KEYPAD_ROW_START + row)));
+                                delayMicroseconds(10);
+                                readPort(value);
                         }
+                        writePort(_outputState | KEYPAD_COL_MASK);
+                }
+                u32 legacyUs = (micros() - start) / iterations;
+
+                // Current: 1 transaction idle, 3 single key, 3 + rows for chords
+                start = micros();
+                for (u16 i = 0; i < iterations; i++)
+                {
+                        readMatrix();
                 }
+                u32 fastUs = (micros() - start) / iterations;
 
-                if (keyFound)
-                        break;
+                Serial.printf("│ %3lu kHz  legacy %5lu us   current %5lu us\n",
+                              (unsigned long)(speeds[s] / 1000),
+                              (unsigned long)legacyUs, (unsigned long)fastUs);
         }
+        Serial.println("└─────────────────────────────────────────────────────┘");
 
-        // Restore all rows HIGH
-        writePort(baseState);
+        setBusSpeed(savedHz);
+}
+
+/************************* ghostMask ***************************************
+ * Without diodes, three keys on the corners of a rectangle make the fourth
+ * corner read as pressed. Any two rows sharing two or more active columns
+ * are ambiguous in those columns.
+ * @param raw Raw key bitmap.
+ * @return Bitmap of keys that cannot be trusted.
+ ***************************************************************/
+u16 IOExpander::ghostMask(u16 raw)
+{
+        u16 mask = 0;
 
-        // Debouncing state machine
-        if (detectedKeyIndex == _rawKeyIndex)
+        for (u8 a = 0; a < KEYPAD_ROWS - 1; a++)
         {
-                // Same key as last scan - increment stability counter
-                _debounceCount++;
+                u8 rowA = (raw >> (a * KEYPAD_COLS)) & 0x000F;
+                if ((rowA & (rowA - 1)) == 0)
+                        continue; // Fewer than two keys: cannot form a rectangle
 
-                if (_debounceCount >= KeypadConfig::DEBOUNCE_COUNT)
+                for (u8 b = a + 1; b < KEYPAD_ROWS; b++)
                 {
-                        // Key is stable (DEBOUNCE_COUNT consecutive reads)
-                        if (detectedKeyIndex != _stableKeyIndex)
+                        u8 common = rowA & (raw >> (b * KEYPAD_COLS)) & 0x000F;
+                        if (common & (common - 1))
                         {
-                                // Key state changed and is stable
-                                if (detectedKeyIndex == 255)
-                                {
-                                        // Key released - Fire the event here!
-                                        if (_pressedKeyIndex != 255)
-                                        {
-                                                // Enforce minimum MIN_PRESS_INTERVAL_MS between key events
-                                                if (currentTime - _lastKeyPressTime >= KeypadConfig::MIN_PRESS_INTERVAL_MS)
-                                                {
-                                                        _lastKeyIndex = _pressedKeyIndex;
-
-                                                        // Update row/col/char for compatibility
-                                                        _lastKeyRow = _pressedKeyIndex / KEYPAD_COLS;
-                                                        _lastKeyCol = _pressedKeyIndex % KEYPAD_COLS;
-                                                        _lastKey = KEYPAD_KEYS[_lastKeyRow][_lastKeyCol];
-                                                        _keyPressed = true;              // Signal that event should fire
-                                                        _lastKeyPressTime = currentTime; // Record time of event
-
-                                                        _pressedKeyIndex = 255; // Clear pressed key
-                                                }
-                                                else
-                                                {
-                                                        _pressedKeyIndex = 255; // Clear but don't fire event
-                                                }
-                                        }
-                                        _stableKeyIndex = 255;
-                                }
-                                else if (_stableKeyIndex == 255)
-                                {
-                                        // New key pressed - Just track it, don't fire event yet
-                                        _stableKeyIndex = detectedKeyIndex;
-                                        _pressedKeyIndex = detectedKeyIndex; // Remember which key is pressed
-                                        _keyPressed = false;                 // No event yet
-                                }
+                                mask |= (u16)common << (a * KEYPAD_COLS);
+                                mask |= (u16)common << (b * KEYPAD_COLS);
                         }
                 }
         }
-        else
-        {
-                // Different key detected - reset debounce counter
-                _rawKeyIndex = detectedKeyIndex;
-                _debounceCount = 1;
-        }
 
-        // Only return a valid key index when an event should fire (key released)
-        // Otherwise return 255 to indicate no event
-        if (_keyPressed)
+        return mask;
+}
+
+//============================================================================
+// OUTPUT COALESCING
+//============================================================================
+
+/************************* setOutputBits ***********************************
+ * Change output bits without touching the bus.
+ * The next port write (flush, keypad strobe, pin write) carries them.
+ * @param mask Bits to change.
+ * @param value New values for the masked bits.
+ ***************************************************************/
+void IOExpander::setOutputBits(u16 mask, u16 value)
+{
+        u16 state = (_outputState & ~mask) | (value & mask);
+        if (state != _outputState)
         {
-                _keyPressed = false; // Clear the flag after returning
-                return _lastKeyIndex;
+                _outputState = state;
+                _dirty = true;
         }
-        return 255; // No event to fire
 }
 
-/************************* getKeypadBitmap ********************************
- * Read keypad state as a 16-bit bitmap (1=pressed).
+/************************* flush *******************************************
+ * Write pending output changes (no transaction when nothing changed).
+ * @return true if the port is up to date.
  ***************************************************************/
-/* IOExpander::getKeypadBitmap removed (unused). */
+bool IOExpander::flush()
+{
+        if (!_dirty || !_isPresent)
+                return !_dirty;
 
-/************************* setMotorA **************************************
- * Control motor A direction/state.
+        return writePort(_outputState);
+}
+
+//============================================================================
+// MOTOR CONTROL
+//============================================================================
+
+/************************* motorBits ***************************************
+ * H-bridge input pattern for one motor (already shifted into place).
+ * @param motor Motor index (0-3 = A-D).
+ * @param direction Requested state.
  ***************************************************************/
-void IOExpander::setMotorA(MotorDirection direction)
+u16 IOExpander::motorBits(u8 motor, MotorDirection direction)
 {
-        u16 state = _outputState;
-
-        // Clear motor A bits
-        state &= ~((1 << MOT1A) | (1 << MOT1B));
+        u8 pinA = MOT1A + motor * 2; // IN1
+        u8 pinB = pinA + 1;          // IN2
 
         switch (direction)
         {
         case MOTOR_FORWARD:
-                state |= (1 << MOT1A); // IN1=HIGH, IN2=LOW
-                break;
+                return (1 << pinA); // IN1=HIGH, IN2=LOW
         case MOTOR_REVERSE:
-                state |= (1 << MOT1B); // IN1=LOW, IN2=HIGH
-                break;
+                return (1 << pinB); // IN1=LOW, IN2=HIGH
         case MOTOR_BRAKE:
-                state |= (1 << MOT1A) | (1 << MOT1B); // Both HIGH
-                break;
+                return (1 << pinA) | (1 << pinB); // Both HIGH
         case MOTOR_STOP:
         default:
-                // Both LOW (already cleared)
-                break;
+                return 0; // Both LOW (coast)
         }
-
-        _outputState = state;
-        writePort(_outputState);
 }
 
-/************************* setMotorB **************************************
- * Control motor B direction/state.
+/************************* setMotor ****************************************
+ * Control one motor's direction/state (written on next flush).
+ * @param motor Motor index (0-3 = A-D).
+ * @param direction MOTOR_STOP, MOTOR_FORWARD, MOTOR_REVERSE, or MOTOR_BRAKE.
  ***************************************************************/
-void IOExpander::setMotorB(MotorDirection direction)
+void IOExpander::setMotor(u8 motor, MotorDirection direction)
 {
-        u16 state = _outputState;
-
-        // Clear motor B bits
-        state &= ~((1 << MOT2A) | (1 << MOT2B));
+        if (motor >= MOTOR_COUNT)
+                return;
 
-        switch (direction)
-        {
-        case MOTOR_FORWARD:
-                state |= (1 << MOT2A); // IN1=HIGH, IN2=LOW
-                break;
-        case MOTOR_REVERSE:
-                state |= (1 << MOT2B); // IN1=LOW, IN2=HIGH
-                break;
-        case MOTOR_BRAKE:
-                state |= (1 << MOT2A) | (1 << MOT2B); // Both HIGH
-                break;
-        case MOTOR_STOP:
-        default:
-                // Both LOW (already cleared)
-                break;
-        }
+        setOutputBits(motorBits(motor, MOTOR_BRAKE), motorBits(motor, direction));
+}
 
-        _outputState = state;
-        writePort(_outputState);
+/************************* setMotorA **************************************
+ * Control motor A direction/state.
+ ***************************************************************/
+void IOExpander::setMotorA(MotorDirection direction)
+{
+        setMotor(0, direction);
 }
 
-/************************* stopAllMotors **********************************
- * Stop/brake all configured motors.
+/************************* setMotorB **************************************
+ * Control motor B direction/state.
  ***************************************************************/
-void IOExpander::stopAllMotors()
+void IOExpander::setMotorB(MotorDirection direction)
 {
-        setMotorA(MOTOR_STOP);
-        setMotorB(MOTOR_STOP);
-        setMotorC(MOTOR_STOP);
-        setMotorD(MOTOR_STOP);
+        setMotor(1, direction);
 }
 
 /************************* setMotorC **************************************
@@ -356,30 +602,7 @@ void IOExpander::stopAllMotors()
  ***************************************************************/
 void IOExpander::setMotorC(MotorDirection direction)
 {
-        u16 state = _outputState;
-
-        // Clear motor C bits
-        state &= ~((1 << MOT3A) | (1 << MOT3B));
-
-        switch (direction)
-        {
-        case MOTOR_FORWARD:
-                state |= (1 << MOT3A); // IN1=HIGH, IN2=LOW
-                break;
-        case MOTOR_REVERSE:
-                state |= (1 << MOT3B); // IN1=LOW, IN2=HIGH
-                break;
-        case MOTOR_BRAKE:
-                state |= (1 << MOT3A) | (1 << MOT3B); // Both HIGH
-                break;
-        case MOTOR_STOP:
-        default:
-                // Both LOW (already cleared)
-                break;
-        }
-
-        _outputState = state;
-        writePort(_outputState);
+        setMotor(2, direction);
 }
 
 /************************* setMotorD **************************************
@@ -387,28 +610,13 @@ void IOExpander::setMotorC(MotorDirection direction)
  ***************************************************************/
 void IOExpander::setMotorD(MotorDirection direction)
 {
-        u16 state = _outputState;
-
-        // Clear motor D bits
-        state &= ~((1 << MOT4A) | (1 << MOT4B));
-
-        switch (direction)
-        {
-        case MOTOR_FORWARD:
-                state |= (1 << MOT4A); // IN1=HIGH, IN2=LOW
-                break;
-        case MOTOR_REVERSE:
-                state |= (1 << MOT4B); // IN1=LOW, IN2=HIGH
-                break;
-        case MOTOR_BRAKE:
-                state |= (1 << MOT4A) | (1 << MOT4B); // Both HIGH
-                break;
-        case MOTOR_STOP:
-        default:
-                // Both LOW (already cleared)
-                break;
-        }
+        setMotor(3, direction);
+}
 
-        _outputState = state;
-        writePort(_outputState);
+/************************* stopAllMotors **********************************
+ * Stop (coast) all motors; one write on the next flush.
+ ***************************************************************/
+void IOExpander::stopAllMotors()
+{
+        setOutputBits(MOTOR_MASK, 0);
 }
@@ -34,11 +34,7 @@
 
 // Timer configuration: ISR interval in milliseconds
 // Note: Using extern const instead of constexpr to allow cross-compilation unit visibility
-extern const u8 ISR_INTERVAL_MS = 5;  // 5 ms = 200 Hz
-extern const u8 ANIM_REFRESH_MS = 40; // 40 ms = 25 Hz pixel buffer update
-
-// Flag to signal pixel update from ISR
-volatile bool pixelUpdateFlag = false;
+extern const u8 ISR_INTERVAL_MS = 5; // 5 ms = 200 Hz
 
 //============================================================================
 // HARDWARE OBJECTS
@@ -48,6 +44,7 @@ volatile bool pixelUpdateFlag = false;
 Synth synth(SPKR_PIN, AUDIO_PWM_CHANNEL);
 
 // PixelStrip(pin, logicalCount, groupSize, brightness)
+// Core resizes it to the device type's cellCount at boot (16 if it has none)
 PixelStrip pixels(PIXEL_PIN, 16, 1, PIXEL_BRIGHTNESS);
 
 // RS-485 communication for Room Bus
@@ -68,19 +65,17 @@ Core core(&pixels, &synth, &animation, &inputManager, &roomBus, &ioExpander);
 // ISR AND SYSTEM FUNCTIONS
 //============================================================================
 
-// Timer ISR: refresh button logic and trigger pixel updates
+// Timer ISR: refresh button logic and wake the input task on button events
 /************************* refreshTimer ***********************************
- * ISR: refresh button logic and trigger pixel updates on schedule.
+ * ISR: debounce buttons; wake the Core input task when an event is latched.
  ***************************************************************/
 void IRAM_ATTR refreshTimer()
 {
-  static u8 animDelay = 0;
-
   updateButtons();
 
-  // Trigger pixel update based on ANIM_REFRESH_MS / ISR_INTERVAL_MS
-  if (!(++animDelay % (ANIM_REFRESH_MS / ISR_INTERVAL_MS)))
-    pixelUpdateFlag = true;
+  // Deliver button events immediately instead of at the next input tick
+  if (buttons[BTN1].released || buttons[BTN1].longPressed)
+    core.notifyFromISR(TASK_INPUT);
 }
 
 //============================================================================
@@ -102,19 +97,14 @@ void setup()
 // ARDUINO MAIN LOOP
 //============================================================================
 /************************* loop *******************************************
- * Arduino main loop: watchdog feed, animation refresh, core update.
+ * Arduino main loop: watchdog feed, core update.
  ***************************************************************/
 void loop()
 {
   // Feed the watchdog
   Watchdog::reset();
 
-  // Refresh pixel animations (timing-critical, driven by ISR flag)
-  core.refreshAnimations(pixelUpdateFlag);
-
-  // Update core firmware (handles inputs, status LED, and Room Bus)
+  // Run due core tasks (inputs, Room Bus, status LED, app, animation),
+  // then sleep until the next deadline or an interrupt wakes us
   core.update();
-
-  // Small delay to prevent hot loop
-  delay(10);
 }
\ No newline at end of file
@@ -69,6 +69,7 @@ const u8 MatrixPanel::kKeyToLedMap[KEYPAD_SIZE] = {
 /**
  * @brief Construct a new MatrixPanel object
  * @param pixels Pointer to PixelStrip controller for LED operations
+ * @param firstLed Strip index of the panel's first LED (0 when the panel is the whole strip)
  *
  * Initializes the matrix panel with a reference to the LED strip controller.
  * The PixelStrip must be already initialized and remain valid for the lifetime
@@ -77,7 +78,8 @@ const u8 MatrixPanel::kKeyToLedMap[KEYPAD_SIZE] = {
 /************************* MatrixPanel constructor **************************
  * Construct with PixelStrip controller reference.
  ***************************************************************/
-MatrixPanel::MatrixPanel(PixelStrip *pixels) : m_pixels(pixels)
+MatrixPanel::MatrixPanel(PixelStrip *pixels, u16 firstLed)
+    : m_pixels(pixels), m_firstLed(firstLed)
 {
 }
 
@@ -182,7 +184,7 @@ void MatrixPanel::ledControl(u8 logicalIndex, u8 r, u8 g, u8 b)
         }
 
         // Map logical index to physical LED index using the wiring table
-        u8 physicalLedIndex = kKeyToLedMap[logicalIndex];
+        u16 physicalLedIndex = m_firstLed + kKeyToLedMap[logicalIndex];
 
         // Check if physical LED exists
         if (physicalLedIndex >= m_pixels->getCount())
@@ -328,3 +330,56 @@ void MatrixPanel::fill(u8 r, u8 g, u8 b)
                 ledControl(i, r, g, b);
         }
 }
+
+//============================================================================
+// TRANSITIONS
+//============================================================================
+
+/**
+ * @brief Fade one LED by logical index to a color
+ * @param logicalIndex Logical cell index (0-15)
+ * @param color 32-bit RGB target color in format 0x00RRGGBB
+ * @param durationMs Fade time in ms (0 = set immediately)
+ * @param easing Transition curve
+ *
+ * Maps the cell like ledControl() and hands the fade to the strip, which
+ * advances it on every refresh. Setting the cell again cancels the fade.
+ */
+/************************* fadeCell ****************************************
+ * Fade LED by logical index to a packed color.
+ ***************************************************************/
+void MatrixPanel::fadeCell(u8 logicalIndex, u32 color, u16 durationMs, FadeEasing easing)
+{
+        if (logicalIndex >= KEYPAD_SIZE)
+        {
+                return;
+        }
+
+        u16 physicalLedIndex = m_firstLed + kKeyToLedMap[logicalIndex];
+        if (physicalLedIndex >= m_pixels->getCount())
+        {
+                return;
+        }
+
+        m_pixels->fadeTo(physicalLedIndex, color, durationMs, easing);
+}
+
+/**
+ * @brief Fade all LEDs to the same color
+ * @param color 32-bit RGB target color in format 0x00RRGGBB
+ * @param durationMs Fade time in ms (0 = set immediately)
+ * @param easing Transition curve
+ *
+ * Cells started within the same millisecond share one fade slot on the
+ * strip, so a whole-panel fade normally costs a single slot.
+ */
+/************************* fadeAll *****************************************
+ * Fade all LEDs to a packed color.
+ ***************************************************************/
+void MatrixPanel::fadeAll(u32 color, u16 durationMs, FadeEasing easing)
+{
+        for (u8 i = 0; i < KEYPAD_SIZE; i++)
+        {
+                fadeCell(i, color, durationMs, easing);
+        }
+}
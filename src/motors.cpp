@@ -0,0 +1,232 @@
+/************************* motors.cpp ***************************
+ * Motor Controller Implementation
+ * Time-sliced PWM, ramps and timed moves on the I/O expander
+ * Created by MSK, November 2025
+ * Port bits are computed in update() and written once per slice
+ ***************************************************************/
+
+#include "motors.h"
+
+//============================================================================
+// CONSTRUCTOR
+//============================================================================
+
+/************************* MotorController constructor *********************
+ * All motors stopped, default ramp.
+ ***************************************************************/
+MotorController::MotorController(IOExpander *io)
+    : m_io(io), m_lastUpdate(0), m_wake(nullptr)
+{
+        for (u8 i = 0; i < MOTOR_COUNT; i++)
+        {
+                m_motors[i].target = 0;
+                m_motors[i].speed = 0;
+                m_motors[i].rampRate = MotorConfig::DEFAULT_RAMP;
+                m_motors[i].stopAt = 0;
+                m_motors[i].brake = false;
+        }
+}
+
+//============================================================================
+// COMMANDS
+//============================================================================
+
+/************************* setSpeed ****************************************
+ * Set target speed; ramping happens in update().
+ * @param motor Motor index (0-3).
+ * @param speed -100..100.
+ ***************************************************************/
+void MotorController::setSpeed(u8 motor, int8_t speed)
+{
+        if (motor >= MOTOR_COUNT)
+                return;
+
+        MotorState &m = m_motors[motor];
+        m.target = constrain(speed, -100, 100);
+        m.stopAt = 0;
+        m.brake = false;
+        wake();
+}
+
+/************************* run *********************************************
+ * Timed move: run at speed, then ramp down after durationMs.
+ * @param motor Motor index (0-3).
+ * @param speed -100..100.
+ * @param durationMs Move time in ms.
+ ***************************************************************/
+void MotorController::run(u8 motor, int8_t speed, u32 durationMs)
+{
+        if (motor >= MOTOR_COUNT)
+                return;
+
+        setSpeed(motor, speed);
+        u32 end = millis() + durationMs;
+        m_motors[motor].stopAt = end ? end : 1; // 0 means "no timed move"
+}
+
+/************************* stop ********************************************
+ * Stop now without ramping; goes out with this pass's expander flush.
+ * @param motor Motor index (0-3).
+ * @param brake true = brake, false = coast.
+ ***************************************************************/
+void MotorController::stop(u8 motor, bool brake)
+{
+        if (motor >= MOTOR_COUNT)
+                return;
+
+        MotorState &m = m_motors[motor];
+        m.target = 0;
+        m.speed = 0;
+        m.stopAt = 0;
+        m.brake = brake;
+        tick();
+}
+
+/************************* stopAll *****************************************
+ * Coast all motors now.
+ ***************************************************************/
+void MotorController::stopAll()
+{
+        for (u8 i = 0; i < MOTOR_COUNT; i++)
+        {
+                m_motors[i].target = 0;
+                m_motors[i].speed = 0;
+                m_motors[i].stopAt = 0;
+                m_motors[i].brake = false;
+        }
+        tick();
+}
+
+/************************* setExpander *************************************
+ * Re-home the motors; the old expander is left coasting.
+ ***************************************************************/
+void MotorController::setExpander(IOExpander *io)
+{
+        if (!io || io == m_io)
+                return;
+
+        stopAll();
+        m_io->stopAllMotors();
+        m_io = io;
+}
+
+/************************* setRamp *****************************************
+ * Set acceleration rate in %/s (0 = instant).
+ ***************************************************************/
+void MotorController::setRamp(u8 motor, u16 percentPerSec)
+{
+        if (motor < MOTOR_COUNT)
+                m_motors[motor].rampRate = percentPerSec;
+}
+
+//============================================================================
+// STATE
+//============================================================================
+
+/************************* getSpeed ****************************************
+ * Current ramped speed in percent.
+ ***************************************************************/
+int8_t MotorController::getSpeed(u8 motor) const
+{
+        if (motor >= MOTOR_COUNT)
+                return 0;
+
+        return m_motors[motor].speed / MotorConfig::SPEED_SCALE;
+}
+
+/************************* isActive ****************************************
+ * True while any motor runs, ramps or has a timed move pending.
+ ***************************************************************/
+bool MotorController::isActive() const
+{
+        for (u8 i = 0; i < MOTOR_COUNT; i++)
+        {
+                const MotorState &m = m_motors[i];
+                if (m.speed || m.target || m.stopAt)
+                        return true;
+        }
+        return false;
+}
+
+/************************* update ******************************************
+ * Advance timed moves and ramps, then compute this slice's outputs.
+ * Motor n is on for the first duty slices after its phase offset
+ * (n * PWM_STEPS / MOTOR_COUNT); the off part of the period coasts.
+ * @param now Time in ms.
+ * @return Motor pin bits.
+ ***************************************************************/
+u16 MotorController::update(u32 now)
+{
+        u32 elapsed = now - m_lastUpdate;
+        if (elapsed > MotorConfig::PWM_PERIOD_MS)
+                elapsed = MotorConfig::PWM_PERIOD_MS; // After idle or a late tick: no jump
+        m_lastUpdate = now;
+
+        u8 slice = (now / MotorConfig::TICK_MS) % MotorConfig::PWM_STEPS;
+        u16 bits = 0;
+
+        for (u8 i = 0; i < MOTOR_COUNT; i++)
+        {
+                MotorState &m = m_motors[i];
+
+                // Timed move finished: ramp down from here
+                if (m.stopAt && (int32_t)(now - m.stopAt) >= 0)
+                {
+                        m.target = 0;
+                        m.stopAt = 0;
+                }
+
+                // Ramp towards target
+                int16_t target = m.target * MotorConfig::SPEED_SCALE;
+                if (m.speed != target)
+                {
+                        int32_t step = (int32_t)m.rampRate * elapsed * MotorConfig::SPEED_SCALE / 1000;
+                        if (m.rampRate == 0)
+                                step = 2 * 100 * MotorConfig::SPEED_SCALE; // Full range in one step
+                        else if (step == 0 && elapsed)
+                                step = 1;
+
+                        if (m.speed < target)
+                                m.speed = (m.speed + step > target) ? target : m.speed + step;
+                        else
+                                m.speed = (m.speed - step < target) ? target : m.speed - step;
+                }
+
+                if (m.speed == 0)
+                {
+                        if (m.brake)
+                                bits |= IOExpander::motorBits(i, MOTOR_BRAKE);
+                        continue;
+                }
+
+                // Duty in slices (rounded), phase-staggered per motor
+                u16 magnitude = (m.speed < 0) ? -m.speed : m.speed;
+                u8 duty = (magnitude * MotorConfig::PWM_STEPS + 50 * MotorConfig::SPEED_SCALE) /
+                          (100 * MotorConfig::SPEED_SCALE);
+                u8 phase = (slice + MotorConfig::PWM_STEPS - (i * MotorConfig::PWM_STEPS / MOTOR_COUNT)) %
+                           MotorConfig::PWM_STEPS;
+
+                if (phase < duty)
+                        bits |= IOExpander::motorBits(i, (m.speed > 0) ? MOTOR_FORWARD : MOTOR_REVERSE);
+        }
+
+        return bits;
+}
+
+/************************* tick ********************************************
+ * Apply the current slice to the expander shadow register; Core's end of
+ * pass flush writes it (only if bits changed).
+ ***************************************************************/
+void MotorController::tick()
+{
+        m_io->setOutputBits(MOTOR_MASK, update(millis()));
+}
+
+/************************* wake ********************************************
+ * Ask the owner to start ticking.
+ ***************************************************************/
+void MotorController::wake()
+{
+        if (m_wake)
+                m_wake();
+}
@@ -1,5 +1,6 @@
 #include "music.h"
 #include "songs.h"
+#include "assetstore.h"
 
 MusicPlayer::MusicPlayer(Synth *s) : synth(s), playing(false), bpm(120)
 {
@@ -10,6 +11,14 @@ MusicPlayer::MusicPlayer(Synth *s) : synth(s), playing(false), bpm(120)
         msPerTick = 0;
         tickCounter = 0;
         ticksUntilNextStep = 0;
+        assetNotes = nullptr;
+        assetCapacity = 0;
+}
+
+MusicPlayer::~MusicPlayer()
+{
+        stopAsset();
+        delete[] assetNotes;
 }
 
 void MusicPlayer::play(const MusicNote *melody, u16 length, u8 newBpm)
@@ -35,6 +44,67 @@ void MusicPlayer::playSong(const Song &song)
         play(song.notes, song.length, song.bpm);
 }
 
+bool MusicPlayer::playAsset(u16 assetId)
+{
+        AssetReader reader;
+        SongAssetHeader header;
+        if (!reader.open(assetId, ASSET_SONG) || !reader.read(0, &header, sizeof(header)))
+        {
+                Serial.printf("Music: asset 0x%04x not found\n", assetId);
+                return false;
+        }
+
+        if (header.length == 0 || header.length > MusicConfig::MAX_ASSET_NOTES || header.bpm == 0 ||
+            reader.size() < sizeof(header) + (u32)header.length * sizeof(SongAssetNote))
+        {
+                Serial.printf("Music: asset 0x%04x malformed or too long\n", assetId);
+                return false;
+        }
+
+        // The ISR may still be reading the previous asset song
+        stopAsset();
+
+        // The buffer only grows: replaying songs (PuzzleVM SYS_SONG) does not touch the heap
+        if (header.length > assetCapacity)
+        {
+                delete[] assetNotes;
+                assetNotes = new MusicNote[header.length];
+                assetCapacity = header.length;
+        }
+        MusicNote *notes = assetNotes;
+
+        // Convert in small batches through a stack buffer
+        SongAssetNote batch[32];
+        for (u16 i = 0; i < header.length;)
+        {
+                u16 n = min<u16>(header.length - i, sizeof(batch) / sizeof(batch[0]));
+                if (!reader.read(sizeof(header) + (u32)i * sizeof(SongAssetNote), batch, n * sizeof(SongAssetNote)))
+                        return false;
+
+                for (u16 k = 0; k < n; k++, i++)
+                {
+                        notes[i].note = batch[k].note;
+                        notes[i].duration = batch[k].duration;
+                        notes[i].advance = batch[k].advance;
+                        notes[i].preset = batch[k].preset <= SOUND_DEFAULT ? (SoundPreset)batch[k].preset : SOUND_DEFAULT;
+                }
+        }
+
+        play(notes, header.length, header.bpm);
+        return true;
+}
+
+void MusicPlayer::stopAsset()
+{
+        // Stop the ISR from touching the notes before they are rewritten or freed
+        if (assetNotes && currentMelody == assetNotes)
+        {
+                playing = false;
+                currentMelody = nullptr;
+                melodyLength = 0;
+        }
+}
+
 void MusicPlayer::stop()
 {
         playing = false;
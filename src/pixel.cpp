@@ -8,40 +8,138 @@
 #include "pixel.h"
 #include "watchdog.h"
 #include <Arduino.h>
+#include "probe.h"
+
+static_assert(PixelConfig::BYTES_PER_PIXEL == 3 && PixelConfig::OFFSET_G == 0 &&
+                  PixelConfig::OFFSET_R == 1 && PixelConfig::OFFSET_B == 2,
+              "applyBuffer() copies the frame straight to the wire (GRB)");
+
+#ifdef PIXEL_OUTPUT_RMT
+constexpr bool kAdafruitFrame = false; // RMT backend keeps its own wire frames
+#else
+constexpr bool kAdafruitFrame = true; // applyBuffer() writes Adafruit's buffer, show() sends it
+#endif
+
+using PixelConfig::FADE_NONE;
+static_assert(PixelConfig::FADE_SLOTS < FADE_NONE, "fadeSlot stores slot numbers in a byte");
+static_assert(PixelConfig::DITHER_BITS <= 8, "lut16 has 8 fractional bits");
 
 /************************* PixelStrip constructor ***************************
  * Construct a PixelStrip with logical/physical grouping.
- * @param pin GPIO driving the NeoPixel strip.
+ * @param pin GPIO driving the NeoPixel strip, PixelConfig::NO_PIN for none
+ *            (Adafruit_NeoPixel then never sets the pin mode, even on delete).
  * @param count Logical pixel count (pre-grouping).
  * @param groupSize Physical LEDs per logical pixel (>=1).
  * @param brightness Initial global brightness (0-255).
  ***************************************************************/
-PixelStrip::PixelStrip(u8 pin, u8 count, u8 groupSize, u8 brightness)
-    : pixels(count * (groupSize > 0 ? groupSize : 1), pin, NEO_GRB + NEO_KHZ800),
+PixelStrip::PixelStrip(u8 pin, u16 count, u16 groupSize, u8 brightness)
+    : pixels(kAdafruitFrame ? count * (groupSize > 0 ? groupSize : 1) : 0,
+             pin == PixelConfig::NO_PIN ? -1 : pin, NEO_GRB + NEO_KHZ800),
       physicalCount(count * (groupSize > 0 ? groupSize : 1)),
       groupSize(groupSize > 0 ? groupSize : 1),
       logicalCount(count),
-      colorBuffer(nullptr)
+      frame(nullptr),
+      pin(pin),
+      brightness(brightness),
+      gamma(false),
+      dither(false),
+      residual(nullptr),
+      lastSendMs(0),
+      dirty(false),
+      dirtyFirst(0),
+      dirtyLast(0),
+      fades(),
+      fadeFrom(nullptr),
+      fadeTarget(nullptr),
+      fadeSlot(nullptr),
+      fadeCount(0),
+      fadeFirst(0),
+      fadeLast(0),
+      wake(nullptr)
+#ifdef PIXEL_OUTPUT_RMT
+      ,
+      sentFirst(0),
+      sentLast(count ? count - 1 : 0)
+#endif
 {
-        pixels.setBrightness(brightness);
+        // Brightness lives in our LUT; applyBuffer() writes Adafruit's buffer directly
+        buildLut();
 
-        // Allocate color buffer for animations
-        colorBuffer = new u32[logicalCount];
+        // Allocate the frame buffer, all black (off)
+        frame = new u8[(size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL];
+        memset(frame, 0, (size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL);
+        markDirty();
 
-        // Initialize buffer to all black (off)
-        for (u8 i = 0; i < logicalCount; i++)
-        {
-                colorBuffer[i] = 0;
-        }
+        setDither(PixelConfig::DITHER_DEFAULT);
+}
+
+/************************* PixelStrip destructor ***************************
+ * Release the frame, dither and fade buffers (output backends free their own).
+ ***************************************************************/
+PixelStrip::~PixelStrip()
+{
+        delete[] frame;
+        delete[] residual;
+        delete[] fadeFrom;
+        delete[] fadeTarget;
+        delete[] fadeSlot;
+}
+
+/************************* setCount ****************************************
+ * Resize the strip to a new logical count before begin(), e.g. once the
+ * device type is known. Frame and dither buffers are reallocated (black);
+ * fade buffers are freed and come back on the next fade.
+ * @param count New logical pixel count.
+ ***************************************************************/
+void PixelStrip::setCount(u16 count)
+{
+        if (count == logicalCount)
+                return;
+
+        delete[] frame;
+        delete[] residual;
+        delete[] fadeFrom;
+        delete[] fadeTarget;
+        delete[] fadeSlot;
+        residual = nullptr;
+        fadeFrom = nullptr;
+        fadeTarget = nullptr;
+        fadeSlot = nullptr;
+        for (FadeSlot &f : fades)
+                f.users = 0;
+        fadeCount = 0;
+
+        logicalCount = count;
+        physicalCount = count * groupSize;
+        if (kAdafruitFrame)
+                pixels.updateLength(physicalCount);
+#ifdef PIXEL_OUTPUT_RMT
+        sentFirst = 0;
+        sentLast = count ? count - 1 : 0;
+#endif
+
+        frame = new u8[(size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL];
+        memset(frame, 0, (size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL);
+        dirty = false;
+        markDirty();
+
+        setDither(dither);
 }
 
 /************************* begin *******************************************
  * Initialize hardware and blank the strip.
+ * With PIXEL_OUTPUT_RMT the RMT backend owns the pin and Adafruit_NeoPixel
+ * is left without a buffer.
  ***************************************************************/
 void PixelStrip::begin()
 {
+#ifdef PIXEL_OUTPUT_RMT
+        output.begin(pin, physicalCount);
+#else
         pixels.begin();
-        pixels.show(); // Initialize all pixels to 'off'
+#endif
+        markDirty();
+        applyBuffer(); // Initialize all pixels to 'off'
 }
 
 /************************* setColor (packed) *******************************
@@ -49,7 +147,7 @@ void PixelStrip::begin()
  * @param index Logical pixel index.
  * @param color Packed RGB color.
  ***************************************************************/
-void PixelStrip::setColor(u8 index, u32 color)
+void PixelStrip::setColor(u16 index, u32 color)
 {
         // Extract RGB and delegate to RGB version
         u8 r = (color >> 16) & 0xFF;
@@ -58,20 +156,65 @@ void PixelStrip::setColor(u8 index, u32 color)
         setColor(index, r, g, b);
 }
 
-void PixelStrip::setColor(u8 index, u8 r, u8 g, u8 b)
+void PixelStrip::setColor(u16 index, u8 r, u8 g, u8 b)
 {
         if (index < logicalCount)
         {
-                // Update buffer
-                colorBuffer[index] = ((u32)r << 16) | ((u32)g << 8) | b;
+                // An explicit color wins over a running fade
+                if (fadeSlot && fadeSlot[index] != FADE_NONE)
+                        cancelFade(index);
+
+                // Frame only; groups are expanded when the frame is applied
+                u8 *px = frame + (u32)index * PixelConfig::BYTES_PER_PIXEL;
+                if (px[PixelConfig::OFFSET_R] == r && px[PixelConfig::OFFSET_G] == g && px[PixelConfig::OFFSET_B] == b)
+                        return; // Redrawing the same color costs no transmission
+
+                px[PixelConfig::OFFSET_R] = r;
+                px[PixelConfig::OFFSET_G] = g;
+                px[PixelConfig::OFFSET_B] = b;
+                markDirty(index, index);
+        }
+}
 
-                // Set all LEDs in this group to the same color
-                u8 startLed = index * groupSize;
-                for (u8 i = 0; i < groupSize; i++)
-                {
-                        pixels.setPixelColor(startLed + i, pixels.Color(r, g, b));
-                }
+/************************* markDirty **************************************
+ * Grow the changed range to cover [first, last].
+ * @param first First logical index.
+ * @param last Last logical index (inclusive).
+ ***************************************************************/
+void PixelStrip::markDirty(u16 first, u16 last)
+{
+        if (!logicalCount)
+                return;
+        if (last >= logicalCount)
+                last = logicalCount - 1;
+        if (first > last)
+                return;
+
+        if (!dirty)
+        {
+                dirtyFirst = first;
+                dirtyLast = last;
+                dirty = true;
+                return;
         }
+
+        if (first < dirtyFirst)
+                dirtyFirst = first;
+        if (last > dirtyLast)
+                dirtyLast = last;
+}
+
+/************************* getColor ***************************************
+ * Read a logical pixel back as packed 0x00RRGGBB.
+ * @param index Logical pixel index.
+ ***************************************************************/
+u32 PixelStrip::getColor(u16 index) const
+{
+        if (index >= logicalCount)
+                return 0;
+
+        const u8 *px = frame + (u32)index * PixelConfig::BYTES_PER_PIXEL;
+        return ((u32)px[PixelConfig::OFFSET_R] << 16) | ((u32)px[PixelConfig::OFFSET_G] << 8) | px[PixelConfig::OFFSET_B];
 }
 
 /************************* setAll (RGB) ***********************************
@@ -82,18 +225,9 @@ void PixelStrip::setColor(u8 index, u8 r, u8 g, u8 b)
  ***************************************************************/
 void PixelStrip::setAll(u8 r, u8 g, u8 b)
 {
-        u32 color = ((u32)r << 16) | ((u32)g << 8) | b;
-
-        // Update buffer
-        for (u8 i = 0; i < logicalCount; i++)
-        {
-                colorBuffer[i] = color;
-        }
-
-        // Update physical LEDs
-        for (u8 i = 0; i < physicalCount; i++)
+        for (u16 i = 0; i < logicalCount; i++)
         {
-                pixels.setPixelColor(i, pixels.Color(r, g, b));
+                setColor(i, r, g, b);
         }
 }
 
@@ -103,21 +237,10 @@ void PixelStrip::setAll(u8 r, u8 g, u8 b)
  ***************************************************************/
 void PixelStrip::setAll(u32 color)
 {
-        // Update buffer
-        for (u8 i = 0; i < logicalCount; i++)
-        {
-                colorBuffer[i] = color;
-        }
-
         u8 r = (color >> 16) & 0xFF;
         u8 g = (color >> 8) & 0xFF;
         u8 b = color & 0xFF;
-
-        // Update physical LEDs
-        for (u8 i = 0; i < physicalCount; i++)
-        {
-                pixels.setPixelColor(i, pixels.Color(r, g, b));
-        }
+        setAll(r, g, b);
 }
 
 /************************* clear ******************************************
@@ -125,23 +248,240 @@ void PixelStrip::setAll(u32 color)
  ***************************************************************/
 void PixelStrip::clear()
 {
-        // Clear buffer
-        for (u8 i = 0; i < logicalCount; i++)
+        if (fadeCount)
         {
-                colorBuffer[i] = 0;
+                memset(fadeSlot, FADE_NONE, logicalCount);
+                for (FadeSlot &f : fades)
+                        f.users = 0;
+                fadeCount = 0;
         }
 
-        // Clear physical LEDs
-        pixels.clear();
-        pixels.show();
+        memset(frame, 0, (size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL);
+        markDirty();
+        show();
 }
 
 /************************* show *******************************************
- * Push current NeoPixel buffer to the strip.
+ * Push the frame buffer to the strip if anything changed.
  ***************************************************************/
 void PixelStrip::show()
 {
-        pixels.show();
+        applyBuffer();
+}
+
+/************************* fadeTo *****************************************
+ * Fade one logical pixel from its current color to a target color.
+ * Pixels started in the same millisecond with the same duration and
+ * easing share a fade slot, so a loop of fadeTo() calls costs one slot.
+ * If every slot is taken the pixel jumps to the target.
+ * @param index Logical pixel index.
+ * @param color Target 0x00RRGGBB color.
+ * @param durationMs Fade time (0 = set immediately).
+ * @param easing Transition curve.
+ ***************************************************************/
+void PixelStrip::fadeTo(u16 index, u32 color, u16 durationMs, FadeEasing easing)
+{
+        fadeRange(index, 1, color, durationMs, easing);
+}
+
+/************************* fadeRange **************************************
+ * Fade a range of logical pixels to one color with one shared slot.
+ * @param first First logical index.
+ * @param count Number of pixels (clipped to the strip).
+ ***************************************************************/
+void PixelStrip::fadeRange(u16 first, u16 count, u32 color, u16 durationMs, FadeEasing easing)
+{
+        if (first >= logicalCount || count == 0)
+                return;
+        if (count > logicalCount - first)
+                count = logicalCount - first;
+
+        u8 slot = FADE_NONE;
+        if (durationMs && easing < FADE_EASING_COUNT && allocFades())
+                slot = acquireFade(millis(), durationMs, easing);
+
+        bool started = false;
+        for (u16 i = first; i < first + count; i++)
+        {
+                if (slot == FADE_NONE)
+                        setColor(i, color); // No fade: jump
+                else if (startFade(i, color, slot))
+                        started = true;
+        }
+
+        if (started && wake)
+                wake();
+}
+
+/************************* allocFades *************************************
+ * Allocate the per-pixel fade arrays on first use.
+ ***************************************************************/
+bool PixelStrip::allocFades()
+{
+        if (fadeSlot)
+                return true;
+        if (!logicalCount)
+                return false;
+
+        size_t bytes = (size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL;
+        fadeFrom = new u8[bytes];
+        fadeTarget = new u8[bytes];
+        fadeSlot = new u8[logicalCount];
+        memset(fadeSlot, FADE_NONE, logicalCount);
+        return true;
+}
+
+/************************* acquireFade ************************************
+ * Slot for a fade starting now: an identical running one, else a free one.
+ * @return Slot number, FADE_NONE if all slots are busy.
+ ***************************************************************/
+u8 PixelStrip::acquireFade(u32 now, u16 durationMs, FadeEasing easing)
+{
+        u8 free = FADE_NONE;
+        for (u8 s = 0; s < PixelConfig::FADE_SLOTS; s++)
+        {
+                FadeSlot &f = fades[s];
+                if (!f.users)
+                {
+                        if (free == FADE_NONE)
+                                free = s;
+                }
+                else if (f.startMs == now && f.durationMs == durationMs && f.easing == easing)
+                {
+                        return s;
+                }
+        }
+
+        if (free != FADE_NONE)
+        {
+                fades[free].startMs = now;
+                fades[free].durationMs = durationMs;
+                fades[free].easing = easing;
+        }
+        return free;
+}
+
+/************************* startFade **************************************
+ * Point one pixel at a slot, starting from the color it shows now.
+ * @return false if the pixel already shows the target (nothing to fade).
+ ***************************************************************/
+bool PixelStrip::startFade(u16 index, u32 color, u8 slot)
+{
+        cancelFade(index);
+
+        u32 at = (u32)index * PixelConfig::BYTES_PER_PIXEL;
+        u8 *to = fadeTarget + at;
+        to[PixelConfig::OFFSET_R] = (color >> 16) & 0xFF;
+        to[PixelConfig::OFFSET_G] = (color >> 8) & 0xFF;
+        to[PixelConfig::OFFSET_B] = color & 0xFF;
+        if (memcmp(to, frame + at, PixelConfig::BYTES_PER_PIXEL) == 0)
+                return false;
+
+        memcpy(fadeFrom + at, frame + at, PixelConfig::BYTES_PER_PIXEL);
+        fadeSlot[index] = slot;
+        fades[slot].users++;
+
+        if (!fadeCount || index < fadeFirst)
+                fadeFirst = index;
+        if (!fadeCount || index > fadeLast)
+                fadeLast = index;
+        fadeCount++;
+        return true;
+}
+
+/************************* cancelFade *************************************
+ * Stop a pixel's fade where it is.
+ ***************************************************************/
+void PixelStrip::cancelFade(u16 index)
+{
+        u8 slot = fadeSlot[index];
+        if (slot == FADE_NONE)
+                return;
+
+        fadeSlot[index] = FADE_NONE;
+        fades[slot].users--;
+        fadeCount--;
+}
+
+/************************* ease *******************************************
+ * Apply a transition curve to a progress value (0-256 in, 0-256 out).
+ ***************************************************************/
+static inline u32 ease(FadeEasing easing, u32 t)
+{
+        switch (easing)
+        {
+        case FADE_EASE_IN:
+                return (t * t) >> 8;
+        case FADE_EASE_OUT:
+                return 256 - (((256 - t) * (256 - t)) >> 8);
+        case FADE_EASE_IN_OUT:
+                return (t * t * (768 - 2 * t)) >> 16;
+        default:
+                return t;
+        }
+}
+
+/************************* updateFades ************************************
+ * Advance every running fade to the current time.
+ * The curve is evaluated once per slot; the pixel pass is one integer
+ * lerp per byte over the fading range, marked dirty as a single range.
+ * Finished pixels land exactly on their target and leave their slot.
+ * @return ms until the next step, 0 when nothing is fading.
+ ***************************************************************/
+u32 PixelStrip::updateFades()
+{
+        if (!fadeCount)
+                return 0;
+
+        u32 now = millis();
+        u16 progress[PixelConfig::FADE_SLOTS];
+        for (u8 s = 0; s < PixelConfig::FADE_SLOTS; s++)
+        {
+                const FadeSlot &f = fades[s];
+                u32 elapsed = now - f.startMs;
+                progress[s] = (!f.users || elapsed >= f.durationMs) ? 256 : (u16)ease(f.easing, (elapsed << 8) / f.durationMs);
+        }
+
+        u16 first = fadeFirst;
+        u16 last = fadeLast;
+        u16 nextFirst = last;
+        u16 nextLast = first;
+
+        for (u16 i = first; i <= last; i++)
+        {
+                u8 slot = fadeSlot[i];
+                if (slot == FADE_NONE)
+                        continue;
+
+                u32 at = (u32)i * PixelConfig::BYTES_PER_PIXEL;
+                const u8 *from = fadeFrom + at;
+                const u8 *to = fadeTarget + at;
+                u8 *px = frame + at;
+                int32_t t = progress[slot];
+                for (u8 k = 0; k < PixelConfig::BYTES_PER_PIXEL; k++)
+                {
+                        px[k] = (u8)(from[k] + (((to[k] - from[k]) * t) >> 8));
+                }
+
+                if (t == 256)
+                {
+                        fadeSlot[i] = FADE_NONE;
+                        fades[slot].users--;
+                        fadeCount--;
+                }
+                else
+                {
+                        if (i < nextFirst)
+                                nextFirst = i;
+                        if (i > nextLast)
+                                nextLast = i;
+                }
+        }
+
+        markDirty(first, last);
+        fadeFirst = nextFirst;
+        fadeLast = nextLast;
+        return fadeCount ? PixelConfig::FADE_REFRESH_MS : 0;
 }
 
 /************************* setBrightness ***********************************
@@ -149,29 +489,214 @@ void PixelStrip::show()
  ***************************************************************/
 void PixelStrip::setBrightness(u8 brightness)
 {
-        pixels.setBrightness(brightness);
+        this->brightness = brightness;
+        buildLut();
+        markDirty(); // Every output byte changes
+}
+
+/************************* setGamma ****************************************
+ * Enable or disable gamma correction of output values.
+ ***************************************************************/
+void PixelStrip::setGamma(bool enable)
+{
+        gamma = enable;
+        buildLut();
+        markDirty();
+}
+
+/************************* setDither **************************************
+ * Enable or disable temporal dithering.
+ ***************************************************************/
+void PixelStrip::setDither(bool enable)
+{
+        if (enable && !residual)
+        {
+                size_t bytes = (size_t)logicalCount * PixelConfig::BYTES_PER_PIXEL;
+                residual = new u8[bytes];
+
+                // Spread the starting error so neighbours do not toggle in step
+                for (size_t i = 0; i < bytes; i++)
+                        residual[i] = (u8)(i * 151);
+        }
+
+        dither = enable;
+        markDirty();
+}
+
+/************************* buildLut ****************************************
+ * Fold gamma and brightness into the output tables, applied per byte.
+ * lut16 keeps the top DITHER_BITS of the fraction for dithering (a finer
+ * fraction would flicker below the refresh rate); lut is its rounded value.
+ * Brightness scaling matches Adafruit_NeoPixel::setBrightness (255 = unscaled).
+ ***************************************************************/
+void PixelStrip::buildLut()
+{
+        constexpr u16 step = 0x100 >> PixelConfig::DITHER_BITS;
+        u32 scale = (u32)brightness + 1;
+        lutIdentity = true;
+        lutExact = true;
+
+        for (u16 i = 0; i < 256; i++)
+        {
+                // Level in 8.8 fixed point (0 - 65280) before brightness
+                u32 level = (u32)i << 8;
+                if (gamma)
+                        level = (u32)(powf(i / 255.0f, PixelConfig::GAMMA) * (255.0f * 256.0f) + 0.5f);
+
+                // Round to a multiple of step: 0xFF00 is one, so this stays <= 0xFF00
+                lut16[i] = (u16)((((level * scale) >> 8) + step / 2) & ~(u32)(step - 1));
+                lut[i] = (u8)((lut16[i] + 0x80) >> 8); // Never rounds past 255
+
+                if (lut[i] != i)
+                        lutIdentity = false;
+                if (lut16[i] & 0xFF)
+                        lutExact = false;
+        }
+}
+
+/************************* isShowing **************************************
+ * Completion flag of the output backend.
+ ***************************************************************/
+bool PixelStrip::isShowing() const
+{
+#ifdef PIXEL_OUTPUT_RMT
+        return output.isBusy();
+#else
+        return false; // show() returns only after the frame is out
+#endif
 }
 
 /************************* applyBuffer ************************************
  * Apply logical buffer to physical LEDs and show (ISR/refresh path).
+ * Frame and output share the wire byte order, so no unpacking: a memcpy
+ * for the common case, otherwise one LUT lookup per byte. Only the dirty
+ * range is converted, and a clean frame is not transmitted unless a
+ * dither refresh is due.
+ * Dithering adds each byte's 8.8 level to the error carried from the last
+ * refresh; the integer part is sent, the fraction is carried to the next.
  ***************************************************************/
 void IRAM_ATTR PixelStrip::applyBuffer()
 {
-        for (u8 i = 0; i < logicalCount; i++)
-        {
-                u32 color = colorBuffer[i];
-                u8 r = (color >> 16) & 0xFF;
-                u8 g = (color >> 8) & 0xFF;
-                u8 b = color & 0xFF;
+        if (!logicalCount)
+                return;
+
+        bool dithering = isDithering();
+        if (!dirty && !(dithering && millis() - lastSendMs >= PixelConfig::DITHER_REFRESH_MS))
+                return;
+
+        PROBE_SCOPE(PROBE_PIXEL_APPLY);
+
+#ifdef PIXEL_OUTPUT_RMT
+        u8 *dst = output.getBackFrame();
+#else
+        u8 *dst = pixels.getPixels();
+#endif
+        if (!dst)
+                return;
+
+        // Dithering changes every output byte on every refresh
+        u16 first = dithering ? 0 : dirtyFirst;
+        u16 last = dithering ? logicalCount - 1 : dirtyLast;
+        dirty = false;
+
+#ifdef PIXEL_OUTPUT_RMT
+        // The back frame holds the frame before last: also bring over what the
+        // previous frame changed
+        u16 prevFirst = sentFirst;
+        u16 prevLast = sentLast;
+        sentFirst = first;
+        sentLast = last;
+        if (prevFirst < first)
+                first = prevFirst;
+        if (prevLast > last)
+                last = prevLast;
+#endif
+
+        convert(dst, first, last, dithering);
+        lastSendMs = millis();
+
+#ifdef PIXEL_OUTPUT_RMT
+        output.send();
+#else
+        pixels.show();
+#endif
+}
+
+/************************* convert ****************************************
+ * Write logical pixels [first, last] to an output buffer in wire order,
+ * through the LUT and expanded across groups (applyBuffer() and benchmark()).
+ * @param dst Output buffer (physicalCount * BYTES_PER_PIXEL bytes).
+ * @param dithering Use the 8.8 LUT and carry the residual.
+ ***************************************************************/
+void IRAM_ATTR PixelStrip::convert(u8 *dst, u16 first, u16 last, bool dithering)
+{
+        const u32 start = (u32)first * PixelConfig::BYTES_PER_PIXEL;
+        const u32 end = ((u32)last + 1) * PixelConfig::BYTES_PER_PIXEL;
 
-                // Set all LEDs in this group to the same color
-                u8 startLed = i * groupSize;
-                for (u8 j = 0; j < groupSize; j++)
+        if (dithering)
+        {
+                if (groupSize == 1)
+                {
+                        for (u32 i = start; i < end; i++)
+                        {
+                                u16 acc = lut16[frame[i]] + residual[i];
+                                dst[i] = acc >> 8;
+                                residual[i] = (u8)acc;
+                        }
+                }
+                else
                 {
-                        pixels.setPixelColor(startLed + j, pixels.Color(r, g, b));
+                        // Repeat each logical pixel across its group
+                        dst += start * groupSize;
+                        for (u32 i = start; i < end; i += PixelConfig::BYTES_PER_PIXEL)
+                        {
+                                u8 c[PixelConfig::BYTES_PER_PIXEL];
+                                for (u8 k = 0; k < PixelConfig::BYTES_PER_PIXEL; k++)
+                                {
+                                        u16 acc = lut16[frame[i + k]] + residual[i + k];
+                                        c[k] = acc >> 8;
+                                        residual[i + k] = (u8)acc;
+                                }
+                                for (u16 j = 0; j < groupSize; j++)
+                                {
+                                        *dst++ = c[0];
+                                        *dst++ = c[1];
+                                        *dst++ = c[2];
+                                }
+                        }
+                }
+        }
+        else if (groupSize == 1)
+        {
+                if (lutIdentity)
+                {
+                        memcpy(dst + start, frame + start, end - start);
+                }
+                else
+                {
+                        for (u32 i = start; i < end; i++)
+                        {
+                                dst[i] = lut[frame[i]];
+                        }
+                }
+        }
+        else
+        {
+                // Repeat each logical pixel across its group
+                dst += start * groupSize;
+                for (u32 i = start; i < end; i += PixelConfig::BYTES_PER_PIXEL)
+                {
+                        u8 c0 = lut[frame[i]];
+                        u8 c1 = lut[frame[i + 1]];
+                        u8 c2 = lut[frame[i + 2]];
+                        for (u16 j = 0; j < groupSize; j++)
+                        {
+                                *dst++ = c0;
+                                *dst++ = c1;
+                                *dst++ = c2;
+                        }
                 }
         }
-        pixels.show();
 }
 
 /************************* pixelCheck *************************************
@@ -188,7 +713,7 @@ void PixelStrip::pixelCheck(u16 delayMs)
         Serial.println(" physical LEDs)...");
 
         // Save current brightness
-        u8 savedBrightness = pixels.getBrightness();
+        u8 savedBrightness = brightness;
 
         // Set to maximum brightness for testing
         setBrightness(255);
@@ -207,7 +732,7 @@ void PixelStrip::pixelCheck(u16 delayMs)
 
         // Turn on each logical pixel to white (255, 255, 255) one by one
         // Each pixel stays on, accumulating until all are lit
-        for (u8 i = 0; i < logicalCount; i++)
+        for (u16 i = 0; i < logicalCount; i++)
         {
                 Serial.print("Pixel ");
                 Serial.print(i);
@@ -242,3 +767,44 @@ void PixelStrip::pixelCheck(u16 delayMs)
 
         Serial.println("=== Pixel Check Complete ===\n");
 }
+
+/************************* benchmark **************************************
+ * Heap and render cost of a strip at typical large sizes.
+ * The strips have no pin and are never begun, so the live strip's GPIO is
+ * left alone; apply is the applyBuffer() conversion into a scratch buffer
+ * (wire time excluded).
+ * Heap is the drop in free heap across construction (frame and, without
+ * RMT, Adafruit's buffer); fill is a full setColor() pass.
+ ***************************************************************/
+void PixelStrip::benchmark()
+{
+        static constexpr u16 kSizes[] = {264, 1000, 2000};
+
+        Serial.println("\n=== Pixel Benchmark ===");
+        for (u16 count : kSizes)
+        {
+                u32 heapBefore = ESP.getFreeHeap();
+                PixelStrip *strip = new PixelStrip(PixelConfig::NO_PIN, count, 1, brightness);
+                u32 heapUsed = heapBefore - ESP.getFreeHeap();
+                u8 *scratch = new u8[(size_t)strip->physicalCount * PixelConfig::BYTES_PER_PIXEL];
+
+                u32 start = micros();
+                for (u16 i = 0; i < count; i++)
+                {
+                        strip->setColor(i, (u8)i, (u8)(i >> 2), (u8)~i);
+                }
+                u32 fillUs = micros() - start;
+
+                start = micros();
+                strip->convert(scratch, 0, count - 1, strip->isDithering());
+                u32 applyUs = micros() - start;
+
+                delete[] scratch;
+                delete strip;
+                Watchdog::reset();
+
+                Serial.printf("[PIX] %4u px: heap %6lu B, fill %5lu us, apply %6lu us\n",
+                              count, (unsigned long)heapUsed, (unsigned long)fillUs, (unsigned long)applyUs);
+        }
+        Serial.println("=== Pixel Benchmark Complete ===\n");
+}
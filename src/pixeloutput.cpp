@@ -0,0 +1,151 @@
+/************************* pixeloutput.cpp **********************
+ * Non-blocking WS2812B output via the RMT peripheral
+ * Frame encoding, ISR bit translation and TX-end completion flag
+ * Created by MSK, November 2025
+ * Compiled in only when PIXEL_OUTPUT_RMT is defined
+ ***************************************************************/
+
+#include "pixeloutput.h"
+
+#ifdef PIXEL_OUTPUT_RMT
+
+// Pre-built RMT items for a 0 and a 1 bit (high first, then low)
+static rmt_item32_t makeBit(u16 high, u16 low)
+{
+        rmt_item32_t item;
+        item.level0 = 1;
+        item.duration0 = high;
+        item.level1 = 0;
+        item.duration1 = low;
+        return item;
+}
+
+static rmt_item32_t kBit0;
+static rmt_item32_t kBit1;
+
+/************************* PixelOutput constructor *************************
+ * No hardware access until begin().
+ ***************************************************************/
+PixelOutput::PixelOutput()
+    : m_back(0), m_ledCount(0), m_busy(false), m_stalls(0), m_ready(false)
+{
+        m_frames[0] = nullptr;
+        m_frames[1] = nullptr;
+}
+
+/************************* PixelOutput destructor **************************
+ * Let the last frame finish, release the channel and both frames.
+ ***************************************************************/
+PixelOutput::~PixelOutput()
+{
+        if (m_ready)
+        {
+                rmt_wait_tx_done(PixelOutputConfig::CHANNEL, pdMS_TO_TICKS(PixelOutputConfig::MAX_WAIT_MS));
+                rmt_driver_uninstall(PixelOutputConfig::CHANNEL);
+        }
+
+        delete[] m_frames[0];
+        delete[] m_frames[1];
+}
+
+/************************* begin *******************************************
+ * Configure the RMT channel (idle LOW) and allocate both frames.
+ * @param pin GPIO driving the strip.
+ * @param ledCount Physical LEDs.
+ ***************************************************************/
+bool PixelOutput::begin(u8 pin, u16 ledCount)
+{
+        kBit0 = makeBit(PixelOutputConfig::T0H, PixelOutputConfig::T0L);
+        kBit1 = makeBit(PixelOutputConfig::T1H, PixelOutputConfig::T1L);
+
+        m_ledCount = ledCount;
+        for (u8 i = 0; i < 2; i++)
+        {
+                m_frames[i] = new u8[(size_t)ledCount * 3];
+                memset(m_frames[i], 0, (size_t)ledCount * 3);
+        }
+
+        rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, PixelOutputConfig::CHANNEL);
+        config.clk_div = PixelOutputConfig::CLK_DIV;
+
+        if (rmt_config(&config) != ESP_OK ||
+            rmt_driver_install(PixelOutputConfig::CHANNEL, 0, 0) != ESP_OK ||
+            rmt_translator_init(PixelOutputConfig::CHANNEL, translate) != ESP_OK)
+        {
+                Serial.println("[PIX] RMT init failed");
+                return false;
+        }
+
+        rmt_register_tx_end_callback(onTxEnd, this);
+        m_ready = true;
+        return true;
+}
+
+/************************* send ********************************************
+ * Swap frames and start the RMT without waiting for completion.
+ * Only waits if the previous frame has not finished yet.
+ * The strip latches after the line idles LOW (>50 us) once TX ends.
+ ***************************************************************/
+bool PixelOutput::send()
+{
+        if (!m_ready)
+                return false;
+
+        if (m_busy)
+        {
+                // Previous frame still shifting out (long strip, fast caller): wait for it
+                // with interrupts enabled; bounded by one frame time
+                m_stalls++;
+                rmt_wait_tx_done(PixelOutputConfig::CHANNEL, pdMS_TO_TICKS(PixelOutputConfig::MAX_WAIT_MS));
+                m_busy = false;
+        }
+
+        u8 front = m_back;
+        m_back ^= 1;
+        m_busy = true;
+
+        if (rmt_write_sample(PixelOutputConfig::CHANNEL, m_frames[front], (size_t)m_ledCount * 3, false) != ESP_OK)
+        {
+                m_busy = false;
+                return false;
+        }
+
+        // New back frame holds the frame before last: caller rewrites every LED
+        return true;
+}
+
+/************************* onTxEnd *****************************************
+ * RMT driver ISR callback: frame fully transmitted.
+ ***************************************************************/
+void IRAM_ATTR PixelOutput::onTxEnd(rmt_channel_t channel, void *arg)
+{
+        PixelOutput *self = static_cast<PixelOutput *>(arg);
+        if (self && channel == PixelOutputConfig::CHANNEL)
+                self->m_busy = false;
+}
+
+/************************* translate ***************************************
+ * RMT driver ISR callback: expand frame bytes into bit items, MSB first.
+ * Called repeatedly as the channel memory drains; converts whole bytes only.
+ ***************************************************************/
+void IRAM_ATTR PixelOutput::translate(const void *src, rmt_item32_t *dest, size_t srcSize,
+                                      size_t wanted, size_t *translated, size_t *itemCount)
+{
+        const u8 *bytes = static_cast<const u8 *>(src);
+        size_t done = 0;
+        size_t items = 0;
+
+        while (done < srcSize && items + 8 <= wanted)
+        {
+                u8 value = bytes[done++];
+                for (u8 mask = 0x80; mask; mask >>= 1)
+                {
+                        dest[items++] = (value & mask) ? kBit1 : kBit0;
+                }
+        }
+
+        *translated = done;
+        *itemCount = items;
+}
+
+#endif // PIXEL_OUTPUT_RMT
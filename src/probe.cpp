@@ -0,0 +1,169 @@
+/************************* probe.cpp ****************************
+ * Hot-path timing probes implementation
+ * Static probe table, ISR-safe recording and Serial dump
+ * Created by MSK, November 2025
+ * Compiled out entirely unless ENABLE_PROBES is defined
+ ***************************************************************/
+
+#include "probe.h"
+
+#ifdef ENABLE_PROBES
+
+#include "esp_timer.h"
+
+//============================================================================
+// STATIC DATA
+//============================================================================
+
+static ProbeStats probeTable[PROBE_COUNT];
+static int64_t probeWindowStartUs = 0;
+static portMUX_TYPE probeMux = portMUX_INITIALIZER_UNLOCKED; // reset() vs ISR record()
+
+static const char *const kProbeNames[PROBE_COUNT] = {
+    "Core::update",
+    "InputManager::poll",
+    "IOExpander::scanKeypad",
+    "Animation::update",
+    "PixelStrip::applyBuffer",
+    "Synth::updateSample",
+    "Synth ISR period",
+    "Animation decode frame",
+    "Animation shader frame"};
+
+//============================================================================
+// RECORDING
+//============================================================================
+
+/************************* record ******************************************
+ * Add one measurement to a probe.
+ * Runs from ISRs (Synth sample timer): integer math only, no libgcc calls.
+ * @param id Probe slot.
+ * @param cycles Elapsed CPU cycles.
+ ***************************************************************/
+void IRAM_ATTR Probe::record(ProbeId id, u32 cycles)
+{
+        if (id >= PROBE_COUNT)
+                return;
+
+        ProbeStats &s = probeTable[id];
+        s.count++;
+        s.totalCycles += cycles;
+        if (cycles < s.minCycles)
+                s.minCycles = cycles;
+        if (cycles > s.maxCycles)
+                s.maxCycles = cycles;
+
+        // log2 bucket without __builtin_clz (no Zbb on the C3, avoids a flash call)
+        u8 bucket = 0;
+        u32 v = cycles >> ProbeConfig::HIST_FIRST_SHIFT;
+        while (v && bucket < ProbeConfig::HIST_BUCKETS - 1)
+        {
+                v >>= 1;
+                bucket++;
+        }
+        s.hist[bucket]++;
+}
+
+/************************* reset *******************************************
+ * Clear all probes and restart the measurement window.
+ * Each probe is cleared in a critical section: the sample ISR records
+ * PROBE_SYNTH_PERIOD and could otherwise land between the field writes.
+ ***************************************************************/
+void Probe::reset()
+{
+        for (u8 i = 0; i < PROBE_COUNT; i++)
+        {
+                ProbeStats &s = probeTable[i];
+                portENTER_CRITICAL(&probeMux);
+                s.count = 0;
+                s.minCycles = 0xFFFFFFFF;
+                s.maxCycles = 0;
+                s.totalCycles = 0;
+                for (u8 b = 0; b < ProbeConfig::HIST_BUCKETS; b++)
+                        s.hist[b] = 0;
+                portEXIT_CRITICAL(&probeMux);
+        }
+        probeWindowStartUs = esp_timer_get_time();
+}
+
+//============================================================================
+// QUERY & REPORTING
+//============================================================================
+
+/************************* get *********************************************
+ * Accumulated stats for one probe.
+ ***************************************************************/
+const ProbeStats *Probe::get(ProbeId id)
+{
+        return (id < PROBE_COUNT) ? &probeTable[id] : nullptr;
+}
+
+/************************* name ********************************************
+ * Display name for one probe.
+ ***************************************************************/
+const char *Probe::name(ProbeId id)
+{
+        return (id < PROBE_COUNT) ? kProbeNames[id] : "?";
+}
+
+/************************* windowUs ****************************************
+ * Length of the current measurement window (microseconds).
+ ***************************************************************/
+u32 Probe::windowUs()
+{
+        return (u32)(esp_timer_get_time() - probeWindowStartUs);
+}
+
+/************************* dump ********************************************
+ * Print all probes: calls, min/avg/max in microseconds, share of wall time
+ * and the non-empty histogram buckets (bucket n = < 2^(n+8) cycles).
+ ***************************************************************/
+void Probe::dump()
+{
+        u32 mhz = ESP.getCpuFreqMHz();
+        u32 window = windowUs();
+        if (mhz == 0)
+                mhz = 1;
+
+        Serial.println("┌─ PROBES ───────────────────────────────────────────────────┐");
+        Serial.printf("│ Window: %lu ms @ %lu MHz\n", (unsigned long)(window / 1000), (unsigned long)mhz);
+
+        for (u8 i = 0; i < PROBE_COUNT; i++)
+        {
+                const ProbeStats &s = probeTable[i];
+                if (s.count == 0)
+                {
+                        Serial.printf("│ %-24s -\n", kProbeNames[i]);
+                        continue;
+                }
+
+                u32 avg = (u32)(s.totalCycles / s.count);
+                u32 totalUs = (u32)(s.totalCycles / mhz);
+                u32 loadPermille = window ? (u32)(((uint64_t)totalUs * 1000) / window) : 0;
+
+                Serial.printf("│ %-24s n=%lu min=%luus avg=%luus max=%luus load=%lu.%lu%%\n",
+                              kProbeNames[i], (unsigned long)s.count,
+                              (unsigned long)(s.minCycles / mhz), (unsigned long)(avg / mhz),
+                              (unsigned long)(s.maxCycles / mhz),
+                              (unsigned long)(loadPermille / 10), (unsigned long)(loadPermille % 10));
+
+                Serial.print("│   hist:");
+                for (u8 b = 0; b < ProbeConfig::HIST_BUCKETS; b++)
+                {
+                        if (s.hist[b] == 0)
+                                continue;
+
+                        // Last bucket is open-ended: report its lower bound instead
+                        bool last = (b == ProbeConfig::HIST_BUCKETS - 1);
+                        u8 shift = b + ProbeConfig::HIST_FIRST_SHIFT - (last ? 1 : 0);
+                        Serial.printf(" %s%luus:%lu", last ? ">=" : "<",
+                                      (unsigned long)((1UL << shift) / mhz),
+                                      (unsigned long)s.hist[b]);
+                }
+                Serial.println();
+        }
+
+        Serial.println("└────────────────────────────────────────────────────────────┘");
+}
+
+#endif // ENABLE_PROBES
@@ -0,0 +1,776 @@
+/************************* puzzlevm.cpp *************************
+ * Puzzle logic VM Implementation
+ * Load-time path verification and a bounded event interpreter
+ * Created by MSK, November 2025
+ * Dispatch via computed goto (GCC labels as values) or switch
+ ***************************************************************/
+
+#include "puzzlevm.h"
+#include "assetstore.h"
+#include "watchdog.h"
+#include <Arduino.h>
+#include <string.h>
+
+static_assert(sizeof(PuzzleAssetHeader::entries) / sizeof(u16) == PUZZLE_EVENT_COUNT,
+              "PuzzleAssetHeader needs one entry per PuzzleEvent");
+static_assert(PuzzleConfig::TIMERS <= 8, "timers are armed through a u8 mask");
+static_assert(PuzzleConfig::STACK_DEPTH < 0xFE, "stack depths are tracked in bytes");
+
+//============================================================================
+// TABLES
+//============================================================================
+
+// Stack effect and operand bytes per opcode (load-time validation only;
+// PZ_SYS takes its effect from PUZZLE_SYS_ARGS / PUZZLE_SYS_RESULT)
+struct OpInfo
+{
+        u8 pops;
+        u8 pushes;
+        u8 operands;
+};
+
+static const OpInfo kOpInfo[PZ_OP_COUNT] = {
+    {0, 0, 0}, // END
+    {0, 1, 1}, // PUSH8
+    {0, 1, 2}, // PUSH16
+    {0, 1, 4}, // PUSH32
+    {0, 1, 0}, // ARG
+    {0, 1, 1}, // LOAD
+    {1, 0, 1}, // STORE
+    {1, 1, 1}, // LOADX
+    {2, 0, 1}, // STOREX
+    {0, 0, 1}, // INC
+    {1, 2, 0}, // DUP
+    {1, 0, 0}, // DROP
+    {2, 2, 0}, // SWAP
+    {2, 3, 0}, // OVER
+    {2, 1, 0}, // ADD
+    {2, 1, 0}, // SUB
+    {2, 1, 0}, // MUL
+    {2, 1, 0}, // DIV
+    {2, 1, 0}, // MOD
+    {1, 1, 0}, // NEG
+    {2, 1, 0}, // AND
+    {2, 1, 0}, // OR
+    {2, 1, 0}, // XOR
+    {2, 1, 0}, // SHL
+    {2, 1, 0}, // SHR
+    {1, 1, 0}, // NOT
+    {2, 1, 0}, // EQ
+    {2, 1, 0}, // NE
+    {2, 1, 0}, // LT
+    {2, 1, 0}, // LE
+    {2, 1, 0}, // GT
+    {2, 1, 0}, // GE
+    {2, 1, 0}, // MIN
+    {2, 1, 0}, // MAX
+    {0, 0, 2}, // JMP
+    {1, 0, 2}, // JZ
+    {1, 0, 2}, // JNZ
+    {0, 1, 0}, // NOW
+    {1, 1, 0}, // RAND
+    {1, 1, 0}, // PARAM
+    {2, 0, 0}, // TIMER
+    {0, 0, 1}, // SYS
+};
+
+// validate() depth map markers (real depths are 0..STACK_DEPTH)
+static constexpr u8 NOT_AN_OP = 0xFF;
+static constexpr u8 UNREACHED = 0xFE;
+
+static inline bool isJump(u8 op)
+{
+        return op == PZ_JMP || op == PZ_JZ || op == PZ_JNZ;
+}
+
+static inline int16_t jumpOffset(const u8 *operand)
+{
+        return (int16_t)(operand[0] | (operand[1] << 8));
+}
+
+//============================================================================
+// CONSTRUCTOR & LOADING
+//============================================================================
+
+/************************* PuzzleVM constructor *****************************
+ * No script until load().
+ ***************************************************************/
+PuzzleVM::PuzzleVM()
+    : m_codeSize(0),
+      m_timersArmed(0),
+      m_startMs(0),
+      m_random(0x2545F491),
+      m_steps(0),
+      m_faults(0),
+      m_host(nullptr),
+      m_hostCtx(nullptr),
+      m_loaded(false)
+{
+        for (u8 e = 0; e < PUZZLE_EVENT_COUNT; e++)
+                m_entries[e] = PuzzleConfig::NO_ENTRY;
+        memset(m_params, 0, sizeof(m_params));
+        reset();
+}
+
+/************************* setHost *****************************************
+ * Route PZ_SYS to the hosting App.
+ ***************************************************************/
+void PuzzleVM::setHost(PuzzleSysFn fn, void *ctx)
+{
+        m_host = fn;
+        m_hostCtx = ctx;
+}
+
+/************************* validate ****************************************
+ * Check a script in three passes:
+ *   1. Decode: known opcodes, complete operands, variable and host call
+ *      indices in range, last instruction END or JMP (no running off the
+ *      end).
+ *   2. Jumps and entry points land on instruction starts.
+ *   3. Stack depth: propagated from every entry point (depth 0) along
+ *      fall-through and jump edges until nothing changes. An instruction
+ *      reached with two depths, or one that would underflow or overflow,
+ *      rejects the script. Unreachable code is never run and not checked.
+ * Uses a MAX_CODE byte depth map on the stack (load time only).
+ ***************************************************************/
+bool PuzzleVM::validate(const u8 *code, u16 codeSize, const u16 *entries)
+{
+        if (!code || !entries || codeSize == 0 || codeSize > PuzzleConfig::MAX_CODE)
+                return false;
+
+        u8 depth[PuzzleConfig::MAX_CODE];
+        memset(depth, NOT_AN_OP, codeSize);
+
+        u8 lastOp = PZ_END;
+        for (u16 pc = 0; pc < codeSize;)
+        {
+                u8 op = code[pc];
+                if (op >= PZ_OP_COUNT || pc + 1 + kOpInfo[op].operands > codeSize)
+                        return false;
+
+                u8 operand = kOpInfo[op].operands ? code[pc + 1] : 0;
+                switch (op)
+                {
+                case PZ_LOAD:
+                case PZ_STORE:
+                case PZ_LOADX:
+                case PZ_STOREX:
+                case PZ_INC:
+                        if (operand >= PuzzleConfig::VAR_COUNT)
+                                return false;
+                        break;
+                case PZ_SYS:
+                        if (operand >= SYS_COUNT)
+                                return false;
+                        break;
+                default:
+                        break;
+                }
+
+                depth[pc] = UNREACHED;
+                lastOp = op;
+                pc += 1 + kOpInfo[op].operands;
+        }
+        if (lastOp != PZ_END && lastOp != PZ_JMP)
+                return false;
+
+        for (u16 pc = 0; pc < codeSize; pc += 1 + kOpInfo[code[pc]].operands)
+        {
+                if (!isJump(code[pc]))
+                        continue;
+                int32_t target = pc + 3 + jumpOffset(&code[pc + 1]);
+                if (target < 0 || target >= codeSize || depth[target] == NOT_AN_OP)
+                        return false;
+        }
+
+        bool any = false;
+        for (u8 e = 0; e < PUZZLE_EVENT_COUNT; e++)
+        {
+                if (entries[e] == PuzzleConfig::NO_ENTRY)
+                        continue;
+                if (entries[e] >= codeSize || depth[entries[e]] == NOT_AN_OP)
+                        return false;
+                depth[entries[e]] = 0;
+                any = true;
+        }
+        if (!any)
+                return false;
+
+        bool changed = true;
+        while (changed)
+        {
+                changed = false;
+                for (u16 pc = 0; pc < codeSize; pc += 1 + kOpInfo[code[pc]].operands)
+                {
+                        u8 d = depth[pc];
+                        if (d == UNREACHED)
+                                continue;
+
+                        u8 op = code[pc];
+                        u8 pops = kOpInfo[op].pops;
+                        u8 pushes = kOpInfo[op].pushes;
+                        if (op == PZ_SYS)
+                        {
+                                pops = PUZZLE_SYS_ARGS[code[pc + 1]];
+                                pushes = PUZZLE_SYS_RESULT[code[pc + 1]];
+                        }
+                        if (d < pops || d - pops + pushes > PuzzleConfig::STACK_DEPTH)
+                                return false;
+                        u8 out = d - pops + pushes;
+
+                        u16 next[2];
+                        u8 count = 0;
+                        if (op != PZ_END && op != PZ_JMP)
+                                next[count++] = pc + 1 + kOpInfo[op].operands;
+                        if (isJump(op))
+                                next[count++] = (u16)(pc + 3 + jumpOffset(&code[pc + 1]));
+
+                        for (u8 i = 0; i < count; i++)
+                        {
+                                if (depth[next[i]] == UNREACHED)
+                                {
+                                        depth[next[i]] = out;
+                                        changed = true;
+                                }
+                                else if (depth[next[i]] != out)
+                                {
+                                        return false;
+                                }
+                        }
+                }
+        }
+        return true;
+}
+
+/************************* load ********************************************
+ * Validate and copy a script; the previous one stays if it is rejected.
+ * Variables and timers start cleared.
+ ***************************************************************/
+bool PuzzleVM::load(const u8 *code, u16 codeSize, const u16 *entries)
+{
+        if (!validate(code, codeSize, entries))
+                return false;
+
+        memcpy(m_code, code, codeSize);
+        m_codeSize = codeSize;
+        memcpy(m_entries, entries, sizeof(m_entries));
+        m_loaded = true;
+        reset();
+        return true;
+}
+
+/************************* loadAsset ***************************************
+ * Load an ASSET_PUZZLE from the AssetStore. The bytecode is read straight
+ * into the VM, so a rejected asset also unloads the previous script.
+ * @param id ASSET_PUZZLE asset ID.
+ * @return false if the asset is missing, malformed or fails validation.
+ ***************************************************************/
+bool PuzzleVM::loadAsset(u16 id)
+{
+        AssetReader reader;
+        PuzzleAssetHeader header;
+        if (!reader.open(id, ASSET_PUZZLE) || !reader.read(0, &header, sizeof(header)))
+        {
+                Serial.printf("PuzzleVM: asset 0x%04x not found\n", id);
+                return false;
+        }
+
+        if (header.codeSize == 0 || header.codeSize > PuzzleConfig::MAX_CODE ||
+            sizeof(header) + header.codeSize != reader.size())
+        {
+                Serial.printf("PuzzleVM: asset 0x%04x malformed\n", id);
+                return false;
+        }
+
+        unload();
+        if (!reader.read(sizeof(header), m_code, header.codeSize) ||
+            !validate(m_code, header.codeSize, header.entries))
+        {
+                Serial.printf("PuzzleVM: asset 0x%04x rejected\n", id);
+                return false;
+        }
+
+        m_codeSize = header.codeSize;
+        memcpy(m_entries, header.entries, sizeof(m_entries));
+        m_loaded = true;
+        reset();
+        return true;
+}
+
+/************************* unload ******************************************
+ * Drop the script (events become no-ops).
+ ***************************************************************/
+void PuzzleVM::unload()
+{
+        m_loaded = false;
+        m_codeSize = 0;
+        m_timersArmed = 0;
+        for (u8 e = 0; e < PUZZLE_EVENT_COUNT; e++)
+                m_entries[e] = PuzzleConfig::NO_ENTRY;
+}
+
+/************************* hasHandler **************************************
+ * True if the loaded script handles the event.
+ ***************************************************************/
+bool PuzzleVM::hasHandler(PuzzleEvent event) const
+{
+        return m_loaded && event < PUZZLE_EVENT_COUNT && m_entries[event] != PuzzleConfig::NO_ENTRY;
+}
+
+/************************* reset *******************************************
+ * Clear variables and timers and restart NOW.
+ ***************************************************************/
+void PuzzleVM::reset()
+{
+        memset(m_vars, 0, sizeof(m_vars));
+        memset(m_timerDue, 0, sizeof(m_timerDue));
+        m_timersArmed = 0;
+        m_startMs = millis();
+}
+
+/************************* setParams ***************************************
+ * Copy a command payload for PARAM (the rest reads as 0).
+ ***************************************************************/
+void PuzzleVM::setParams(const u8 *params, u8 len)
+{
+        if (len > PuzzleConfig::PARAM_BYTES)
+                len = PuzzleConfig::PARAM_BYTES;
+        memset(m_params, 0, sizeof(m_params));
+        if (params && len)
+                memcpy(m_params, params, len);
+}
+
+//============================================================================
+// EXECUTION
+//============================================================================
+
+/************************* run *********************************************
+ * Run the handler of one event.
+ ***************************************************************/
+PuzzleFault PuzzleVM::run(PuzzleEvent event, int32_t arg)
+{
+        m_steps = 0;
+        if (!hasHandler(event))
+                return PZ_FAULT_NONE;
+
+        PuzzleFault fault = PuzzleConfig::THREADED ? exec<true>(m_entries[event], arg)
+                                                   : exec<false>(m_entries[event], arg);
+        if (fault != PZ_FAULT_NONE)
+        {
+                m_faults++;
+                Serial.printf("PuzzleVM: event %u aborted (fault %u) after %lu steps\n",
+                              event, fault, (unsigned long)m_steps);
+        }
+        return fault;
+}
+
+/************************* tick ********************************************
+ * Fire every armed timer whose deadline has passed (each one once).
+ ***************************************************************/
+PuzzleFault PuzzleVM::tick()
+{
+        PuzzleFault first = PZ_FAULT_NONE;
+        if (!m_timersArmed)
+                return first;
+
+        u32 now = millis();
+        for (u8 t = 0; t < PuzzleConfig::TIMERS; t++)
+        {
+                if (!(m_timersArmed & (1u << t)) || (int32_t)(now - m_timerDue[t]) < 0)
+                        continue;
+
+                m_timersArmed &= ~(1u << t); // The handler may re-arm it
+                PuzzleFault fault = run(PUZZLE_ON_TIMER, t);
+                if (first == PZ_FAULT_NONE)
+                        first = fault;
+        }
+        return first;
+}
+
+/************************* exec ********************************************
+ * Interpret from an entry point until END. Stack bounds were proven by
+ * validate(); every dispatch spends one step of the MAX_STEPS budget and
+ * every PZ_SYS one of MAX_SYS_CALLS (a host call costs whatever its driver
+ * does), so a looping handler is cut off after a bounded, short time. Each handler
+ * ends in NEXT, which either jumps straight to the next handler through
+ * the label table (Threaded) or goes back to one switch.
+ ***************************************************************/
+template <bool Threaded>
+PuzzleFault PuzzleVM::exec(u16 entry, int32_t arg)
+{
+        static const void *const kLabels[PZ_OP_COUNT] = {
+            &&op_END, &&op_PUSH8, &&op_PUSH16, &&op_PUSH32, &&op_ARG,
+            &&op_LOAD, &&op_STORE, &&op_LOADX, &&op_STOREX, &&op_INC,
+            &&op_DUP, &&op_DROP, &&op_SWAP, &&op_OVER,
+            &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_NEG,
+            &&op_AND, &&op_OR, &&op_XOR, &&op_SHL, &&op_SHR, &&op_NOT,
+            &&op_EQ, &&op_NE, &&op_LT, &&op_LE, &&op_GT, &&op_GE, &&op_MIN, &&op_MAX,
+            &&op_JMP, &&op_JZ, &&op_JNZ,
+            &&op_NOW, &&op_RAND, &&op_PARAM, &&op_TIMER, &&op_SYS};
+
+        int32_t stack[PuzzleConfig::STACK_DEPTH];
+        int32_t *sp = stack; // Next free slot; top = sp[-1]
+        const u8 *pc = m_code + entry;
+        u32 left = PuzzleConfig::MAX_STEPS;
+        u8 calls = PuzzleConfig::MAX_SYS_CALLS;
+        PuzzleFault fault = PZ_FAULT_NONE;
+        int32_t a, b;
+
+#define NEXT                                          \
+        do                                            \
+        {                                             \
+                if (left-- == 0)                      \
+                        goto out_of_steps;            \
+                if (Threaded)                         \
+                        goto *kLabels[*pc++];         \
+                else                                  \
+                        goto dispatch;                \
+        } while (0)
+#define PUSH(v) (*sp++ = (v))
+#define POP() (*--sp)
+#define TOP sp[-1]
+
+        left--; // First op through the switch in both modes
+        goto dispatch;
+
+dispatch:
+        switch (*pc++)
+        {
+        case PZ_END: goto op_END;
+        case PZ_PUSH8: goto op_PUSH8;
+        case PZ_PUSH16: goto op_PUSH16;
+        case PZ_PUSH32: goto op_PUSH32;
+        case PZ_ARG: goto op_ARG;
+        case PZ_LOAD: goto op_LOAD;
+        case PZ_STORE: goto op_STORE;
+        case PZ_LOADX: goto op_LOADX;
+        case PZ_STOREX: goto op_STOREX;
+        case PZ_INC: goto op_INC;
+        case PZ_DUP: goto op_DUP;
+        case PZ_DROP: goto op_DROP;
+        case PZ_SWAP: goto op_SWAP;
+        case PZ_OVER: goto op_OVER;
+        case PZ_ADD: goto op_ADD;
+        case PZ_SUB: goto op_SUB;
+        case PZ_MUL: goto op_MUL;
+        case PZ_DIV: goto op_DIV;
+        case PZ_MOD: goto op_MOD;
+        case PZ_NEG: goto op_NEG;
+        case PZ_AND: goto op_AND;
+        case PZ_OR: goto op_OR;
+        case PZ_XOR: goto op_XOR;
+        case PZ_SHL: goto op_SHL;
+        case PZ_SHR: goto op_SHR;
+        case PZ_NOT: goto op_NOT;
+        case PZ_EQ: goto op_EQ;
+        case PZ_NE: goto op_NE;
+        case PZ_LT: goto op_LT;
+        case PZ_LE: goto op_LE;
+        case PZ_GT: goto op_GT;
+        case PZ_GE: goto op_GE;
+        case PZ_MIN: goto op_MIN;
+        case PZ_MAX: goto op_MAX;
+        case PZ_JMP: goto op_JMP;
+        case PZ_JZ: goto op_JZ;
+        case PZ_JNZ: goto op_JNZ;
+        case PZ_NOW: goto op_NOW;
+        case PZ_RAND: goto op_RAND;
+        case PZ_PARAM: goto op_PARAM;
+        case PZ_TIMER: goto op_TIMER;
+        default: goto op_SYS;
+        }
+
+op_PUSH8:
+        PUSH((int32_t)(int8_t)pc[0]);
+        pc += 1;
+        NEXT;
+op_PUSH16:
+        PUSH((int32_t)(int16_t)(pc[0] | (pc[1] << 8)));
+        pc += 2;
+        NEXT;
+op_PUSH32:
+        PUSH((int32_t)((u32)pc[0] | ((u32)pc[1] << 8) | ((u32)pc[2] << 16) | ((u32)pc[3] << 24)));
+        pc += 4;
+        NEXT;
+op_ARG:
+        PUSH(arg);
+        NEXT;
+
+op_LOAD:
+        PUSH(m_vars[pc[0]]);
+        pc += 1;
+        NEXT;
+op_STORE:
+        m_vars[pc[0]] = POP();
+        pc += 1;
+        NEXT;
+op_LOADX:
+        if ((u32)TOP >= (u32)(PuzzleConfig::VAR_COUNT - pc[0]))
+                goto out_of_range;
+        TOP = m_vars[pc[0] + TOP];
+        pc += 1;
+        NEXT;
+op_STOREX:
+        b = POP();
+        a = POP();
+        if ((u32)b >= (u32)(PuzzleConfig::VAR_COUNT - pc[0]))
+                goto out_of_range;
+        m_vars[pc[0] + b] = a;
+        pc += 1;
+        NEXT;
+op_INC:
+        m_vars[pc[0]] = (int32_t)((u32)m_vars[pc[0]] + 1);
+        pc += 1;
+        NEXT;
+
+op_DUP:
+        a = TOP;
+        PUSH(a);
+        NEXT;
+op_DROP:
+        --sp;
+        NEXT;
+op_SWAP:
+        a = sp[-1];
+        sp[-1] = sp[-2];
+        sp[-2] = a;
+        NEXT;
+op_OVER:
+        a = sp[-2];
+        PUSH(a);
+        NEXT;
+
+        // Wrapping arithmetic through u32: scripts never hit signed overflow UB
+op_ADD:
+        b = POP();
+        TOP = (int32_t)((u32)TOP + (u32)b);
+        NEXT;
+op_SUB:
+        b = POP();
+        TOP = (int32_t)((u32)TOP - (u32)b);
+        NEXT;
+op_MUL:
+        b = POP();
+        TOP = (int32_t)((u32)TOP * (u32)b);
+        NEXT;
+op_DIV:
+        b = POP();
+        TOP = b == 0 ? 0 : (b == -1 ? (int32_t)(0u - (u32)TOP) : TOP / b);
+        NEXT;
+op_MOD:
+        b = POP();
+        TOP = (b == 0 || b == -1) ? 0 : TOP % b;
+        NEXT;
+op_NEG:
+        TOP = (int32_t)(0u - (u32)TOP);
+        NEXT;
+op_AND:
+        b = POP();
+        TOP &= b;
+        NEXT;
+op_OR:
+        b = POP();
+        TOP |= b;
+        NEXT;
+op_XOR:
+        b = POP();
+        TOP ^= b;
+        NEXT;
+op_SHL:
+        b = POP();
+        TOP = (int32_t)((u32)TOP << (b & 31));
+        NEXT;
+op_SHR:
+        b = POP();
+        TOP >>= (b & 31);
+        NEXT;
+op_NOT:
+        TOP = !TOP;
+        NEXT;
+op_EQ:
+        b = POP();
+        TOP = TOP == b;
+        NEXT;
+op_NE:
+        b = POP();
+        TOP = TOP != b;
+        NEXT;
+op_LT:
+        b = POP();
+        TOP = TOP < b;
+        NEXT;
+op_LE:
+        b = POP();
+        TOP = TOP <= b;
+        NEXT;
+op_GT:
+        b = POP();
+        TOP = TOP > b;
+        NEXT;
+op_GE:
+        b = POP();
+        TOP = TOP >= b;
+        NEXT;
+op_MIN:
+        b = POP();
+        TOP = b < TOP ? b : TOP;
+        NEXT;
+op_MAX:
+        b = POP();
+        TOP = b > TOP ? b : TOP;
+        NEXT;
+
+op_JMP:
+        pc += 2 + jumpOffset(pc);
+        NEXT;
+op_JZ:
+        a = POP();
+        pc += 2 + (a ? 0 : jumpOffset(pc));
+        NEXT;
+op_JNZ:
+        a = POP();
+        pc += 2 + (a ? jumpOffset(pc) : 0);
+        NEXT;
+
+op_NOW:
+        PUSH((int32_t)(millis() - m_startMs));
+        NEXT;
+op_RAND:
+        m_random ^= m_random << 13; // xorshift32
+        m_random ^= m_random >> 17;
+        m_random ^= m_random << 5;
+        TOP = TOP > 0 ? (int32_t)(m_random % (u32)TOP) : 0;
+        NEXT;
+op_PARAM:
+        TOP = (u32)TOP < PuzzleConfig::PARAM_BYTES ? m_params[TOP] : 0;
+        NEXT;
+op_TIMER:
+        b = POP();
+        a = POP();
+        if ((u32)a < PuzzleConfig::TIMERS)
+        {
+                if (b > 0)
+                {
+                        m_timerDue[a] = millis() + (u32)b;
+                        m_timersArmed |= 1u << a;
+                }
+                else
+                {
+                        m_timersArmed &= ~(1u << a);
+                }
+        }
+        NEXT;
+op_SYS:
+{
+        if (calls-- == 0)
+                goto out_of_calls;
+        u8 id = pc[0];
+        pc += 1;
+        sp -= PUZZLE_SYS_ARGS[id];
+        a = m_host ? m_host(m_hostCtx, id, sp) : 0;
+        if (PUZZLE_SYS_RESULT[id])
+                PUSH(a);
+        NEXT;
+}
+
+out_of_range:
+        fault = PZ_FAULT_INDEX;
+        goto op_END;
+out_of_calls:
+        fault = PZ_FAULT_HOST_CALLS;
+        goto op_END;
+out_of_steps:
+        fault = PZ_FAULT_STEPS;
+        left = 0; // NEXT decremented past it
+op_END:
+        m_steps = PuzzleConfig::MAX_STEPS - left;
+        return fault;
+
+#undef NEXT
+#undef PUSH
+#undef POP
+#undef TOP
+}
+
+//============================================================================
+// DIAGNOSTICS
+//============================================================================
+
+// Counting loop for the benchmark: 8 instructions per iteration
+//   loop: LOAD 0, PUSH8 1, ADD, DUP, STORE 0, PUSH16 500, LT, JNZ loop
+static const u8 kBenchLoop[] = {
+    PZ_LOAD, 0, PZ_PUSH8, 1, PZ_ADD, PZ_DUP, PZ_STORE, 0,
+    PZ_PUSH16, 0xF4, 0x01, PZ_LT, PZ_JNZ, 0xF1, 0xFF, PZ_END};
+
+// Keypad sequence check as a puzzle would write it: compare ARG with
+// var[1 + var[0]] and advance or restart
+static const u8 kBenchKey[] = {
+    PZ_LOAD, 0, PZ_LOADX, 1, PZ_ARG, PZ_EQ, PZ_JZ, 5, 0,
+    PZ_INC, 0, PZ_JMP, 4, 0,
+    PZ_PUSH8, 0, PZ_STORE, 0, PZ_END};
+
+/************************* benchmark ***************************************
+ * Time the sample scripts with both dispatch modes. Reports ns per
+ * instruction and the worst case a handler can take (MAX_STEPS of them),
+ * which is what bounds an event against the watchdog. Host calls are not
+ * included (they cost whatever the driver does).
+ ***************************************************************/
+void PuzzleVM::benchmark()
+{
+        struct Sample
+        {
+                const char *name;
+                const u8 *code;
+                u16 size;
+                u16 runs;
+        };
+        const Sample samples[] = {
+            {"loop", kBenchLoop, sizeof(kBenchLoop), 20},
+            {"key", kBenchKey, sizeof(kBenchKey), 2000},
+        };
+
+        Serial.println("\n=== Puzzle VM Benchmark ===");
+        PuzzleVM *vm = new PuzzleVM(); // ~1.4 KB: keep it off the stack
+        u16 entries[PUZZLE_EVENT_COUNT];
+        for (u8 e = 0; e < PUZZLE_EVENT_COUNT; e++)
+                entries[e] = PuzzleConfig::NO_ENTRY;
+        entries[PUZZLE_ON_KEY] = 0;
+
+        for (const Sample &s : samples)
+        {
+                u32 start = micros();
+                bool ok = vm->load(s.code, s.size, entries);
+                u32 loadUs = micros() - start;
+                if (!ok)
+                {
+                        Serial.printf("[PVM] %-5s invalid\n", s.name);
+                        continue;
+                }
+
+                u32 ns[2];
+                u32 steps = 0;
+                for (u8 k = 0; k < 2; k++)
+                {
+                        steps = 0;
+                        start = micros();
+                        for (u16 r = 0; r < s.runs; r++)
+                        {
+                                vm->m_vars[0] = 0;
+                                k ? vm->exec<true>(0, r & 3) : vm->exec<false>(0, r & 3);
+                                steps += vm->m_steps;
+                        }
+                        ns[k] = (micros() - start) * 1000 / (steps ? steps : 1);
+                        if (ns[k] == 0)
+                                ns[k] = 1;
+                }
+                Watchdog::reset();
+
+                Serial.printf("[PVM] %-5s %2u bytes  load %3lu us  switch %3lu ns/op  threaded %3lu ns/op  (%lu ops)\n",
+                              s.name, s.size, (unsigned long)loadUs, (unsigned long)ns[0], (unsigned long)ns[1],
+                              (unsigned long)steps);
+                Serial.printf("[PVM] %-5s worst-case event (%u steps) ~%lu us\n",
+                              s.name, PuzzleConfig::MAX_STEPS, (unsigned long)(ns[1] * PuzzleConfig::MAX_STEPS / 1000));
+        }
+        delete vm;
+        Serial.println("=== Puzzle VM Benchmark Complete ===\n");
+}
@@ -102,6 +102,9 @@ void parserInit(RoomBusParser *parser)
         parser->state = RB_PSTATE_WAIT_START;
         parser->idx = 0;
         parser->rxCrc = 0;
+        parser->crcErrors = 0;
+        parser->droppedBytes = 0;
+        parser->frameCount = 0;
 }
 
 /**
@@ -138,6 +141,10 @@ int parserFeed(RoomBusParser *parser, uint8_t byte, RoomFrame *out)
                         parser->rxCrc = 0;
                         parser->state = RB_PSTATE_READ_FRAME;
                 }
+                else
+                {
+                        parser->droppedBytes++; // Line noise between frames
+                }
                 break;
 
         case RB_PSTATE_READ_FRAME:
@@ -181,10 +188,13 @@ int parserFeed(RoomBusParser *parser, uint8_t byte, RoomFrame *out)
 
                                 // Reset for next frame
                                 parser->state = RB_PSTATE_WAIT_START;
+                                parser->frameCount++;
                                 return 1; // one complete frame decoded
                         }
+                        parser->crcErrors++;
                 }
-                // CRC or end byte failed → reset
+                // CRC or end byte failed → reset (whole packet is lost)
+                parser->droppedBytes += RB_MAX_PACKET_SIZE;
                 parser->state = RB_PSTATE_WAIT_START;
                 break;
 
@@ -231,6 +241,15 @@ void RoomSerial::begin()
         parserInit(&parser);
 }
 
+/************************* setReceiveCallback *****************************
+ * Register a data-received callback on the UART (call after begin()).
+ * Fires on RX FIFO threshold or after a short line-idle timeout.
+ ***************************************************************/
+void RoomSerial::setReceiveCallback(void (*callback)())
+{
+        serial.onReceive(callback);
+}
+
 /************************* enableTransmit *********************************
  * Set transceiver to transmit mode (DE high).
  ***************************************************************/
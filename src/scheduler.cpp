@@ -0,0 +1,166 @@
+/************************* scheduler.cpp ************************
+ * Deadline-driven cooperative scheduler implementation
+ * Periodic deadlines plus notification-bit triggers
+ * Created by MSK, November 2025
+ * Replaces the fixed delay() at the end of the main loop
+ ***************************************************************/
+
+#include "scheduler.h"
+
+/************************* Scheduler constructor **************************
+ * Start with all slots empty.
+ ***************************************************************/
+Scheduler::Scheduler()
+    : m_owner(nullptr), m_pending(0)
+{
+        for (u8 i = 0; i < SchedulerConfig::MAX_TASKS; i++)
+        {
+                m_tasks[i].name = nullptr;
+                m_tasks[i].fn = nullptr;
+                m_tasks[i].ctx = nullptr;
+                m_tasks[i].periodMs = 0;
+                m_tasks[i].nextDue = 0;
+        }
+}
+
+/************************* begin *******************************************
+ * Bind to the calling task; triggers are delivered to it.
+ ***************************************************************/
+void Scheduler::begin()
+{
+        m_owner = xTaskGetCurrentTaskHandle();
+}
+
+/************************* setTask *****************************************
+ * Register a task in slot id.
+ * @param id Slot and notification bit.
+ * @param name Diagnostic name.
+ * @param fn Task body.
+ * @param ctx Context pointer for fn.
+ * @param periodMs Period in ms (0 = event-driven only).
+ ***************************************************************/
+bool Scheduler::setTask(u8 id, const char *name, TaskFn fn, void *ctx, u32 periodMs)
+{
+        if (id >= SchedulerConfig::MAX_TASKS || !fn)
+                return false;
+
+        SchedTask &t = m_tasks[id];
+        t.name = name;
+        t.fn = fn;
+        t.ctx = ctx;
+        t.periodMs = periodMs;
+        t.nextDue = millis() + periodMs;
+        return true;
+}
+
+/************************* setPeriod ***************************************
+ * Change a task's period; the next deadline is counted from now.
+ ***************************************************************/
+void Scheduler::setPeriod(u8 id, u32 periodMs)
+{
+        if (id >= SchedulerConfig::MAX_TASKS)
+                return;
+
+        m_tasks[id].periodMs = periodMs;
+        m_tasks[id].nextDue = millis() + periodMs;
+}
+
+/************************* trigger *****************************************
+ * Mark a task runnable from task context (wakes the owner if sleeping).
+ ***************************************************************/
+void Scheduler::trigger(u8 id)
+{
+        if (id >= SchedulerConfig::MAX_TASKS)
+                return;
+
+        if (m_owner)
+        {
+                xTaskNotify(m_owner, 1UL << id, eSetBits);
+        }
+        else
+        {
+                m_pending |= (1UL << id); // Not started yet: picked up on first runDue()
+        }
+}
+
+/************************* triggerFromISR **********************************
+ * Mark a task runnable from an ISR (wakes the owner if sleeping).
+ ***************************************************************/
+void IRAM_ATTR Scheduler::triggerFromISR(u8 id)
+{
+        if (!m_owner || id >= SchedulerConfig::MAX_TASKS)
+                return;
+
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(m_owner, 1UL << id, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+}
+
+/************************* runDue ******************************************
+ * Run triggered tasks and periodic tasks whose deadline has passed.
+ * A late periodic task is rescheduled from now (no burst catch-up).
+ ***************************************************************/
+void Scheduler::runDue()
+{
+        u32 pending = m_pending;
+        m_pending = 0;
+
+        for (u8 i = 0; i < SchedulerConfig::MAX_TASKS; i++)
+        {
+                SchedTask &t = m_tasks[i];
+                if (!t.fn)
+                        continue;
+
+                u32 now = millis();
+                bool triggered = (pending & (1UL << i)) != 0;
+                bool expired = t.periodMs && (int32_t)(now - t.nextDue) >= 0;
+                if (!triggered && !expired)
+                        continue;
+
+                if (t.periodMs)
+                {
+                        t.nextDue += t.periodMs;
+                        if ((int32_t)(now - t.nextDue) >= 0)
+                                t.nextDue = now + t.periodMs; // Overrun: drop missed ticks
+                }
+
+                t.fn(t.ctx);
+        }
+}
+
+/************************* waitForWork *************************************
+ * Sleep until the earliest periodic deadline or a trigger notification.
+ ***************************************************************/
+void Scheduler::waitForWork()
+{
+        u32 now = millis();
+        u32 sleepMs = SchedulerConfig::MAX_SLEEP_MS;
+
+        for (u8 i = 0; i < SchedulerConfig::MAX_TASKS; i++)
+        {
+                const SchedTask &t = m_tasks[i];
+                if (!t.fn || !t.periodMs)
+                        continue;
+
+                int32_t remaining = (int32_t)(t.nextDue - now);
+                if (remaining <= 0)
+                {
+                        sleepMs = 0;
+                        break;
+                }
+                if ((u32)remaining < sleepMs)
+                        sleepMs = (u32)remaining;
+        }
+
+        if (!m_owner)
+        {
+                delay(sleepMs); // begin() not called: plain sleep
+                return;
+        }
+
+        u32 bits = 0;
+        if (xTaskNotifyWait(0, 0xFFFFFFFF, &bits, pdMS_TO_TICKS(sleepMs)) == pdTRUE)
+        {
+                m_pending |= bits;
+        }
+}
@@ -0,0 +1,578 @@
+/************************* shader.cpp ***************************
+ * Shader VM Implementation
+ * Load-time validation and a check-free per-pixel interpreter
+ * Created by MSK, November 2025
+ * Dispatch via computed goto (GCC labels as values) or switch
+ ***************************************************************/
+
+#include "shader.h"
+#include "colors.h"
+#include "watchdog.h"
+#include <Arduino.h>
+#include <math.h>
+
+//============================================================================
+// TABLES
+//============================================================================
+
+// Stack effect and operand bytes per opcode (load-time validation only)
+struct OpInfo
+{
+        u8 pops;
+        u8 pushes;
+        u8 operands;
+};
+
+static const OpInfo kOpInfo[SH_OP_COUNT] = {
+    {1, 0, 0}, // END
+    {0, 1, 1}, // PUSH8
+    {0, 1, 2}, // PUSH16
+    {0, 1, 3}, // PUSHC
+    {0, 1, 0}, // INDEX
+    {0, 1, 0}, // X
+    {0, 1, 0}, // Y
+    {0, 1, 0}, // TIME
+    {0, 1, 0}, // COUNT
+    {1, 2, 0}, // DUP
+    {1, 0, 0}, // DROP
+    {2, 2, 0}, // SWAP
+    {2, 3, 0}, // OVER
+    {2, 1, 0}, // ADD
+    {2, 1, 0}, // SUB
+    {2, 1, 0}, // MUL
+    {2, 1, 0}, // DIV
+    {2, 1, 0}, // MOD
+    {1, 1, 0}, // NEG
+    {1, 1, 0}, // ABS
+    {2, 1, 0}, // MIN
+    {2, 1, 0}, // MAX
+    {1, 1, 0}, // FRACT
+    {1, 1, 0}, // FLOOR
+    {1, 1, 0}, // CLAMP
+    {2, 1, 0}, // LT
+    {3, 1, 0}, // SEL
+    {1, 1, 0}, // SIN
+    {1, 1, 0}, // TRI
+    {1, 1, 0}, // NOISE
+    {2, 1, 0}, // NOISE2
+    {3, 1, 0}, // HSV
+    {3, 1, 0}, // RGB
+    {1, 1, 0}, // PAL
+    {3, 1, 0}, // MIXC
+    {2, 1, 0}, // SCALEC
+};
+
+// One sine period in 256 steps, Q8.8 (-256..256); filled on first load()
+static int16_t sinTable[256];
+static bool tablesReady = false;
+
+/************************* buildTables *************************************
+ * Fill the sine LUT (once; floats only here, never per pixel).
+ ***************************************************************/
+static void buildTables()
+{
+        if (tablesReady)
+                return;
+
+        for (u16 i = 0; i < 256; i++)
+        {
+                sinTable[i] = (int16_t)lroundf(sinf(i * (2.0f * (float)M_PI / 256.0f)) * ShaderConfig::ONE);
+        }
+        tablesReady = true;
+}
+
+//============================================================================
+// BUILT-IN HELPERS
+//============================================================================
+
+static inline int32_t clamp01(int32_t v)
+{
+        return v < 0 ? 0 : (v > ShaderConfig::ONE ? ShaderConfig::ONE : v);
+}
+
+static inline u32 channel(int32_t v)
+{
+        return v < 0 ? 0 : (v > 255 ? 255 : (u32)v);
+}
+
+/************************* hash ********************************************
+ * Integer hash of a lattice point to 0..255.
+ ***************************************************************/
+static inline int32_t hash(u32 x)
+{
+        x *= 0x9E3779B1u;
+        x ^= x >> 15;
+        x *= 0x85EBCA77u;
+        x ^= x >> 13;
+        return (int32_t)(x >> 24);
+}
+
+// Smoothstep of a Q8.8 fraction: 3f^2 - 2f^3, 0..256
+static inline int32_t smooth(int32_t f)
+{
+        return (f * f * (3 * ShaderConfig::ONE - 2 * f)) >> 16;
+}
+
+static inline int32_t lerp(int32_t a, int32_t b, int32_t t)
+{
+        return a + (((b - a) * t) >> 8);
+}
+
+/************************* noise1 / noise2 *********************************
+ * Value noise: hashed lattice values, smoothstep-interpolated.
+ * Lattice spacing 1.0; result 0..255 (Q8.8 0..~1).
+ ***************************************************************/
+static inline int32_t noise1(int32_t x)
+{
+        int32_t i = x >> 8;
+        int32_t t = smooth(x & 0xFF);
+        return lerp(hash((u32)i), hash((u32)(i + 1)), t);
+}
+
+static inline int32_t noise2(int32_t x, int32_t y)
+{
+        u32 ix = (u32)(x >> 8);
+        u32 iy = (u32)(y >> 8) * 0x27D4EB2Fu;
+        int32_t tx = smooth(x & 0xFF);
+        int32_t ty = smooth(y & 0xFF);
+        int32_t top = lerp(hash(ix ^ iy), hash((ix + 1) ^ iy), tx);
+        iy += 0x27D4EB2Fu;
+        int32_t bottom = lerp(hash(ix ^ iy), hash((ix + 1) ^ iy), tx);
+        return lerp(top, bottom, ty);
+}
+
+/************************* hsv *********************************************
+ * HSV to packed RGB, integer only.
+ * @param h Hue in turns (Q8.8, wraps).
+ * @param s Saturation 0..1 (Q8.8).
+ * @param v Value 0..1 (Q8.8).
+ ***************************************************************/
+static inline u32 hsv(int32_t h, int32_t s, int32_t v)
+{
+        u32 sat = (u32)clamp01(s);
+        u32 val = channel(v);
+        u32 hh = (u32)(h & 0xFF) * 6;
+        u32 f = hh & 0xFF;
+
+        u32 p = (val * (256 - sat)) >> 8;
+        u32 q = (val * (256 - ((sat * f) >> 8))) >> 8;
+        u32 t = (val * (256 - ((sat * (256 - f)) >> 8))) >> 8;
+
+        switch (hh >> 8)
+        {
+        case 0:
+                return (val << 16) | (t << 8) | p;
+        case 1:
+                return (q << 16) | (val << 8) | p;
+        case 2:
+                return (p << 16) | (val << 8) | t;
+        case 3:
+                return (p << 16) | (q << 8) | val;
+        case 4:
+                return (t << 16) | (p << 8) | val;
+        default:
+                return (val << 16) | (p << 8) | q;
+        }
+}
+
+//============================================================================
+// CONSTRUCTOR & LOADING
+//============================================================================
+
+/************************* Shader constructor ******************************
+ * No program until load().
+ ***************************************************************/
+Shader::Shader()
+    : m_program{nullptr, 0, nullptr, 0, 0},
+      m_loaded(false),
+      m_time(0),
+      m_count(0)
+{
+}
+
+/************************* validate ****************************************
+ * Walk the program once: known opcodes, complete operands, no stack
+ * underflow or overflow, palette present for PAL, terminated by END.
+ * Programs are straight-line (no jumps), so the walk is exact.
+ ***************************************************************/
+bool Shader::validate(const ShaderProgram &program, u8 *maxDepth)
+{
+        if (!program.code || program.codeSize == 0 || program.codeSize > ShaderConfig::MAX_CODE ||
+            program.paletteSize > ShaderConfig::MAX_PALETTE || (program.paletteSize && !program.palette))
+                return false;
+
+        u8 depth = 0;
+        u8 deepest = 0;
+        for (u16 pc = 0; pc < program.codeSize;)
+        {
+                u8 op = program.code[pc++];
+                if (op >= SH_OP_COUNT)
+                        return false;
+
+                const OpInfo &info = kOpInfo[op];
+                if (depth < info.pops || pc + info.operands > program.codeSize)
+                        return false;
+                if (op == SH_PAL && program.paletteSize == 0)
+                        return false;
+
+                depth = depth - info.pops + info.pushes;
+                if (depth > ShaderConfig::STACK_DEPTH)
+                        return false;
+                if (depth > deepest)
+                        deepest = depth;
+
+                if (op == SH_END)
+                {
+                        if (maxDepth)
+                                *maxDepth = deepest;
+                        return true;
+                }
+                pc += info.operands;
+        }
+
+        return false; // No END
+}
+
+/************************* load ********************************************
+ * Validate and select a program.
+ ***************************************************************/
+bool Shader::load(const ShaderProgram &program)
+{
+        buildTables();
+
+        m_loaded = validate(program);
+        if (m_loaded)
+                m_program = program;
+        return m_loaded;
+}
+
+/************************* beginFrame **************************************
+ * Latch the time and pixel count inputs for this frame.
+ ***************************************************************/
+void Shader::beginFrame(u32 timeMs, u16 count)
+{
+        m_time = (int32_t)(((uint64_t)timeMs * ShaderConfig::ONE) / 1000);
+        m_count = (int32_t)count * ShaderConfig::ONE;
+}
+
+/************************* eval ********************************************
+ * Color of one pixel (0 if no program is loaded).
+ ***************************************************************/
+u32 Shader::eval(u16 index) const
+{
+        if (!m_loaded)
+                return 0;
+        return ShaderConfig::THREADED ? run<true>(index) : run<false>(index);
+}
+
+//============================================================================
+// INTERPRETER
+//============================================================================
+
+/************************* run *********************************************
+ * Execute the program for one pixel. No checks: load() proved the program
+ * safe. Each handler ends in NEXT, which either jumps straight to the next
+ * handler through the label table (Threaded) or goes back to one switch.
+ ***************************************************************/
+template <bool Threaded>
+u32 Shader::run(u16 index) const
+{
+        static const void *const kLabels[SH_OP_COUNT] = {
+            &&op_END, &&op_PUSH8, &&op_PUSH16, &&op_PUSHC,
+            &&op_INDEX, &&op_X, &&op_Y, &&op_TIME, &&op_COUNT,
+            &&op_DUP, &&op_DROP, &&op_SWAP, &&op_OVER,
+            &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_NEG, &&op_ABS,
+            &&op_MIN, &&op_MAX, &&op_FRACT, &&op_FLOOR, &&op_CLAMP, &&op_LT, &&op_SEL,
+            &&op_SIN, &&op_TRI, &&op_NOISE, &&op_NOISE2, &&op_HSV, &&op_RGB,
+            &&op_PAL, &&op_MIXC, &&op_SCALEC};
+
+        int32_t stack[ShaderConfig::STACK_DEPTH];
+        int32_t *sp = stack; // Next free slot; top = sp[-1]
+        const u8 *pc = m_program.code;
+        const u16 width = m_program.width;
+        int32_t a, b;
+
+#define NEXT                                  \
+        do                                    \
+        {                                     \
+                if (Threaded)                 \
+                        goto *kLabels[*pc++]; \
+                else                          \
+                        goto dispatch;        \
+        } while (0)
+#define PUSH(v) (*sp++ = (v))
+#define POP() (*--sp)
+#define TOP sp[-1]
+
+        goto dispatch; // First op through the switch in both modes
+
+dispatch:
+        switch (*pc++)
+        {
+        case SH_END: goto op_END;
+        case SH_PUSH8: goto op_PUSH8;
+        case SH_PUSH16: goto op_PUSH16;
+        case SH_PUSHC: goto op_PUSHC;
+        case SH_INDEX: goto op_INDEX;
+        case SH_X: goto op_X;
+        case SH_Y: goto op_Y;
+        case SH_TIME: goto op_TIME;
+        case SH_COUNT: goto op_COUNT;
+        case SH_DUP: goto op_DUP;
+        case SH_DROP: goto op_DROP;
+        case SH_SWAP: goto op_SWAP;
+        case SH_OVER: goto op_OVER;
+        case SH_ADD: goto op_ADD;
+        case SH_SUB: goto op_SUB;
+        case SH_MUL: goto op_MUL;
+        case SH_DIV: goto op_DIV;
+        case SH_MOD: goto op_MOD;
+        case SH_NEG: goto op_NEG;
+        case SH_ABS: goto op_ABS;
+        case SH_MIN: goto op_MIN;
+        case SH_MAX: goto op_MAX;
+        case SH_FRACT: goto op_FRACT;
+        case SH_FLOOR: goto op_FLOOR;
+        case SH_CLAMP: goto op_CLAMP;
+        case SH_LT: goto op_LT;
+        case SH_SEL: goto op_SEL;
+        case SH_SIN: goto op_SIN;
+        case SH_TRI: goto op_TRI;
+        case SH_NOISE: goto op_NOISE;
+        case SH_NOISE2: goto op_NOISE2;
+        case SH_HSV: goto op_HSV;
+        case SH_RGB: goto op_RGB;
+        case SH_PAL: goto op_PAL;
+        case SH_MIXC: goto op_MIXC;
+        default: goto op_SCALEC;
+        }
+
+op_END:
+        return (u32)TOP & 0x00FFFFFF;
+
+op_PUSH8:
+        PUSH((int32_t)(int8_t)pc[0] * ShaderConfig::ONE);
+        pc += 1;
+        NEXT;
+op_PUSH16:
+        PUSH((int32_t)(int16_t)(pc[0] | (pc[1] << 8)));
+        pc += 2;
+        NEXT;
+op_PUSHC:
+        PUSH((int32_t)(((u32)pc[0] << 16) | ((u32)pc[1] << 8) | pc[2]));
+        pc += 3;
+        NEXT;
+
+op_INDEX:
+        PUSH((int32_t)index * ShaderConfig::ONE);
+        NEXT;
+op_X:
+        PUSH((int32_t)(width ? index % width : index) * ShaderConfig::ONE);
+        NEXT;
+op_Y:
+        PUSH((int32_t)(width ? index / width : 0) * ShaderConfig::ONE);
+        NEXT;
+op_TIME:
+        PUSH(m_time);
+        NEXT;
+op_COUNT:
+        PUSH(m_count);
+        NEXT;
+
+op_DUP:
+        a = TOP;
+        PUSH(a);
+        NEXT;
+op_DROP:
+        --sp;
+        NEXT;
+op_SWAP:
+        a = sp[-1];
+        sp[-1] = sp[-2];
+        sp[-2] = a;
+        NEXT;
+op_OVER:
+        a = sp[-2];
+        PUSH(a);
+        NEXT;
+
+op_ADD:
+        b = POP();
+        TOP += b;
+        NEXT;
+op_SUB:
+        b = POP();
+        TOP -= b;
+        NEXT;
+op_MUL:
+        b = POP();
+        TOP = (int32_t)(((int64_t)TOP * b) >> 8);
+        NEXT;
+op_DIV:
+        b = POP();
+        TOP = b ? (int32_t)(((int64_t)TOP * ShaderConfig::ONE) / b) : 0;
+        NEXT;
+op_MOD:
+        b = POP();
+        if (b > 0)
+        {
+                a = TOP % b;
+                TOP = a < 0 ? a + b : a;
+        }
+        else
+        {
+                TOP = 0;
+        }
+        NEXT;
+op_NEG:
+        TOP = -TOP;
+        NEXT;
+op_ABS:
+        TOP = TOP < 0 ? -TOP : TOP;
+        NEXT;
+op_MIN:
+        b = POP();
+        TOP = b < TOP ? b : TOP;
+        NEXT;
+op_MAX:
+        b = POP();
+        TOP = b > TOP ? b : TOP;
+        NEXT;
+op_FRACT:
+        TOP &= 0xFF;
+        NEXT;
+op_FLOOR:
+        TOP &= ~0xFF;
+        NEXT;
+op_CLAMP:
+        TOP = clamp01(TOP);
+        NEXT;
+op_LT:
+        b = POP();
+        TOP = TOP < b ? ShaderConfig::ONE : 0;
+        NEXT;
+op_SEL:
+        b = POP();
+        a = POP();
+        TOP = TOP > 0 ? a : b;
+        NEXT;
+
+op_SIN:
+        TOP = sinTable[TOP & 0xFF];
+        NEXT;
+op_TRI:
+        a = TOP & 0xFF;
+        TOP = a < 128 ? a * 2 : (256 - a) * 2;
+        NEXT;
+op_NOISE:
+        TOP = noise1(TOP);
+        NEXT;
+op_NOISE2:
+        b = POP();
+        TOP = noise2(TOP, b);
+        NEXT;
+op_HSV:
+        b = POP();
+        a = POP();
+        TOP = (int32_t)hsv(TOP, a, b);
+        NEXT;
+op_RGB:
+        b = POP();
+        a = POP();
+        TOP = (int32_t)((channel(TOP) << 16) | (channel(a) << 8) | channel(b));
+        NEXT;
+op_PAL:
+{
+        u32 pos = (u32)(TOP & 0xFF) * m_program.paletteSize;
+        u32 i = pos >> 8;
+        u32 j = i + 1 < m_program.paletteSize ? i + 1 : 0;
+        TOP = (int32_t)colorLerp(m_program.palette[i], m_program.palette[j], pos & 0xFF);
+        NEXT;
+}
+op_MIXC:
+        b = POP();
+        a = POP();
+        TOP = (int32_t)colorLerp((u32)TOP, (u32)a, (u32)clamp01(b));
+        NEXT;
+op_SCALEC:
+        b = POP();
+        TOP = (int32_t)colorLerp(0, (u32)TOP, (u32)clamp01(b));
+        NEXT;
+
+#undef NEXT
+#undef PUSH
+#undef POP
+#undef TOP
+}
+
+//============================================================================
+// DIAGNOSTICS
+//============================================================================
+
+// Sample programs for the benchmark (also usable as built-in looks)
+static const u8 kBenchRainbow[] = {
+    SH_INDEX, SH_COUNT, SH_DIV, SH_TIME, SH_PUSH16, 64, 0, SH_MUL, SH_ADD, // hue = i/n + t/4
+    SH_PUSH8, 1, SH_PUSH8, 1, SH_HSV, SH_END};
+
+static const u8 kBenchBreathing[] = {
+    SH_TIME, SH_PUSH16, 32, 0, SH_MUL, SH_TRI, SH_DUP, SH_DUP, SH_RGB, SH_END}; // 8 s white pulse
+
+static const u8 kBenchPlasma[] = {
+    SH_X, SH_PUSH16, 26, 0, SH_MUL, SH_TIME, SH_ADD, SH_SIN,                     // sin(x/10 + t)
+    SH_Y, SH_PUSH16, 33, 0, SH_MUL, SH_TIME, SH_PUSH16, 179, 0, SH_MUL, SH_SUB, SH_SIN, // sin(y/8 - 0.7t)
+    SH_ADD, SH_PUSH16, 64, 0, SH_MUL,                                            // /4
+    SH_X, SH_PUSH16, 13, 0, SH_MUL, SH_Y, SH_PUSH16, 13, 0, SH_MUL, SH_TIME, SH_ADD, SH_NOISE2,
+    SH_ADD, SH_PAL, SH_END};
+
+static const u32 kBenchPalette[] = {0x000020, 0x0040FF, 0x00FFC0, 0xFFFFFF, 0xFF4000, 0x400020};
+
+/************************* benchmark ***************************************
+ * Time the sample programs over `count` pixels with both dispatch modes.
+ * Reports ns/pixel, pixels/second and the LED count one core could drive
+ * at 50 Hz with the program alone (no output time).
+ * @param count Pixels per timed frame.
+ ***************************************************************/
+void Shader::benchmark(u16 count)
+{
+        struct Sample
+        {
+                const char *name;
+                ShaderProgram program;
+        };
+        const Sample samples[] = {
+            {"rainbow", {kBenchRainbow, sizeof(kBenchRainbow), nullptr, 0, 0}},
+            {"breathing", {kBenchBreathing, sizeof(kBenchBreathing), nullptr, 0, 0}},
+            {"plasma", {kBenchPlasma, sizeof(kBenchPlasma), kBenchPalette, 6, 32}},
+        };
+
+        Serial.println("\n=== Shader Benchmark ===");
+        Shader shader;
+        for (const Sample &s : samples)
+        {
+                if (!shader.load(s.program))
+                {
+                        Serial.printf("[SHD] %-10s invalid\n", s.name);
+                        continue;
+                }
+                shader.beginFrame(12345, count);
+
+                u32 ns[2];
+                volatile u32 sink = 0; // Keeps the timed loop from being optimized out
+                for (u8 k = 0; k < 2; k++)
+                {
+                        u32 start = micros();
+                        for (u16 i = 0; i < count; i++)
+                                sink += k ? shader.run<true>(i) : shader.run<false>(i);
+                        ns[k] = (micros() - start) * 1000 / count;
+                        if (ns[k] == 0)
+                                ns[k] = 1;
+                }
+                Watchdog::reset();
+
+                u32 pps = 1000000000UL / ns[1];
+                Serial.printf("[SHD] %-10s %2u bytes  switch %4lu ns/px  threaded %4lu ns/px  %lu px/s  %lu LEDs @ 50 Hz\n",
+                              s.name, s.program.codeSize, (unsigned long)ns[0], (unsigned long)ns[1],
+                              (unsigned long)pps, (unsigned long)(pps / 50));
+        }
+        Serial.println("=== Shader Benchmark Complete ===\n");
+}
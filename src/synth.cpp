@@ -9,6 +9,7 @@
 #include "music.h" // Include for MusicPlayer definition
 #include <math.h>
 #include <algorithm>
+#include "probe.h"
 
 //============================================================================
 // CONFIGURATION ADSR PRESETS
@@ -23,6 +24,18 @@
 
 static Synth *synthInstance = nullptr;
 
+// ISR load accounting: cycles spent inside the ISR are summed over a window of
+// sampleRate samples (~1 s); the finished window is published for telemetry.
+// The first ISR opens the first window. The published pair is written and
+// read under isrLoadMux so a reader never mixes two windows.
+static u32 isrBusyCycles = 0;            // ISR cycles in the current window
+static u32 isrWindowStart = 0;           // Cycle count at window start
+static bool isrWindowOpen = false;       // Set by the first ISR
+static u16 isrWindowSamples = 0;         // Samples in the current window
+static u32 isrLoadCycles = 0;            // ISR cycles in the last full window
+static u32 isrLoadSpan = 0;              // Wall cycles of the last full window
+static portMUX_TYPE isrLoadMux = portMUX_INITIALIZER_UNLOCKED;
+
 /************************* sampleTimerISR *********************************
  * Timer ISR: dispatch to active Synth instance.
  ***************************************************************/
@@ -30,7 +43,35 @@ void IRAM_ATTR sampleTimerISR()
 {
         if (synthInstance)
         {
+                u32 start = ESP.getCycleCount();
+                if (!isrWindowOpen)
+                {
+                        isrWindowStart = start;
+                        isrWindowOpen = true;
+                }
+
+#ifdef ENABLE_PROBES
+                // Entry-to-entry period: spread around 1/sampleRate is the audio jitter
+                static u32 lastEntry = 0;
+                if (lastEntry)
+                        Probe::record(PROBE_SYNTH_PERIOD, start - lastEntry);
+                lastEntry = start;
+#endif
+
                 synthInstance->updateSample();
+                u32 end = ESP.getCycleCount();
+
+                isrBusyCycles += end - start;
+                if (++isrWindowSamples >= synthInstance->getSampleRate())
+                {
+                        portENTER_CRITICAL_ISR(&isrLoadMux);
+                        isrLoadCycles = isrBusyCycles;
+                        isrLoadSpan = end - isrWindowStart;
+                        portEXIT_CRITICAL_ISR(&isrLoadMux);
+                        isrWindowStart = end;
+                        isrBusyCycles = 0;
+                        isrWindowSamples = 0;
+                }
         }
 }
 
@@ -147,6 +188,23 @@ void Synth::begin(u16 sampleRateHz)
         timerAlarmEnable(sampleTimer);
 }
 
+/************************* getIsrLoad *************************************
+ * Share of CPU time spent in the sample ISR over the last ~1 s window.
+ * @return Load in per mille (0-1000), 0 until the first window completes.
+ ***************************************************************/
+u16 Synth::getIsrLoad() const
+{
+        portENTER_CRITICAL(&isrLoadMux);
+        u32 cycles = isrLoadCycles;
+        u32 span = isrLoadSpan;
+        portEXIT_CRITICAL(&isrLoadMux);
+        if (span == 0)
+                return 0;
+
+        u32 permille = (u32)(((uint64_t)cycles * 1000) / span);
+        return (permille > 1000) ? 1000 : (u16)permille;
+}
+
 /************************* setWaveform ************************************
  * Select output waveform.
  ***************************************************************/
@@ -373,6 +431,8 @@ bool Synth::isPlaying()
  ***************************************************************/
 void IRAM_ATTR Synth::updateSample()
 {
+        PROBE_SCOPE(PROBE_SYNTH_SAMPLE);
+
         // --- 0. Update Music Player ---
         if (musicPlayer)
         {
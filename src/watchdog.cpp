@@ -2,7 +2,8 @@
  * Watchdog Timer Implementation
  * Multi-platform watchdog support for system reliability
  * Created by MSK, November 2025
- * Supports ESP32, AVR, SAM, SAMD, and Teensy platforms
+ * Supports ESP32, AVR, SAM, SAMD, and Teensy platforms, plus a no-op
+ * host build for the native tests
  ***************************************************************/
 
 #include "watchdog.h"
@@ -164,6 +165,25 @@ void Watchdog::disable()
         // Placeholder
 }
 
+// ============================================================================
+#elif !defined(ARDUINO)
+// ---------------------------- Host (env:native tests) -----------------------
+// No hardware to guard: the test runner is the watchdog
+
+void Watchdog::begin(uint32_t timeoutSeconds, bool enablePanic)
+{
+        (void)timeoutSeconds;
+        (void)enablePanic;
+}
+
+void Watchdog::reset()
+{
+}
+
+void Watchdog::disable()
+{
+}
+
 // ============================================================================
 #else
 // ---------------------------- Fallback (No Watchdog) ------------------------
@@ -0,0 +1,41 @@
+/************************* Adafruit_NeoPixel.h (native) ********
+ * Host stand-in for Adafruit_NeoPixel: a wire buffer and a show() count
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#ifndef NATIVE_ADAFRUIT_NEOPIXEL_H
+#define NATIVE_ADAFRUIT_NEOPIXEL_H
+
+#include "Arduino.h"
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel
+{
+public:
+        Adafruit_NeoPixel(uint16_t n, int16_t, uint16_t)
+            : m_count(n), m_pixels(n ? new uint8_t[n * 3]() : nullptr), m_shows(0) {}
+        ~Adafruit_NeoPixel() { delete[] m_pixels; }
+        Adafruit_NeoPixel(const Adafruit_NeoPixel &) = delete;
+        Adafruit_NeoPixel &operator=(const Adafruit_NeoPixel &) = delete;
+
+        void begin() {}
+        void updateLength(uint16_t n)
+        {
+                delete[] m_pixels;
+                m_count = n;
+                m_pixels = n ? new uint8_t[n * 3]() : nullptr;
+        }
+        void show() { m_shows++; }
+        uint8_t *getPixels() const { return m_pixels; }
+        uint16_t numPixels() const { return m_count; }
+        uint32_t showCount() const { return m_shows; }
+
+private:
+        uint16_t m_count;
+        uint8_t *m_pixels;
+        uint32_t m_shows;
+};
+
+#endif // NATIVE_ADAFRUIT_NEOPIXEL_H
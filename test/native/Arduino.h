@@ -0,0 +1,100 @@
+/************************* Arduino.h (native) ******************
+ * Host stand-in for the Arduino core (pio test -e native)
+ * Just enough of the API for the modules built into the host tests
+ * Created by MSK, November 2025
+ * millis() is a simulated clock the tests set; micros() is the host clock
+ ***************************************************************/
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "esp_timer.h"
+
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define FALLING 0x02
+#define digitalPinToInterrupt(p) (p)
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// Simulated millis() clock (advanced by the test, or by delay())
+inline unsigned long g_nativeMillis = 0;
+
+inline void setMillis(unsigned long ms) { g_nativeMillis = ms; }
+inline unsigned long millis() { return g_nativeMillis; }
+inline void delay(uint32_t ms) { g_nativeMillis += ms; }
+
+// 32 bits as on the ESP32, so u32 deltas (micros() - start) wrap the same way
+inline uint32_t micros()
+{
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// FreeRTOS critical sections: the host tests have no ISRs to hold off
+typedef struct
+{
+        int owner;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) (void)(mux)
+#define portEXIT_CRITICAL(mux) (void)(mux)
+
+inline void delayMicroseconds(uint32_t) {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void attachInterrupt(uint8_t, void (*)(void), int) {}
+
+// Serial: printf/print/println to stdout
+class HWCDC
+{
+public:
+        void begin(unsigned long) {}
+
+        size_t printf(const char *format, ...)
+        {
+                va_list args;
+                va_start(args, format);
+                int n = vprintf(format, args);
+                va_end(args);
+                return n < 0 ? 0 : (size_t)n;
+        }
+
+        size_t print(const char *s) { return (size_t)::printf("%s", s); }
+        size_t print(long v) { return (size_t)::printf("%ld", v); }
+        size_t println(const char *s = "") { return (size_t)::printf("%s\n", s); }
+        size_t println(long v) { return (size_t)::printf("%ld\n", v); }
+};
+
+inline HWCDC Serial;
+
+// ESP: the "cycle counter" counts host nanoseconds (1000 MHz), so probe
+// timings read directly as host time
+class EspClass
+{
+public:
+        uint32_t getCycleCount()
+        {
+                using namespace std::chrono;
+                return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        }
+        uint32_t getCpuFreqMHz() { return 1000; }
+        uint32_t getFreeHeap() { return 0; }
+};
+
+inline EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
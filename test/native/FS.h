@@ -0,0 +1,60 @@
+/************************* FS.h (native) ***********************
+ * Host stand-in for the Arduino FS API: a filesystem with no files
+ * (AssetStore builds; asset lookups fail as on an unformatted partition)
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+        enum SeekMode
+        {
+                SeekSet = 0,
+                SeekCur = 1,
+                SeekEnd = 2
+        };
+
+        class File
+        {
+        public:
+                size_t write(const uint8_t *, size_t) { return 0; }
+                size_t read(uint8_t *, size_t) { return 0; }
+                bool seek(uint32_t, SeekMode = SeekSet) { return false; }
+                size_t position() const { return 0; }
+                size_t size() const { return 0; }
+                void flush() {}
+                void close() {}
+                bool isDirectory() { return false; }
+                const char *name() const { return ""; }
+                const char *path() const { return ""; }
+                File openNextFile(const char * = FILE_READ) { return File(); }
+                operator bool() const { return false; }
+        };
+
+        class FS
+        {
+        public:
+                File open(const char *, const char * = FILE_READ, bool = false) { return File(); }
+                bool exists(const char *) { return false; }
+                bool remove(const char *) { return false; }
+                bool rename(const char *, const char *) { return false; }
+                bool mkdir(const char *) { return false; }
+        };
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekSet;
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,26 @@
+/************************* LittleFS.h (native) *****************
+ * Host stand-in for LittleFS: mount fails, nothing is stored
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs
+{
+        class LittleFSFS : public FS
+        {
+        public:
+                bool begin(bool = false, const char * = "/littlefs", uint8_t = 10, const char * = "spiffs") { return false; }
+                bool format() { return false; }
+                size_t totalBytes() { return 0; }
+                size_t usedBytes() { return 0; }
+                void end() {}
+        };
+}
+
+inline fs::LittleFSFS LittleFS;
+
+#endif // NATIVE_LITTLEFS_H
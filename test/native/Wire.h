@@ -0,0 +1,109 @@
+/************************* Wire.h (native) *********************
+ * Host stand-in for TwoWire with simulated PCF8575 expanders
+ * Records every port write so tests can check the bits and the
+ * number of I2C transactions
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire
+{
+public:
+        static constexpr uint8_t BASE_ADDR = 0x20;
+        static constexpr uint8_t SLOTS = 8; // 0x20-0x27
+
+        TwoWire() { reset(); }
+
+        // Simulation state: remove all expanders, ports back to power-on (all HIGH)
+        void reset()
+        {
+                for (uint8_t i = 0; i < SLOTS; i++)
+                {
+                        m_present[i] = false;
+                        m_port[i] = 0xFFFF;
+                        m_inputs[i] = 0xFFFF;
+                }
+                m_writes = 0;
+                m_reads = 0;
+                m_clock = 100000;
+        }
+
+        void attach(uint8_t address) { m_present[slot(address)] = true; }
+        uint16_t port(uint8_t address) const { return m_port[slot(address)]; }
+        void setInputs(uint8_t address, uint16_t pins) { m_inputs[slot(address)] = pins; }
+        uint32_t writeCount() const { return m_writes; }
+        uint32_t readCount() const { return m_reads; }
+        uint32_t getClock() const { return m_clock; }
+
+        // TwoWire API
+        bool begin(int = -1, int = -1, uint32_t = 0) { return true; }
+        void setClock(uint32_t hz) { m_clock = hz; }
+
+        void beginTransmission(uint8_t address)
+        {
+                m_txAddr = address;
+                m_txLen = 0;
+        }
+
+        size_t write(uint8_t data)
+        {
+                if (m_txLen < 2)
+                        m_tx[m_txLen] = data;
+                m_txLen++;
+                return 1;
+        }
+
+        uint8_t endTransmission(bool = true)
+        {
+                if (!present(m_txAddr))
+                        return 2; // NACK on address
+                if (m_txLen == 2)
+                {
+                        m_port[slot(m_txAddr)] = (uint16_t)(m_tx[0] | (m_tx[1] << 8));
+                        m_writes++;
+                }
+                return 0;
+        }
+
+        uint8_t requestFrom(uint8_t address, uint8_t count, bool = true)
+        {
+                if (!present(address))
+                        return 0;
+                // Quasi-bidirectional pins: a pin reads LOW if driven LOW or pulled LOW
+                uint16_t pins = m_port[slot(address)] & m_inputs[slot(address)];
+                m_rx[0] = pins & 0xFF;
+                m_rx[1] = pins >> 8;
+                m_rxPos = 0;
+                m_reads++;
+                return count > 2 ? 2 : count;
+        }
+
+        int read() { return m_rxPos < 2 ? m_rx[m_rxPos++] : -1; }
+
+private:
+        static uint8_t slot(uint8_t address) { return (address - BASE_ADDR) & (SLOTS - 1); }
+        bool present(uint8_t address) const
+        {
+                return address >= BASE_ADDR && address < BASE_ADDR + SLOTS && m_present[slot(address)];
+        }
+
+        bool m_present[SLOTS];
+        uint16_t m_port[SLOTS];
+        uint16_t m_inputs[SLOTS];
+        uint32_t m_writes;
+        uint32_t m_reads;
+        uint32_t m_clock;
+        uint8_t m_txAddr = 0;
+        uint8_t m_tx[2] = {0, 0};
+        uint8_t m_txLen = 0;
+        uint8_t m_rx[2] = {0, 0};
+        uint8_t m_rxPos = 0;
+};
+
+inline TwoWire Wire;
+
+#endif // NATIVE_WIRE_H
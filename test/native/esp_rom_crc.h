@@ -0,0 +1,23 @@
+/************************* esp_rom_crc.h (native) **************
+ * Host stand-in for the ROM CRC-32 (IEEE, reflected, as in ESP-IDF)
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#ifndef NATIVE_ESP_ROM_CRC_H
+#define NATIVE_ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len)
+{
+        crc = ~crc;
+        while (len--)
+        {
+                crc ^= *buf++;
+                for (uint8_t k = 0; k < 8; k++)
+                        crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        return ~crc;
+}
+
+#endif // NATIVE_ESP_ROM_CRC_H
@@ -0,0 +1,27 @@
+/************************* esp_timer.h (native) ****************
+ * Host stand-in for esp_timer_get_time(): the host microsecond clock,
+ * or a simulated one once a test calls setTimerUs()
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include <stdint.h>
+#include <chrono>
+
+// Simulated esp_timer clock (negative = follow the host clock)
+inline int64_t g_nativeTimerUs = -1;
+
+inline void setTimerUs(int64_t us) { g_nativeTimerUs = us; }
+
+inline int64_t esp_timer_get_time()
+{
+        if (g_nativeTimerUs >= 0)
+                return g_nativeTimerUs;
+
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // NATIVE_ESP_TIMER_H
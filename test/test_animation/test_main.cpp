@@ -0,0 +1,402 @@
+/************************* test_animation ***********************
+ * Packed animation playback on the host (pio test -e native)
+ * Every decoded frame is compared with the raw frames, and the
+ * "Animation decode frame" probe times the decoder on 264-LED content;
+ * pixel fades must survive the frames and digits drawn over them
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#include <unity.h>
+#include <vector>
+#include <map>
+#include "animation.h"
+#include "compositor.h"
+#include "glyph.h"
+#include "probe.h"
+#include "test_animation.h"
+#include "test_animation_packed.h"
+
+typedef std::vector<u32> Frame;
+
+static constexpr u8 PIN = 2;
+static constexpr u16 NUMBOX_LEDS = 264; // 24 digits x 11 segments
+static constexpr u16 NUMBOX_FRAMES = 250;
+static constexpr u8 NUMBOX_FPS = 25;    // 10 s
+
+/************************* encoder ****************************************
+ * Same token choices as tools/anim_encode.py (encode_frame), so sizes
+ * match the tool's report.
+ ***************************************************************/
+struct Encoded
+{
+        std::vector<u32> palette;
+        std::vector<u8> stream;
+        PackedAnimation anim;
+};
+
+static u16 runLength(const std::vector<u8> &v, u16 start, u16 limit)
+{
+        u16 end = start;
+        while (end < v.size() && v[end] == v[start] && end - start < limit)
+                end++;
+        return end - start;
+}
+
+static void encodeFrame(std::vector<u8> &out, const std::vector<u8> &cur, const std::vector<u8> *prev)
+{
+        using namespace PackedAnimToken;
+        const u16 n = cur.size();
+        u16 i = 0;
+        while (i < n)
+        {
+                if (prev && cur[i] == (*prev)[i])
+                {
+                        u16 j = i;
+                        while (j < n && cur[j] == (*prev)[j] && j - i < 64)
+                                j++;
+                        out.push_back(SKIP | (j - i - 1));
+                        i = j;
+                        continue;
+                }
+
+                u16 run = runLength(cur, i, 128);
+                if (run >= 2)
+                {
+                        out.push_back(RUN | (run - 1));
+                        out.push_back(cur[i]);
+                        i += run;
+                        continue;
+                }
+
+                u16 j = i;
+                while (j < n && j - i < 64)
+                {
+                        if (j > i && prev && j + 1 < n && cur[j] == (*prev)[j] && cur[j + 1] == (*prev)[j + 1])
+                                break;
+                        if (j > i && runLength(cur, j, 3) >= 3)
+                                break;
+                        j++;
+                }
+                out.push_back(LITERAL | (j - i - 1));
+                out.insert(out.end(), cur.begin() + i, cur.begin() + j);
+                i = j;
+        }
+}
+
+static void encode(Encoded &e, const std::vector<Frame> &frames, u8 fps)
+{
+        std::map<u32, u8> lookup;
+        std::vector<u8> prev;
+        for (const Frame &frame : frames)
+        {
+                std::vector<u8> indices;
+                for (u32 color : frame)
+                {
+                        auto it = lookup.find(color);
+                        if (it == lookup.end())
+                        {
+                                it = lookup.emplace(color, (u8)e.palette.size()).first;
+                                e.palette.push_back(color);
+                        }
+                        indices.push_back(it->second);
+                }
+                encodeFrame(e.stream, indices, prev.empty() ? nullptr : &prev);
+                prev = indices;
+        }
+        e.anim = {e.palette.data(), e.stream.data(), (u32)e.stream.size(), (u16)frames.size(),
+                  (u16)frames[0].size(), (u16)e.palette.size(), fps};
+}
+
+/************************* content ****************************************
+ * 264-LED Num Box content, 250 frames at 25 fps.
+ ***************************************************************/
+
+// Binary counter on the digit segments plus a moving cursor dot
+static Frame counterFrame(u16 f)
+{
+        Frame fr(NUMBOX_LEDS, 0);
+        u16 value = f / 25;
+        for (u16 c = 0; c < 24; c++)
+        {
+                bool on = (value >> (c % 8)) & 1;
+                for (u16 k = 0; k < 11; k++)
+                {
+                        if (on && k % 3)
+                                fr[c * 11 + k] = 0xE00000;
+                }
+        }
+        fr[(f * 3) % NUMBOX_LEDS] = 0x00FF00;
+        return fr;
+}
+
+// Red dot with a 3-pixel tail on blue
+static Frame chaseFrame(u16 f)
+{
+        static const u32 kTail[] = {0xFF0000, 0x550000, 0x110008, 0x080008};
+        Frame fr(NUMBOX_LEDS, 0x0000FF);
+        for (u16 t = 0; t < 4; t++)
+                fr[(f + NUMBOX_LEDS - t) % NUMBOX_LEDS] = kTail[t];
+        return fr;
+}
+
+// 32-hue rainbow, 8 LEDs per hue, rotating one hue per frame
+static Frame rainbowFrame(u16 f)
+{
+        static u32 hues[32];
+        for (u8 h = 0; h < 32; h++)
+        {
+                double x = h / 32.0 * 6.0;
+                int sector = (int)x;
+                double q = 1.0 - (x - sector);
+                double t = 1.0 - (1.0 - (x - sector)); // As Python's colorsys.hsv_to_rgb
+                double rgb[6][3] = {{1, t, 0}, {q, 1, 0}, {0, 1, t}, {0, q, 1}, {t, 0, 1}, {1, 0, q}};
+                const double *c = rgb[sector % 6];
+                hues[h] = ((u32)(c[0] * 255) << 16) | ((u32)(c[1] * 255) << 8) | (u32)(c[2] * 255);
+        }
+
+        Frame fr(NUMBOX_LEDS);
+        for (u16 i = 0; i < NUMBOX_LEDS; i++)
+                fr[i] = hues[(i / 8 + f) % 32];
+        return fr;
+}
+
+/************************* helpers ****************************************/
+
+// ms at which frame f is due
+static u32 frameTime(u32 f, u8 fps)
+{
+        return (f * 1000 + fps - 1) / fps;
+}
+
+// Play the packed animation for `loops` passes and check every frame on the strip
+static void playAndCheck(const PackedAnimation &packed, const std::vector<Frame> &frames, u8 loops = 1)
+{
+        PixelStrip strip(PIN, packed.ledCount);
+        Animation anim(&strip);
+        anim.init();
+
+        setMillis(0);
+        anim.startBitmap(&packed, true);
+
+        const u32 count = frames.size();
+        for (u32 f = 0; f < count * loops; f++)
+        {
+                setMillis(frameTime(f, packed.frameRate));
+                anim.update();
+
+                const Frame &expected = frames[f % count];
+                for (u16 i = 0; i < packed.ledCount; i++)
+                {
+                        if (strip.getColor(i) != expected[i])
+                        {
+                                char msg[64];
+                                snprintf(msg, sizeof(msg), "frame %lu LED %u", (unsigned long)(f % count), i);
+                                TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected[i], strip.getColor(i), msg);
+                        }
+                }
+        }
+}
+
+template <size_t Frames, size_t Leds>
+static std::vector<Frame> rawFrames(const u32 (&data)[Frames][Leds])
+{
+        std::vector<Frame> frames;
+        for (size_t f = 0; f < Frames; f++)
+                frames.emplace_back(data[f], data[f] + Leds);
+        return frames;
+}
+
+void setUp()
+{
+        setMillis(0);
+        Probe::reset();
+}
+
+void tearDown() {}
+
+/************************* tests ******************************************/
+
+void test_packed_headers_match_raw()
+{
+        playAndCheck(kTestAnimDataPacked, rawFrames(kTestAnimData), 2);
+        playAndCheck(kColorTestAnimDataPacked, rawFrames(kColorTestAnimData), 2);
+}
+
+void test_encoder_matches_tool()
+{
+        Encoded e;
+        encode(e, rawFrames(kTestAnimData), kTestAnimDataPacked.frameRate);
+        TEST_ASSERT_EQUAL_UINT32(sizeof(kTestAnimDataPackedData), e.stream.size());
+        TEST_ASSERT_EQUAL_MEMORY(kTestAnimDataPackedData, e.stream.data(), e.stream.size());
+}
+
+// Decode all frames of one content four times; print size and decode time per frame
+static void decodeNumBox(const char *name, Frame (*generate)(u16), u32 expectedBytes)
+{
+        std::vector<Frame> frames;
+        for (u16 f = 0; f < NUMBOX_FRAMES; f++)
+                frames.push_back(generate(f));
+
+        Encoded e;
+        encode(e, frames, NUMBOX_FPS);
+        u32 bytes = e.palette.size() * sizeof(u32) + e.stream.size();
+        TEST_ASSERT_EQUAL_UINT32(expectedBytes, bytes);
+
+        Probe::reset();
+        playAndCheck(e.anim, frames, 4);
+
+        // Host "cycles" are nanoseconds (test/native/Arduino.h)
+        const ProbeStats *s = Probe::get(PROBE_ANIM_DECODE);
+        TEST_ASSERT_EQUAL_UINT32(4 * NUMBOX_FRAMES, s->count);
+        Serial.printf("[ANIM] %-8s %u x %u LEDs  %6lu B  decode avg %5.2f us/frame  max %5.2f us\n",
+                      name, NUMBOX_FRAMES, NUMBOX_LEDS, (unsigned long)bytes,
+                      s->totalCycles / 1000.0 / s->count, s->maxCycles / 1000.0);
+}
+
+void test_numbox_counter() { decodeNumBox("counter", counterFrame, 2660); }
+void test_numbox_chase() { decodeNumBox("chase", chaseFrame, 2782); }
+void test_numbox_rainbow() { decodeNumBox("rainbow", rainbowFrame, 16628); }
+
+// A playing animation leaves a fading pixel to the fade
+void test_fade_over_animation()
+{
+        std::vector<Frame> frames;
+        for (u16 f = 0; f < NUMBOX_FRAMES; f++)
+                frames.push_back(chaseFrame(f));
+        Encoded e;
+        encode(e, frames, NUMBOX_FPS);
+
+        PixelStrip strip(PIN, NUMBOX_LEDS);
+        Animation anim(&strip);
+        anim.init();
+        anim.startBitmap(&e.anim, true);
+        anim.update();
+
+        strip.fadeTo(10, 0xFFFFFF, 1000, FADE_LINEAR); // The chase passes LED 10 at 400-560 ms
+        for (u32 f = 1; f <= 25; f++)
+        {
+                setMillis(frameTime(f, NUMBOX_FPS));
+                anim.update();
+                strip.updateFades();
+                if (f == 12) // 480 ms: 48% of the way from blue
+                        TEST_ASSERT_EQUAL_HEX32(0x7979FF, strip.getColor(10));
+        }
+        TEST_ASSERT_FALSE(strip.isFading());
+        TEST_ASSERT_EQUAL_HEX32(0xFFFFFF, strip.getColor(10));
+        TEST_ASSERT_EQUAL_HEX32(0xFF0000, strip.getColor(25)); // The rest kept playing
+}
+
+// Layer changes wake the frame task; its update() skips fading pixels
+static u32 g_wakes;
+static void countWake() { g_wakes++; }
+
+void test_fade_over_compositor()
+{
+        PixelStrip strip(PIN, 16);
+        Compositor layers(&strip);
+        g_wakes = 0;
+        layers.setWakeCallback(countWake);
+        TEST_ASSERT_TRUE(layers.begin(1));
+        layers.fill(0, 0x0000FF);
+        TEST_ASSERT_EQUAL_UINT32(2, g_wakes);
+        layers.update();
+
+        strip.fadeTo(5, 0xFF0000, 100, FADE_LINEAR);
+        layers.fill(0, 0x00FF00);
+        layers.update();
+        TEST_ASSERT_TRUE(strip.isFading(5));
+        TEST_ASSERT_FALSE(strip.isFading(6));
+        TEST_ASSERT_EQUAL_HEX32(0x0000FF, strip.getColor(5));
+        TEST_ASSERT_EQUAL_HEX32(0x00FF00, strip.getColor(6));
+
+        setMillis(100);
+        strip.updateFades();
+        TEST_ASSERT_EQUAL_HEX32(0xFF0000, strip.getColor(5));
+
+        // A source started after setSource() wakes the task too
+        Animation anim(&strip);
+        anim.init();
+        layers.setSource(0, &anim);
+        u32 wakes = g_wakes;
+        anim.start(ANIM_RAINBOW_CYCLE);
+        TEST_ASSERT_EQUAL_UINT32(wakes + 1, g_wakes);
+        layers.update(); // Sources draw without waking again
+        TEST_ASSERT_EQUAL_UINT32(wakes + 1, g_wakes);
+        layers.end();
+}
+
+// Digits drawn straight into the strip leave a fading LED to the fade
+void test_fade_under_glyph()
+{
+        PixelStrip strip(PIN, GlyphConfig::LEDS_PER_DIGIT);
+        SegmentDisplay display(&strip, 0, 1);
+        display.setColor(0x00FF00);
+        strip.fadeTo(2, 0xFF0000, 100, FADE_LINEAR);
+
+        display.setSegments(0, (1u << SEG_COUNT) - 1); // Every segment lit
+        display.render();
+        TEST_ASSERT_TRUE(strip.isFading(2));
+        TEST_ASSERT_EQUAL_HEX32(0, strip.getColor(2));
+        TEST_ASSERT_EQUAL_HEX32(0x00FF00, strip.getColor(3));
+
+        setMillis(100);
+        strip.updateFades();
+        TEST_ASSERT_EQUAL_HEX32(0xFF0000, strip.getColor(2));
+}
+
+// Dithered levels repeat within 1 << DITHER_BITS refreshes, never slower
+void test_dither_cycle()
+{
+        PixelStrip strip(PIN, 1);
+        strip.setBrightness(100); // Fractional levels
+        strip.setDither(true);
+        TEST_ASSERT_TRUE(strip.isDithering());
+        strip.setColor(0, 0x010203);
+
+        constexpr u8 cycle = 1 << PixelConfig::DITHER_BITS;
+        constexpr u16 refreshes = 256;
+        u8 sent[refreshes][PixelConfig::BYTES_PER_PIXEL];
+        for (u16 r = 0; r < refreshes; r++)
+        {
+                setMillis((r + 1) * PixelConfig::DITHER_REFRESH_MS);
+                strip.applyBuffer();
+                memcpy(sent[r], strip.getPixels().getPixels(), PixelConfig::BYTES_PER_PIXEL);
+        }
+        TEST_ASSERT_EQUAL_UINT32(refreshes, strip.getPixels().showCount());
+        for (u16 r = cycle; r < refreshes; r++)
+                TEST_ASSERT_EQUAL_MEMORY(sent[r % cycle], sent[r], PixelConfig::BYTES_PER_PIXEL);
+}
+
+// Core resizes the 16-pixel boot strip to the device's cellCount (Timer: 44)
+void test_strip_set_count()
+{
+        PixelStrip strip(PIN, 16);
+        strip.setDither(true);
+        strip.fadeTo(3, 0xFFFFFF, 100);
+        strip.setCount(44);
+        TEST_ASSERT_EQUAL_UINT16(44, strip.getCount());
+        TEST_ASSERT_EQUAL_UINT16(44, strip.getPhysicalCount());
+        TEST_ASSERT_FALSE(strip.isFading());
+
+        strip.begin();
+        strip.setColor(43, 0x123456);
+        strip.applyBuffer();
+        TEST_ASSERT_EQUAL_HEX32(0x123456, strip.getColor(43));
+        TEST_ASSERT_EQUAL_HEX32(0, strip.getColor(44));
+}
+
+int main(int argc, char **argv)
+{
+        UNITY_BEGIN();
+        RUN_TEST(test_packed_headers_match_raw);
+        RUN_TEST(test_encoder_matches_tool);
+        RUN_TEST(test_numbox_counter);
+        RUN_TEST(test_numbox_chase);
+        RUN_TEST(test_numbox_rainbow);
+        RUN_TEST(test_fade_over_animation);
+        RUN_TEST(test_fade_over_compositor);
+        RUN_TEST(test_fade_under_glyph);
+        RUN_TEST(test_dither_cycle);
+        RUN_TEST(test_strip_set_count);
+        return UNITY_END();
+}
@@ -0,0 +1,193 @@
+/************************* test_countdown ***********************
+ * Countdown on the host (pio test -e native)
+ * Runs on a simulated esp_timer clock: counting, pause/resume, rounding,
+ * and how server resyncs are slewed in or snapped
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#include <unity.h>
+#include "countdown.h"
+#include "esp_timer.h"
+
+using namespace CountdownConfig;
+
+/************************* helpers ****************************************/
+
+static constexpr int64_t SECOND = 1000000; // esp_timer microseconds
+
+static void at(int64_t us) { setTimerUs(us); }
+
+// 60 s countdown started at t = 0, 50 s left at t = 10 s
+static void startMinute(Countdown &c)
+{
+        at(0);
+        c.set(60000);
+        c.start();
+        at(10 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(50000, c.remainingMs());
+}
+
+void setUp() { at(0); }
+
+void tearDown() {}
+
+/************************* tests ******************************************/
+
+void test_counts_down_and_stops_once()
+{
+        Countdown c;
+        c.set(10000);
+        TEST_ASSERT_FALSE(c.isRunning());
+        c.start();
+        TEST_ASSERT_TRUE(c.isRunning());
+
+        at(3 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(7000, c.remainingMs());
+        TEST_ASSERT_FALSE(c.update());
+
+        at(10 * SECOND);
+        TEST_ASSERT_TRUE(c.update());
+        TEST_ASSERT_FALSE(c.isRunning());
+        TEST_ASSERT_EQUAL_UINT32(0, c.remainingMs());
+        TEST_ASSERT_FALSE(c.update()); // Reported once
+
+        c.start(); // Nothing left to run
+        TEST_ASSERT_FALSE(c.isRunning());
+}
+
+void test_pause_freezes()
+{
+        Countdown c;
+        c.set(10000);
+        c.start();
+        at(4 * SECOND);
+        c.pause();
+
+        at(60 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(6000, c.remainingMs());
+        TEST_ASSERT_FALSE(c.update());
+
+        c.start();
+        at(62 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(4000, c.remainingMs());
+}
+
+void test_rounds_up()
+{
+        Countdown c;
+        c.set(1000);
+        c.start();
+        at(999500);
+        TEST_ASSERT_EQUAL_UINT32(1, c.remainingMs()); // Not 0 before it has expired
+        TEST_ASSERT_FALSE(c.update());
+        at(SECOND);
+        TEST_ASSERT_EQUAL_UINT32(0, c.remainingMs());
+        TEST_ASSERT_TRUE(c.update());
+}
+
+void test_add_clamps_at_zero()
+{
+        Countdown c;
+        c.set(3000);
+        c.add(2000);
+        TEST_ASSERT_EQUAL_UINT32(5000, c.remainingMs());
+        c.add(-8000);
+        TEST_ASSERT_EQUAL_UINT32(0, c.remainingMs());
+        c.start();
+        TEST_ASSERT_FALSE(c.isRunning());
+}
+
+// Running 1 s slow: the clock runs SLEW_PERMILLE fast until it has caught up
+void test_slew_when_behind()
+{
+        Countdown c;
+        startMinute(c);
+        c.sync(49000);
+        TEST_ASSERT_EQUAL_UINT32(50000, c.remainingMs()); // No jump
+
+        at(15 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(50000 - 5000 - 5000 * SLEW_PERMILLE / 1000, c.remainingMs());
+
+        at(20 * SECOND); // 10 s at 10%: the second is absorbed
+        TEST_ASSERT_EQUAL_UINT32(39000, c.remainingMs());
+        at(30 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(29000, c.remainingMs()); // Back to real time
+}
+
+// Running 1 s fast: the clock runs slow instead
+void test_slew_when_ahead()
+{
+        Countdown c;
+        startMinute(c);
+        c.sync(51000);
+        TEST_ASSERT_EQUAL_UINT32(50000, c.remainingMs());
+
+        at(20 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(41000, c.remainingMs());
+        at(30 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(31000, c.remainingMs());
+}
+
+// A pause keeps the part of the correction not yet slewed in
+void test_slew_survives_pause()
+{
+        Countdown c;
+        startMinute(c);
+        c.sync(49000);
+
+        at(15 * SECOND); // Half absorbed
+        c.pause();
+        TEST_ASSERT_EQUAL_UINT32(44500, c.remainingMs());
+
+        at(100 * SECOND);
+        c.start();
+        at(105 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(39000, c.remainingMs());
+        at(106 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(38000, c.remainingMs());
+}
+
+// Errors past SNAP_MS, or any error while paused, are applied at once
+void test_snap()
+{
+        Countdown c;
+        startMinute(c);
+        c.sync(50000 - SNAP_MS - 1);
+        TEST_ASSERT_EQUAL_UINT32(50000 - SNAP_MS - 1, c.remainingMs());
+
+        c.pause();
+        c.sync(30500);
+        TEST_ASSERT_EQUAL_UINT32(30500, c.remainingMs());
+
+        c.sync(31000); // And a later small error while running slews again
+        c.start();
+        c.sync(30000);
+        TEST_ASSERT_EQUAL_UINT32(31000, c.remainingMs());
+}
+
+// set() drops a pending correction
+void test_set_drops_correction()
+{
+        Countdown c;
+        startMinute(c);
+        c.sync(49000);
+        c.set(20000);
+        at(30 * SECOND);
+        TEST_ASSERT_EQUAL_UINT32(0, c.remainingMs());
+        TEST_ASSERT_TRUE(c.update());
+}
+
+int main(int argc, char **argv)
+{
+        UNITY_BEGIN();
+        RUN_TEST(test_counts_down_and_stops_once);
+        RUN_TEST(test_pause_freezes);
+        RUN_TEST(test_rounds_up);
+        RUN_TEST(test_add_clamps_at_zero);
+        RUN_TEST(test_slew_when_behind);
+        RUN_TEST(test_slew_when_ahead);
+        RUN_TEST(test_slew_survives_pause);
+        RUN_TEST(test_snap);
+        RUN_TEST(test_set_drops_correction);
+        return UNITY_END();
+}
@@ -0,0 +1,217 @@
+/************************* test_motors **************************
+ * MotorController on a simulated PCF8575 port (pio test -e native)
+ * Duty and phase of the PWM slices, ramps, timed moves, brake, and
+ * the number of port writes per PWM period
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#include <unity.h>
+#include "motors.h"
+
+using namespace MotorConfig;
+
+static constexpr u8 ADDR = IO_EXPANDER_BASE_ADDR;
+
+/************************* helpers ****************************************/
+
+// Slices of one PWM period (starting at t) in which motor 0's pins equal bits
+static u8 countSlices(MotorController &motors, u32 t, u16 bits)
+{
+        u8 on = 0;
+        for (u8 s = 0; s < PWM_STEPS; s++)
+        {
+                if ((motors.update(t + s * TICK_MS) & IOExpander::motorBits(0, MOTOR_BRAKE)) == bits)
+                        on++;
+        }
+        return on;
+}
+
+// One Core pass: motor tick, then the end-of-pass flush
+static void pass(MotorController &motors, IOExpander &io, u32 now)
+{
+        setMillis(now);
+        motors.tick();
+        io.flush();
+}
+
+void setUp()
+{
+        Wire.reset();
+        Wire.attach(ADDR);
+        setMillis(0);
+}
+
+void tearDown() {}
+
+/************************* tests ******************************************/
+
+void test_duty_follows_speed()
+{
+        IOExpander io(ADDR);
+        MotorController motors(&io);
+        motors.setRamp(0, 0);
+
+        const int8_t speeds[] = {10, 30, 50, 70, 100};
+        u32 t = 0;
+        for (int8_t speed : speeds)
+        {
+                motors.setSpeed(0, speed);
+                motors.update(t);
+                TEST_ASSERT_EQUAL_UINT8(speed / 10, countSlices(motors, t, IOExpander::motorBits(0, MOTOR_FORWARD)));
+                t += PWM_PERIOD_MS;
+        }
+
+        motors.setSpeed(0, -40);
+        motors.update(t);
+        TEST_ASSERT_EQUAL_UINT8(4, countSlices(motors, t, IOExpander::motorBits(0, MOTOR_REVERSE)));
+        TEST_ASSERT_EQUAL_UINT8(0, countSlices(motors, t, IOExpander::motorBits(0, MOTOR_FORWARD)));
+}
+
+void test_phase_stagger()
+{
+        IOExpander io(ADDR);
+        MotorController motors(&io);
+        for (u8 m = 0; m < MOTOR_COUNT; m++)
+        {
+                motors.setRamp(m, 0);
+                motors.setSpeed(m, 10); // One slice each
+        }
+
+        // Each motor's on-slice is at its phase offset, never two together
+        const u8 firstSlice[MOTOR_COUNT] = {0, 2, 5, 7};
+        for (u8 s = 0; s < PWM_STEPS; s++)
+        {
+                u16 bits = motors.update(s * TICK_MS);
+                u16 expected = 0;
+                for (u8 m = 0; m < MOTOR_COUNT; m++)
+                {
+                        if (s == firstSlice[m])
+                                expected |= IOExpander::motorBits(m, MOTOR_FORWARD);
+                }
+                TEST_ASSERT_EQUAL_HEX16(expected, bits);
+        }
+}
+
+void test_ramp_up_and_down()
+{
+        IOExpander io(ADDR);
+        MotorController motors(&io); // DEFAULT_RAMP: 0 -> 100% in 500 ms
+
+        motors.setSpeed(0, 100);
+        u32 t = 0;
+        for (; t <= 250; t += TICK_MS)
+                motors.update(t);
+        TEST_ASSERT_INT8_WITHIN(1, 50, motors.getSpeed(0));
+
+        for (; t < 500; t += TICK_MS)
+                motors.update(t);
+        TEST_ASSERT_EQUAL_INT8(99, motors.getSpeed(0));
+        motors.update(t);
+        TEST_ASSERT_EQUAL_INT8(100, motors.getSpeed(0));
+
+        // Down through 0 into reverse takes 1 s at 200 %/s
+        motors.setSpeed(0, -100);
+        u32 start = t;
+        while (motors.getSpeed(0) != -100 && t < start + 2000)
+                motors.update(t += TICK_MS);
+        TEST_ASSERT_EQUAL_UINT32(1000, t - start);
+
+        // A late tick is clamped to one PWM period (no jump after idle)
+        motors.setSpeed(0, 0);
+        motors.update(t + 5000);
+        TEST_ASSERT_EQUAL_INT8(-96, motors.getSpeed(0));
+}
+
+void test_timed_move()
+{
+        IOExpander io(ADDR);
+        MotorController motors(&io);
+        motors.setRamp(2, 0);
+
+        setMillis(1000);
+        motors.run(2, -100, 300);
+        TEST_ASSERT_TRUE(motors.isActive());
+
+        u16 reverse = IOExpander::motorBits(2, MOTOR_REVERSE);
+        for (u32 t = 1000; t < 1300; t += TICK_MS)
+                TEST_ASSERT_EQUAL_HEX16(reverse, motors.update(t));
+
+        TEST_ASSERT_EQUAL_HEX16(0, motors.update(1300));
+        TEST_ASSERT_EQUAL_INT8(0, motors.getSpeed(2));
+        TEST_ASSERT_FALSE(motors.isActive());
+}
+
+void test_brake_and_coast()
+{
+        IOExpander io(ADDR);
+        TEST_ASSERT_TRUE(io.begin());
+        MotorController motors(&io);
+        motors.setRamp(1, 0);
+        motors.setSpeed(1, 100);
+        pass(motors, io, 0);
+        TEST_ASSERT_EQUAL_HEX16(IOExpander::motorBits(1, MOTOR_FORWARD), Wire.port(ADDR) & MOTOR_MASK);
+
+        motors.stop(1, true);
+        io.flush();
+        TEST_ASSERT_EQUAL_HEX16(IOExpander::motorBits(1, MOTOR_BRAKE), Wire.port(ADDR) & MOTOR_MASK);
+        TEST_ASSERT_FALSE(motors.isActive());
+
+        motors.stop(1, false);
+        io.flush();
+        TEST_ASSERT_EQUAL_HEX16(0, Wire.port(ADDR) & MOTOR_MASK);
+}
+
+void test_port_writes_per_period()
+{
+        IOExpander io(ADDR);
+        TEST_ASSERT_TRUE(io.begin());
+        io.stopAllMotors(); // As Core does after discovery
+        io.flush();
+        u16 pins = Wire.port(ADDR) & ~MOTOR_MASK;
+        MotorController motors(&io);
+
+        // Nothing running: no writes at all
+        u32 writes = Wire.writeCount();
+        u32 t = 0;
+        for (; t < 10 * PWM_PERIOD_MS; t += TICK_MS)
+                pass(motors, io, t);
+        TEST_ASSERT_EQUAL_UINT32(writes, Wire.writeCount());
+
+        // 50% on one motor: one on and one off edge per period
+        motors.setRamp(0, 0);
+        motors.setSpeed(0, 50);
+        pass(motors, io, t);
+        t += TICK_MS;
+        writes = Wire.writeCount();
+        for (u8 p = 0; p < 10; p++)
+        {
+                for (u8 s = 0; s < PWM_STEPS; s++, t += TICK_MS)
+                        pass(motors, io, t);
+        }
+        TEST_ASSERT_EQUAL_UINT32(20, Wire.writeCount() - writes);
+
+        // 100%: the bits never change, so the port is not written
+        motors.setSpeed(0, 100);
+        pass(motors, io, t);
+        t += TICK_MS;
+        writes = Wire.writeCount();
+        for (; t < 40 * PWM_PERIOD_MS; t += TICK_MS)
+                pass(motors, io, t);
+        TEST_ASSERT_EQUAL_UINT32(writes, Wire.writeCount());
+        TEST_ASSERT_EQUAL_HEX16(IOExpander::motorBits(0, MOTOR_FORWARD), Wire.port(ADDR) & MOTOR_MASK);
+
+        // Pins outside MOTOR_MASK are never touched
+        TEST_ASSERT_EQUAL_HEX16(pins, Wire.port(ADDR) & ~MOTOR_MASK);
+}
+
+int main(int argc, char **argv)
+{
+        UNITY_BEGIN();
+        RUN_TEST(test_duty_follows_speed);
+        RUN_TEST(test_phase_stagger);
+        RUN_TEST(test_ramp_up_and_down);
+        RUN_TEST(test_timed_move);
+        RUN_TEST(test_brake_and_coast);
+        RUN_TEST(test_port_writes_per_period);
+        return UNITY_END();
+}
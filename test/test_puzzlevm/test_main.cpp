@@ -0,0 +1,219 @@
+/************************* test_puzzlevm ************************
+ * PuzzleVM on the host (pio test -e native)
+ * Load-time checks, run-time faults and budgets, and the interpreter
+ * benchmark (ns per instruction, switch and threaded dispatch)
+ * Created by MSK, November 2025
+ ***************************************************************/
+
+#include <unity.h>
+#include <Arduino.h>
+#include "puzzlevm.h"
+
+using namespace PuzzleConfig;
+
+/************************* helpers ****************************************/
+
+// Host calls seen by the script (id and first two arguments)
+struct HostLog
+{
+        u32 calls;
+        u8 lastId;
+        int32_t args[2];
+};
+
+static HostLog g_host;
+
+static int32_t recordHost(void *ctx, u8 id, const int32_t *args)
+{
+        HostLog *log = static_cast<HostLog *>(ctx);
+        log->calls++;
+        log->lastId = id;
+        log->args[0] = PUZZLE_SYS_ARGS[id] > 0 ? args[0] : 0;
+        log->args[1] = PUZZLE_SYS_ARGS[id] > 1 ? args[1] : 0;
+        return 1;
+}
+
+// Entry table with one handler at offset 0
+static const u16 *entriesAt(PuzzleEvent event, u16 offset = 0)
+{
+        static u16 entries[PUZZLE_EVENT_COUNT];
+        for (u8 e = 0; e < PUZZLE_EVENT_COUNT; e++)
+                entries[e] = NO_ENTRY;
+        entries[event] = offset;
+        return entries;
+}
+
+// VM with a script on ON_KEY and the host log attached
+static PuzzleVM *loadKey(const u8 *code, u16 size)
+{
+        PuzzleVM *vm = new PuzzleVM(); // ~1.4 KB: keep it off the stack
+        vm->setHost(recordHost, &g_host);
+        TEST_ASSERT_TRUE(vm->load(code, size, entriesAt(PUZZLE_ON_KEY)));
+        return vm;
+}
+
+void setUp()
+{
+        g_host = HostLog();
+        setMillis(0);
+}
+
+void tearDown() {}
+
+/************************* tests ******************************************/
+
+// Count var[0] to 500, then report it: SYS_LED(ARG, var[0])
+void test_counting_loop()
+{
+        static const u8 code[] = {
+            PZ_LOAD, 0, PZ_PUSH8, 1, PZ_ADD, PZ_DUP, PZ_STORE, 0,
+            PZ_PUSH16, 0xF4, 0x01, PZ_LT, PZ_JNZ, 0xF1, 0xFF,
+            PZ_ARG, PZ_LOAD, 0, PZ_SYS, SYS_LED, PZ_END};
+        PuzzleVM *vm = loadKey(code, sizeof(code));
+
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_NONE, vm->run(PUZZLE_ON_KEY, 7));
+        TEST_ASSERT_EQUAL_UINT32(500 * 8 + 4, vm->getStepCount());
+        TEST_ASSERT_EQUAL_UINT32(1, g_host.calls);
+        TEST_ASSERT_EQUAL_UINT8(SYS_LED, g_host.lastId);
+        TEST_ASSERT_EQUAL_INT32(7, g_host.args[0]);
+        TEST_ASSERT_EQUAL_INT32(500, g_host.args[1]);
+        delete vm;
+}
+
+void test_rejects_bad_scripts()
+{
+        static const u8 underflow[] = {PZ_PUSH8, 1, PZ_ADD, PZ_END};
+        static const u8 badJump[] = {PZ_JMP, 0x10, 0x00, PZ_END};
+        static const u8 badSys[] = {PZ_SYS, SYS_COUNT, PZ_END};
+        static const u8 badVar[] = {PZ_LOAD, VAR_COUNT, PZ_DROP, PZ_END};
+        static const u8 noEnd[] = {PZ_PUSH8, 1, PZ_DROP};
+        // Loop that grows the stack by one per pass
+        static const u8 growing[] = {PZ_PUSH8, 1, PZ_JMP, 0xFB, 0xFF};
+
+        const u16 *entries = entriesAt(PUZZLE_ON_START);
+        TEST_ASSERT_FALSE(PuzzleVM::validate(underflow, sizeof(underflow), entries));
+        TEST_ASSERT_FALSE(PuzzleVM::validate(badJump, sizeof(badJump), entries));
+        TEST_ASSERT_FALSE(PuzzleVM::validate(badSys, sizeof(badSys), entries));
+        TEST_ASSERT_FALSE(PuzzleVM::validate(badVar, sizeof(badVar), entries));
+        TEST_ASSERT_FALSE(PuzzleVM::validate(noEnd, sizeof(noEnd), entries));
+        TEST_ASSERT_FALSE(PuzzleVM::validate(growing, sizeof(growing), entries));
+        TEST_ASSERT_FALSE(PuzzleVM::validate(underflow, sizeof(underflow), entriesAt(PUZZLE_ON_START, 1)));
+}
+
+void test_step_budget()
+{
+        static const u8 spin[] = {PZ_JMP, 0xFD, 0xFF};
+        PuzzleVM *vm = loadKey(spin, sizeof(spin));
+
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_STEPS, vm->run(PUZZLE_ON_KEY, 0));
+        TEST_ASSERT_EQUAL_UINT32(MAX_STEPS, vm->getStepCount());
+        TEST_ASSERT_EQUAL_UINT32(1, vm->getFaultCount());
+        delete vm;
+}
+
+void test_index_fault()
+{
+        // var[60 + ARG]: ARG 3 is the last variable, ARG 4 is past it
+        static const u8 code[] = {PZ_ARG, PZ_LOADX, 60, PZ_DROP, PZ_END};
+        PuzzleVM *vm = loadKey(code, sizeof(code));
+
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_NONE, vm->run(PUZZLE_ON_KEY, 3));
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_INDEX, vm->run(PUZZLE_ON_KEY, 4));
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_INDEX, vm->run(PUZZLE_ON_KEY, -1));
+        delete vm;
+}
+
+void test_host_call_budget()
+{
+        // SYS_SHOW ARG times, then END
+        static const u8 code[] = {
+            PZ_ARG, PZ_DUP, PZ_JZ, 8, 0,
+            PZ_SYS, SYS_SHOW, PZ_PUSH8, 1, PZ_SUB, PZ_JMP, 0xF4, 0xFF,
+            PZ_DROP, PZ_END};
+        PuzzleVM *vm = loadKey(code, sizeof(code));
+
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_NONE, vm->run(PUZZLE_ON_KEY, MAX_SYS_CALLS));
+        TEST_ASSERT_EQUAL_UINT32(MAX_SYS_CALLS, g_host.calls);
+
+        // One more call aborts the handler before the host runs it
+        g_host = HostLog();
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_HOST_CALLS, vm->run(PUZZLE_ON_KEY, MAX_SYS_CALLS + 1));
+        TEST_ASSERT_EQUAL_UINT32(MAX_SYS_CALLS, g_host.calls);
+
+        // The budget is per event
+        g_host = HostLog();
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_NONE, vm->run(PUZZLE_ON_KEY, MAX_SYS_CALLS));
+        TEST_ASSERT_EQUAL_UINT32(MAX_SYS_CALLS, g_host.calls);
+        delete vm;
+}
+
+void test_timers()
+{
+        // ON_START: TIMER(2, 100); ON_TIMER: SYS_LED(ARG, NOW)
+        static const u8 code[] = {
+            PZ_PUSH8, 2, PZ_PUSH8, 100, PZ_TIMER, PZ_END,
+            PZ_ARG, PZ_NOW, PZ_SYS, SYS_LED, PZ_END};
+        u16 entries[PUZZLE_EVENT_COUNT];
+        for (u8 e = 0; e < PUZZLE_EVENT_COUNT; e++)
+                entries[e] = NO_ENTRY;
+        entries[PUZZLE_ON_START] = 0;
+        entries[PUZZLE_ON_TIMER] = 6;
+
+        PuzzleVM *vm = new PuzzleVM();
+        vm->setHost(recordHost, &g_host);
+        TEST_ASSERT_TRUE(vm->load(code, sizeof(code), entries));
+        TEST_ASSERT_EQUAL_UINT8(PZ_FAULT_NONE, vm->run(PUZZLE_ON_START));
+
+        setMillis(99);
+        vm->tick();
+        TEST_ASSERT_EQUAL_UINT32(0, g_host.calls);
+
+        setMillis(100);
+        vm->tick();
+        vm->tick(); // One-shot
+        TEST_ASSERT_EQUAL_UINT32(1, g_host.calls);
+        TEST_ASSERT_EQUAL_INT32(2, g_host.args[0]);
+        TEST_ASSERT_EQUAL_INT32(100, g_host.args[1]);
+        delete vm;
+}
+
+// ns per instruction through run() (configured dispatch), then the
+// firmware's own benchmark (both dispatch modes, as printed at boot)
+void test_benchmark()
+{
+        static const u8 code[] = {
+            PZ_PUSH8, 0, PZ_STORE, 0,
+            PZ_LOAD, 0, PZ_PUSH8, 1, PZ_ADD, PZ_DUP, PZ_STORE, 0,
+            PZ_PUSH16, 0xF4, 0x01, PZ_LT, PZ_JNZ, 0xF1, 0xFF, PZ_END};
+        PuzzleVM *vm = loadKey(code, sizeof(code));
+
+        constexpr u32 RUNS = 2000;
+        uint64_t steps = 0;
+        u32 start = ESP.getCycleCount(); // Host nanoseconds (test/native/Arduino.h)
+        for (u32 r = 0; r < RUNS; r++)
+        {
+                vm->run(PUZZLE_ON_KEY, 0);
+                steps += vm->getStepCount();
+        }
+        u32 ns = ESP.getCycleCount() - start;
+        TEST_ASSERT_EQUAL_UINT32(RUNS * (500 * 8 + 3), (u32)steps);
+        Serial.printf("[PVM] run()  %s  %.2f ns/op  (%llu ops)  worst-case event ~%.1f us\n",
+                      THREADED ? "threaded" : "switch", (double)ns / steps, (unsigned long long)steps,
+                      (double)ns / steps * MAX_STEPS / 1000.0);
+        delete vm;
+
+        PuzzleVM::benchmark();
+}
+
+int main(int argc, char **argv)
+{
+        UNITY_BEGIN();
+        RUN_TEST(test_counting_loop);
+        RUN_TEST(test_rejects_bad_scripts);
+        RUN_TEST(test_step_budget);
+        RUN_TEST(test_index_fault);
+        RUN_TEST(test_host_call_budget);
+        RUN_TEST(test_timers);
+        RUN_TEST(test_benchmark);
+        return UNITY_END();
+}
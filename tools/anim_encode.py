@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+anim_encode.py - Convert sprite sheets into PackedAnimation headers.
+
+Input (one of):
+  sheet.png       Sprite sheet, one frame per row of pixels (width = LEDs)
+                  or a grid of frames with --frame WxH (row-major pixels)
+  anim.gif        Animated GIF, one GIF frame per animation frame
+  header.h        Existing raw BitmapAnimation arrays (u32 name[][N] = {...});
+                  CLR_* names are resolved from include/colors.h
+
+Output: a C header with the palette, the token stream and a PackedAnimation
+descriptor, plus a size report on stdout. With --asset ID, -o names a
+directory instead and each animation is written as an AssetStore file
+(<id>.bin, IDs counting up from ID) for data/assets (pio run -t uploadfs) or
+a CORE_ASSET upload (see include/assetstore.h).
+
+Token stream (see PackedAnimToken in include/animation.h), count stored as n-1:
+  0nnnnnnn idx      RUN      1-128 LEDs of one palette color
+  10nnnnnn idx...   LITERAL  1-64 LEDs, one palette index each
+  11nnnnnn          SKIP     1-64 LEDs unchanged since the previous frame
+Frame 0 never uses SKIP so looping can restart the stream from the top.
+
+Requires Pillow for PNG/GIF input (pip install pillow).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+RUN, LITERAL, SKIP = 0x00, 0x80, 0xC0
+ASSET_MAGIC, ASSET_VERSION = 0x31415352, 1
+ASSET_PACKED_ANIMATION = 1
+MAX_RUN, MAX_COUNT = 128, 64
+MAX_PALETTE = 256
+
+
+# ---------------------------------------------------------------------------
+# Input
+# ---------------------------------------------------------------------------
+
+def load_image_frames(path, frame_size):
+    from PIL import Image, ImageSequence
+
+    img = Image.open(path)
+    frames = []
+
+    if getattr(img, "is_animated", False):
+        for frame in ImageSequence.Iterator(img):
+            rgb = frame.convert("RGB")
+            frames.append([pack(*px) for px in rgb.getdata()])
+        return frames
+
+    rgb = img.convert("RGB")
+    width, height = rgb.size
+    if frame_size:
+        fw, fh = frame_size
+        for top in range(0, height - fh + 1, fh):
+            for left in range(0, width - fw + 1, fw):
+                tile = rgb.crop((left, top, left + fw, top + fh))
+                frames.append([pack(*px) for px in tile.getdata()])
+    else:
+        pixels = list(rgb.getdata())
+        for row in range(height):
+            frames.append([pack(*px) for px in pixels[row * width:(row + 1) * width]])
+    return frames
+
+
+def load_header_frames(path, colors_path):
+    names = {}
+    if colors_path and os.path.exists(colors_path):
+        for name, value in re.findall(r"#define\s+(\w+)\s+(0x[0-9A-Fa-f]+)", open(colors_path).read()):
+            names[name] = int(value, 16)
+
+    text = re.sub(r"//[^\n]*", "", open(path).read())
+    rates = dict((name, int(fps)) for name, fps in re.findall(r"createBitmapAnimation\((\w+),\s*(\d+)\)", text))
+    arrays = {}
+    for name, body in re.findall(r"u32\s+(\w+)\s*\[\s*\]\s*\[\s*\d+\s*\]\s*=\s*\{(.*?)\};", text, re.S):
+        frames = []
+        for row in re.findall(r"\{([^{}]*)\}", body):
+            values = [v.strip() for v in row.split(",") if v.strip()]
+            frames.append([int(v, 0) if v[0].isdigit() else names[v] for v in values])
+        arrays[name] = (frames, rates.get(name))
+    return arrays
+
+
+def pack(r, g, b):
+    return (r << 16) | (g << 8) | b
+
+
+# ---------------------------------------------------------------------------
+# Encoding
+# ---------------------------------------------------------------------------
+
+def build_palette(frames):
+    palette = []
+    lookup = {}
+    for frame in frames:
+        for color in frame:
+            if color not in lookup:
+                lookup[color] = len(palette)
+                palette.append(color)
+    if len(palette) > MAX_PALETTE:
+        sys.exit("error: %d colors, palette holds %d (reduce colors first)" % (len(palette), MAX_PALETTE))
+    return palette, lookup
+
+
+def run_length(values, start, limit):
+    end = start
+    while end < len(values) and values[end] == values[start] and end - start < limit:
+        end += 1
+    return end - start
+
+
+def encode_frame(cur, prev):
+    out = bytearray()
+    i, n = 0, len(cur)
+
+    while i < n:
+        # Unchanged since the previous frame
+        if prev is not None and cur[i] == prev[i]:
+            j = i
+            while j < n and cur[j] == prev[j] and j - i < MAX_COUNT:
+                j += 1
+            out.append(SKIP | (j - i - 1))
+            i = j
+            continue
+
+        run = run_length(cur, i, MAX_RUN)
+        if run >= 2:
+            out += bytes((RUN | (run - 1), cur[i]))
+            i += run
+            continue
+
+        # Literal until a run or an unchanged pair starts
+        j = i
+        while j < n and j - i < MAX_COUNT:
+            if j > i and prev is not None and j + 1 < n and cur[j] == prev[j] and cur[j + 1] == prev[j + 1]:
+                break
+            if j > i and run_length(cur, j, 3) >= 3:
+                break
+            j += 1
+        out.append(LITERAL | (j - i - 1))
+        out += bytes(cur[i:j])
+        i = j
+
+    return out
+
+
+def encode(frames):
+    led_count = len(frames[0])
+    if any(len(f) != led_count for f in frames):
+        sys.exit("error: frames differ in LED count")
+
+    palette, lookup = build_palette(frames)
+    stream = bytearray()
+    prev = None
+    for frame in frames:
+        indices = [lookup[c] for c in frame]
+        stream += encode_frame(indices, prev)
+        prev = indices
+    return palette, stream
+
+
+def decode(palette, stream, led_count, frame_count):
+    """Reference decoder (mirrors Animation::decodePackedFrame)."""
+    frames, cur, p = [], [0] * led_count, 0
+    for _ in range(frame_count):
+        led = 0
+        while led < led_count:
+            token = stream[p]
+            p += 1
+            if not token & 0x80:
+                count = (token & 0x7F) + 1
+                cur[led:led + count] = [palette[stream[p]]] * count
+                p += 1
+            elif token & 0xC0 == LITERAL:
+                count = (token & 0x3F) + 1
+                cur[led:led + count] = [palette[x] for x in stream[p:p + count]]
+                p += count
+            else:
+                count = (token & 0x3F) + 1
+            led += count
+        frames.append(list(cur))
+    return frames
+
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def write_header(out, name, palette, stream, frame_count, led_count, fps):
+    out.write("// Generated by tools/anim_encode.py - do not edit\n")
+    out.write("// %d frames x %d LEDs, %d colors, %d bytes (raw u32: %d bytes)\n\n"
+              % (frame_count, led_count, len(palette), packed_size(palette, stream),
+                 frame_count * led_count * 4))
+
+    out.write("static const u32 %sPalette[] = {\n" % name)
+    for k in range(0, len(palette), 8):
+        out.write("    " + ", ".join("0x%06X" % c for c in palette[k:k + 8]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("static const u8 %sData[] = {\n" % name)
+    for k in range(0, len(stream), 16):
+        out.write("    " + ", ".join("0x%02X" % b for b in stream[k:k + 16]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("const PackedAnimation %s = {%sPalette, %sData, sizeof(%sData), %d, %d, %d, %d};\n"
+              % (name, name, name, name, frame_count, led_count, len(palette), fps))
+
+
+def asset_bytes(asset_id, asset_type, payload):
+    """AssetHeader (include/assetstore.h) followed by the payload."""
+    header = struct.pack("<IHBBII", ASSET_MAGIC, asset_id, asset_type, ASSET_VERSION,
+                         len(payload), zlib.crc32(payload) & 0xFFFFFFFF)
+    return header + payload
+
+
+def write_asset(directory, asset_id, palette, stream, frame_count, led_count, fps):
+    payload = struct.pack("<HHHBB", frame_count, led_count, len(palette), fps, 0)
+    payload += b"".join(struct.pack("<I", c) for c in palette) + bytes(stream)
+    path = os.path.join(directory, "%04x.bin" % asset_id)
+    with open(path, "wb") as f:
+        f.write(asset_bytes(asset_id, ASSET_PACKED_ANIMATION, payload))
+    print("  -> asset 0x%04x %s (%d bytes)" % (asset_id, path, len(payload) + 16))
+
+
+def packed_size(palette, stream):
+    return len(palette) * 4 + len(stream)
+
+
+def report(name, frames, palette, stream):
+    raw = len(frames) * len(frames[0]) * 4
+    size = packed_size(palette, stream)
+    print("%-28s %3d frames x %4d LEDs  raw %7d B  packed %6d B (palette %4d + stream %6d)  ratio %5.1f:1"
+          % (name, len(frames), len(frames[0]), raw, size, len(palette) * 4, len(stream), raw / size))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode LED animations as PackedAnimation headers")
+    parser.add_argument("input", help="PNG/GIF sprite sheet or C header with raw u32 frame arrays")
+    parser.add_argument("-o", "--output", help="Output header (default: stdout report only)")
+    parser.add_argument("-n", "--name", default="kPackedAnimation", help="Descriptor name (image input)")
+    parser.add_argument("--fps", type=int, default=25, help="Frame rate (default 25)")
+    parser.add_argument("--frame", help="Frame size WxH for grid sprite sheets")
+    parser.add_argument("--asset", type=lambda v: int(v, 0),
+                        help="Write AssetStore files into the -o directory, first asset ID")
+    parser.add_argument("--colors", default=os.path.join(os.path.dirname(__file__), "..", "include", "colors.h"),
+                        help="colors.h for CLR_* names in header input")
+    args = parser.parse_args()
+
+    if args.input.endswith(".h"):
+        sources = [(name + "Packed", frames, fps or args.fps)
+                   for name, (frames, fps) in load_header_frames(args.input, args.colors).items()]
+    else:
+        size = tuple(int(v) for v in args.frame.lower().split("x")) if args.frame else None
+        sources = [(args.name, load_image_frames(args.input, size), args.fps)]
+
+    if args.asset is not None and not args.output:
+        sys.exit("error: --asset needs -o DIR")
+
+    out = open(args.output, "w") if args.output and args.asset is None else None
+    if out:
+        out.write("#pragma once\n\n#include \"msk.h\"\n#include \"animation.h\"\n\n")
+    elif args.asset is not None:
+        os.makedirs(args.output, exist_ok=True)
+
+    for index, (name, frames, fps) in enumerate(sources):
+        palette, stream = encode(frames)
+        if decode(palette, stream, len(frames[0]), len(frames)) != frames:
+            sys.exit("error: round trip failed for %s" % name)
+        report(name, frames, palette, stream)
+        if args.asset is not None:
+            write_asset(args.output, args.asset + index, palette, stream, len(frames), len(frames[0]), fps)
+        if out:
+            write_header(out, name, palette, stream, len(frames), len(frames[0]), fps)
+            out.write("\n")
+
+    if out:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
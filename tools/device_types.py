@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+device_types.py - Generate the DeviceType enum in roomBus.ts from the firmware.
+
+Values come from `enum DeviceType` in include/deviceconfig.h and the names
+from the DEVICE_CATALOG entries in src/deviceconfig.cpp (the `name` field,
+e.g. "GlowButton"), so the server and the devices share one source. The
+firmware already checks at compile time that the catalog has one entry per
+type, in enum order.
+
+The enum is written between the "Generated from DeviceType" and "End of
+generated DeviceType" marker comments in roomBus.ts; the rest of the file
+is left alone.
+
+  tools/device_types.py           rewrite roomBus.ts
+  tools/device_types.py --check   exit 1 if roomBus.ts is out of date (CI)
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(__file__)
+ROOT = os.path.join(HERE, "..")
+BEGIN = "// Generated from DeviceType in deviceconfig.h by tools/device_types.py - do not edit"
+END = "// End of generated DeviceType"
+
+
+def load_types(header, source):
+    """[(value, C name, catalog name)] in enum order."""
+    text = open(header).read()
+    body = re.search(r"enum\s+DeviceType\s*:\s*u8\s*\{(.*?)\}", text, re.S).group(1)
+    values = {}
+    for name, value in re.findall(r"\b([A-Z][A-Z0-9_]*)\s*=\s*(\d+)", re.sub(r"//[^\n]*", "", body)):
+        if int(value) in values.values():
+            sys.exit("error: DeviceType value %s used twice" % value)
+        values[name] = int(value)
+
+    catalog = re.search(r"DEVICE_CATALOG\[\]\s*=\s*\{(.*)\n\};", open(source).read(), re.S).group(1)
+    names = dict(re.findall(r"\{\s*([A-Z][A-Z0-9_]*)\s*,\s*\"(\w+)\"", catalog))
+
+    missing = set(values) ^ set(names)
+    if missing:
+        sys.exit("error: enum and DEVICE_CATALOG disagree on: %s" % ", ".join(sorted(missing)))
+    return sorted((values[c], c, names[c]) for c in values)
+
+
+def render(types):
+    lines = [BEGIN, "export enum DeviceType {"]
+    lines += ["    %s = %d, // %s" % (name, value, cname) for value, cname, name in types]
+    lines += ["}", END]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the roomBus.ts DeviceType enum")
+    parser.add_argument("--check", action="store_true", help="Only verify roomBus.ts is up to date")
+    parser.add_argument("--header", default=os.path.join(ROOT, "include", "deviceconfig.h"))
+    parser.add_argument("--source", default=os.path.join(ROOT, "src", "deviceconfig.cpp"))
+    parser.add_argument("--ts", default=os.path.join(ROOT, "roomBus.ts"))
+    args = parser.parse_args()
+
+    types = load_types(args.header, args.source)
+    ts = open(args.ts).read()
+    block = re.compile(re.escape(BEGIN) + r".*?" + re.escape(END), re.S)
+    if not block.search(ts):
+        sys.exit("error: %s has no generated DeviceType block" % args.ts)
+    updated = block.sub(lambda m: render(types), ts, count=1)
+
+    if args.check:
+        if updated != ts:
+            sys.exit("error: %s is out of date, run tools/device_types.py" % args.ts)
+        print("roomBus.ts DeviceType up to date (%d types)" % len(types))
+    elif updated != ts:
+        with open(args.ts, "w") as f:
+            f.write(updated)
+        print("roomBus.ts DeviceType updated (%d types)" % len(types))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""
+puzzle_asm.py - Assemble puzzle logic scripts for the Puzzle VM.
+
+Source: whitespace-separated words, `;` starts a comment.
+
+  .var step                 ; one variable (all start at 0)
+  .var code 4               ; four variables: code[0..3]
+  .on start init            ; handler of an event (PuzzleEvent in puzzlevm.h:
+  .on key pressed           ;   start key keyup keyhold button timer command)
+
+  init:   7 0 =code[]  2 1 =code[]  9 2 =code[]  4 3 =code[]  end
+  pressed:
+          @step @code[] arg eq jz wrong
+          ++step @step 4 lt jnz done
+          EV_PUZZLE_SOLVED 0 0 event
+  done:   end
+  wrong:  0 =step EV_PUZZLE_FAILED 0 0 event end
+
+  <number>        push a constant (PUSH8/PUSH16/PUSH32 by range; 0x.. ok)
+  rgb:RRGGBB      push a color
+  EV_*            push an event ID from include/roombus.h
+  .const NAME N   name a constant
+  label:          jump target or handler
+  @v  =v          load / store variable v
+  @v[]  =v[]      load / store v[i] (index on the stack: i -- x, x i --)
+  ++v             increment v
+  jmp/jz/jnz L    jump to a label
+  <mnemonic>      any PuzzleOp from puzzlevm.h without the PZ_ prefix
+                  (arg, dup, add, lt, not, now, rand, param, timer, end, ...)
+  <host call>     any PuzzleSys without the SYS_ prefix
+                  (led, fill, fade, show, tone, song, silence, motor, event)
+
+Every path from every handler is checked the same way PuzzleVM::validate()
+does on the device (consistent stack depth, no underflow or overflow, no
+running off the end).
+
+Output: a C header with the bytecode and entry table, or with --asset ID, an
+ASSET_PUZZLE file <id>.bin in the -o directory for data/assets (pio run -t
+uploadfs) or a CORE_ASSET upload (then run it with PUZZLE_LOAD, see
+include/roombus.h).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+ASSET_MAGIC, ASSET_VERSION = 0x31415352, 1
+ASSET_PUZZLE = 4
+NO_ENTRY = 0xFFFF
+HERE = os.path.dirname(__file__)
+
+# Stack effect (pops, pushes) and operand bytes per mnemonic
+EFFECTS = {
+    "end": (0, 0, 0), "push8": (0, 1, 1), "push16": (0, 1, 2), "push32": (0, 1, 4),
+    "arg": (0, 1, 0), "load": (0, 1, 1), "store": (1, 0, 1), "loadx": (1, 1, 1),
+    "storex": (2, 0, 1), "inc": (0, 0, 1),
+    "dup": (1, 2, 0), "drop": (1, 0, 0), "swap": (2, 2, 0), "over": (2, 3, 0),
+    "add": (2, 1, 0), "sub": (2, 1, 0), "mul": (2, 1, 0), "div": (2, 1, 0), "mod": (2, 1, 0),
+    "neg": (1, 1, 0), "and": (2, 1, 0), "or": (2, 1, 0), "xor": (2, 1, 0),
+    "shl": (2, 1, 0), "shr": (2, 1, 0), "not": (1, 1, 0),
+    "eq": (2, 1, 0), "ne": (2, 1, 0), "lt": (2, 1, 0), "le": (2, 1, 0),
+    "gt": (2, 1, 0), "ge": (2, 1, 0), "min": (2, 1, 0), "max": (2, 1, 0),
+    "jmp": (0, 0, 2), "jz": (1, 0, 2), "jnz": (1, 0, 2),
+    "now": (0, 1, 0), "rand": (1, 1, 0), "param": (1, 1, 0), "timer": (2, 0, 0),
+    "sys": (0, 0, 1),
+}
+OPERAND_OPS = ("push8", "push16", "push32", "load", "store", "loadx", "storex", "inc", "sys")
+
+
+def enum_names(text, enum, prefix):
+    body = re.search(r"enum\s+%s\s*:\s*u8\s*\{(.*?)\}" % enum, text, re.S).group(1)
+    return re.findall(r"\b%s(\w+)" % prefix, re.sub(r"//[^\n]*", "", body))
+
+
+def load_config(include_dir):
+    """Opcodes, events, host calls and limits from puzzlevm.h; EV_* from roombus.h."""
+    text = open(os.path.join(include_dir, "puzzlevm.h")).read()
+    names = enum_names(text, "PuzzleOp", "PZ_")
+    opcodes = {n.lower(): v for v, n in enumerate(names) if n != "OP_COUNT"}
+
+    missing = set(opcodes) ^ set(EFFECTS)
+    if missing:
+        sys.exit("error: puzzlevm.h and puzzle_asm.py disagree on: %s" % ", ".join(sorted(missing)))
+
+    events = [n.lower() for n in enum_names(text, "PuzzleEvent", "PUZZLE_ON_")]
+    sys_names = [n.lower() for n in enum_names(text, "PuzzleSys", "SYS_") if n != "COUNT"]
+    arity = [int(v) for v in re.search(r"PUZZLE_SYS_ARGS\[\w+\]\s*=\s*\{([^}]*)\}", text).group(1).split(",")]
+    result = [int(v) for v in re.search(r"PUZZLE_SYS_RESULT\[\w+\]\s*=\s*\{([^}]*)\}", text).group(1).split(",")]
+    calls = {n: (i, arity[i], result[i]) for i, n in enumerate(sys_names)}
+
+    limits = dict((k, int(v, 0)) for k, v in re.findall(r"constexpr\s+\w+\s+(\w+)\s*=\s*(0x[0-9A-Fa-f]+|\d+);", text))
+
+    roombus = open(os.path.join(include_dir, "roombus.h")).read()
+    constants = dict((k, int(v, 0)) for k, v in re.findall(r"\b(EV_\w+)\s*=\s*(0x[0-9A-Fa-f]+|\d+)", roombus))
+    return opcodes, events, calls, limits, constants
+
+
+def assemble(source, opcodes, events, calls, limits, constants):
+    code, fixups, labels, entries = [], [], {}, {}
+    variables, consts = {}, dict(constants)
+    boundaries = []
+
+    def emit(op, operands=()):
+        boundaries.append(len(code))
+        code.append(opcodes[op])
+        code.extend(operands)
+
+    def push(v):
+        if -128 <= v <= 127:
+            emit("push8", (v & 0xFF,))
+        elif -32768 <= v <= 32767:
+            emit("push16", (v & 0xFF, (v >> 8) & 0xFF))
+        elif -(1 << 31) <= v < (1 << 32):
+            emit("push32", tuple((v >> s) & 0xFF for s in (0, 8, 16, 24)))
+        else:
+            raise ValueError("constant %d does not fit 32 bits" % v)
+
+    def var(name):
+        if name not in variables:
+            raise ValueError("unknown variable '%s' (declare it with .var)" % name)
+        return variables[name][0]
+
+    words = re.sub(r";[^\n]*", "", source).split()
+    k = 0
+    while k < len(words):
+        word = words[k]
+        low = word.lower()
+        k += 1
+        if low == ".var":
+            name = words[k]
+            count = 1
+            k += 1
+            if k < len(words) and re.fullmatch(r"\d+", words[k]):
+                count = int(words[k])
+                k += 1
+            base = sum(c for _, c in variables.values())
+            if base + count > limits["VAR_COUNT"]:
+                raise ValueError("more than %d variables" % limits["VAR_COUNT"])
+            variables[name] = (base, count)
+        elif low == ".const":
+            consts[words[k]] = int(words[k + 1], 0)
+            k += 2
+        elif low == ".on":
+            event = words[k].lower()
+            if event not in events:
+                raise ValueError("unknown event '%s' (%s)" % (words[k], " ".join(events)))
+            entries[event] = words[k + 1]
+            k += 2
+        elif word.endswith(":"):
+            if word[:-1] in labels:
+                raise ValueError("label '%s' defined twice" % word[:-1])
+            labels[word[:-1]] = len(code)
+        elif low in ("jmp", "jz", "jnz"):
+            emit(low, (0, 0))
+            fixups.append((len(code) - 2, words[k]))
+            k += 1
+        elif word.startswith("@") and word.endswith("[]"):
+            emit("loadx", (var(word[1:-2]),))
+        elif word.startswith("=") and word.endswith("[]"):
+            emit("storex", (var(word[1:-2]),))
+        elif word.startswith("@"):
+            emit("load", (var(word[1:]),))
+        elif word.startswith("="):
+            emit("store", (var(word[1:]),))
+        elif word.startswith("++"):
+            emit("inc", (var(word[2:]),))
+        elif low.startswith("rgb:"):
+            push(int(low[4:], 16))
+        elif low in opcodes and low not in OPERAND_OPS and low not in ("jmp", "jz", "jnz"):
+            emit(low)
+        elif low in calls:
+            emit("sys", (calls[low][0],))
+        elif word in consts:
+            push(consts[word])
+        else:
+            try:
+                push(int(word, 0))
+            except ValueError:
+                raise ValueError("unknown word '%s'" % word)
+
+    for at, label in fixups:
+        if label not in labels:
+            raise ValueError("unknown label '%s'" % label)
+        offset = labels[label] - (at + 2)
+        code[at], code[at + 1] = offset & 0xFF, (offset >> 8) & 0xFF
+
+    table = [NO_ENTRY] * len(events)
+    for event, label in entries.items():
+        if label not in labels:
+            raise ValueError("unknown label '%s' for .on %s" % (label, event))
+        table[events.index(event)] = labels[label]
+
+    if not entries:
+        raise ValueError("no handlers (.on EVENT label)")
+    if len(code) > limits["MAX_CODE"]:
+        raise ValueError("%d bytes of code, limit %d" % (len(code), limits["MAX_CODE"]))
+    names = {v: n for n, v in opcodes.items()}
+    if names[code[boundaries[-1]]] not in ("end", "jmp"):
+        raise ValueError("code runs off the end (finish with 'end' or 'jmp')")
+
+    deepest = check_stack(code, boundaries, table, names, calls, limits["STACK_DEPTH"])
+    return code, table, deepest, sum(c for _, c in variables.values())
+
+
+def check_stack(code, boundaries, table, names, calls, limit):
+    """Depth at every reachable instruction, as PuzzleVM::validate() computes it."""
+    by_id = {i: (a, r) for i, a, r in calls.values()}
+    starts = set(boundaries)
+    depth = {}
+    work = []
+    for pc in table:
+        if pc != NO_ENTRY:
+            depth[pc] = 0
+            work.append(pc)
+
+    deepest = 0
+    while work:
+        pc = work.pop()
+        op = names[code[pc]]
+        pops, pushes, size = EFFECTS[op]
+        if op == "sys":
+            pops, pushes = by_id[code[pc + 1]]
+        d = depth[pc]
+        if d < pops:
+            raise ValueError("'%s' at %d needs %d values on the stack, has %d" % (op, pc, pops, d))
+        out = d - pops + pushes
+        if out > limit:
+            raise ValueError("stack depth %d at %d, limit %d" % (out, pc, limit))
+        deepest = max(deepest, out)
+
+        nexts = []
+        if op not in ("end", "jmp"):
+            nexts.append(pc + 1 + size)
+        if op in ("jmp", "jz", "jnz"):
+            offset = code[pc + 1] | (code[pc + 2] << 8)
+            nexts.append(pc + 3 + (offset - 0x10000 if offset & 0x8000 else offset))
+        for n in nexts:
+            if n not in starts:
+                raise ValueError("jump from %d lands mid-instruction" % pc)
+            if n not in depth:
+                depth[n] = out
+                work.append(n)
+            elif depth[n] != out:
+                raise ValueError("stack depth %d and %d meet at %d" % (depth[n], out, n))
+    return deepest
+
+
+def write_header(out, name, code, table):
+    out.write("#pragma once\n\n#include \"msk.h\"\n#include \"puzzlevm.h\"\n\n")
+    out.write("// Generated by tools/puzzle_asm.py - do not edit\n\n")
+    out.write("static const u8 %sCode[] = {\n" % name)
+    for k in range(0, len(code), 16):
+        out.write("    " + ", ".join("0x%02X" % b for b in code[k:k + 16]) + ",\n")
+    out.write("};\n\n")
+    out.write("static const u16 %sEntries[PUZZLE_EVENT_COUNT] = {%s};\n"
+              % (name, ", ".join("0x%04X" % e for e in table)))
+
+
+def asset_bytes(asset_id, code, table):
+    """AssetHeader + PuzzleAssetHeader (include/assetstore.h), code."""
+    payload = struct.pack("<H%dH" % len(table), len(code), *table) + bytes(code)
+    header = struct.pack("<IHBBII", ASSET_MAGIC, asset_id, ASSET_PUZZLE, ASSET_VERSION,
+                         len(payload), zlib.crc32(payload) & 0xFFFFFFFF)
+    return header + payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Assemble puzzle logic scripts")
+    parser.add_argument("input", help="Script source file")
+    parser.add_argument("-o", "--output", help="Output header, or directory with --asset (default: report only)")
+    parser.add_argument("-n", "--name", default="kPuzzle", help="Array name prefix in the header")
+    parser.add_argument("--asset", type=lambda v: int(v, 0), help="Write an ASSET_PUZZLE file with this ID")
+    parser.add_argument("--include", default=os.path.join(HERE, "..", "include"))
+    args = parser.parse_args()
+
+    if args.asset is not None and not args.output:
+        sys.exit("error: --asset needs -o DIR")
+
+    config = load_config(args.include)
+    try:
+        code, table, depth, variables = assemble(open(args.input).read(), *config)
+    except (ValueError, IndexError) as e:
+        sys.exit("error: %s: %s" % (args.input, e or "unexpected end of source"))
+
+    handlers = sum(1 for e in table if e != NO_ENTRY)
+    print("%-24s %4d bytes code, %d handlers, %2d variables, stack depth %d"
+          % (os.path.basename(args.input), len(code), handlers, variables, depth))
+
+    if args.asset is not None:
+        os.makedirs(args.output, exist_ok=True)
+        path = os.path.join(args.output, "%04x.bin" % args.asset)
+        data = asset_bytes(args.asset, code, table)
+        with open(path, "wb") as f:
+            f.write(data)
+        print("  -> asset 0x%04x %s (%d bytes)" % (args.asset, path, len(data)))
+    elif args.output:
+        with open(args.output, "w") as out:
+            write_header(out, args.name, code, table)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+shader_asm.py - Assemble LED shader programs for the Shader VM.
+
+Source: whitespace-separated words, `;` starts a comment.
+  rainbow: index count div time 0.25 mul add 1 1 hsv end
+
+  <number>        push a constant (integers -128..127 as PUSH8, anything
+                  else as Q8.8 PUSH16, range -128..127.996)
+  rgb:RRGGBB      push a color (PUSHC)
+  <mnemonic>      any ShaderOp from include/shader.h without the SH_ prefix
+                  (index, x, y, time, dup, mul, sin, noise2, hsv, pal, ...)
+  .palette RRGGBB RRGGBB ...   palette for `pal` (up to MAX_PALETTE colors)
+  .width N        pixels per row for x/y (default 0 = one row)
+
+A final `end` is added if missing. The stack effect of every word is checked
+the same way Shader::validate() does on the device.
+
+Output: a C header with the bytecode, palette and a ShaderProgram descriptor,
+or with --asset ID, an ASSET_SHADER file <id>.bin in the -o directory for
+data/assets (pio run -t uploadfs) or a CORE_ASSET upload (then play it with
+ASSET_OP_PLAY, see include/roombus.h).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+ASSET_MAGIC, ASSET_VERSION = 0x31415352, 1
+ASSET_SHADER = 3
+HERE = os.path.dirname(__file__)
+
+# Stack effect (pops, pushes) per mnemonic; operand bytes are implied
+EFFECTS = {
+    "end": (1, 0), "push8": (0, 1), "push16": (0, 1), "pushc": (0, 1),
+    "index": (0, 1), "x": (0, 1), "y": (0, 1), "time": (0, 1), "count": (0, 1),
+    "dup": (1, 2), "drop": (1, 0), "swap": (2, 2), "over": (2, 3),
+    "add": (2, 1), "sub": (2, 1), "mul": (2, 1), "div": (2, 1), "mod": (2, 1),
+    "neg": (1, 1), "abs": (1, 1), "min": (2, 1), "max": (2, 1), "fract": (1, 1),
+    "floor": (1, 1), "clamp": (1, 1), "lt": (2, 1), "sel": (3, 1),
+    "sin": (1, 1), "tri": (1, 1), "noise": (1, 1), "noise2": (2, 1),
+    "hsv": (3, 1), "rgb": (3, 1), "pal": (1, 1), "mixc": (3, 1), "scalec": (2, 1),
+}
+
+
+def load_config(include_dir):
+    """Opcode values and limits from include/shader.h."""
+    text = open(os.path.join(include_dir, "shader.h")).read()
+    body = re.search(r"enum\s+ShaderOp\s*:\s*u8\s*\{(.*?)\}", text, re.S).group(1)
+    names = re.findall(r"\bSH_(\w+)", re.sub(r"//[^\n]*", "", body))
+    opcodes = {name.lower(): value for value, name in enumerate(names) if name != "OP_COUNT"}
+
+    missing = set(opcodes) ^ set(EFFECTS)
+    if missing:
+        sys.exit("error: shader.h and shader_asm.py disagree on: %s" % ", ".join(sorted(missing)))
+
+    limits = dict((k, int(v)) for k, v in re.findall(r"constexpr\s+\w+\s+(\w+)\s*=\s*(\d+);", text))
+    return opcodes, limits
+
+
+def assemble(source, opcodes, limits):
+    code, palette, width = [], [], 0
+    depth, deepest = 0, 0
+
+    def emit(op, operands=()):
+        nonlocal depth, deepest
+        pops, pushes = EFFECTS[op]
+        if depth < pops:
+            raise ValueError("'%s' needs %d values on the stack, has %d" % (op, pops, depth))
+        depth += pushes - pops
+        deepest = max(deepest, depth)
+        code.append(opcodes[op])
+        code.extend(operands)
+
+    words = re.sub(r";[^\n]*", "", source).split()
+    ended = False
+    k = 0
+    while k < len(words):
+        word = words[k].lower()
+        k += 1
+        if word == ".palette":
+            while k < len(words) and re.fullmatch(r"[0-9a-fA-F]{6}", words[k]):
+                palette.append(int(words[k], 16))
+                k += 1
+        elif word == ".width":
+            width = int(words[k], 0)
+            k += 1
+        elif word.startswith("rgb:"):
+            c = int(word[4:], 16)
+            emit("pushc", ((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF))
+        elif word in EFFECTS and word not in ("push8", "push16", "pushc"):
+            emit(word)
+            if word == "end":
+                ended = True
+                break
+        else:
+            try:
+                v = float(word)
+            except ValueError:
+                raise ValueError("unknown word '%s'" % words[k - 1])
+            if v == int(v) and -128 <= v <= 127:
+                emit("push8", (int(v) & 0xFF,))
+            else:
+                q = int(round(v * 256))
+                if not -32768 <= q <= 32767:
+                    raise ValueError("constant %s out of Q8.8 range" % word)
+                emit("push16", (q & 0xFF, (q >> 8) & 0xFF))
+
+    if k < len(words):
+        raise ValueError("words after 'end'")
+    if not ended:
+        emit("end")
+
+    if "pal" in words and not palette:
+        raise ValueError("'pal' needs a .palette")
+    if len(code) > limits["MAX_CODE"]:
+        raise ValueError("%d bytes of code, limit %d" % (len(code), limits["MAX_CODE"]))
+    if len(palette) > limits["MAX_PALETTE"]:
+        raise ValueError("%d palette colors, limit %d" % (len(palette), limits["MAX_PALETTE"]))
+    if deepest > limits["STACK_DEPTH"]:
+        raise ValueError("stack depth %d, limit %d" % (deepest, limits["STACK_DEPTH"]))
+    return code, palette, width, deepest
+
+
+def write_header(out, name, code, palette, width):
+    out.write("#pragma once\n\n#include \"msk.h\"\n#include \"shader.h\"\n\n")
+    out.write("// Generated by tools/shader_asm.py - do not edit\n\n")
+    if palette:
+        out.write("static const u32 %sPalette[] = {\n" % name)
+        for k in range(0, len(palette), 8):
+            out.write("    " + ", ".join("0x%06X" % c for c in palette[k:k + 8]) + ",\n")
+        out.write("};\n\n")
+
+    out.write("static const u8 %sCode[] = {\n" % name)
+    for k in range(0, len(code), 16):
+        out.write("    " + ", ".join("0x%02X" % b for b in code[k:k + 16]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("const ShaderProgram %s = {%sCode, sizeof(%sCode), %s, %d, %d};\n"
+              % (name, name, name, name + "Palette" if palette else "nullptr", len(palette), width))
+
+
+def asset_bytes(asset_id, code, palette, width):
+    """AssetHeader + ShaderAssetHeader (include/assetstore.h), palette, code."""
+    payload = struct.pack("<HHB3x", len(code), width, len(palette))
+    payload += b"".join(struct.pack("<I", c) for c in palette) + bytes(code)
+    header = struct.pack("<IHBBII", ASSET_MAGIC, asset_id, ASSET_SHADER, ASSET_VERSION,
+                         len(payload), zlib.crc32(payload) & 0xFFFFFFFF)
+    return header + payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Assemble LED shader programs")
+    parser.add_argument("input", help="Shader source file")
+    parser.add_argument("-o", "--output", help="Output header, or directory with --asset (default: report only)")
+    parser.add_argument("-n", "--name", default="kShader", help="Descriptor name in the header")
+    parser.add_argument("--asset", type=lambda v: int(v, 0), help="Write an ASSET_SHADER file with this ID")
+    parser.add_argument("--include", default=os.path.join(HERE, "..", "include"))
+    args = parser.parse_args()
+
+    if args.asset is not None and not args.output:
+        sys.exit("error: --asset needs -o DIR")
+
+    opcodes, limits = load_config(args.include)
+    try:
+        code, palette, width, depth = assemble(open(args.input).read(), opcodes, limits)
+    except ValueError as e:
+        sys.exit("error: %s: %s" % (args.input, e))
+
+    print("%-24s %3d bytes code, %2d colors, stack depth %d, width %d"
+          % (os.path.basename(args.input), len(code), len(palette), depth, width))
+
+    if args.asset is not None:
+        os.makedirs(args.output, exist_ok=True)
+        path = os.path.join(args.output, "%04x.bin" % args.asset)
+        data = asset_bytes(args.asset, code, palette, width)
+        with open(path, "wb") as f:
+            f.write(data)
+        print("  -> asset 0x%04x %s (%d bytes)" % (args.asset, path, len(data)))
+    elif args.output:
+        with open(args.output, "w") as out:
+            write_header(out, args.name, code, palette, width)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""
+song_encode.py - Convert the songs in src/songs.cpp into AssetStore files.
+
+Each `const Song SONG_X = {NOTES_X, ..., bpm};` becomes one ASSET_SONG file
+(<id>.bin, IDs counting up from --asset in file order) in the output
+directory, ready for data/assets (pio run -t uploadfs) or a CORE_ASSET
+upload. NOTE_*, DUR_* and SOUND_* names are resolved from include/synth.h and
+include/music.h. Layout: see AssetHeader / SongAssetHeader in
+include/assetstore.h.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+ASSET_MAGIC, ASSET_VERSION = 0x31415352, 1
+ASSET_SONG = 2
+HERE = os.path.dirname(__file__)
+
+
+def load_names(include_dir):
+    names = {}
+    for header in ("synth.h", "music.h"):
+        text = open(os.path.join(include_dir, header)).read()
+        for name, value in re.findall(r"#define\s+(\w+)\s+(\d+)\b", text):
+            names[name] = int(value)
+
+    # SoundPreset enum order
+    body = re.search(r"enum\s+SoundPreset\s*\{(.*?)\}", open(os.path.join(include_dir, "synth.h")).read(), re.S)
+    for index, name in enumerate(re.findall(r"\b(SOUND_\w+)\b", re.sub(r"//[^\n]*", "", body.group(1)))):
+        names[name] = index
+    return names
+
+
+def value(token, names):
+    token = token.strip()
+    return int(token, 0) if token[0].isdigit() else names[token]
+
+
+def load_songs(path, names):
+    text = re.sub(r"//[^\n]*", "", open(path).read())
+    arrays = {}
+    for name, body in re.findall(r"MusicNote\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\};", text, re.S):
+        arrays[name] = [[value(v, names) for v in row.split(",")] for row in re.findall(r"\{([^{}]*)\}", body)]
+
+    songs = []
+    for name, notes, bpm in re.findall(r"const\s+Song\s+(\w+)\s*=\s*\{\s*(\w+)\s*,[^,]*,\s*(\d+)\s*\}", text):
+        songs.append((name, arrays[notes], int(bpm)))
+    return songs
+
+
+def asset_bytes(asset_id, payload):
+    header = struct.pack("<IHBBII", ASSET_MAGIC, asset_id, ASSET_SONG, ASSET_VERSION,
+                         len(payload), zlib.crc32(payload) & 0xFFFFFFFF)
+    return header + payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode songs.cpp melodies as AssetStore files")
+    parser.add_argument("-o", "--output", required=True, help="Output directory")
+    parser.add_argument("--asset", type=lambda v: int(v, 0), default=0x100, help="First asset ID (default 0x100)")
+    parser.add_argument("--songs", default=os.path.join(HERE, "..", "src", "songs.cpp"))
+    parser.add_argument("--include", default=os.path.join(HERE, "..", "include"))
+    args = parser.parse_args()
+
+    songs = load_songs(args.songs, load_names(args.include))
+    if not songs:
+        sys.exit("error: no songs found in %s" % args.songs)
+
+    os.makedirs(args.output, exist_ok=True)
+    for index, (name, notes, bpm) in enumerate(songs):
+        payload = struct.pack("<HBB", len(notes), bpm, 0)
+        payload += b"".join(struct.pack("<HHHBB", n, d, a, p, 0) for n, d, a, p in notes)
+        asset_id = args.asset + index
+        path = os.path.join(args.output, "%04x.bin" % asset_id)
+        with open(path, "wb") as f:
+            f.write(asset_bytes(asset_id, payload))
+        print("%-16s %3d notes @ %3d bpm  -> asset 0x%04x %s (%d bytes)"
+              % (name, len(notes), bpm, asset_id, path, len(payload) + 16))
+
+
+if __name__ == "__main__":
+    main()